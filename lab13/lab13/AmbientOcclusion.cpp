@@ -0,0 +1,473 @@
+#include "AmbientOcclusion.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace
+{
+    const char* fullscreenVertexSrc = R"(
+        #version 330 core
+        void main()
+        {
+            vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+            gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+        }
+    )";
+
+    // глубина [0, 1] -> расстояние по оси взгляда (Mat4::Perspective)
+    const char* linearizeGlsl = R"(
+        uniform vec2 uProjZ;   // proj.m[10], proj.m[14]
+
+        float LinearDepth(float d)
+        {
+            return uProjZ.y / (d * 2.0 - 1.0 + uProjZ.x);
+        }
+    )";
+
+    const char* linearFragmentSrc = R"(
+        out float Distance;
+
+        uniform sampler2D uDepth;
+        uniform int uScale;      // 1 или 2
+        uniform ivec2 uSize;     // используемая часть uDepth
+
+        float Depth(ivec2 p)
+        {
+            return texelFetch(uDepth, min(p, uSize - 1), 0).r;
+        }
+
+        void main()
+        {
+            ivec2 p = ivec2(gl_FragCoord.xy);
+            ivec2 s = p * uScale;
+            if (uScale == 1)
+            {
+                Distance = LinearDepth(Depth(s));
+                return;
+            }
+            // шахматный порядок: ближняя и дальняя глубины блока чередуются
+            vec4 d = vec4(Depth(s), Depth(s + ivec2(1, 0)), Depth(s + ivec2(0, 1)), Depth(s + ivec2(1, 1)));
+            float nearest = min(min(d.x, d.y), min(d.z, d.w));
+            float farthest = max(max(d.x, d.y), max(d.z, d.w));
+            Distance = LinearDepth(((p.x + p.y) & 1) == 0 ? nearest : farthest);
+        }
+    )";
+
+    const char* aoFragmentSrc = R"(
+        #version 330 core
+        out vec2 Result;         // AO, расстояние
+
+        uniform sampler2D uDistance;
+        uniform ivec2 uSize;
+        uniform vec3 uProj;      // масштабы проекции x, y; дальняя плоскость
+        uniform int uSamples;
+        uniform float uRadius;
+        uniform int uFrame;
+
+        const float kTwoPi = 6.2831853;
+        const float kGoldenAngle = 2.3999632;
+        // порядок Байера 4x4: у соседних пикселей далёкие повороты
+        const float kBayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0,
+                                           3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+
+        vec3 ViewPos(ivec2 p)
+        {
+            p = clamp(p, ivec2(0), uSize - 1);
+            float z = texelFetch(uDistance, p, 0).r;
+            vec2 ndc = (vec2(p) + 0.5) / vec2(uSize) * 2.0 - 1.0;
+            return vec3(ndc.x / uProj.x * z, ndc.y / uProj.y * z, -z);
+        }
+
+        void main()
+        {
+            ivec2 p = ivec2(gl_FragCoord.xy);
+            vec3 c = ViewPos(p);
+            float z = -c.z;
+            float screenRadius = uRadius * uProj.y * 0.5 * float(uSize.y) / z;
+            if (z > uProj.z * 0.99 || screenRadius < 1.0)
+            {
+                Result = vec2(1.0, z);
+                return;
+            }
+
+            // нормаль по глубине: из двух соседей — тот, что ближе по глубине
+            vec3 l = ViewPos(p - ivec2(1, 0));
+            vec3 r = ViewPos(p + ivec2(1, 0));
+            vec3 b = ViewPos(p - ivec2(0, 1));
+            vec3 t = ViewPos(p + ivec2(0, 1));
+            vec3 dx = abs(r.z - c.z) < abs(c.z - l.z) ? r - c : c - l;
+            vec3 dy = abs(t.z - c.z) < abs(c.z - b.z) ? t - c : c - b;
+            vec3 n = normalize(cross(dx, dy));
+
+            // шаблон 4x4 + сдвиг по кадрам (золотое сечение)
+            float noise = kBayer[(p.x & 3) + (p.y & 3) * 4] / 16.0;
+            float frame = float(uFrame % 64);
+            float rotation = kTwoPi * fract(noise + frame * 0.618034);
+            float offset = fract(noise + 0.5 / 16.0 + frame * 0.414214);
+
+            screenRadius = min(screenRadius, 64.0);
+            float r2 = uRadius * uRadius;
+            float occlusion = 0.0;
+            for (int i = 0; i < uSamples; ++i)
+            {
+                float s = (float(i) + offset) / float(uSamples);
+                float angle = rotation + float(i) * kGoldenAngle;
+                vec2 o = vec2(cos(angle), sin(angle)) * max(s * screenRadius, 1.0);
+                vec3 v = ViewPos(p + ivec2(round(o))) - c;
+                float vv = dot(v, v);
+                // косинус к нормали, затухание к краю радиуса
+                occlusion += max(0.0, dot(v, n) * inversesqrt(vv + 1e-6) - 0.1) * max(0.0, 1.0 - vv / r2);
+            }
+            Result = vec2(clamp(1.0 - 2.0 * occlusion / float(uSamples), 0.0, 1.0), z);
+        }
+    )";
+
+    const char* temporalFragmentSrc = R"(
+        #version 330 core
+        out vec2 Result;
+
+        uniform sampler2D uCurrent;
+        uniform sampler2D uHistory;
+        uniform ivec2 uSize;
+        uniform vec2 uProjScale;     // масштабы проекции x, y
+        uniform mat4 uReproject;     // вид этого кадра -> клип прошлого
+        uniform float uWeight;       // 0 — истории нет
+        uniform vec2 uHistoryUV;     // используемая доля текстуры истории
+
+        void main()
+        {
+            ivec2 p = ivec2(gl_FragCoord.xy);
+            vec2 current = texelFetch(uCurrent, p, 0).rg;
+            Result = current;
+            if (uWeight <= 0.0)
+                return;
+
+            float z = current.g;
+            vec2 ndc = (vec2(p) + 0.5) / vec2(uSize) * 2.0 - 1.0;
+            vec4 prev = uReproject * vec4(ndc.x / uProjScale.x * z, ndc.y / uProjScale.y * z, -z, 1.0);
+            if (prev.w <= 0.0)
+                return;
+            vec2 uv = prev.xy / prev.w * 0.5 + 0.5;
+            if (any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0))))
+                return;
+
+            // прошлый кадр видел здесь ту же поверхность?
+            vec2 history = texture(uHistory, uv * uHistoryUV).rg;
+            if (abs(history.g - prev.w) > 0.05 * prev.w)
+                return;
+            Result = vec2(mix(current.r, history.r, uWeight), z);
+        }
+    )";
+
+    const char* compositeFragmentSrc = R"(
+        out vec4 FragColor;
+
+        uniform sampler2D uScene;
+        uniform sampler2D uDepth;
+        uniform sampler2D uOcclusion;   // RG: AO, расстояние
+        uniform vec4 uViewport;
+        uniform int uScale;
+        uniform ivec2 uAoSize;
+        uniform float uStrength;
+
+        void main()
+        {
+            ivec2 p = ivec2(gl_FragCoord.xy - uViewport.xy);
+            vec4 color = texelFetch(uScene, p, 0);
+            float z = LinearDepth(texelFetch(uDepth, p, 0).r);
+
+            // четыре ближайших текселя AO: билинейный вес x близость глубины
+            vec2 a = (vec2(p) + 0.5) / float(uScale) - 0.5;
+            ivec2 i = ivec2(floor(a));
+            vec2 f = a - vec2(i);
+            float sum = 0.0;
+            float weights = 0.0;
+            for (int k = 0; k < 4; ++k)
+            {
+                ivec2 o = ivec2(k & 1, k >> 1);
+                vec2 s = texelFetch(uOcclusion, clamp(i + o, ivec2(0), uAoSize - 1), 0).rg;
+                vec2 bw = mix(1.0 - f, f, vec2(o));
+                float w = (bw.x * bw.y + 1e-3) / (1e-3 + abs(s.g - z) / z);
+                sum += s.r * w;
+                weights += w;
+            }
+            float ao = sum / weights;
+            FragColor = vec4(color.rgb * mix(1.0, ao, uStrength), color.a);
+        }
+    )";
+
+    GLuint CheckLinked(GLuint prog)
+    {
+        GLint ok = 0;
+        glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+        if (ok)
+            return prog;
+        glDeleteProgram(prog);
+        return 0;
+    }
+
+    GLuint FullscreenProgram(const std::string& fragSrc)
+    {
+        GLuint vert = CompileShader(GL_VERTEX_SHADER, fullscreenVertexSrc);
+        GLuint frag = CompileShader(GL_FRAGMENT_SHADER, fragSrc.c_str());
+        GLuint prog = CheckLinked(LinkProgram(vert, frag));
+        glDeleteShader(vert);
+        glDeleteShader(frag);
+        return prog;
+    }
+
+    // текстура с framebuffer вокруг неё
+    void CreateTarget(GLenum internalFormat, GLenum format, GLenum type, unsigned w, unsigned h,
+        GLint filter, GLuint& tex, GLuint& fbo)
+    {
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "AO target is incomplete: " << w << "x" << h << std::endl;
+    }
+
+    void BindTexture(GLuint unit, GLuint tex)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, tex);
+    }
+}
+
+bool AmbientOcclusion::Init(const AmbientOcclusionSettings& s)
+{
+    settings = s;
+    settings.downscale = std::clamp(settings.downscale, 1u, 2u);
+    settings.samples = std::clamp(settings.samples, 1u, 64u);
+    settings.history = std::clamp(settings.history, 0.0f, 0.98f);
+
+    const std::string version = "#version 330 core\n";
+    linearProg = FullscreenProgram(version + linearizeGlsl + linearFragmentSrc);
+    aoProg = FullscreenProgram(aoFragmentSrc);
+    temporalProg = FullscreenProgram(temporalFragmentSrc);
+    compositeProg = FullscreenProgram(version + linearizeGlsl + compositeFragmentSrc);
+    if (!linearProg || !aoProg || !temporalProg || !compositeProg)
+    {
+        Destroy();
+        return false;
+    }
+
+    linearProjLoc = glGetUniformLocation(linearProg, "uProjZ");
+    linearScaleLoc = glGetUniformLocation(linearProg, "uScale");
+    linearSizeLoc = glGetUniformLocation(linearProg, "uSize");
+    aoSizeLoc = glGetUniformLocation(aoProg, "uSize");
+    aoProjLoc = glGetUniformLocation(aoProg, "uProj");
+    aoSamplesLoc = glGetUniformLocation(aoProg, "uSamples");
+    aoRadiusLoc = glGetUniformLocation(aoProg, "uRadius");
+    aoFrameLoc = glGetUniformLocation(aoProg, "uFrame");
+    temporalSizeLoc = glGetUniformLocation(temporalProg, "uSize");
+    temporalProjLoc = glGetUniformLocation(temporalProg, "uProjScale");
+    temporalReprojectLoc = glGetUniformLocation(temporalProg, "uReproject");
+    temporalWeightLoc = glGetUniformLocation(temporalProg, "uWeight");
+    temporalHistoryUVLoc = glGetUniformLocation(temporalProg, "uHistoryUV");
+    compositeViewportLoc = glGetUniformLocation(compositeProg, "uViewport");
+    compositeProjLoc = glGetUniformLocation(compositeProg, "uProjZ");
+    compositeScaleLoc = glGetUniformLocation(compositeProg, "uScale");
+    compositeAoSizeLoc = glGetUniformLocation(compositeProg, "uAoSize");
+    compositeStrengthLoc = glGetUniformLocation(compositeProg, "uStrength");
+
+    glUseProgram(linearProg);
+    glUniform1i(glGetUniformLocation(linearProg, "uDepth"), 0);
+    glUseProgram(aoProg);
+    glUniform1i(glGetUniformLocation(aoProg, "uDistance"), 0);
+    glUseProgram(temporalProg);
+    glUniform1i(glGetUniformLocation(temporalProg, "uCurrent"), 0);
+    glUniform1i(glGetUniformLocation(temporalProg, "uHistory"), 1);
+    glUseProgram(compositeProg);
+    glUniform1i(glGetUniformLocation(compositeProg, "uScene"), 0);
+    glUniform1i(glGetUniformLocation(compositeProg, "uDepth"), 1);
+    glUniform1i(glGetUniformLocation(compositeProg, "uOcclusion"), 2);
+    glUseProgram(0);
+
+    glGenVertexArrays(1, &emptyVAO);
+    timer.Init(4, true);
+    return true;
+}
+
+void AmbientOcclusion::Destroy()
+{
+    Free();
+    timer.Destroy();
+    for (GLuint* prog : { &linearProg, &aoProg, &temporalProg, &compositeProg })
+    {
+        glDeleteProgram(*prog);
+        *prog = 0;
+    }
+    glDeleteVertexArrays(1, &emptyVAO);
+    emptyVAO = 0;
+}
+
+void AmbientOcclusion::Allocate(unsigned w, unsigned h)
+{
+    capacityWidth = w;
+    capacityHeight = h;
+
+    CreateTarget(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, w, h, GL_NEAREST, colorTex, sceneFBO);
+    glGenTextures(1, &depthTex);
+    glBindTexture(GL_TEXTURE_2D, depthTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, w, h, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTex, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "AO scene target is incomplete: " << w << "x" << h << std::endl;
+
+    unsigned aw = (w + settings.downscale - 1) / settings.downscale;
+    unsigned ah = (h + settings.downscale - 1) / settings.downscale;
+    CreateTarget(GL_R32F, GL_RED, GL_FLOAT, aw, ah, GL_NEAREST, linearTex, linearFBO);
+    CreateTarget(GL_RG16F, GL_RG, GL_HALF_FLOAT, aw, ah, GL_NEAREST, aoTex, aoFBO);
+    for (int i = 0; i < 2; ++i)
+        CreateTarget(GL_RG16F, GL_RG, GL_HALF_FLOAT, aw, ah, GL_LINEAR, historyTex[i], historyFBO[i]);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    historyValid = false;
+}
+
+void AmbientOcclusion::Free()
+{
+    GLuint fbos[5] = { sceneFBO, linearFBO, aoFBO, historyFBO[0], historyFBO[1] };
+    GLuint textures[6] = { colorTex, depthTex, linearTex, aoTex, historyTex[0], historyTex[1] };
+    glDeleteFramebuffers(5, fbos);
+    glDeleteTextures(6, textures);
+    sceneFBO = linearFBO = aoFBO = historyFBO[0] = historyFBO[1] = 0;
+    colorTex = depthTex = linearTex = aoTex = historyTex[0] = historyTex[1] = 0;
+    capacityWidth = capacityHeight = 0;
+    historyValid = false;
+}
+
+void AmbientOcclusion::BeginScene()
+{
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFBO);
+    glGetIntegerv(GL_VIEWPORT, targetViewport);
+
+    width = std::max(1, targetViewport[2]);
+    height = std::max(1, targetViewport[3]);
+    if (width > capacityWidth || height > capacityHeight)
+    {
+        unsigned newW = std::max(width, capacityWidth);
+        unsigned newH = std::max(height, capacityHeight);
+        Free();
+        Allocate(newW, newH);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+    glViewport(0, 0, width, height);
+}
+
+void AmbientOcclusion::DrawPass(GLuint fbo, unsigned w, unsigned h)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, w, h);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+void AmbientOcclusion::EndScene(const Mat4& view, const Mat4& proj)
+{
+    double ms = 0.0;
+    if (timer.Poll(ms))
+        gpuMs.Add(ms);
+    timer.Begin();
+
+    unsigned scale = settings.downscale;
+    unsigned aw = (width + scale - 1) / scale;
+    unsigned ah = (height + scale - 1) / scale;
+    // история другого размера не совпадёт по пикселям
+    if (aw != historyWidth || ah != historyHeight)
+    {
+        historyValid = false;
+        historyWidth = aw;
+        historyHeight = ah;
+    }
+    float farPlane = proj.m[14] / (proj.m[10] + 1.0f);
+
+    glDisable(GL_DEPTH_TEST);
+    glBindVertexArray(emptyVAO);
+
+    // --- глубина в расстояние, в разрешении AO ---
+    glUseProgram(linearProg);
+    glUniform2f(linearProjLoc, proj.m[10], proj.m[14]);
+    glUniform1i(linearScaleLoc, scale);
+    glUniform2i(linearSizeLoc, width, height);
+    BindTexture(0, depthTex);
+    DrawPass(linearFBO, aw, ah);
+
+    // --- AO кадра ---
+    glUseProgram(aoProg);
+    glUniform2i(aoSizeLoc, aw, ah);
+    glUniform3f(aoProjLoc, proj.m[0], proj.m[5], farPlane);
+    glUniform1i(aoSamplesLoc, settings.samples);
+    glUniform1f(aoRadiusLoc, settings.radius);
+    glUniform1i(aoFrameLoc, (GLint)frame);
+    BindTexture(0, linearTex);
+    DrawPass(aoFBO, aw, ah);
+
+    // --- накопление с прошлыми кадрами ---
+    unsigned write = historyIndex;
+    unsigned read = 1 - historyIndex;
+    Mat4 reproject = prevViewProj * InverseRigid(view);
+    glUseProgram(temporalProg);
+    glUniform2i(temporalSizeLoc, aw, ah);
+    glUniform2f(temporalProjLoc, proj.m[0], proj.m[5]);
+    glUniformMatrix4fv(temporalReprojectLoc, 1, GL_FALSE, reproject.m);
+    glUniform1f(temporalWeightLoc, historyValid ? settings.history : 0.0f);
+    unsigned capW = (capacityWidth + scale - 1) / scale;
+    unsigned capH = (capacityHeight + scale - 1) / scale;
+    glUniform2f(temporalHistoryUVLoc, (float)aw / capW, (float)ah / capH);
+    BindTexture(0, aoTex);
+    BindTexture(1, historyTex[read]);
+    DrawPass(historyFBO[write], aw, ah);
+
+    // --- цвет x AO в цель ---
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+    glViewport(targetViewport[0], targetViewport[1], targetViewport[2], targetViewport[3]);
+    glUseProgram(compositeProg);
+    glUniform4f(compositeViewportLoc, (float)targetViewport[0], (float)targetViewport[1],
+        (float)width, (float)height);
+    glUniform2f(compositeProjLoc, proj.m[10], proj.m[14]);
+    glUniform1i(compositeScaleLoc, scale);
+    glUniform2i(compositeAoSizeLoc, aw, ah);
+    glUniform1f(compositeStrengthLoc, settings.strength);
+    BindTexture(0, colorTex);
+    BindTexture(1, depthTex);
+    BindTexture(2, historyTex[write]);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    for (GLuint unit = 0; unit < 3; ++unit)
+        BindTexture(unit, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(0);
+    glUseProgram(0);
+    glEnable(GL_DEPTH_TEST);
+
+    historyValid = true;
+    historyIndex = read;
+    prevViewProj = proj * view;
+    ++frame;
+
+    timer.End();
+}
+
+std::string AmbientOcclusion::Summary() const
+{
+    char buf[192];
+    unsigned scale = settings.downscale;
+    std::snprintf(buf, sizeof(buf), "%s res %ux%u, %u samples, radius %.2f, history %.2f, GPU: ",
+        scale == 1 ? "full" : "half", (width + scale - 1) / scale, (height + scale - 1) / scale,
+        settings.samples, settings.radius, settings.history);
+    return buf + gpuMs.Summary();
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "FrameStats.h"
+#include "GlUtils.h"
+#include "GpuTimer.h"
+#include "Math3D.h"
+
+#include <string>
+
+// =======================================================
+// ЗАТЕНЕНИЕ ОКРУЖЕНИЕМ В ПОЛОВИНЕ РАЗРЕШЕНИЯ (SSAO)
+// =======================================================
+//
+// Сцена рисуется в свою цель (RGBA16F + текстура глубины), затем:
+//   глубина  — в линейную, в половине разрешения: из блока 2x2 в
+//              шахматном порядке ближняя или дальняя, чтобы тонкие края
+//              не пропадали;
+//   AO       — на каждый пиксель samples выборок по спирали вокруг него
+//              (косинус к нормали с затуханием к краю радиуса); нормаль —
+//              по разностям глубины; поворот спирали — из шаблона 4x4 и
+//              номера кадра, поэтому соседние пиксели и кадры берут
+//              разные направления;
+//   история  — перепроецирование прошлого кадра по камере, отказ при
+//              расхождении глубины; шум шаблона усредняется во времени;
+//   вывод    — билатеральное увеличение (билинейные веса x близость
+//              глубины, без ореолов на краях) и умножение цвета на AO
+//              в framebuffer, который был привязан до BeginScene.
+
+struct AmbientOcclusionSettings
+{
+    unsigned downscale = 2;   // 2 — половина разрешения, 1 — полное (для сравнения)
+    unsigned samples = 8;     // выборок на пиксель за кадр
+    float radius = 1.0f;      // в мировых единицах
+    float strength = 0.8f;    // 0 — затенения нет
+    float history = 0.85f;    // вес накопленного AO, 0 — без накопления
+};
+
+class AmbientOcclusion
+{
+public:
+    bool Init(const AmbientOcclusionSettings& settings);
+    void Destroy();
+
+    // привязывает свою цель размером с текущий viewport (ёмкость только
+    // растёт); framebuffer и viewport запоминаются для EndScene
+    void BeginScene();
+    // AO по глубине кадра, затем цвет x AO — в запомненный framebuffer;
+    // view и proj — камера кадра (перепроецирование истории)
+    void EndScene(const Mat4& view, const Mat4& proj);
+
+    // "half res 600x450, 8 samples, radius 1.00, history 0.85, GPU: <FrameTimeStats>"
+    std::string Summary() const;
+
+private:
+    void Allocate(unsigned w, unsigned h);
+    void Free();
+    void DrawPass(GLuint targetFBO, unsigned w, unsigned h);
+
+    AmbientOcclusionSettings settings;
+
+    // --- полное разрешение ---
+    GLuint sceneFBO = 0;
+    GLuint colorTex = 0;           // RGBA16F: в цепочке с HDR значения > 1
+    GLuint depthTex = 0;
+    unsigned capacityWidth = 0;
+    unsigned capacityHeight = 0;
+    unsigned width = 0;            // используемая часть
+    unsigned height = 0;
+
+    // --- разрешение AO ---
+    GLuint linearFBO = 0;
+    GLuint linearTex = 0;          // R32F, расстояние по оси взгляда
+    GLuint aoFBO = 0;
+    GLuint aoTex = 0;              // RG16F: AO кадра, расстояние
+    GLuint historyFBO[2] = {};
+    GLuint historyTex[2] = {};     // RG16F, попеременно читается и пишется
+    unsigned historyIndex = 0;     // куда пишется в этом кадре
+    bool historyValid = false;
+    unsigned historyWidth = 0;     // размер, для которого история верна
+    unsigned historyHeight = 0;
+    Mat4 prevViewProj;
+    unsigned frame = 0;
+
+    GLint targetFBO = 0;
+    GLint targetViewport[4] = {};
+
+    GLuint linearProg = 0;
+    GLuint aoProg = 0;
+    GLuint temporalProg = 0;
+    GLuint compositeProg = 0;
+    GLint linearProjLoc = -1;
+    GLint linearScaleLoc = -1;
+    GLint linearSizeLoc = -1;
+    GLint aoSizeLoc = -1;
+    GLint aoProjLoc = -1;
+    GLint aoSamplesLoc = -1;
+    GLint aoRadiusLoc = -1;
+    GLint aoFrameLoc = -1;
+    GLint temporalSizeLoc = -1;
+    GLint temporalProjLoc = -1;
+    GLint temporalReprojectLoc = -1;
+    GLint temporalWeightLoc = -1;
+    GLint temporalHistoryUVLoc = -1;
+    GLint compositeViewportLoc = -1;
+    GLint compositeProjLoc = -1;
+    GLint compositeScaleLoc = -1;
+    GLint compositeAoSizeLoc = -1;
+    GLint compositeStrengthLoc = -1;
+    GLuint emptyVAO = 0;
+
+    GpuTimer timer;                // timestamps: может стоять внутри замера кадра
+    FrameTimeStats gpuMs;
+};
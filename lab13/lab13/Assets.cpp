@@ -0,0 +1,277 @@
+#include "Assets.h"
+#include "Math3D.h"
+
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+bool LoadTextureImage(const std::string& filename, sf::Image& img)
+{
+    if (!img.loadFromFile(filename))
+    {
+        std::cout << "Failed to load texture: " << filename << std::endl;
+        return false;
+    }
+    img.flipVertically();
+    return true;
+}
+
+namespace
+{
+    void SkipSpaces(const char*& p, const char* end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+            ++p;
+    }
+
+    bool ParseFloat(const char*& p, const char* end, float& out)
+    {
+        SkipSpaces(p, end);
+        if (p < end && *p == '+')
+            ++p;
+        auto r = std::from_chars(p, end, out);
+        if (r.ec != std::errc())
+            return false;
+        p = r.ptr;
+        return true;
+    }
+
+    bool ParseInt(const char*& p, const char* end, int& out)
+    {
+        auto r = std::from_chars(p, end, out);
+        if (r.ec != std::errc())
+            return false;
+        p = r.ptr;
+        return true;
+    }
+
+    // индекс OBJ (с 1, отрицательные — от конца) -> с 0, -1 если нет
+    int ResolveIndex(int i, size_t count)
+    {
+        if (i > 0)
+            return i <= (int)count ? i - 1 : -1;
+        if (i < 0)
+            return (int)count + i >= 0 ? (int)count + i : -1;
+        return -1;
+    }
+
+    // вершина меша = позиция + UV + нормаль (+ группа сглаживания, если нормали нет)
+    struct VertexKey
+    {
+        int texcoord;
+        int normal;
+        uint64_t group;
+        uint32_t next;       // следующая вершина с той же позицией
+    };
+
+    const uint32_t kNoVertex = 0xFFFFFFFFu;
+}
+
+bool LoadOBJ(const std::string& filename, MeshData& mesh, ThreadPool& pool)
+{
+    auto t0 = std::chrono::steady_clock::now();
+
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Failed to open OBJ: " << filename << std::endl;
+        return false;
+    }
+    std::string text;
+    file.seekg(0, std::ios::end);
+    text.resize((size_t)file.tellg());
+    file.seekg(0, std::ios::beg);
+    file.read(text.data(), (std::streamsize)text.size());
+
+    mesh = MeshData();
+    std::vector<Vec3> positions;
+    std::vector<float> texcoords;
+    std::vector<Vec3> normals;
+
+    std::vector<VertexKey> keys;
+    std::vector<uint32_t> firstVertex;     // по позиции: первая вершина цепочки
+    std::vector<uint32_t> normalGroup;     // по вершине, см. GenerateNormals
+    uint32_t groupCount = 0;
+
+    // без "s" весь меш сглаживается; "s off" / "s 0" — плоские грани
+    uint64_t smoothing = 0;
+    bool flat = false;
+    uint64_t faceIndex = 0;
+
+    auto vertexFor = [&](int vi, int ti, int ni) -> uint32_t
+        {
+            uint64_t group = ni >= 0 ? 0 : (flat ? (1ull << 32) | faceIndex : smoothing);
+            if (firstVertex.size() < positions.size())
+                firstVertex.resize(positions.size(), kNoVertex);
+
+            uint32_t sameGroup = kNoVertex;
+            for (uint32_t v = firstVertex[vi]; v != kNoVertex; v = keys[v].next)
+            {
+                const VertexKey& k = keys[v];
+                if (k.normal < 0 && ni < 0 && k.group == group)
+                {
+                    if (k.texcoord == ti)
+                        return v;
+                    sameGroup = v;
+                }
+                else if (k.normal == ni && ni >= 0 && k.texcoord == ti)
+                    return v;
+            }
+
+            uint32_t v = (uint32_t)keys.size();
+            keys.push_back({ ti, ni, group, firstVertex[vi] });
+            firstVertex[vi] = v;
+
+            mesh.positions.push_back(positions[vi]);
+            mesh.texcoords.push_back(ti >= 0 ? texcoords[ti * 2] : 0.0f);
+            mesh.texcoords.push_back(ti >= 0 ? texcoords[ti * 2 + 1] : 0.0f);
+            mesh.normals.push_back(ni >= 0 ? normals[ni] : Vec3());
+            if (ni >= 0)
+                normalGroup.push_back(kNoNormalGroup);
+            else
+                normalGroup.push_back(sameGroup != kNoVertex ? normalGroup[sameGroup] : groupCount++);
+            return v;
+        };
+
+    std::vector<uint32_t> face;
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end)
+    {
+        const char* lineEnd = (const char*)std::memchr(p, '\n', end - p);
+        if (!lineEnd)
+            lineEnd = end;
+        const char* q = p;
+        p = lineEnd + 1;
+        SkipSpaces(q, lineEnd);
+        if (q >= lineEnd)
+            continue;
+
+        if (q[0] == 'v' && q + 1 < lineEnd && (q[1] == ' ' || q[1] == '\t'))
+        {
+            ++q;
+            Vec3 v;
+            ParseFloat(q, lineEnd, v.x) && ParseFloat(q, lineEnd, v.y) && ParseFloat(q, lineEnd, v.z);
+            positions.push_back(v);
+        }
+        else if (q[0] == 'v' && q + 2 < lineEnd && q[1] == 't')
+        {
+            q += 2;
+            float u = 0.0f, v = 0.0f;
+            ParseFloat(q, lineEnd, u) && ParseFloat(q, lineEnd, v);
+            texcoords.push_back(u);
+            texcoords.push_back(v);
+        }
+        else if (q[0] == 'v' && q + 2 < lineEnd && q[1] == 'n')
+        {
+            q += 2;
+            Vec3 n;
+            ParseFloat(q, lineEnd, n.x) && ParseFloat(q, lineEnd, n.y) && ParseFloat(q, lineEnd, n.z);
+            normals.push_back(Normalize(n));
+        }
+        else if (q[0] == 's' && q + 1 < lineEnd && (q[1] == ' ' || q[1] == '\t'))
+        {
+            ++q;
+            SkipSpaces(q, lineEnd);
+            int group = 0;
+            flat = !ParseInt(q, lineEnd, group) || group == 0;
+            smoothing = flat ? 0 : (uint64_t)(uint32_t)group;
+        }
+        else if (q[0] == 'f' && q + 1 < lineEnd && (q[1] == ' ' || q[1] == '\t'))
+        {
+            // треугольники и многоугольники, индексы v, v/vt, v//vn или v/vt/vn
+            ++q;
+            face.clear();
+            while (true)
+            {
+                SkipSpaces(q, lineEnd);
+                int vi = 0, ti = 0, ni = 0;
+                if (q >= lineEnd || !ParseInt(q, lineEnd, vi))
+                    break;
+                if (q < lineEnd && *q == '/')
+                {
+                    ++q;
+                    if (q < lineEnd && *q != '/')
+                        ParseInt(q, lineEnd, ti);
+                    if (q < lineEnd && *q == '/')
+                    {
+                        ++q;
+                        ParseInt(q, lineEnd, ni);
+                    }
+                }
+                while (q < lineEnd && *q != ' ' && *q != '\t')
+                    ++q;
+
+                int v = ResolveIndex(vi, positions.size());
+                if (v < 0)
+                    continue;
+                face.push_back(vertexFor(v, ResolveIndex(ti, texcoords.size() / 2),
+                    ResolveIndex(ni, normals.size())));
+            }
+
+            // triangulation: (0, i-1, i) для i = 2..n-1
+            for (size_t i = 1; i + 1 < face.size(); ++i)
+            {
+                mesh.indices.push_back(face[0]);
+                mesh.indices.push_back(face[i]);
+                mesh.indices.push_back(face[i + 1]);
+            }
+            ++faceIndex;
+        }
+    }
+
+    if (mesh.indices.empty())
+    {
+        std::cout << "OBJ has no vertices: " << filename << std::endl;
+        return false;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    // --- недостающие нормали и касательные ---
+    GenerateNormals(mesh, normalGroup, groupCount, pool);
+    GenerateTangents(mesh, pool);
+    auto t2 = std::chrono::steady_clock::now();
+
+    auto ms = [](auto a, auto b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+    char timing[128];
+    std::snprintf(timing, sizeof(timing), "parse %.1f ms, normals/tangents %.1f ms", ms(t0, t1), ms(t1, t2));
+    std::cout << "OBJ loaded: " << filename
+        << ", vertices: " << mesh.VertexCount()
+        << ", triangles: " << mesh.TriangleCount()
+        << (groupCount > 0 ? ", generated normals" : "")
+        << " (" << timing << ")" << std::endl;
+    return true;
+}
+
+namespace
+{
+    std::filesystem::file_time_type WriteTime(const std::string& filename)
+    {
+        std::error_code ec;
+        auto t = std::filesystem::last_write_time(filename, ec);
+        return ec ? std::filesystem::file_time_type() : t;
+    }
+}
+
+void FileWatcher::Add(const std::string& filename)
+{
+    files.push_back({ filename, WriteTime(filename) });
+}
+
+bool FileWatcher::Changed()
+{
+    bool changed = false;
+    for (Entry& e : files)
+    {
+        auto t = WriteTime(e.filename);
+        if (t != e.time)
+        {
+            e.time = t;
+            changed = true;
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "MeshData.h"
+
+#include <SFML/Graphics/Image.hpp>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// изображение для текстуры (перевёрнуто: в GL первая строка — низ)
+bool LoadTextureImage(const std::string& filename, sf::Image& img);
+
+// индексированный меш из OBJ; нормали, которых нет в файле (vn),
+// строятся с учётом групп сглаживания, касательные — всегда
+// (параллельно на pool приложения)
+bool LoadOBJ(const std::string& filename, MeshData& mesh, ThreadPool& pool);
+
+// изменения файлов ассетов по времени последней записи
+class FileWatcher
+{
+public:
+    void Add(const std::string& filename);
+    // true — хотя бы один файл изменился с прошлого вызова
+    bool Changed();
+
+private:
+    struct Entry
+    {
+        std::string filename;
+        std::filesystem::file_time_type time;
+    };
+    std::vector<Entry> files;
+};
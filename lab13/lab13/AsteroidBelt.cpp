@@ -0,0 +1,614 @@
+#include "AsteroidBelt.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    const unsigned kVariants = 4;
+    const unsigned kNearCapacity = 65536;   // ближних камней на вариант
+    const unsigned kCullGroupSize = 256;
+
+    // общее для отбора и точек: камень по упакованному состоянию и времени
+    const char* rockGlsl = R"(
+        uniform float uTime;
+        uniform float uMinSize;
+        uniform float uMaxSize;
+
+        uint Hash(uint x)
+        {
+            x ^= x >> 16;
+            x *= 0x7feb352du;
+            x ^= x >> 15;
+            x *= 0x846ca68bu;
+            x ^= x >> 16;
+            return x;
+        }
+
+        float Hash01(uint x)
+        {
+            return float(Hash(x) >> 8) / 16777216.0;
+        }
+
+        // bits: вариант (2 бита), размер (8 бит), seed (22 бита)
+        float RockScale(uint bits)
+        {
+            return mix(uMinSize, uMaxSize, float((bits >> 2) & 255u) / 255.0);
+        }
+
+        // orbit: радиус, начальный угол, высота; скорость ~ 1/r, как у планет
+        vec3 RockPosition(vec3 orbit, uint bits)
+        {
+            float speed = (0.9 + 0.2 * Hash01(bits)) / orbit.x;
+            float angle = orbit.y + speed * uTime;
+            return vec3(cos(angle) * orbit.x, orbit.z, sin(angle) * orbit.x);
+        }
+
+        vec4 RockRotation(uint bits)
+        {
+            uint h = Hash(bits ^ 0x9e3779b9u);
+            vec3 axis = vec3(Hash01(h), Hash01(h ^ 0x68bc21ebu), Hash01(h ^ 0x02e5be93u)) * 2.0 - 1.0;
+            axis = normalize(axis + vec3(1e-3));
+            float angle = (Hash01(h + 1u) * 2.0 - 1.0) * 2.0 * uTime + Hash01(h + 2u) * 6.2831853;
+            return vec4(axis * sin(angle * 0.5), cos(angle * 0.5));
+        }
+    )";
+
+    const char* cullComputeSrc = R"(
+        layout(local_size_x = 256) in;
+
+        struct Rock
+        {
+            float radius;
+            float angle;
+            float height;
+            uint bits;
+        };
+        struct NearRock
+        {
+            vec4 placement;   // позиция, масштаб
+            vec4 rotation;
+        };
+        struct Command
+        {
+            uint count;
+            uint instanceCount;
+            uint first;
+            uint baseInstance;
+        };
+
+        layout(std430, binding = 0) readonly buffer Rocks { Rock rocks[]; };
+        layout(std430, binding = 1) writeonly buffer NearRocks { NearRock nearRocks[]; };
+        layout(std430, binding = 2) buffer Commands { Command commands[]; };
+        layout(std430, binding = 3) writeonly buffer Meshed { uint meshed[]; };
+
+        uniform uint uFrame;
+        uniform uint uCount;
+        uniform uint uCapacity;
+        uniform float uMeshDistance;
+        uniform vec3 uCamera;
+        uniform vec4 uPlanes[6];
+
+        void main()
+        {
+            uint i = gl_GlobalInvocationID.x;
+            if (i >= uCount)
+                return;
+
+            Rock rock = rocks[i];
+            vec3 p = RockPosition(vec3(rock.radius, rock.angle, rock.height), rock.bits);
+            if (distance(p, uCamera) >= uMeshDistance)
+                return;
+            float bound = RockScale(rock.bits) * 1.5;
+            for (int k = 0; k < 6; ++k)
+            {
+                if (dot(uPlanes[k].xyz, p) + uPlanes[k].w < -bound)
+                    return;
+            }
+
+            uint variant = rock.bits & 3u;
+            uint slot = atomicAdd(commands[variant].instanceCount, 1u);
+            if (slot >= uCapacity)
+            {
+                // участок полон: счётчик остаётся равным ёмкости,
+                // камень не помечен — его нарисует проход точек
+                atomicAdd(commands[variant].instanceCount, 0xFFFFFFFFu);
+                return;
+            }
+            nearRocks[variant * uCapacity + slot] =
+                NearRock(vec4(p, RockScale(rock.bits)), RockRotation(rock.bits));
+            meshed[i] = uFrame;
+        }
+    )";
+
+    const char* meshVertexSrc = R"(
+        #version 330 core
+        layout(location = 0) in vec3 aPosition;
+        layout(location = 1) in vec3 aNormal;
+        layout(location = 2) in vec4 aPlacement;   // позиция, масштаб
+        layout(location = 3) in vec4 aRotation;    // кватернион
+
+        uniform mat4 uViewProj;
+
+        out vec3 vNormal;
+        out vec3 vToSun;
+
+        vec3 Rotate(vec4 q, vec3 v)
+        {
+            return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+        }
+
+        void main()
+        {
+            vec3 world = aPlacement.xyz + Rotate(aRotation, aPosition * aPlacement.w);
+            vNormal = Rotate(aRotation, aNormal);
+            vToSun = -world;   // Солнце в начале координат
+            gl_Position = uViewProj * vec4(world, 1.0);
+        }
+    )";
+
+    const char* meshFragmentSrc = R"(
+        #version 330 core
+        in vec3 vNormal;
+        in vec3 vToSun;
+        out vec4 FragColor;
+
+        uniform vec3 uAlbedo;
+
+        void main()
+        {
+            float diffuse = max(dot(normalize(vNormal), normalize(vToSun)), 0.0);
+            FragColor = vec4(uAlbedo * (0.06 + diffuse), 1.0);
+        }
+    )";
+
+    const char* pointVertexSrc = R"(
+        layout(location = 0) in vec3 aOrbit;
+        layout(location = 1) in uint aPacked;
+        layout(location = 2) in uint aMeshed;   // кадр, в котором отбор нарисовал камень геометрией
+
+        uniform mat4 uView;
+        uniform mat4 uProj;
+        uniform float uPixelScale;      // proj.m[5] * высота viewport / 2
+        uniform uint uFrame;            // кадр отбора; 0 — геометрии нет
+
+        out vec3 vToSun;                // в пространстве камеры
+        out float vCoverage;
+
+        void main()
+        {
+            vec3 p = RockPosition(aOrbit, aPacked);
+            vec4 viewPos = uView * vec4(p, 1.0);
+            float depth = -viewPos.z;
+            if (depth <= 0.0 || (uFrame != 0u && aMeshed == uFrame))
+            {
+                gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+                gl_PointSize = 1.0;
+                vToSun = vec3(0.0, 0.0, 1.0);
+                vCoverage = 0.0;
+                return;
+            }
+            gl_Position = uProj * viewPos;
+
+            // меньше пикселя — тусклее, а не мельче
+            float diameter = 2.0 * RockScale(aPacked) * uPixelScale / depth;
+            gl_PointSize = clamp(diameter, 1.0, 64.0);
+            vCoverage = min(1.0, diameter * diameter);
+            vToSun = mat3(uView) * -p;
+        }
+    )";
+
+    const char* pointFragmentSrc = R"(
+        #version 330 core
+        in vec3 vToSun;
+        in float vCoverage;
+        out vec4 FragColor;
+
+        uniform vec3 uAlbedo;
+
+        void main()
+        {
+            // освещённая сфера на месте камня
+            vec2 d = gl_PointCoord * 2.0 - 1.0;
+            d.y = -d.y;
+            float r2 = dot(d, d);
+            if (r2 > 1.0)
+                discard;
+            vec3 n = vec3(d, sqrt(1.0 - r2));
+            float diffuse = max(dot(n, normalize(vToSun)), 0.0);
+            FragColor = vec4(uAlbedo * (0.06 + diffuse) * vCoverage, 1.0);
+        }
+    )";
+
+    struct RockState
+    {
+        float radius;
+        float angle;
+        float height;
+        uint32_t packed;
+    };
+
+    struct RockVertex
+    {
+        float position[3];
+        float normal[3];
+    };
+
+    struct DrawArraysIndirectCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint first;
+        GLuint baseInstance;
+    };
+
+    GLuint CheckLinked(GLuint prog)
+    {
+        GLint ok = 0;
+        glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+        if (ok)
+            return prog;
+        glDeleteProgram(prog);
+        return 0;
+    }
+
+    GLuint RenderProgram(const std::string& vertSrc, const char* fragSrc)
+    {
+        GLuint vert = CompileShader(GL_VERTEX_SHADER, vertSrc.c_str());
+        GLuint frag = CompileShader(GL_FRAGMENT_SHADER, fragSrc);
+        GLuint prog = CheckLinked(LinkProgram(vert, frag));
+        glDeleteShader(vert);
+        glDeleteShader(frag);
+        return prog;
+    }
+
+    // икосаэдр, каждый треугольник делится на 4; вершины на единичной сфере
+    void Icosphere(std::vector<Vec3>& vertices, std::vector<unsigned>& indices)
+    {
+        const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+        vertices = {
+            { -1, t, 0 }, { 1, t, 0 }, { -1, -t, 0 }, { 1, -t, 0 },
+            { 0, -1, t }, { 0, 1, t }, { 0, -1, -t }, { 0, 1, -t },
+            { t, 0, -1 }, { t, 0, 1 }, { -t, 0, -1 }, { -t, 0, 1 },
+        };
+        for (Vec3& v : vertices)
+            v = Normalize(v);
+        std::vector<unsigned> faces = {
+            0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+            1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+            3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+            4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1,
+        };
+
+        std::map<std::pair<unsigned, unsigned>, unsigned> midpoints;
+        auto midpoint = [&](unsigned a, unsigned b)
+            {
+                auto key = std::make_pair(std::min(a, b), std::max(a, b));
+                auto it = midpoints.find(key);
+                if (it != midpoints.end())
+                    return it->second;
+                vertices.push_back(Normalize(vertices[a] + vertices[b]));
+                unsigned index = (unsigned)vertices.size() - 1;
+                midpoints[key] = index;
+                return index;
+            };
+
+        indices.clear();
+        for (size_t f = 0; f < faces.size(); f += 3)
+        {
+            unsigned a = faces[f], b = faces[f + 1], c = faces[f + 2];
+            unsigned ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+            unsigned split[12] = { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca };
+            indices.insert(indices.end(), split, split + 12);
+        }
+    }
+}
+
+void AsteroidBelt::CreateVariants()
+{
+    std::vector<Vec3> sphere;
+    std::vector<unsigned> indices;
+    Icosphere(sphere, indices);
+
+    std::mt19937 rng(settings.seed);
+    auto frand = [&](float a, float b)
+        {
+            return a + (b - a) * (float)(rng() / 4294967295.0);
+        };
+
+    std::vector<RockVertex> vertices;
+    for (unsigned v = 0; v < kVariants; ++v)
+    {
+        // вмятины и выступы вокруг случайных направлений, затем растяжение
+        Vec3 dents[6];
+        float depth[6];
+        for (int k = 0; k < 6; ++k)
+        {
+            dents[k] = Normalize(Vec3(frand(-1, 1), frand(-1, 1), frand(-1, 1)));
+            depth[k] = frand(-0.3f, 0.15f);
+        }
+        Vec3 stretch(frand(0.7f, 1.2f), frand(0.6f, 1.0f), frand(0.8f, 1.3f));
+
+        std::vector<Vec3> shape(sphere.size());
+        float maxRadius = 0.0f;
+        for (size_t i = 0; i < sphere.size(); ++i)
+        {
+            const Vec3& n = sphere[i];
+            float r = 1.0f;
+            for (int k = 0; k < 6; ++k)
+            {
+                float c = std::max(0.0f, Dot(n, dents[k]));
+                r += depth[k] * c * c * c;
+            }
+            shape[i] = Vec3(n.x * stretch.x, n.y * stretch.y, n.z * stretch.z) * r;
+            maxRadius = std::max(maxRadius, Length(shape[i]));
+        }
+
+        // плоские грани: у каждого треугольника своя нормаль
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            Vec3 a = shape[indices[i]] * (1.0f / maxRadius);
+            Vec3 b = shape[indices[i + 1]] * (1.0f / maxRadius);
+            Vec3 c = shape[indices[i + 2]] * (1.0f / maxRadius);
+            Vec3 n = Normalize(Cross(b - a, c - a));
+            for (const Vec3& p : { a, b, c })
+                vertices.push_back({ { p.x, p.y, p.z }, { n.x, n.y, n.z } });
+        }
+    }
+    variantVertices = (unsigned)(indices.size());
+
+    glGenVertexArrays(1, &meshVAO);
+    glGenBuffers(1, &meshVBO);
+    glBindVertexArray(meshVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(RockVertex), vertices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(RockVertex), (void*)offsetof(RockVertex, position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(RockVertex), (void*)offsetof(RockVertex, normal));
+
+    glBindBuffer(GL_ARRAY_BUFFER, nearBuffer);
+    for (GLuint attr = 2; attr < 4; ++attr)
+    {
+        glEnableVertexAttribArray(attr);
+        glVertexAttribPointer(attr, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)((attr - 2) * 4 * sizeof(float)));
+        glVertexAttribDivisor(attr, 1);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+bool AsteroidBelt::Init(const AsteroidBeltSettings& s)
+{
+    settings = s;
+    settings.innerRadius = std::max(0.5f, settings.innerRadius);
+    settings.outerRadius = std::max(settings.innerRadius, settings.outerRadius);
+
+    const std::string version = "#version 330 core\n";
+    pointProg = RenderProgram(version + rockGlsl + pointVertexSrc, pointFragmentSrc);
+    if (!pointProg)
+    {
+        Destroy();
+        return false;
+    }
+    pointTimeLoc = glGetUniformLocation(pointProg, "uTime");
+    pointViewLoc = glGetUniformLocation(pointProg, "uView");
+    pointProjLoc = glGetUniformLocation(pointProg, "uProj");
+    pointPixelScaleLoc = glGetUniformLocation(pointProg, "uPixelScale");
+    pointFrameLoc = glGetUniformLocation(pointProg, "uFrame");
+
+    // серо-бурый камень; для HDR-цели — в линейном цвете
+    float albedo[3] = { 0.46f, 0.41f, 0.36f };
+    if (settings.linearOutput)
+    {
+        for (float& c : albedo)
+            c = std::pow(c, 2.2f);
+    }
+    glUseProgram(pointProg);
+    glUniform1f(glGetUniformLocation(pointProg, "uMinSize"), settings.minSize);
+    glUniform1f(glGetUniformLocation(pointProg, "uMaxSize"), settings.maxSize);
+    glUniform3fv(glGetUniformLocation(pointProg, "uAlbedo"), 1, albedo);
+
+    // --- состояние камней, один раз ---
+    std::mt19937 rng(settings.seed);
+    auto frand = [&](float a, float b)
+        {
+            return a + (b - a) * (float)(rng() / 4294967295.0);
+        };
+    std::vector<RockState> rocks(settings.count);
+    for (RockState& r : rocks)
+    {
+        // гуще к середине пояса; мелких камней больше, чем крупных
+        float u = (frand(0, 1) + frand(0, 1)) * 0.5f;
+        r.radius = settings.innerRadius + (settings.outerRadius - settings.innerRadius) * u;
+        r.angle = frand(0.0f, 6.2831853f);
+        r.height = (frand(-1, 1) + frand(-1, 1) + frand(-1, 1)) / 3.0f * settings.thickness;
+        float size = frand(0, 1);
+        uint32_t sizeByte = (uint32_t)(size * size * size * 255.0f + 0.5f);
+        r.packed = (rng() & 3u) | (sizeByte << 2) | ((rng() >> 10) << 10);
+    }
+
+    glGenBuffers(1, &rockBuffer);
+    glGenVertexArrays(1, &pointVAO);
+    glBindVertexArray(pointVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, rockBuffer);
+    glBufferData(GL_ARRAY_BUFFER, rocks.size() * sizeof(RockState), rocks.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(RockState), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(RockState), (void*)offsetof(RockState, packed));
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // --- ближние камни геометрией: отбор compute-шейдером (GL 4.3) ---
+    if (GLEW_VERSION_4_3)
+    {
+        GLuint comp = CompileShader(GL_COMPUTE_SHADER, (std::string("#version 430 core\n") + rockGlsl + cullComputeSrc).c_str());
+        cullProg = CheckLinked(LinkComputeProgram(comp));
+        glDeleteShader(comp);
+        meshProg = RenderProgram(meshVertexSrc, meshFragmentSrc);
+        if (!cullProg || !meshProg)
+        {
+            glDeleteProgram(cullProg);
+            glDeleteProgram(meshProg);
+            cullProg = meshProg = 0;
+        }
+    }
+    else
+        std::cout << "Compute shaders need OpenGL 4.3, asteroid belt drawn as points only" << std::endl;
+
+    if (UsesCompute())
+    {
+        cullTimeLoc = glGetUniformLocation(cullProg, "uTime");
+        cullFrameLoc = glGetUniformLocation(cullProg, "uFrame");
+        cullCameraLoc = glGetUniformLocation(cullProg, "uCamera");
+        cullPlanesLoc = glGetUniformLocation(cullProg, "uPlanes");
+        glUseProgram(cullProg);
+        glUniform1ui(glGetUniformLocation(cullProg, "uCount"), settings.count);
+        glUniform1ui(glGetUniformLocation(cullProg, "uCapacity"), kNearCapacity);
+        glUniform1f(glGetUniformLocation(cullProg, "uMeshDistance"), settings.meshDistance);
+        glUniform1f(glGetUniformLocation(cullProg, "uMinSize"), settings.minSize);
+        glUniform1f(glGetUniformLocation(cullProg, "uMaxSize"), settings.maxSize);
+
+        meshViewProjLoc = glGetUniformLocation(meshProg, "uViewProj");
+        glUseProgram(meshProg);
+        glUniform3fv(glGetUniformLocation(meshProg, "uAlbedo"), 1, albedo);
+
+        nearCapacity = kNearCapacity;
+        glGenBuffers(1, &nearBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, nearBuffer);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)kVariants * nearCapacity * 8 * sizeof(float), nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        CreateVariants();
+
+        glGenBuffers(1, &commandBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, kVariants * sizeof(DrawArraysIndirectCommand), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+        // отметки отбора по камням: точки пропускают только те камни,
+        // что действительно попали в участки (переполнение — точками)
+        std::vector<uint32_t> none(settings.count, 0);
+        glGenBuffers(1, &meshedBuffer);
+        glBindVertexArray(pointVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, meshedBuffer);
+        glBufferData(GL_ARRAY_BUFFER, none.size() * sizeof(uint32_t), none.data(), GL_DYNAMIC_COPY);
+        glEnableVertexAttribArray(2);
+        glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    glUseProgram(0);
+
+    timer.Init(4, true);
+    return true;
+}
+
+void AsteroidBelt::Destroy()
+{
+    timer.Destroy();
+    GLuint buffers[5] = { rockBuffer, meshVBO, nearBuffer, commandBuffer, meshedBuffer };
+    GLuint arrays[2] = { pointVAO, meshVAO };
+    glDeleteBuffers(5, buffers);
+    glDeleteVertexArrays(2, arrays);
+    rockBuffer = meshVBO = nearBuffer = commandBuffer = meshedBuffer = 0;
+    frame = 0;
+    pointVAO = meshVAO = 0;
+    for (GLuint* prog : { &pointProg, &meshProg, &cullProg })
+    {
+        glDeleteProgram(*prog);
+        *prog = 0;
+    }
+    nearCapacity = variantVertices = 0;
+}
+
+int AsteroidBelt::Draw(const Mat4& view, const Mat4& proj, float time)
+{
+    if (!pointProg)
+        return 0;
+
+    double ms = 0.0;
+    if (timer.Poll(ms))
+        gpuMs.Add(ms);
+    timer.Begin();
+
+    int drawCalls = 0;
+    if (UsesCompute())
+    {
+        // счётчики экземпляров — в 0, остальное в командах постоянно
+        DrawArraysIndirectCommand commands[kVariants];
+        for (unsigned v = 0; v < kVariants; ++v)
+            commands[v] = { variantVertices, 0, v * variantVertices, v * nearCapacity };
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(commands), commands);
+
+        Mat4 viewProj = proj * view;
+        Mat4 invView = InverseRigid(view);
+        float planes[6][4];
+        FrustumPlanes(viewProj, planes);
+
+        // 0 — «не нарисован»: после переполнения счётчика пропускается
+        if (++frame == 0)
+            frame = 1;
+
+        glUseProgram(cullProg);
+        glUniform1ui(cullFrameLoc, frame);
+        glUniform1f(cullTimeLoc, time);
+        glUniform3f(cullCameraLoc, invView.m[12], invView.m[13], invView.m[14]);
+        glUniform4fv(cullPlanesLoc, 6, &planes[0][0]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, rockBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, nearBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commandBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, meshedBuffer);
+        glDispatchCompute((settings.count + kCullGroupSize - 1) / kCullGroupSize, 1, 1);
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+        for (GLuint binding = 0; binding < 4; ++binding)
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
+
+        glUseProgram(meshProg);
+        glUniformMatrix4fv(meshViewProjLoc, 1, GL_FALSE, viewProj.m);
+        glBindVertexArray(meshVAO);
+        glMultiDrawArraysIndirect(GL_TRIANGLES, nullptr, kVariants, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        ++drawCalls;
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glUseProgram(pointProg);
+    glUniform1f(pointTimeLoc, time);
+    glUniformMatrix4fv(pointViewLoc, 1, GL_FALSE, view.m);
+    glUniformMatrix4fv(pointProjLoc, 1, GL_FALSE, proj.m);
+    glUniform1f(pointPixelScaleLoc, proj.m[5] * 0.5f * viewport[3]);
+    glUniform1ui(pointFrameLoc, UsesCompute() ? frame : 0u);
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    glBindVertexArray(pointVAO);
+    glDrawArrays(GL_POINTS, 0, (GLsizei)settings.count);
+    glDisable(GL_PROGRAM_POINT_SIZE);
+    ++drawCalls;
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+    timer.End();
+    return drawCalls;
+}
+
+std::string AsteroidBelt::Summary() const
+{
+    char buf[256];
+    if (UsesCompute())
+        std::snprintf(buf, sizeof(buf), "%u rocks, r %.1f..%.1f, %u variants x %u tris within %.1f (compute + indirect), GPU: ",
+            settings.count, settings.innerRadius, settings.outerRadius, kVariants, variantVertices / 3,
+            settings.meshDistance);
+    else
+        std::snprintf(buf, sizeof(buf), "%u rocks, r %.1f..%.1f, points only, GPU: ",
+            settings.count, settings.innerRadius, settings.outerRadius);
+    return buf + gpuMs.Summary();
+}
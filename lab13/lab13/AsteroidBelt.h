@@ -0,0 +1,94 @@
+#pragma once
+
+#include "FrameStats.h"
+#include "GlUtils.h"
+#include "GpuTimer.h"
+#include "Math3D.h"
+
+#include <cstdint>
+#include <string>
+
+// =======================================================
+// ПОЯС АСТЕРОИДОВ (ЧАСТИЦЫ НА GPU)
+// =======================================================
+//
+// Состояние камня — 16 байт в буфере GPU (радиус и начальный угол
+// орбиты, высота над плоскостью, упакованные размер/вариант/seed),
+// записывается один раз. Положение и поворот считаются шейдером от
+// времени симуляции: угол = начальный + скорость * t, как у планет,
+// поэтому на кадр CPU не трогает ни одного камня.
+//
+// Дальние камни — точки-спрайты с освещённой сферой вместо геометрии;
+// субпиксельные тускнеют, а не мерцают. Ближние (GL 4.3):
+//   compute — отбор по расстоянию и пирамиде видимости, компактная
+//             запись (позиция, масштаб, кватернион) в участок своего
+//             варианта и атомарный счётчик instanceCount в команде;
+//   draw    — один glMultiDrawArraysIndirect по всем вариантам.
+// Попавший в участок камень помечается номером кадра, и точки
+// пропускают только помеченные: если участок варианта переполнен,
+// лишние ближние камни остаются точками, а не пропадают.
+// Варианты — низкополигональные камни (икосфера, 80 треугольников,
+// вмятины и растяжение), генерируются при старте. Без GL 4.3 весь
+// пояс рисуется точками.
+
+struct AsteroidBeltSettings
+{
+    unsigned count = 1000000;
+    float innerRadius = 14.0f;
+    float outerRadius = 20.0f;
+    float thickness = 0.5f;       // разброс по высоте
+    float minSize = 0.02f;
+    float maxSize = 0.12f;
+    float meshDistance = 6.0f;    // ближе — геометрия, дальше — точки
+    unsigned seed = 3;
+    bool linearOutput = false;    // цель в линейном цвете (HDR)
+};
+
+class AsteroidBelt
+{
+public:
+    bool Init(const AsteroidBeltSettings& settings);
+    void Destroy();
+
+    // в текущий framebuffer с проверкой глубины; time — время симуляции
+    // (тот же отсчёт, что у UpdatePlanets); возвращает число вызовов отрисовки
+    int Draw(const Mat4& view, const Mat4& proj, float time);
+
+    bool UsesCompute() const { return cullProg != 0; }
+
+    // "1000000 rocks, r 14.0..20.0, 4 variants x 80 tris within 6.0 (compute + indirect), GPU: <FrameTimeStats>"
+    std::string Summary() const;
+
+private:
+    void CreateVariants();
+
+    AsteroidBeltSettings settings;
+
+    GLuint rockBuffer = 0;         // состояние камней: вершины точек и SSBO для отбора
+    GLuint pointVAO = 0;
+    GLuint meshVBO = 0;            // все варианты подряд, позиция + нормаль грани
+    GLuint meshVAO = 0;
+    GLuint nearBuffer = 0;         // ближние: по участку на вариант
+    GLuint commandBuffer = 0;      // DrawArraysIndirectCommand на вариант
+    GLuint meshedBuffer = 0;       // uint на камень: кадр, когда он попал в участок
+    uint32_t frame = 0;            // номер отбора для meshedBuffer
+    unsigned nearCapacity = 0;     // камней в участке варианта
+    unsigned variantVertices = 0;
+
+    GLuint pointProg = 0;
+    GLuint meshProg = 0;
+    GLuint cullProg = 0;
+    GLint pointTimeLoc = -1;
+    GLint pointViewLoc = -1;
+    GLint pointProjLoc = -1;
+    GLint pointPixelScaleLoc = -1;
+    GLint pointFrameLoc = -1;
+    GLint meshViewProjLoc = -1;
+    GLint cullTimeLoc = -1;
+    GLint cullFrameLoc = -1;
+    GLint cullCameraLoc = -1;
+    GLint cullPlanesLoc = -1;
+
+    GpuTimer timer;                // timestamps: может стоять внутри замера кадра
+    FrameTimeStats gpuMs;
+};
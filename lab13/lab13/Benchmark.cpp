@@ -0,0 +1,294 @@
+#include "Benchmark.h"
+
+#include "Assets.h"
+#include "HeadlessRenderer.h"
+#include "RayBvh.h"
+
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+SegmentReport::SegmentReport(const CameraPath& path)
+{
+    for (const PathSegment& seg : path.Segments())
+        names.push_back(seg.name);
+    segments.resize(names.size());
+}
+
+void SegmentReport::Add(size_t segment, double ms)
+{
+    segments[segment].Add(ms);
+    total.Add(ms);
+}
+
+void SegmentReport::Print(const std::string& title) const
+{
+    std::cout << title << "\n";
+
+    char line[160];
+    std::snprintf(line, sizeof(line), "  %-16s %7s %8s %8s %8s %8s %8s",
+        "segment", "frames", "mean", "p50", "p95", "p99", "max ms");
+    std::cout << line << "\n";
+
+    auto row = [&](const std::string& name, const FrameTimeStats& s)
+        {
+            std::snprintf(line, sizeof(line), "  %-16s %7zu %8.2f %8.2f %8.2f %8.2f %8.2f",
+                name.c_str(), s.Count(), s.Mean(), s.Percentile(50), s.Percentile(95),
+                s.Percentile(99), s.Max());
+            std::cout << line << "\n";
+        };
+    for (size_t i = 0; i < names.size(); ++i)
+        row(names[i], segments[i]);
+    row("total", total);
+    std::cout.flush();
+}
+
+int BenchmarkFrameCount(const CameraPath& path, float dt)
+{
+    return (int)std::floor(path.Duration() / dt + 1e-3f) + 1;
+}
+
+int RunHeadlessBenchmark(const BenchmarkOptions& opt)
+{
+    CameraPath path;
+    if (!path.Load(opt.pathFile))
+        return 1;
+
+    ThreadPool pool(opt.threads);
+    MeshData model;
+    if (!LoadOBJ("model.obj", model, pool))
+        return 1;
+
+    sf::Image texImage;
+    if (!LoadTextureImage("model_diffuse.png", texImage))
+        return 1;
+
+    HeadlessRenderer headless;
+    if (!headless.Init(opt.software, pool, opt.width, opt.height, model, texImage))
+        return 1;
+    if (!headless.EnableLighting(opt.lights) || !headless.EnableSunShadows(opt.shadows) ||
+        !headless.SetShadingPath(opt.shading) || !headless.EnableVisibilityBuffer(opt.visibility) ||
+        (opt.rings && !headless.EnableRings(opt.ringSettings)) ||
+        (opt.procedural && !headless.EnableProceduralPlanets(opt.proceduralSettings, pool)) ||
+        (opt.hdr && !headless.EnableHdr(opt.hdrSettings)) ||
+        (opt.ao && !headless.EnableAmbientOcclusion(opt.aoSettings)) ||
+        (opt.stars && !headless.EnableStarfield(opt.starSettings)) ||
+        (opt.belt && !headless.EnableAsteroidBelt(opt.beltSettings)) ||
+        (opt.trails && !headless.EnableOrbitTrails(opt.trailSettings)))
+        return 1;
+
+    std::vector<Planet> planets = CreatePlanets(path.PlanetCount(), path.Seed());
+    UpdatePlanets(planets, path.StartTime());
+    Mat4 proj = MakeProjection(opt.width, opt.height);
+
+    // прогрев: первый кадр платит за загрузку шейдеров и драйвер
+    headless.Render(planets, path.Evaluate(0.0f).View(), proj, path.StartTime());
+
+    SegmentReport report(path);
+    int frames = BenchmarkFrameCount(path, opt.dt);
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        float t = frame * opt.dt;
+
+        sf::Clock frameClock;
+        Camera camera = path.Evaluate(t);
+        headless.Render(planets, camera.View(), proj, path.StartTime() + t);
+        report.Add(path.SegmentAt(t), frameClock.getElapsedTime().asMicroseconds() / 1000.0);
+
+        UpdatePlanets(planets, opt.dt);
+    }
+
+    char title[256];
+    std::snprintf(title, sizeof(title), "Benchmark %s (%s, %ux%u, %d frames, dt %.4f s, %u lights)",
+        opt.pathFile.c_str(), headless.IsSoftware() ? "software" : "OpenGL",
+        opt.width, opt.height, frames, opt.dt, opt.lights);
+    report.Print(title);
+    if (opt.lights > 0 && !headless.IsSoftware())
+        std::cout << "Clustered lighting: " << headless.LightingSummary() << std::endl;
+    if (opt.shadows.size > 0 && !headless.IsSoftware())
+        std::cout << "Sun shadows: " << headless.ShadowSummary() << std::endl;
+    if (opt.shading != ShadingPath::Forward && !headless.IsSoftware())
+        std::cout << "Deferred shading: " << headless.ShadingSummary() << std::endl;
+    if (opt.visibility && !headless.IsSoftware())
+        std::cout << "Visibility buffer: " << headless.VisibilitySummary() << std::endl;
+    if (opt.rings && !headless.IsSoftware())
+        std::cout << "Planet rings: " << headless.RingSummary() << std::endl;
+    if (opt.procedural && !headless.IsSoftware())
+        std::cout << "Procedural planets: " << headless.ProceduralSummary() << std::endl;
+    if (opt.hdr && !headless.IsSoftware())
+        std::cout << "HDR: " << headless.HdrSummary() << std::endl;
+    if (opt.ao && !headless.IsSoftware())
+        std::cout << "Ambient occlusion: " << headless.AoSummary() << std::endl;
+    if (opt.stars && !headless.IsSoftware())
+        std::cout << "Starfield: " << headless.StarSummary() << std::endl;
+    if (opt.belt && !headless.IsSoftware())
+        std::cout << "Asteroid belt: " << headless.BeltSummary() << std::endl;
+    if (opt.trails && !headless.IsSoftware())
+        std::cout << "Orbit trails: " << headless.TrailSummary() << std::endl;
+    return 0;
+}
+
+int RunShadingComparison(const BenchmarkOptions& opt)
+{
+    CameraPath path;
+    if (!path.Load(opt.pathFile))
+        return 1;
+
+    ThreadPool pool(opt.threads);
+    MeshData model;
+    if (!LoadOBJ("model.obj", model, pool))
+        return 1;
+
+    sf::Image texImage;
+    if (!LoadTextureImage("model_diffuse.png", texImage))
+        return 1;
+
+    std::vector<std::pair<unsigned, unsigned>> sizes = opt.compareSizes;
+    if (sizes.empty())
+        sizes.push_back({ opt.width, opt.height });
+    const ShadingPath paths[3] = { ShadingPath::Forward, ShadingPath::DeferredVolumes, ShadingPath::DeferredTiled };
+    int frames = BenchmarkFrameCount(path, opt.dt);
+
+    char line[160];
+    std::snprintf(line, sizeof(line), "Shading comparison %s (%d frames per run, dt %.4f s)",
+        opt.pathFile.c_str(), frames, opt.dt);
+    std::cout << line << "\n";
+    std::snprintf(line, sizeof(line), "  %-10s %7s %-8s %8s %8s %8s %10s",
+        "size", "lights", "path", "mean", "p50", "p95 ms", "p50/fwd");
+    std::cout << line << std::endl;
+
+    for (const auto& size : sizes)
+    {
+        // свой контекст и цель на каждый размер
+        HeadlessRenderer headless;
+        if (!headless.Init(false, pool, size.first, size.second, model, texImage))
+            return 1;
+        if (!headless.EnableLighting(1) || !headless.EnableSunShadows(opt.shadows))
+        {
+            std::cout << "Shading comparison: failed to set up lighting and shadows at "
+                << size.first << "x" << size.second << std::endl;
+            return 1;
+        }
+        Mat4 proj = MakeProjection(size.first, size.second);
+
+        for (unsigned lights : opt.compareLights)
+        {
+            // без освещения цифры были бы за неосвещённый проход
+            if (!headless.EnableLighting(lights))
+            {
+                std::cout << "Shading comparison: failed to enable " << lights << " lights" << std::endl;
+                return 1;
+            }
+            double forwardP50 = 0.0;
+            for (ShadingPath shading : paths)
+            {
+                if (!headless.SetShadingPath(shading))
+                {
+                    std::cout << "Shading comparison: failed to set up " << ShadingPathName(shading)
+                        << " shading at " << size.first << "x" << size.second << std::endl;
+                    return 1;
+                }
+
+                std::vector<Planet> planets = CreatePlanets(path.PlanetCount(), path.Seed());
+                UpdatePlanets(planets, path.StartTime());
+                headless.Render(planets, path.Evaluate(0.0f).View(), proj);
+
+                FrameTimeStats stats;
+                for (int frame = 0; frame < frames; ++frame)
+                {
+                    sf::Clock frameClock;
+                    headless.Render(planets, path.Evaluate(frame * opt.dt).View(), proj);
+                    stats.Add(frameClock.getElapsedTime().asMicroseconds() / 1000.0);
+                    UpdatePlanets(planets, opt.dt);
+                }
+
+                double p50 = stats.Percentile(50);
+                if (shading == ShadingPath::Forward)
+                    forwardP50 = p50;
+                char sizeText[32];
+                std::snprintf(sizeText, sizeof(sizeText), "%ux%u", size.first, size.second);
+                std::snprintf(line, sizeof(line), "  %-10s %7u %-8s %8.2f %8.2f %8.2f %10.2f",
+                    sizeText, lights, ShadingPathName(shading), stats.Mean(), p50,
+                    stats.Percentile(95), forwardP50 > 0.0 ? p50 / forwardP50 : 1.0);
+                std::cout << line << std::endl;
+            }
+        }
+        std::cout << "  deferred: " << headless.ShadingSummary() << std::endl;
+    }
+    return 0;
+}
+
+int RunRayBenchmark(const BenchmarkOptions& opt)
+{
+    ThreadPool pool(opt.threads);
+    MeshData model;
+    if (!LoadOBJ("model.obj", model, pool))
+        return 1;
+
+    MeshBvh meshBvh;
+    meshBvh.Build(model, pool);
+
+    // CreatePlanets добавляет Солнце
+    std::vector<Planet> planets = CreatePlanets((int)std::max(1u, opt.rayInstances) - 1, opt.raySeed);
+    SceneBvh scene;
+    scene.Build(planets, meshBvh, pool);
+
+    std::cout << "Ray benchmark: " << planets.size() << " instances, " << opt.width << "x" << opt.height
+        << " primary rays\n"
+        << "  mesh BVH:  " << meshBvh.Summary() << "\n"
+        << "  scene BVH: " << scene.Summary() << std::endl;
+
+    Camera camera;
+    auto traceRow = [&](unsigned y)
+        {
+            size_t hits = 0;
+            for (unsigned x = 0; x < opt.width; ++x)
+            {
+                RayHit hit;
+                hits += scene.Intersect(CameraRay(camera, x + 0.5f, y + 0.5f, opt.width, opt.height), hit);
+            }
+            return hits;
+        };
+
+    char line[160];
+    double rays = (double)opt.width * opt.height;
+
+    sf::Clock serialClock;
+    size_t serialHits = 0;
+    for (unsigned y = 0; y < opt.height; ++y)
+        serialHits += traceRow(y);
+    double serialMs = serialClock.getElapsedTime().asMicroseconds() / 1000.0;
+
+    std::vector<size_t> workerHits(pool.Size(), 0);
+    sf::Clock parallelClock;
+    pool.ParallelFor(opt.height, [&](size_t y, unsigned worker) { workerHits[worker] += traceRow((unsigned)y); });
+    double parallelMs = parallelClock.getElapsedTime().asMicroseconds() / 1000.0;
+    size_t parallelHits = 0;
+    for (size_t h : workerHits)
+        parallelHits += h;
+
+    std::snprintf(line, sizeof(line), "  1 thread:  %8.2f Mrays/s (%.0f ms)", rays / (serialMs * 1000.0), serialMs);
+    std::cout << line << std::endl;
+    std::snprintf(line, sizeof(line), "  %u threads: %7.2f Mrays/s (%.0f ms), %.1f%% hit%s", pool.Size(),
+        rays / (parallelMs * 1000.0), parallelMs, 100.0 * parallelHits / rays,
+        parallelHits == serialHits ? "" : " (MISMATCH with 1 thread)");
+    std::cout << line << std::endl;
+
+    RayHit hit;
+    if (scene.Intersect(CameraRay(camera, opt.width * 0.5f, opt.height * 0.5f, opt.width, opt.height), hit))
+    {
+        float uv[2];
+        meshBvh.TexCoord(hit.triangle, hit.u, hit.v, uv);
+        std::snprintf(line, sizeof(line), "  center pick: planet %u, triangle %u, uv (%.3f, %.3f), t %.2f",
+            hit.instance, hit.triangle, uv[0], uv[1], hit.t);
+        std::cout << line << std::endl;
+    }
+    else
+    {
+        std::cout << "  center pick: nothing" << std::endl;
+    }
+    return 0;
+}
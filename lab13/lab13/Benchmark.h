@@ -0,0 +1,91 @@
+#pragma once
+
+#include "AmbientOcclusion.h"
+#include "AsteroidBelt.h"
+#include "CameraPath.h"
+#include "DeferredShading.h"
+#include "FrameStats.h"
+#include "HdrBloom.h"
+#include "OrbitTrails.h"
+#include "PlanetRings.h"
+#include "ProceduralPlanets.h"
+#include "Starfield.h"
+#include "SunShadows.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// =======================================================
+// БЕНЧМАРК ПО СЦЕНАРНОМУ ПРОЛЁТУ
+// =======================================================
+//
+// Камера идёт по CameraPath, симуляция шагает фиксированным dt,
+// поэтому каждый прогон рисует одни и те же кадры. Время кадров
+// собирается отдельно по участкам пути и по прогону целиком.
+
+struct BenchmarkOptions
+{
+    std::string pathFile;
+    bool software = false;
+    unsigned threads = 0;
+    unsigned width = 1200;
+    unsigned height = 900;
+    float dt = 1.0f / 60.0f;      // шаг симуляции и пути
+    unsigned lights = 0;          // точечных источников, 0 — без освещения
+    SunShadowSettings shadows = { 0 };   // size == 0 — без теней
+    ShadingPath shading = ShadingPath::Forward;
+    bool visibility = false;      // visibility buffer вместо прохода с материалом
+    bool rings = false;           // кольца планет (OIT)
+    PlanetRingSettings ringSettings;
+    bool procedural = false;      // процедурные планеты с LOD
+    ProceduralPlanetSettings proceduralSettings;
+    bool hdr = false;             // HDR-цель, bloom и тональная компрессия
+    HdrBloomSettings hdrSettings;
+    bool ao = false;              // SSAO в пониженном разрешении
+    AmbientOcclusionSettings aoSettings;
+    bool stars = false;           // звёздное небо
+    StarfieldSettings starSettings;
+    bool belt = false;            // пояс астероидов
+    AsteroidBeltSettings beltSettings;
+    bool trails = false;          // следы орбит
+    OrbitTrailSettings trailSettings;
+
+    // RunShadingComparison: число источников и размеры кадра (пусто — width x height)
+    std::vector<unsigned> compareLights;
+    std::vector<std::pair<unsigned, unsigned>> compareSizes;
+
+    // лучи через BVH (RunRayBenchmark)
+    unsigned rayInstances = 1000000;
+    unsigned raySeed = 7;
+};
+
+class SegmentReport
+{
+public:
+    explicit SegmentReport(const CameraPath& path);
+
+    void Add(size_t segment, double ms);
+    // таблица: участок, кадры, mean / p50 / p95 / p99 / max
+    void Print(const std::string& title) const;
+
+private:
+    std::vector<std::string> names;
+    std::vector<FrameTimeStats> segments;
+    FrameTimeStats total;
+};
+
+// число кадров пролёта при шаге dt (последний кадр — на конце пути)
+int BenchmarkFrameCount(const CameraPath& path, float dt);
+
+int RunHeadlessBenchmark(const BenchmarkOptions& opt);
+
+// прямое освещение против отложенного (объёмы, тайлы) на одном пролёте:
+// каждое сочетание размера кадра и числа источников, таблица mean / p50 / p95
+// и отношение p50 к прямому пути
+int RunShadingComparison(const BenchmarkOptions& opt);
+
+// первичные лучи width x height из стартовой камеры через SceneBvh над
+// rayInstances планетами: время построения обоих уровней, лучей в секунду
+// на одном и на всех потоках, выбор планеты в центре кадра
+int RunRayBenchmark(const BenchmarkOptions& opt);
@@ -0,0 +1,158 @@
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    struct KeyValues
+    {
+        float v[5];   // x, y, z, yaw, pitch
+    };
+
+    KeyValues Values(const CameraKey& k)
+    {
+        return { { k.pos.x, k.pos.y, k.pos.z, k.yaw, k.pitch } };
+    }
+
+    // касательная в ключе i (единицы в секунду)
+    KeyValues Tangent(const std::vector<CameraKey>& keys, size_t i)
+    {
+        size_t a = (i == 0) ? 0 : i - 1;
+        size_t b = std::min(i + 1, keys.size() - 1);
+        KeyValues va = Values(keys[a]);
+        KeyValues vb = Values(keys[b]);
+        float dt = keys[b].time - keys[a].time;
+        KeyValues m;
+        for (int c = 0; c < 5; ++c)
+            m.v[c] = dt > 0.0f ? (vb.v[c] - va.v[c]) / dt : 0.0f;
+        return m;
+    }
+}
+
+bool CameraPath::Load(const std::string& filename)
+{
+    std::ifstream file(filename);
+    if (!file.is_open())
+    {
+        std::cout << "Failed to open camera path: " << filename << std::endl;
+        return false;
+    }
+
+    segments.clear();
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNo;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos)
+            line.resize(hash);
+
+        std::istringstream iss(line);
+        std::string cmd;
+        if (!(iss >> cmd)) continue;
+
+        bool ok = true;
+        if (cmd == "seed")
+            ok = (bool)(iss >> seed);
+        else if (cmd == "planets")
+            ok = (bool)(iss >> planetCount) && planetCount >= 0;
+        else if (cmd == "time")
+            ok = (bool)(iss >> startTime);
+        else if (cmd == "segment")
+        {
+            PathSegment seg;
+            ok = (bool)(iss >> seg.name);
+            segments.push_back(seg);
+        }
+        else if (cmd == "key")
+        {
+            CameraKey k;
+            ok = (bool)(iss >> k.time >> k.pos.x >> k.pos.y >> k.pos.z >> k.yaw >> k.pitch);
+            if (ok && segments.empty())
+                segments.push_back({ "path", {} });
+            if (ok)
+            {
+                auto& keys = segments.back().keys;
+                const CameraKey* prev = !keys.empty() ? &keys.back()
+                    : (segments.size() > 1 && !segments[segments.size() - 2].keys.empty()
+                        ? &segments[segments.size() - 2].keys.back() : nullptr);
+                if (prev && k.time < prev->time)
+                {
+                    std::cout << filename << ":" << lineNo << ": key times must not decrease" << std::endl;
+                    return false;
+                }
+                keys.push_back(k);
+            }
+        }
+        else
+        {
+            std::cout << filename << ":" << lineNo << ": unknown command '" << cmd << "'" << std::endl;
+            return false;
+        }
+
+        if (!ok)
+        {
+            std::cout << filename << ":" << lineNo << ": bad arguments for '" << cmd << "'" << std::endl;
+            return false;
+        }
+    }
+
+    segments.erase(std::remove_if(segments.begin(), segments.end(),
+        [](const PathSegment& s) { return s.keys.empty(); }), segments.end());
+    if (segments.empty())
+    {
+        std::cout << "Camera path has no keys: " << filename << std::endl;
+        return false;
+    }
+
+    duration = segments.back().keys.back().time;
+    return true;
+}
+
+size_t CameraPath::SegmentAt(float t) const
+{
+    size_t seg = 0;
+    while (seg + 1 < segments.size() && segments[seg + 1].keys.front().time <= t)
+        ++seg;
+    return seg;
+}
+
+Camera CameraPath::Evaluate(float t) const
+{
+    const auto& keys = segments[SegmentAt(t)].keys;
+
+    // до первого / после последнего ключа участка — держим крайний
+    size_t i = 0;
+    while (i + 1 < keys.size() && keys[i + 1].time <= t)
+        ++i;
+
+    KeyValues out = Values(keys[i]);
+    if (i + 1 < keys.size() && t > keys[i].time)
+    {
+        const CameraKey& k0 = keys[i];
+        const CameraKey& k1 = keys[i + 1];
+        float h = k1.time - k0.time;
+        float u = (t - k0.time) / h;
+        float u2 = u * u;
+        float u3 = u2 * u;
+        float h00 = 2 * u3 - 3 * u2 + 1;
+        float h10 = u3 - 2 * u2 + u;
+        float h01 = -2 * u3 + 3 * u2;
+        float h11 = u3 - u2;
+
+        KeyValues p0 = Values(k0), p1 = Values(k1);
+        KeyValues m0 = Tangent(keys, i), m1 = Tangent(keys, i + 1);
+        for (int c = 0; c < 5; ++c)
+            out.v[c] = h00 * p0.v[c] + h10 * h * m0.v[c] + h01 * p1.v[c] + h11 * h * m1.v[c];
+    }
+
+    Camera cam;
+    cam.pos = Vec3(out.v[0], out.v[1], out.v[2]);
+    cam.yaw = out.v[3];
+    cam.pitch = std::clamp(out.v[4], -89.0f, 89.0f);
+    return cam;
+}
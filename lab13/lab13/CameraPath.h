@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Scene.h"
+
+#include <string>
+#include <vector>
+
+// =======================================================
+// СЦЕНАРНЫЕ ПРОЛЁТЫ КАМЕРЫ ДЛЯ БЕНЧМАРКОВ
+// =======================================================
+//
+// Текстовый файл:
+//   # комментарий
+//   seed 7                      — набор планет
+//   planets 100                 — число планет (без Солнца)
+//   time 0                      — время симуляции в начале пролёта
+//   segment dense_ring          — начало именованного участка
+//   key <t> <x> <y> <z> <yaw> <pitch>
+//
+// Внутри участка камера идёт по сплайну Эрмита (касательные
+// Катмулла-Рома с учётом неравномерного шага ключей), между участками
+// — склейка без интерполяции. Участок длится до начала следующего.
+
+struct CameraKey
+{
+    float time = 0.0f;
+    Vec3 pos;
+    float yaw = 0.0f;
+    float pitch = 0.0f;
+};
+
+struct PathSegment
+{
+    std::string name;
+    std::vector<CameraKey> keys;   // по возрастанию time
+};
+
+class CameraPath
+{
+public:
+    bool Load(const std::string& filename);
+
+    unsigned Seed() const { return seed; }
+    int PlanetCount() const { return planetCount; }
+    float StartTime() const { return startTime; }
+    float Duration() const { return duration; }
+
+    const std::vector<PathSegment>& Segments() const { return segments; }
+
+    // номер участка, активного в момент t
+    size_t SegmentAt(float t) const;
+    Camera Evaluate(float t) const;
+
+private:
+    unsigned seed = 1;
+    int planetCount = kDefaultPlanetCount;
+    float startTime = 0.0f;
+    float duration = 0.0f;
+    std::vector<PathSegment> segments;
+};
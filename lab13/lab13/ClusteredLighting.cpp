@@ -0,0 +1,380 @@
+#include "ClusteredLighting.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CLUSTER_SSE2 1
+#endif
+
+namespace
+{
+    // насыщенный цвет по тону h в [0, 1)
+    Vec3 HueColor(float h)
+    {
+        float r = std::fabs(h * 6.0f - 3.0f) - 1.0f;
+        float g = 2.0f - std::fabs(h * 6.0f - 2.0f);
+        float b = 2.0f - std::fabs(h * 6.0f - 4.0f);
+        return Vec3(std::clamp(r, 0.0f, 1.0f), std::clamp(g, 0.0f, 1.0f), std::clamp(b, 0.0f, 1.0f));
+    }
+
+    float Fract(float v) { return v - std::floor(v); }
+
+    const float kGoldenRatio = 0.618034f;
+
+    // светящаяся планета j (1, 2, ...) — планета j * kEmissivePlanetStride
+    Vec3 EmissivePlanetColor(size_t j)
+    {
+        return HueColor(Fract(j * kGoldenRatio)) * 0.6f + Vec3(0.4f, 0.4f, 0.4f);
+    }
+
+    // номера тайлов, которые задевает отрезок [c - r, c + r] на глубинах [z0, z1]
+    void TileRange(float c, float r, float z0, float z1, float proj, unsigned n,
+        unsigned& t0, unsigned& t1)
+    {
+        float hi = c + r;
+        float lo = c - r;
+        float maxT = hi >= 0.0f ? hi / z0 : hi / z1;
+        float minT = lo >= 0.0f ? lo / z1 : lo / z0;
+        float a = (minT * proj * 0.5f + 0.5f) * n;
+        float b = (maxT * proj * 0.5f + 0.5f) * n;
+        t0 = (unsigned)std::clamp(std::floor(a), 0.0f, (float)(n - 1));
+        t1 = (unsigned)std::clamp(std::floor(b), 0.0f, (float)(n - 1));
+    }
+}
+
+void GatherSceneLights(const std::vector<Planet>& planets, unsigned count,
+    std::vector<PointLight>& out)
+{
+    out.clear();
+    count = std::min(count, kMaxLights);
+    if (count == 0 || planets.empty())
+        return;
+
+    // Солнце освещает всю систему
+    out.push_back({ PlanetPosition(planets[0]), kSunLightRadius, Vec3(1.0f, 0.92f, 0.8f) * 1.3f });
+
+    for (size_t i = kEmissivePlanetStride; i < planets.size() && out.size() < count; i += kEmissivePlanetStride)
+    {
+        size_t j = i / kEmissivePlanetStride;
+        out.push_back({ PlanetPosition(planets[i]), 10.0f, EmissivePlanetColor(j) * 1.2f });
+    }
+
+    // остальное — небольшие источники, кружащие вокруг планет
+    size_t hosts = planets.size() - 1;
+    for (size_t k = 0; out.size() < count && hosts > 0; ++k)
+    {
+        const Planet& host = planets[1 + k % hosts];
+        float ring = 1.6f + 0.4f * (float)((k / hosts) % 4);
+        float a = k * 2.0f * (float)M_PI * kGoldenRatio + host.selfAngle * 1.5f;
+        Vec3 offset(std::cos(a), 0.35f * std::sin(2.0f * a), std::sin(a));
+        PointLight light;
+        light.position = PlanetPosition(host) + offset * (host.scale * ring);
+        light.radius = 4.0f;
+        light.color = HueColor(Fract(k * kGoldenRatio)) * 0.8f;
+        out.push_back(light);
+    }
+}
+
+Vec3 PlanetEmission(size_t planetIndex, unsigned count)
+{
+    if (count == 0)
+        return Vec3();
+    if (planetIndex == 0)
+        return Vec3(1.0f, 1.0f, 1.0f);
+    if (planetIndex % kEmissivePlanetStride != 0)
+        return Vec3();
+    size_t j = planetIndex / kEmissivePlanetStride;
+    return j < count ? EmissivePlanetColor(j) * 0.8f : Vec3();
+}
+
+// =======================================================
+// РАСКЛАДКА ПО КЛАСТЕРАМ
+// =======================================================
+
+void LightClusterBuilder::Build(const std::vector<PointLight>& lights, const Mat4& view, const Mat4& proj)
+{
+    auto t0 = std::chrono::steady_clock::now();
+
+    // near/far и масштабы проекции из Mat4::Perspective
+    nearZ = proj.m[14] / (proj.m[10] - 1.0f);
+    farZ = proj.m[14] / (proj.m[10] + 1.0f);
+    projX = proj.m[0];
+    projY = proj.m[5];
+    float logRange = std::log(farZ / nearZ);
+    sliceScale = (float)grid.z / logRange;
+    sliceBias = -sliceScale * std::log(nearZ);
+
+    // --- перенос в видовые координаты и отсечение по пирамиде ---
+    size_t n = lights.size();
+    vx.resize(n);
+    vy.resize(n);
+    vz.resize(n);
+    vr.resize(n);
+    source.resize(n);
+    size_t visible = 0;
+
+    // расстояние до боковой плоскости: (proj * x - depth) / sqrt(proj^2 + 1)
+    const float sideX = std::sqrt(projX * projX + 1.0f);
+    const float sideY = std::sqrt(projY * projY + 1.0f);
+
+#ifdef CLUSTER_SSE2
+    const __m128 m0 = _mm_set1_ps(view.m[0]), m4 = _mm_set1_ps(view.m[4]), m8 = _mm_set1_ps(view.m[8]), m12 = _mm_set1_ps(view.m[12]);
+    const __m128 m1 = _mm_set1_ps(view.m[1]), m5 = _mm_set1_ps(view.m[5]), m9 = _mm_set1_ps(view.m[9]), m13 = _mm_set1_ps(view.m[13]);
+    const __m128 m2 = _mm_set1_ps(view.m[2]), m6 = _mm_set1_ps(view.m[6]), m10 = _mm_set1_ps(view.m[10]), m14 = _mm_set1_ps(view.m[14]);
+    const __m128 px = _mm_set1_ps(projX), py = _mm_set1_ps(projY);
+    const __m128 sx = _mm_set1_ps(sideX), sy = _mm_set1_ps(sideY);
+    const __m128 zNear = _mm_set1_ps(nearZ), zFar = _mm_set1_ps(farZ);
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+    for (size_t base = 0; base < n; base += 4)
+    {
+        size_t last = n - 1;
+        const PointLight& l0 = lights[base];
+        const PointLight& l1 = lights[std::min(base + 1, last)];
+        const PointLight& l2 = lights[std::min(base + 2, last)];
+        const PointLight& l3 = lights[std::min(base + 3, last)];
+        __m128 wx = _mm_setr_ps(l0.position.x, l1.position.x, l2.position.x, l3.position.x);
+        __m128 wy = _mm_setr_ps(l0.position.y, l1.position.y, l2.position.y, l3.position.y);
+        __m128 wz = _mm_setr_ps(l0.position.z, l1.position.z, l2.position.z, l3.position.z);
+        __m128 r = _mm_setr_ps(l0.radius, l1.radius, l2.radius, l3.radius);
+
+        __m128 x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, wx), _mm_mul_ps(m4, wy)), _mm_add_ps(_mm_mul_ps(m8, wz), m12));
+        __m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, wx), _mm_mul_ps(m5, wy)), _mm_add_ps(_mm_mul_ps(m9, wz), m13));
+        __m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, wx), _mm_mul_ps(m6, wy)), _mm_add_ps(_mm_mul_ps(m10, wz), m14));
+        __m128 depth = _mm_sub_ps(_mm_setzero_ps(), z);
+
+        // снаружи: за near/far или за одной из боковых плоскостей
+        __m128 out = _mm_or_ps(_mm_cmplt_ps(_mm_add_ps(depth, r), zNear), _mm_cmpgt_ps(_mm_sub_ps(depth, r), zFar));
+        __m128 ax = _mm_and_ps(_mm_mul_ps(px, x), signMask);
+        __m128 ay = _mm_and_ps(_mm_mul_ps(py, y), signMask);
+        out = _mm_or_ps(out, _mm_cmpgt_ps(_mm_sub_ps(ax, depth), _mm_mul_ps(r, sx)));
+        out = _mm_or_ps(out, _mm_cmpgt_ps(_mm_sub_ps(ay, depth), _mm_mul_ps(r, sy)));
+
+        int inside = ~_mm_movemask_ps(out) & 0xF;
+        if (n - base < 4)
+            inside &= (1 << (n - base)) - 1;
+        if (!inside)
+            continue;
+
+        alignas(16) float ox[4], oy[4], od[4], orad[4];
+        _mm_store_ps(ox, x);
+        _mm_store_ps(oy, y);
+        _mm_store_ps(od, depth);
+        _mm_store_ps(orad, r);
+        for (int l = 0; l < 4; ++l)
+        {
+            if (!(inside & (1 << l)))
+                continue;
+            vx[visible] = ox[l];
+            vy[visible] = oy[l];
+            vz[visible] = od[l];
+            vr[visible] = orad[l];
+            source[visible] = (uint32_t)(base + l);
+            ++visible;
+        }
+    }
+#else
+    for (size_t i = 0; i < n; ++i)
+    {
+        Vec4 p = TransformPoint(view, lights[i].position);
+        float depth = -p.z;
+        float r = lights[i].radius;
+        if (depth + r < nearZ || depth - r > farZ)
+            continue;
+        if (std::fabs(projX * p.x) - depth > r * sideX || std::fabs(projY * p.y) - depth > r * sideY)
+            continue;
+        vx[visible] = p.x;
+        vy[visible] = p.y;
+        vz[visible] = depth;
+        vr[visible] = r;
+        source[visible] = (uint32_t)i;
+        ++visible;
+    }
+#endif
+
+    // --- данные источников для шейдера ---
+    lightData.resize(visible * 8);
+    for (size_t i = 0; i < visible; ++i)
+    {
+        const PointLight& l = lights[source[i]];
+        float* d = &lightData[i * 8];
+        d[0] = vx[i];
+        d[1] = vy[i];
+        d[2] = -vz[i];
+        d[3] = vr[i];
+        d[4] = l.color.x;
+        d[5] = l.color.y;
+        d[6] = l.color.z;
+        d[7] = l.castsShadow ? 1.0f : 0.0f;
+    }
+
+    // --- два прохода: число источников в кластерах, затем списки ---
+    clusters.assign(grid.Count() * 2, 0);
+    ForEachCluster(visible, [&](unsigned cluster, size_t) { ++clusters[cluster * 2 + 1]; });
+
+    uint32_t offset = 0;
+    maxPerCluster = 0;
+    for (unsigned c = 0; c < grid.Count(); ++c)
+    {
+        clusters[c * 2] = offset;
+        offset += clusters[c * 2 + 1];
+        maxPerCluster = std::max<size_t>(maxPerCluster, clusters[c * 2 + 1]);
+        clusters[c * 2 + 1] = 0;
+    }
+
+    indices.resize(offset);
+    ForEachCluster(visible, [&](unsigned cluster, size_t light)
+        {
+            uint32_t& count = clusters[cluster * 2 + 1];
+            indices[clusters[cluster * 2] + count] = (uint16_t)light;
+            ++count;
+        });
+
+    totalLights = n;
+    visibleSum += visible;
+    indexSum += (double)indices.size();
+    ++frames;
+    buildMs.Add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+}
+
+template <typename Visit>
+void LightClusterBuilder::ForEachCluster(size_t visible, Visit&& visit) const
+{
+    auto sliceOf = [&](float depth)
+        {
+            float s = std::floor(std::log(depth) * sliceScale + sliceBias);
+            return (unsigned)std::clamp(s, 0.0f, (float)(grid.z - 1));
+        };
+    auto sliceNear = [&](unsigned s)
+        {
+            return std::exp(((float)s - sliceBias) / sliceScale);
+        };
+
+    for (size_t i = 0; i < visible; ++i)
+    {
+        float z0 = std::max(vz[i] - vr[i], nearZ);
+        float z1 = std::min(vz[i] + vr[i], farZ);
+        unsigned s0 = sliceOf(z0);
+        unsigned s1 = sliceOf(z1);
+
+        for (unsigned s = s0; s <= s1; ++s)
+        {
+            // границы среза с небольшим запасом на расхождение с GPU
+            float sz0 = std::max(z0, sliceNear(s) * 0.999f);
+            float sz1 = std::min(z1, sliceNear(s + 1) * 1.001f);
+
+            // сечение сферы срезом: если центр вне среза, радиус меньше
+            float dz = vz[i] < sz0 ? sz0 - vz[i] : (vz[i] > sz1 ? vz[i] - sz1 : 0.0f);
+            float r = std::sqrt(std::max(vr[i] * vr[i] - dz * dz, 0.0f));
+
+            unsigned tx0, tx1, ty0, ty1;
+            TileRange(vx[i], r, sz0, sz1, projX, grid.x, tx0, tx1);
+            TileRange(vy[i], r, sz0, sz1, projY, grid.y, ty0, ty1);
+
+            for (unsigned ty = ty0; ty <= ty1; ++ty)
+                for (unsigned tx = tx0; tx <= tx1; ++tx)
+                    visit((s * grid.y + ty) * grid.x + tx, i);
+        }
+    }
+}
+
+std::string LightClusterBuilder::Summary() const
+{
+    double perFrame = frames ? 1.0 / frames : 0.0;
+    char buf[320];
+    std::snprintf(buf, sizeof(buf),
+        "%zu lights (%.0f visible), %ux%ux%u clusters, %.1f lights per cluster, max %zu\n  build %s",
+        totalLights, visibleSum * perFrame, grid.x, grid.y, grid.z,
+        indexSum * perFrame / grid.Count(), maxPerCluster, buildMs.Summary().c_str());
+    return buf;
+}
+
+// =======================================================
+// TBO
+// =======================================================
+
+void ClusterLightBuffers::Init(unsigned frameCount)
+{
+    slots.resize(std::max(1u, frameCount));
+    for (Slot& s : slots)
+    {
+        Create(s.lights, GL_RGBA32F);
+        Create(s.clusters, GL_RG32UI);
+        Create(s.indices, GL_R16UI);
+    }
+}
+
+void ClusterLightBuffers::Destroy()
+{
+    for (Slot& s : slots)
+    {
+        for (TextureBuffer* tb : { &s.lights, &s.clusters, &s.indices })
+        {
+            glDeleteTextures(1, &tb->texture);
+            glDeleteBuffers(1, &tb->buffer);
+        }
+    }
+    slots.clear();
+}
+
+void ClusterLightBuffers::Create(TextureBuffer& tb, GLenum format)
+{
+    // пустой буфер тоже должен быть корректным TBO
+    tb.capacity = 256;
+    glGenBuffers(1, &tb.buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, tb.buffer);
+    glBufferData(GL_TEXTURE_BUFFER, tb.capacity, nullptr, GL_STREAM_DRAW);
+    glGenTextures(1, &tb.texture);
+    glBindTexture(GL_TEXTURE_BUFFER, tb.texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, tb.buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void ClusterLightBuffers::Write(TextureBuffer& tb, const void* data, GLsizeiptr size)
+{
+    if (size == 0)
+        return;
+    glBindBuffer(GL_TEXTURE_BUFFER, tb.buffer);
+    if (size > tb.capacity)
+    {
+        tb.capacity = std::max(size, tb.capacity * 2);
+        glBufferData(GL_TEXTURE_BUFFER, tb.capacity, nullptr, GL_STREAM_DRAW);
+    }
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void ClusterLightBuffers::Upload(unsigned frame, const LightClusterBuilder& builder)
+{
+    Slot& s = slots[frame % slots.size()];
+    Write(s.lights, builder.LightData().data(), builder.LightData().size() * sizeof(float));
+    Write(s.clusters, builder.Clusters().data(), builder.Clusters().size() * sizeof(uint32_t));
+    Write(s.indices, builder.Indices().data(), builder.Indices().size() * sizeof(uint16_t));
+}
+
+void ClusterLightBuffers::Bind(unsigned frame, GLuint firstUnit) const
+{
+    const Slot& s = slots[frame % slots.size()];
+    const GLuint textures[3] = { s.lights.texture, s.clusters.texture, s.indices.texture };
+    for (GLuint i = 0; i < 3; ++i)
+    {
+        glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void ClusterLightBuffers::Unbind(GLuint firstUnit) const
+{
+    for (GLuint i = 0; i < 3; ++i)
+    {
+        glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "FrameStats.h"
+#include "Math3D.h"
+#include "Scene.h"
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// =======================================================
+// КЛАСТЕРНОЕ ОСВЕЩЕНИЕ (clustered forward)
+// =======================================================
+//
+// Пирамида видимости делится на сетку X x Y тайлов экрана и Z срезов
+// глубины (логарифмически). Источники раскладываются по кластерам на
+// CPU; фрагмент находит свой кластер по gl_FragCoord и глубине и
+// перебирает только его список, поэтому цена пикселя зависит от числа
+// источников рядом, а не от их общего числа.
+
+struct PointLight
+{
+    Vec3 position;        // мировые координаты
+    float radius = 1.0f;  // за радиусом вклад ровно 0
+    Vec3 color;           // уже с интенсивностью
+    bool castsShadow = false;   // тень из кубической карты Солнца (SunShadows.h)
+};
+
+const float kSunLightRadius = 120.0f;
+
+// источники сцены: 0-й — Солнце, затем светящиеся планеты
+// (каждая kEmissivePlanetStride-я), остальные — "светлячки" вокруг планет
+const size_t kEmissivePlanetStride = 10;
+const unsigned kMaxLights = 65535;   // индексы в кластерах 16-битные
+
+void GatherSceneLights(const std::vector<Planet>& planets, unsigned count,
+    std::vector<PointLight>& out);
+
+// собственное свечение планеты при count источниках (0 — не светится)
+Vec3 PlanetEmission(size_t planetIndex, unsigned count);
+
+struct ClusterGrid
+{
+    unsigned x = 16;
+    unsigned y = 9;
+    unsigned z = 24;
+
+    unsigned Count() const { return x * y * z; }
+};
+
+class LightClusterBuilder
+{
+public:
+    // view/proj — как у кадра, proj — перспективная (Mat4::Perspective)
+    void Build(const std::vector<PointLight>& lights, const Mat4& view, const Mat4& proj);
+
+    const ClusterGrid& Grid() const { return grid; }
+
+    // по 8 float на видимый источник: позиция в видовых координатах, радиус, цвет, 0
+    const std::vector<float>& LightData() const { return lightData; }
+    // по 2 на кластер: начало списка в Indices() и число источников
+    const std::vector<uint32_t>& Clusters() const { return clusters; }
+    const std::vector<uint16_t>& Indices() const { return indices; }
+
+    // срез = log(глубина) * SliceScale + SliceBias
+    float SliceScale() const { return sliceScale; }
+    float SliceBias() const { return sliceBias; }
+
+    // "4096 lights (612 visible), 16x9x24 clusters, build p50 .., 3.1 lights per cluster, max 40"
+    std::string Summary() const;
+
+private:
+    template <typename Visit>
+    void ForEachCluster(size_t visible, Visit&& visit) const;
+
+    ClusterGrid grid;
+    float nearZ = 0.1f;
+    float farZ = 1000.0f;
+    float projX = 1.0f;        // proj.m[0], proj.m[5]
+    float projY = 1.0f;
+    float sliceScale = 0.0f;
+    float sliceBias = 0.0f;
+
+    // видимые источники в видовых координатах (SoA), глубина положительна
+    std::vector<float> vx, vy, vz, vr;
+    std::vector<uint32_t> source;   // номер во входном массиве
+
+    std::vector<float> lightData;
+    std::vector<uint32_t> clusters;
+    std::vector<uint16_t> indices;
+
+    size_t totalLights = 0;
+    size_t maxPerCluster = 0;
+    FrameTimeStats buildMs;
+    double indexSum = 0.0;
+    size_t frames = 0;
+    size_t visibleSum = 0;
+};
+
+// TBO с данными кластеров: набор буферов на каждый кадр в полёте
+class ClusterLightBuffers
+{
+public:
+    void Init(unsigned frameCount);
+    void Destroy();
+
+    // слот frame должен быть свободен (fence кадра или glFinish)
+    void Upload(unsigned frame, const LightClusterBuilder& builder);
+
+    // привязка к текстурным блокам firstUnit..firstUnit+2:
+    // источники (RGBA32F), кластеры (RG32UI), индексы (R16UI)
+    void Bind(unsigned frame, GLuint firstUnit) const;
+    void Unbind(GLuint firstUnit) const;
+
+private:
+    struct TextureBuffer
+    {
+        GLuint buffer = 0;
+        GLuint texture = 0;
+        GLsizeiptr capacity = 0;
+    };
+
+    struct Slot
+    {
+        TextureBuffer lights, clusters, indices;
+    };
+
+    static void Create(TextureBuffer& tb, GLenum format);
+    static void Write(TextureBuffer& tb, const void* data, GLsizeiptr size);
+
+    std::vector<Slot> slots;
+};
@@ -0,0 +1,727 @@
+#include "DeferredShading.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <vector>
+
+const char* pointLightGlsl = R"(
+    uniform samplerBuffer uLights;       // 2 texel на источник: позиция + радиус, цвет
+
+    uniform samplerCubeShadow uShadowCube;
+    uniform bool uSunShadows;
+    uniform mat4 uInvView;
+    uniform vec3 uSunPos;
+    uniform float uShadowRange;
+
+    // как в прямом освещении: точка сдвинута по нормали против акне
+    float SunShadow(vec3 p, vec3 n)
+    {
+        vec3 world = (uInvView * vec4(p, 1.0)).xyz;
+        vec3 worldN = mat3(uInvView) * n;
+        vec3 d = world - uSunPos;
+        d += worldN * (0.02 + 0.002 * length(d));
+        return texture(uShadowCube, vec4(d, length(d) / uShadowRange - 0.0005));
+    }
+
+    vec3 PointLight(int index, vec3 p, vec3 n)
+    {
+        vec4 posRadius = texelFetch(uLights, 2 * index);
+        vec3 d = posRadius.xyz - p;
+        float dist2 = dot(d, d);
+        float f = clamp(1.0 - dist2 / (posRadius.w * posRadius.w), 0.0, 1.0);
+        if (f <= 0.0)
+            return vec3(0.0);
+        vec4 color = texelFetch(uLights, 2 * index + 1);   // w — тень Солнца
+        float lit = f * f * max(dot(n, d * inversesqrt(dist2)), 0.0);
+        if (uSunShadows && color.w > 0.5 && lit > 0.0)
+            lit *= SunShadow(p, n);
+        return color.rgb * lit;
+    }
+)";
+
+namespace
+{
+    // G-буфер для проходов освещения: глубина, альбедо, нормаль, свет (композит)
+    const GLuint kGBufferUnit = 5;
+    const unsigned kTileSize = 16;
+
+    // чтение G-буфера (после pointLightGlsl)
+    const char* gbufferCommonSrc = R"(
+        uniform sampler2D uDepth;
+        uniform sampler2D uAlbedo;
+        uniform sampler2D uNormal;
+
+        uniform vec2 uSize;                  // используемая часть G-буфера
+        uniform vec4 uProjParams;            // 1 / proj[0], 1 / proj[5], proj[10], proj[14]
+
+        vec3 DecodeNormal(vec2 t)
+        {
+            vec2 e = t * 2.0 - 1.0;
+            vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+            float f = max(-n.z, 0.0);
+            n.x += n.x >= 0.0 ? -f : f;
+            n.y += n.y >= 0.0 ? -f : f;
+            return normalize(n);
+        }
+
+        // глубина [0, 1] -> видовые координаты (Mat4::Perspective)
+        vec3 ViewPosition(ivec2 pixel, float depth)
+        {
+            vec2 ndc = (vec2(pixel) + 0.5) / uSize * 2.0 - 1.0;
+            float z = -uProjParams.w / (depth * 2.0 - 1.0 + uProjParams.z);
+            return vec3(ndc * uProjParams.xy * -z, z);
+        }
+    )";
+
+    // объём источника: сфера радиуса источника вокруг его позиции
+    const char* volumeVertexSrc = R"(
+        layout(location = 0) in vec3 aPos;
+
+        uniform mat4 uProj;
+        uniform float uVolumeScale;
+
+        flat out int vLight;
+
+        void main()
+        {
+            vLight = gl_InstanceID;
+            vec4 posRadius = texelFetch(uLights, 2 * gl_InstanceID);
+            gl_Position = uProj * vec4(posRadius.xyz + aPos * (posRadius.w * uVolumeScale), 1.0);
+        }
+    )";
+
+    const char* volumeFragmentSrc = R"(
+        flat in int vLight;
+        out vec4 FragColor;
+
+        void main()
+        {
+            ivec2 pixel = ivec2(gl_FragCoord.xy);
+            float depth = texelFetch(uDepth, pixel, 0).r;
+            if (depth >= 1.0)
+                discard;
+            vec3 p = ViewPosition(pixel, depth);
+            vec3 n = DecodeNormal(texelFetch(uNormal, pixel, 0).xy);
+            vec3 albedo = texelFetch(uAlbedo, pixel, 0).rgb;
+            FragColor = vec4(albedo * PointLight(vLight, p, n), 0.0);
+        }
+    )";
+
+    // полноэкранный треугольник без вершинного буфера
+    const char* fullscreenVertexSrc = R"(
+        void main()
+        {
+            vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+            gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+        }
+    )";
+
+    // тайлы без compute: список источников — кластер пикселя
+    const char* clusterFragmentSrc = R"(
+        out vec4 FragColor;
+
+        uniform usamplerBuffer uClusters;    // начало списка, число источников
+        uniform usamplerBuffer uLightIndex;
+        uniform uvec3 uGrid;
+        uniform vec2 uSlice;                 // срез = log(глубина) * x + y
+
+        void main()
+        {
+            ivec2 pixel = ivec2(gl_FragCoord.xy);
+            float depth = texelFetch(uDepth, pixel, 0).r;
+            if (depth >= 1.0)
+                discard;
+            vec3 p = ViewPosition(pixel, depth);
+
+            vec2 uv = clamp(gl_FragCoord.xy / uSize, 0.0, 0.9999);
+            uvec2 tile = uvec2(uv * vec2(uGrid.xy));
+            float slice = clamp(log(-p.z) * uSlice.x + uSlice.y, 0.0, float(uGrid.z - 1u));
+            int cluster = int((uint(slice) * uGrid.y + tile.y) * uGrid.x + tile.x);
+            uvec2 range = texelFetch(uClusters, cluster).xy;
+            if (range.y == 0u)
+                discard;
+
+            vec3 n = DecodeNormal(texelFetch(uNormal, pixel, 0).xy);
+            vec3 light = vec3(0.0);
+            for (uint i = 0u; i < range.y; ++i)
+                light += PointLight(int(texelFetch(uLightIndex, int(range.x + i)).r), p, n);
+            FragColor = vec4(texelFetch(uAlbedo, pixel, 0).rgb * light, 0.0);
+        }
+    )";
+
+    // тайл 16x16: диапазон глубины тайла -> AABB в видовых координатах ->
+    // отбор источников пачками по kBatch в shared-память -> освещение
+    const char* tiledComputeSrc = R"(
+        layout(local_size_x = 16, local_size_y = 16) in;
+        layout(rgba16f) uniform image2D uLightImage;
+
+        uniform int uLightCount;
+
+        const uint kBatch = 1024u;
+        shared uint sMinZ;
+        shared uint sMaxZ;
+        shared uint sCount;
+        shared uint sList[kBatch];
+
+        void main()
+        {
+            ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+            bool inside = all(lessThan(pixel, ivec2(uSize)));
+            if (gl_LocalInvocationIndex == 0u)
+            {
+                sMinZ = 0x7F7FFFFFu;
+                sMaxZ = 0u;
+            }
+            barrier();
+
+            float depth = inside ? texelFetch(uDepth, pixel, 0).r : 1.0;
+            bool geometry = depth < 1.0;
+            vec3 p = vec3(0.0);
+            if (geometry)
+            {
+                p = ViewPosition(pixel, depth);
+                // положительные float сравниваются как uint
+                atomicMin(sMinZ, floatBitsToUint(-p.z));
+                atomicMax(sMaxZ, floatBitsToUint(-p.z));
+            }
+            barrier();
+            if (sMaxZ == 0u)
+                return;   // в тайле только фон, решение общее для группы
+
+            float minZ = uintBitsToFloat(sMinZ);
+            float maxZ = uintBitsToFloat(sMaxZ);
+            vec2 lo = (vec2(gl_WorkGroupID.xy * 16u) / uSize * 2.0 - 1.0) * uProjParams.xy;
+            vec2 hi = (vec2(gl_WorkGroupID.xy * 16u + 16u) / uSize * 2.0 - 1.0) * uProjParams.xy;
+            vec3 boxMin = vec3(min(lo * minZ, lo * maxZ), -maxZ);
+            vec3 boxMax = vec3(max(hi * minZ, hi * maxZ), -minZ);
+
+            vec3 n = geometry ? DecodeNormal(texelFetch(uNormal, pixel, 0).xy) : vec3(0.0);
+            vec3 light = vec3(0.0);
+            for (int base = 0; base < uLightCount; base += int(kBatch))
+            {
+                if (gl_LocalInvocationIndex == 0u)
+                    sCount = 0u;
+                barrier();
+
+                int end = min(base + int(kBatch), uLightCount);
+                for (int i = base + int(gl_LocalInvocationIndex); i < end; i += 256)
+                {
+                    vec4 posRadius = texelFetch(uLights, 2 * i);
+                    vec3 d = clamp(posRadius.xyz, boxMin, boxMax) - posRadius.xyz;
+                    if (dot(d, d) < posRadius.w * posRadius.w)
+                        sList[atomicAdd(sCount, 1u)] = uint(i);
+                }
+                barrier();
+
+                if (geometry)
+                    for (uint i = 0u; i < sCount; ++i)
+                        light += PointLight(int(sList[i]), p, n);
+                barrier();
+            }
+
+            if (geometry)
+            {
+                vec3 albedo = texelFetch(uAlbedo, pixel, 0).rgb;
+                imageStore(uLightImage, pixel, imageLoad(uLightImage, pixel) + vec4(albedo * light, 0.0));
+            }
+        }
+    )";
+
+    const char* compositeVertexSrc = R"(
+        #version 330 core
+        void main()
+        {
+            vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+            gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+        }
+    )";
+
+    // свет -> цвет цели, глубина G-буфера -> её глубина
+    const char* compositeFragmentSrc = R"(
+        #version 330 core
+        out vec4 FragColor;
+
+        uniform sampler2D uLightTex;
+        uniform sampler2D uDepth;
+        uniform ivec2 uOffset;               // начало viewport цели
+
+        void main()
+        {
+            ivec2 pixel = ivec2(gl_FragCoord.xy) - uOffset;
+            FragColor = vec4(texelFetch(uLightTex, pixel, 0).rgb, 1.0);
+            gl_FragDepth = texelFetch(uDepth, pixel, 0).r;
+        }
+    )";
+
+    std::string LightingSource(const char* version, const char* body)
+    {
+        return std::string(version) + "\n" + pointLightGlsl + gbufferCommonSrc + body;
+    }
+
+    GLuint CompileSource(GLenum type, const std::string& src)
+    {
+        return CompileShader(type, src.c_str());
+    }
+
+    GLuint CheckLinked(GLuint prog)
+    {
+        GLint ok = 0;
+        glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+        if (ok)
+            return prog;
+        glDeleteProgram(prog);
+        return 0;
+    }
+
+    // икосаэдр, разбитый один раз: 80 граней, вершины на единичной сфере
+    void BuildIcosphere(std::vector<Vec3>& vertices, std::vector<uint16_t>& indices)
+    {
+        const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+        vertices = {
+            Vec3(-1, t, 0), Vec3(1, t, 0), Vec3(-1, -t, 0), Vec3(1, -t, 0),
+            Vec3(0, -1, t), Vec3(0, 1, t), Vec3(0, -1, -t), Vec3(0, 1, -t),
+            Vec3(t, 0, -1), Vec3(t, 0, 1), Vec3(-t, 0, -1), Vec3(-t, 0, 1),
+        };
+        for (Vec3& v : vertices)
+            v = Normalize(v);
+        std::vector<uint16_t> faces = {
+            0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+            1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+            3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+            4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1,
+        };
+
+        std::map<uint32_t, uint16_t> midpoints;
+        auto midpoint = [&](uint16_t a, uint16_t b)
+            {
+                uint32_t key = std::min(a, b) << 16 | std::max(a, b);
+                auto it = midpoints.find(key);
+                if (it != midpoints.end())
+                    return it->second;
+                vertices.push_back(Normalize(vertices[a] + vertices[b]));
+                uint16_t index = (uint16_t)(vertices.size() - 1);
+                midpoints[key] = index;
+                return index;
+            };
+
+        indices.clear();
+        for (size_t f = 0; f < faces.size(); f += 3)
+        {
+            uint16_t a = faces[f], b = faces[f + 1], c = faces[f + 2];
+            uint16_t ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+            uint16_t tris[12] = { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca };
+            indices.insert(indices.end(), tris, tris + 12);
+        }
+
+        // все грани наружу (CCW снаружи)
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const Vec3& p0 = vertices[indices[i]];
+            const Vec3& p1 = vertices[indices[i + 1]];
+            const Vec3& p2 = vertices[indices[i + 2]];
+            if (Dot(Cross(p1 - p0, p2 - p0), p0 + p1 + p2) < 0.0f)
+                std::swap(indices[i + 1], indices[i + 2]);
+        }
+    }
+
+    // во сколько раз раздуть многогранник, чтобы он содержал единичную сферу
+    float InradiusScale(const std::vector<Vec3>& vertices, const std::vector<uint16_t>& indices)
+    {
+        float inradius = 1.0f;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const Vec3& p0 = vertices[indices[i]];
+            Vec3 n = Normalize(Cross(vertices[indices[i + 1]] - p0, vertices[indices[i + 2]] - p0));
+            inradius = std::min(inradius, Dot(n, p0));
+        }
+        return 1.0f / inradius;
+    }
+}
+
+const char* ShadingPathName(ShadingPath path)
+{
+    switch (path)
+    {
+    case ShadingPath::DeferredVolumes: return "volumes";
+    case ShadingPath::DeferredTiled: return "tiled";
+    default: return "forward";
+    }
+}
+
+bool ParseShadingPath(const std::string& name, ShadingPath& path)
+{
+    for (ShadingPath p : { ShadingPath::Forward, ShadingPath::DeferredVolumes, ShadingPath::DeferredTiled })
+    {
+        if (name == ShadingPathName(p))
+        {
+            path = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DeferredShading::InitLightingProgram(GLuint program, LightingUniforms& u)
+{
+    if (!program)
+        return false;
+
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "uDepth"), kGBufferUnit);
+    glUniform1i(glGetUniformLocation(program, "uAlbedo"), kGBufferUnit + 1);
+    glUniform1i(glGetUniformLocation(program, "uNormal"), kGBufferUnit + 2);
+    glUniform1i(glGetUniformLocation(program, "uLights"), lightUnit);
+    glUniform1i(glGetUniformLocation(program, "uClusters"), lightUnit + 1);
+    glUniform1i(glGetUniformLocation(program, "uLightIndex"), lightUnit + 2);
+    glUniform1i(glGetUniformLocation(program, "uShadowCube"), shadowUnit);
+    glUseProgram(0);
+
+    u.size = glGetUniformLocation(program, "uSize");
+    u.projParams = glGetUniformLocation(program, "uProjParams");
+    u.sunShadows = glGetUniformLocation(program, "uSunShadows");
+    u.invView = glGetUniformLocation(program, "uInvView");
+    u.sunPos = glGetUniformLocation(program, "uSunPos");
+    u.shadowRange = glGetUniformLocation(program, "uShadowRange");
+    return true;
+}
+
+bool DeferredShading::Init(ShadingPath p, GLuint lights, GLuint shadows)
+{
+    path = p;
+    lightUnit = lights;
+    shadowUnit = shadows;
+
+    const char* version = "#version 330 core";
+    bool ok = true;
+    if (path == ShadingPath::DeferredVolumes)
+    {
+        GLuint vert = CompileSource(GL_VERTEX_SHADER, LightingSource(version, volumeVertexSrc));
+        GLuint frag = CompileSource(GL_FRAGMENT_SHADER, LightingSource(version, volumeFragmentSrc));
+        volumeProg = CheckLinked(LinkProgram(vert, frag));
+        glDeleteShader(vert);
+        glDeleteShader(frag);
+        ok = InitLightingProgram(volumeProg, volumeUniforms);
+        volumeProjLoc = glGetUniformLocation(volumeProg, "uProj");
+        volumeScaleLoc = glGetUniformLocation(volumeProg, "uVolumeScale");
+
+        std::vector<Vec3> vertices;
+        std::vector<uint16_t> indices;
+        BuildIcosphere(vertices, indices);
+        sphereScale = InradiusScale(vertices, indices);
+        sphereIndexCount = (GLsizei)indices.size();
+
+        glGenVertexArrays(1, &sphereVAO);
+        glGenBuffers(1, &sphereVBO);
+        glGenBuffers(1, &sphereEBO);
+        glBindVertexArray(sphereVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vec3), vertices.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vec3), (void*)0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    else if (GLEW_VERSION_4_3)
+    {
+        GLuint comp = CompileSource(GL_COMPUTE_SHADER, LightingSource("#version 430 core", tiledComputeSrc));
+        computeProg = CheckLinked(LinkComputeProgram(comp));
+        glDeleteShader(comp);
+        ok = InitLightingProgram(computeProg, computeUniforms);
+        computeCountLoc = glGetUniformLocation(computeProg, "uLightCount");
+        if (ok)
+        {
+            glUseProgram(computeProg);
+            glUniform1i(glGetUniformLocation(computeProg, "uLightImage"), 0);
+            glUseProgram(0);
+        }
+    }
+    else
+    {
+        std::cout << "Compute shaders need OpenGL 4.3, tiled lighting falls back to clusters" << std::endl;
+        GLuint vert = CompileSource(GL_VERTEX_SHADER, LightingSource(version, fullscreenVertexSrc));
+        GLuint frag = CompileSource(GL_FRAGMENT_SHADER, LightingSource(version, clusterFragmentSrc));
+        clusterProg = CheckLinked(LinkProgram(vert, frag));
+        glDeleteShader(vert);
+        glDeleteShader(frag);
+        ok = InitLightingProgram(clusterProg, clusterUniforms);
+        clusterGridLoc = glGetUniformLocation(clusterProg, "uGrid");
+        clusterSliceLoc = glGetUniformLocation(clusterProg, "uSlice");
+    }
+
+    GLuint vert = CompileShader(GL_VERTEX_SHADER, compositeVertexSrc);
+    GLuint frag = CompileShader(GL_FRAGMENT_SHADER, compositeFragmentSrc);
+    compositeProg = CheckLinked(LinkProgram(vert, frag));
+    glDeleteShader(vert);
+    glDeleteShader(frag);
+    if (compositeProg)
+    {
+        glUseProgram(compositeProg);
+        glUniform1i(glGetUniformLocation(compositeProg, "uLightTex"), kGBufferUnit + 3);
+        glUniform1i(glGetUniformLocation(compositeProg, "uDepth"), kGBufferUnit);
+        glUseProgram(0);
+        compositeOffsetLoc = glGetUniformLocation(compositeProg, "uOffset");
+    }
+
+    glGenVertexArrays(1, &emptyVAO);
+    if (!ok || !compositeProg)
+    {
+        Destroy();
+        return false;
+    }
+    return true;
+}
+
+void DeferredShading::Destroy()
+{
+    Free();
+    glDeleteProgram(volumeProg);
+    glDeleteProgram(clusterProg);
+    glDeleteProgram(computeProg);
+    glDeleteProgram(compositeProg);
+    glDeleteVertexArrays(1, &emptyVAO);
+    glDeleteVertexArrays(1, &sphereVAO);
+    glDeleteBuffers(1, &sphereVBO);
+    glDeleteBuffers(1, &sphereEBO);
+    volumeProg = clusterProg = computeProg = compositeProg = 0;
+    emptyVAO = sphereVAO = sphereVBO = sphereEBO = 0;
+}
+
+void DeferredShading::Allocate(unsigned w, unsigned h)
+{
+    capacityWidth = w;
+    capacityHeight = h;
+
+    auto texture = [&](GLuint& tex, GLenum internalFormat, GLenum format, GLenum type)
+        {
+            glGenTextures(1, &tex);
+            glBindTexture(GL_TEXTURE_2D, tex);
+            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, type, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        };
+    texture(lightTex, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+    texture(albedoTex, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+    texture(normalTex, GL_RG16, GL_RG, GL_UNSIGNED_SHORT);
+    texture(depthTex, GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &gbufferFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, gbufferFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, lightTex, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, albedoTex, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, normalTex, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTex, 0);
+    const GLenum buffers[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+    glDrawBuffers(3, buffers);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "G-buffer is incomplete: " << w << "x" << h << std::endl;
+
+    // проходы, читающие глубину, не могут её же держать привязанной:
+    // объёмам для теста — копия в renderbuffer того же формата
+    glGenRenderbuffers(1, &volumeDepthRB);
+    glBindRenderbuffer(GL_RENDERBUFFER, volumeDepthRB);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, w, h);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glGenFramebuffers(1, &lightFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, lightTex, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, volumeDepthRB);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Light buffer is incomplete: " << w << "x" << h << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DeferredShading::Free()
+{
+    glDeleteFramebuffers(1, &gbufferFBO);
+    glDeleteFramebuffers(1, &lightFBO);
+    glDeleteRenderbuffers(1, &volumeDepthRB);
+    volumeDepthRB = 0;
+    GLuint textures[4] = { lightTex, albedoTex, normalTex, depthTex };
+    glDeleteTextures(4, textures);
+    gbufferFBO = lightFBO = 0;
+    lightTex = albedoTex = normalTex = depthTex = 0;
+    capacityWidth = capacityHeight = 0;
+}
+
+void DeferredShading::BeginGeometry(unsigned w, unsigned h, const float clearColor[3])
+{
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFBO);
+    glGetIntegerv(GL_VIEWPORT, targetViewport);
+
+    width = std::max(1u, w);
+    height = std::max(1u, h);
+    // динамическое разрешение меняет размер каждый кадр — текстуры только растут
+    if (width > capacityWidth || height > capacityHeight)
+    {
+        unsigned newW = std::max(width, capacityWidth);
+        unsigned newH = std::max(height, capacityHeight);
+        Free();
+        Allocate(newW, newH);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, gbufferFBO);
+    glViewport(0, 0, width, height);
+    const GLfloat light[4] = { clearColor[0], clearColor[1], clearColor[2], 1.0f };
+    const GLfloat zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, light);
+    glClearBufferfv(GL_COLOR, 1, zero);
+    glClearBufferfv(GL_COLOR, 2, zero);
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void DeferredShading::SetLightingUniforms(const LightingUniforms& u, const DeferredLights& lights)
+{
+    const Mat4& proj = lights.proj;
+    glUniform2f(u.size, (float)width, (float)height);
+    glUniform4f(u.projParams, 1.0f / proj.m[0], 1.0f / proj.m[5], proj.m[10], proj.m[14]);
+    glUniform1i(u.sunShadows, lights.shadows ? 1 : 0);
+    if (lights.shadows)
+    {
+        Mat4 invView = InverseRigid(lights.view);
+        Vec3 sun = lights.shadows->LightPosition();
+        glUniformMatrix4fv(u.invView, 1, GL_FALSE, invView.m);
+        glUniform3f(u.sunPos, sun.x, sun.y, sun.z);
+        glUniform1f(u.shadowRange, lights.shadows->Range());
+        glActiveTexture(GL_TEXTURE0 + shadowUnit);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, lights.shadows->Texture());
+    }
+}
+
+void DeferredShading::BindGBuffer()
+{
+    const GLuint textures[4] = { depthTex, albedoTex, normalTex, lightTex };
+    for (GLuint i = 0; i < 4; ++i)
+    {
+        glActiveTexture(GL_TEXTURE0 + kGBufferUnit + i);
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void DeferredShading::UnbindGBuffer()
+{
+    for (GLuint i = 0; i < 4; ++i)
+    {
+        glActiveTexture(GL_TEXTURE0 + kGBufferUnit + i);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glActiveTexture(GL_TEXTURE0 + shadowUnit);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void DeferredShading::Resolve(const DeferredLights& lights)
+{
+    GLsizei count = (GLsizei)(lights.clusters->LightData().size() / 8);
+
+    // свет только из lightTex, глубина G-буфера читается как текстура
+    BindGBuffer();
+    if (count > 0)
+    {
+        if (path == ShadingPath::DeferredVolumes)
+            LightVolumes(lights, count);
+        else if (computeProg)
+            LightTilesCompute(lights, count);
+        else
+            LightTilesClusters(lights);
+    }
+    Composite();
+    UnbindGBuffer();
+    glUseProgram(0);
+}
+
+void DeferredShading::LightVolumes(const DeferredLights& lights, GLsizei count)
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, gbufferFBO);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, lightFBO);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
+    glUseProgram(volumeProg);
+    SetLightingUniforms(volumeUniforms, lights);
+    glUniformMatrix4fv(volumeProjLoc, 1, GL_FALSE, lights.proj.m);
+    glUniform1f(volumeScaleLoc, sphereScale);
+
+    // задние грани: объём виден и когда камера внутри него;
+    // depth clamp — и когда он выходит за far. GL_GREATER пропускает
+    // только пиксели, поверхность которых ближе задней стенки объёма:
+    // всё, что за объёмом, и фон отсекаются до фрагментного шейдера
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_GREATER);
+    glDepthMask(GL_FALSE);
+    glCullFace(GL_FRONT);
+    glEnable(GL_DEPTH_CLAMP);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+
+    glBindVertexArray(sphereVAO);
+    glDrawElementsInstanced(GL_TRIANGLES, sphereIndexCount, GL_UNSIGNED_SHORT, nullptr, count);
+    glBindVertexArray(0);
+
+    glDisable(GL_BLEND);
+    glDisable(GL_DEPTH_CLAMP);
+    glCullFace(GL_BACK);
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
+}
+
+void DeferredShading::LightTilesCompute(const DeferredLights& lights, GLsizei count)
+{
+    glUseProgram(computeProg);
+    SetLightingUniforms(computeUniforms, lights);
+    glUniform1i(computeCountLoc, count);
+    glBindImageTexture(0, lightTex, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA16F);
+    glDispatchCompute((width + kTileSize - 1) / kTileSize, (height + kTileSize - 1) / kTileSize, 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA16F);
+}
+
+void DeferredShading::LightTilesClusters(const DeferredLights& lights)
+{
+    const ClusterGrid& grid = lights.clusters->Grid();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
+    glUseProgram(clusterProg);
+    SetLightingUniforms(clusterUniforms, lights);
+    glUniform3ui(clusterGridLoc, grid.x, grid.y, grid.z);
+    glUniform2f(clusterSliceLoc, lights.clusters->SliceScale(), lights.clusters->SliceBias());
+
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void DeferredShading::Composite()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+    glViewport(targetViewport[0], targetViewport[1], targetViewport[2], targetViewport[3]);
+
+    // глубина пишется как есть, чтобы поверх можно было рисовать прямым проходом
+    glDepthFunc(GL_ALWAYS);
+    glUseProgram(compositeProg);
+    glUniform2i(compositeOffsetLoc, targetViewport[0], targetViewport[1]);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glDepthFunc(GL_LESS);
+}
+
+std::string DeferredShading::Summary() const
+{
+    const char* lighting = path == ShadingPath::DeferredVolumes ? "depth-tested light volumes"
+        : computeProg ? "compute 16x16 tiles" : "cluster pass (no compute)";
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "%s, %s, G-buffer %ux%u (8 B/px + depth, light RGBA16F)",
+        ShadingPathName(path), lighting, capacityWidth, capacityHeight);
+    return buf;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "ClusteredLighting.h"
+#include "GlUtils.h"
+#include "SunShadows.h"
+
+#include <string>
+
+// =======================================================
+// ОТЛОЖЕННОЕ ОСВЕЩЕНИЕ (deferred shading)
+// =======================================================
+//
+// Проход геометрии пишет компактный G-буфер, 8 байт на пиксель + глубина:
+//   нормаль — RG16, октаэдрическая развёртка единичного вектора;
+//   альбедо — RGBA8;
+//   позиция не хранится: восстанавливается по глубине и проекции.
+// Рядом буфер света RGBA16F, сразу с фоновым светом и свечением планеты
+// (в R11G11B10F при сложении сотен источников теряются слабые вклады).
+// Затем источники добавляются в буфер света одним из способов:
+//   объёмы — instanced-сферы источников с аддитивным смешением,
+//            задние грани с проверкой глубины GL_GREATER по копии
+//            глубины G-буфера: пиксель платит только за объёмы, за
+//            задней стенкой которых он не лежит;
+//   тайлы  — compute-шейдер (GL 4.3): тайл 16x16 находит диапазон своей
+//            глубины, отбирает источники в shared-память и освещает
+//            пиксели только ими. Без compute — полноэкранный проход
+//            по кластерам LightClusterBuilder.
+// В конце свет и глубина переносятся в framebuffer, который был
+// привязан до прохода геометрии.
+
+enum class ShadingPath
+{
+    Forward,           // кластерное прямое освещение (SceneRenderer)
+    DeferredVolumes,
+    DeferredTiled,
+};
+
+// "forward", "volumes", "tiled"
+const char* ShadingPathName(ShadingPath path);
+bool ParseShadingPath(const std::string& name, ShadingPath& path);
+
+// GLSL после #version: uLights, тень Солнца (uShadowCube, uSunShadows,
+// uInvView, uSunPos, uShadowRange) и vec3 PointLight(index, viewPos, n)
+// — вклад источника, как в прямом кластерном освещении
+extern const char* pointLightGlsl;
+
+// источники для прохода освещения: данные LightClusterBuilder уже в TBO
+// (ClusterLightBuffers::Bind на lightUnit из Init)
+struct DeferredLights
+{
+    const LightClusterBuilder* clusters = nullptr;
+    const SunShadowMap* shadows = nullptr;   // nullptr — без теней
+    Mat4 view;
+    Mat4 proj;
+};
+
+class DeferredShading
+{
+public:
+    // lightUnit..lightUnit+2 — TBO кластеров, shadowUnit — кубическая карта теней
+    bool Init(ShadingPath path, GLuint lightUnit, GLuint shadowUnit);
+    void Destroy();
+
+    // привязывает G-буфер (не меньше w x h) и очищает его; текущие
+    // framebuffer и viewport запоминаются для Resolve
+    void BeginGeometry(unsigned w, unsigned h, const float clearColor[3]);
+    // источники в буфер света, затем свет и глубина — в запомненный framebuffer
+    void Resolve(const DeferredLights& lights);
+
+    ShadingPath Path() const { return path; }
+    bool UsesCompute() const { return computeProg != 0; }
+
+    // "tiled, compute 16x16 tiles, G-buffer 1280x720 (8 B/px + depth, light RGBA16F)"
+    std::string Summary() const;
+
+private:
+    // общие для проходов освещения uniform (восстановление позиции, тени)
+    struct LightingUniforms
+    {
+        GLint size = -1;
+        GLint projParams = -1;
+        GLint sunShadows = -1;
+        GLint invView = -1;
+        GLint sunPos = -1;
+        GLint shadowRange = -1;
+    };
+
+    void Allocate(unsigned w, unsigned h);
+    void Free();
+    bool InitLightingProgram(GLuint program, LightingUniforms& u);
+    void SetLightingUniforms(const LightingUniforms& u, const DeferredLights& lights);
+    void BindGBuffer();
+    void UnbindGBuffer();
+
+    void LightVolumes(const DeferredLights& lights, GLsizei count);
+    void LightTilesCompute(const DeferredLights& lights, GLsizei count);
+    void LightTilesClusters(const DeferredLights& lights);
+    void Composite();
+
+    ShadingPath path = ShadingPath::DeferredVolumes;
+    GLuint lightUnit = 1;
+    GLuint shadowUnit = 4;
+
+    // --- G-буфер ---
+    GLuint gbufferFBO = 0;       // свет, альбедо, нормаль + глубина
+    GLuint lightFBO = 0;         // свет + копия глубины: проходы, читающие глубину
+    GLuint volumeDepthRB = 0;    // копия глубины для теста объёмов (не текстура)
+    GLuint lightTex = 0;
+    GLuint albedoTex = 0;
+    GLuint normalTex = 0;
+    GLuint depthTex = 0;
+    unsigned capacityWidth = 0;  // растёт, но не сжимается
+    unsigned capacityHeight = 0;
+    unsigned width = 0;          // используемая часть
+    unsigned height = 0;
+
+    // framebuffer и viewport до BeginGeometry
+    GLint targetFBO = 0;
+    GLint targetViewport[4] = {};
+
+    // --- программы ---
+    GLuint volumeProg = 0;
+    GLuint clusterProg = 0;      // тайлы без compute
+    GLuint computeProg = 0;
+    GLuint compositeProg = 0;
+    LightingUniforms volumeUniforms, clusterUniforms, computeUniforms;
+    GLint volumeProjLoc = -1;
+    GLint volumeScaleLoc = -1;
+    GLint clusterGridLoc = -1;
+    GLint clusterSliceLoc = -1;
+    GLint computeCountLoc = -1;
+    GLint compositeOffsetLoc = -1;
+
+    GLuint emptyVAO = 0;
+    GLuint sphereVAO = 0;        // икосфера для объёмов
+    GLuint sphereVBO = 0;
+    GLuint sphereEBO = 0;
+    GLsizei sphereIndexCount = 0;
+    float sphereScale = 1.0f;    // чтобы грани описывали единичную сферу
+};
@@ -0,0 +1,202 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+namespace
+{
+    // полноэкранный треугольник без вершинного буфера
+    const char* upscaleVertexSrc = R"(
+        #version 330 core
+        out vec2 vUV;
+
+        void main()
+        {
+            vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+            vUV = p;
+            gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+        }
+    )";
+
+    // билинейная выборка + резкость с подавлением на краях (по мотивам CAS)
+    const char* upscaleFragmentSrc = R"(
+        #version 330 core
+        in vec2 vUV;
+        out vec4 FragColor;
+
+        uniform sampler2D uScene;
+        uniform vec2 uUVScale;    // доля текстуры, занятая кадром
+        uniform vec2 uUVMax;      // на полтекселя внутри кадра
+        uniform vec2 uTexel;      // 1 / размер текстуры
+        uniform float uSharpness;
+
+        vec3 Fetch(vec2 uv)
+        {
+            return texture(uScene, min(uv, uUVMax)).rgb;
+        }
+
+        void main()
+        {
+            vec2 uv = vUV * uUVScale;
+            vec3 c = Fetch(uv);
+            if (uSharpness > 0.0)
+            {
+                vec3 n = Fetch(uv + vec2(0.0, uTexel.y));
+                vec3 s = Fetch(uv - vec2(0.0, uTexel.y));
+                vec3 e = Fetch(uv + vec2(uTexel.x, 0.0));
+                vec3 w = Fetch(uv - vec2(uTexel.x, 0.0));
+
+                vec3 mn = min(c, min(min(n, s), min(e, w)));
+                vec3 mx = max(c, max(max(n, s), max(e, w)));
+                vec3 amp = sqrt(clamp(min(mn, 1.0 - mx) / max(mx, vec3(1e-4)), 0.0, 1.0));
+                vec3 k = -amp * mix(0.125, 0.2, uSharpness);
+                c = clamp((c + (n + s + e + w) * k) / (1.0 + 4.0 * k), 0.0, 1.0);
+            }
+            FragColor = vec4(c, 1.0);
+        }
+    )";
+
+    // размеры цели кратны 8: меньше мелких смен viewport
+    const unsigned kSizeStep = 8;
+    // зона нечувствительности вокруг цели и плавность подстройки
+    const double kDeadband = 0.05;
+    const float kSmoothing = 0.3f;
+}
+
+bool DynamicResolution::Init(const DynamicResolutionSettings& s, unsigned w, unsigned h)
+{
+    settings = s;
+    settings.minScale = std::clamp(settings.minScale, 0.1f, 1.0f);
+    settings.maxScale = std::clamp(settings.maxScale, settings.minScale, 1.0f);
+    scale = settings.maxScale;
+
+    GLuint vert = CompileShader(GL_VERTEX_SHADER, upscaleVertexSrc);
+    GLuint frag = CompileShader(GL_FRAGMENT_SHADER, upscaleFragmentSrc);
+    upscaleProg = LinkProgram(vert, frag);
+    glDeleteShader(vert);
+    glDeleteShader(frag);
+    if (!upscaleProg)
+        return false;
+
+    uSceneLoc = glGetUniformLocation(upscaleProg, "uScene");
+    uUVScaleLoc = glGetUniformLocation(upscaleProg, "uUVScale");
+    uUVMaxLoc = glGetUniformLocation(upscaleProg, "uUVMax");
+    uTexelLoc = glGetUniformLocation(upscaleProg, "uTexel");
+    uSharpnessLoc = glGetUniformLocation(upscaleProg, "uSharpness");
+
+    glGenVertexArrays(1, &emptyVAO);
+    timer.Init();
+    Resize(w, h);
+
+    std::cout << "Dynamic resolution: target " << settings.targetMs << " ms GPU, scale "
+        << settings.minScale << ".." << settings.maxScale << std::endl;
+    return true;
+}
+
+void DynamicResolution::Destroy()
+{
+    if (target.fbo)
+        DestroyRenderTarget(target);
+    timer.Destroy();
+    glDeleteVertexArrays(1, &emptyVAO);
+    glDeleteProgram(upscaleProg);
+    emptyVAO = 0;
+    upscaleProg = 0;
+}
+
+void DynamicResolution::Resize(unsigned w, unsigned h)
+{
+    w = std::max(1u, w);
+    h = std::max(1u, h);
+    if (w == windowWidth && h == windowHeight && target.fbo)
+        return;
+
+    windowWidth = w;
+    windowHeight = h;
+    if (target.fbo)
+        DestroyRenderTarget(target);
+    target = CreateRenderTarget(w, h);
+    UpdateRenderSize();
+}
+
+void DynamicResolution::UpdateRenderSize()
+{
+    auto quantize = [](float v, unsigned limit)
+        {
+            unsigned q = (unsigned)std::lround(v / kSizeStep) * kSizeStep;
+            return std::clamp(q, std::min(limit, kSizeStep), limit);
+        };
+    renderWidth = quantize(windowWidth * scale, windowWidth);
+    renderHeight = quantize(windowHeight * scale, windowHeight);
+}
+
+void DynamicResolution::UpdateScale(double ms)
+{
+    gpuMs.Add(ms);
+    double ratio = settings.targetMs / std::max(ms, 0.01);
+    if (std::fabs(ratio - 1.0) < kDeadband)
+        return;
+
+    // стоимость ~ числу пикселей ~ scale^2
+    float desired = scale * (float)std::sqrt(ratio);
+    desired = std::clamp(desired, settings.minScale, settings.maxScale);
+    scale += (desired - scale) * kSmoothing;
+    UpdateRenderSize();
+}
+
+void DynamicResolution::BeginScene()
+{
+    double ms = 0.0;
+    if (timer.Poll(ms))
+        UpdateScale(ms);
+
+    timer.Begin();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+    glViewport(0, 0, renderWidth, renderHeight);
+    // очистка только используемой части цели
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(0, 0, renderWidth, renderHeight);
+}
+
+void DynamicResolution::EndScene()
+{
+    glDisable(GL_SCISSOR_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, windowWidth, windowHeight);
+
+    glDisable(GL_DEPTH_TEST);
+    glUseProgram(upscaleProg);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, target.color);
+    glUniform1i(uSceneLoc, 0);
+    glUniform2f(uUVScaleLoc, (float)renderWidth / windowWidth, (float)renderHeight / windowHeight);
+    glUniform2f(uUVMaxLoc, (renderWidth - 0.5f) / windowWidth, (renderHeight - 0.5f) / windowHeight);
+    glUniform2f(uTexelLoc, 1.0f / windowWidth, 1.0f / windowHeight);
+    // при 1:1 резкость не нужна
+    bool native = renderWidth == windowWidth && renderHeight == windowHeight;
+    glUniform1f(uSharpnessLoc, native ? 0.0f : settings.sharpness);
+
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    glEnable(GL_DEPTH_TEST);
+
+    timer.End();
+
+    scaleSum += scale;
+    scaleMin = std::min(scaleMin, scale);
+    ++frames;
+}
+
+std::string DynamicResolution::Summary() const
+{
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "scale mean %.2f (min %.2f), GPU: ",
+        frames ? scaleSum / frames : 1.0, scaleMin);
+    return buf + gpuMs.Summary();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "FrameStats.h"
+#include "GlUtils.h"
+#include "GpuTimer.h"
+
+#include <string>
+
+// =======================================================
+// ДИНАМИЧЕСКОЕ РАЗРЕШЕНИЕ ПО ВРЕМЕНИ GPU
+// =======================================================
+//
+// Сцена рисуется в offscreen-цель размером с окно, но только в
+// левый нижний прямоугольник (scale * окно); масштаб подбирается
+// по таймеру GPU, чтобы держать целевое время кадра. Смена масштаба
+// — только viewport, цель пересоздаётся лишь при ресайзе окна.
+// Затем кадр растягивается в окно билинейно с адаптивной резкостью
+// (сильнее на плоских участках, слабее на контрастных краях).
+
+struct DynamicResolutionSettings
+{
+    float targetMs = 12.0f;     // целевое время GPU на кадр
+    float minScale = 0.5f;      // по каждой оси
+    float maxScale = 1.0f;
+    float sharpness = 0.4f;     // 0 — чистый билинейный фильтр
+};
+
+class DynamicResolution
+{
+public:
+    bool Init(const DynamicResolutionSettings& settings, unsigned w, unsigned h);
+    void Destroy();
+
+    // размер окна; масштаб не сбрасывается
+    void Resize(unsigned w, unsigned h);
+
+    // привязывает offscreen-цель с текущим масштабом и начинает замер
+    void BeginScene();
+    // растягивает кадр в framebuffer окна, заканчивает замер,
+    // по готовым замерам двигает масштаб
+    void EndScene();
+
+    float Scale() const { return scale; }
+    unsigned RenderWidth() const { return renderWidth; }
+    unsigned RenderHeight() const { return renderHeight; }
+
+    // "scale mean 0.82 (min 0.61), GPU: <FrameTimeStats>"
+    std::string Summary() const;
+
+private:
+    void UpdateScale(double gpuMs);
+    void UpdateRenderSize();
+
+    DynamicResolutionSettings settings;
+    unsigned windowWidth = 0;
+    unsigned windowHeight = 0;
+    unsigned renderWidth = 0;
+    unsigned renderHeight = 0;
+    float scale = 1.0f;
+
+    RenderTarget target;
+    GpuTimer timer;
+
+    GLuint upscaleProg = 0;
+    GLuint emptyVAO = 0;
+    GLint uSceneLoc = -1;
+    GLint uUVScaleLoc = -1;
+    GLint uUVMaxLoc = -1;
+    GLint uTexelLoc = -1;
+    GLint uSharpnessLoc = -1;
+
+    FrameTimeStats gpuMs;
+    double scaleSum = 0.0;
+    float scaleMin = 1.0f;
+    size_t frames = 0;
+};
@@ -0,0 +1,461 @@
+#include "FrameCapture.h"
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    // очередь к кодировщику без постоянного отображения: столько копий кадров
+    // держим в памяти, дальше основной поток ждёт (PNG медленнее 60 Гц)
+    const size_t kMaxQueuedCopies = 8;
+
+    bool FenceSignaled(GLsync fence, GLuint64 timeoutNs)
+    {
+        GLenum r = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNs);
+        return r == GL_ALREADY_SIGNALED || r == GL_CONDITION_SATISFIED;
+    }
+
+    // шаблон пользователя в snprintf не попадает: формат номера собираем сами
+    std::string FormatPattern(const CapturePattern& pattern, uint64_t frame)
+    {
+        char number[32];
+        std::snprintf(number, sizeof(number), pattern.zeroPad ? "%0*llu" : "%*llu",
+            pattern.width, (unsigned long long)frame);
+        return pattern.prefix + number + pattern.suffix;
+    }
+
+    bool EndsWith(const std::string& s, const std::string& suffix)
+    {
+        return s.size() >= suffix.size() &&
+            s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+bool ParseCapturePattern(const std::string& text, CapturePattern& out)
+{
+    out = CapturePattern();
+    bool found = false;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        std::string& part = found ? out.suffix : out.prefix;
+        if (text[i] != '%')
+        {
+            part += text[i];
+            continue;
+        }
+        if (i + 1 < text.size() && text[i + 1] == '%')
+        {
+            part += '%';
+            ++i;
+            continue;
+        }
+        if (found)
+            return false;   // второе поле
+
+        size_t j = i + 1;
+        if (j < text.size() && text[j] == '0')
+        {
+            out.zeroPad = true;
+            ++j;
+        }
+        while (j < text.size() && text[j] >= '0' && text[j] <= '9')
+        {
+            out.width = out.width * 10 + (text[j] - '0');
+            if (out.width > 20)
+                return false;
+            ++j;
+        }
+        for (int l = 0; l < 2 && j < text.size() && text[j] == 'l'; ++l)
+            ++j;
+        if (j >= text.size() || (text[j] != 'd' && text[j] != 'u' && text[j] != 'i'))
+            return false;
+        found = true;
+        i = j;
+    }
+    return found;
+}
+
+FrameCapture::~FrameCapture()
+{
+    Stop();
+}
+
+bool FrameCapture::Init(unsigned ringSize)
+{
+    persistent = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+    slots.resize(std::max(2u, ringSize));
+    for (Slot& s : slots)
+        glGenBuffers(1, &s.pbo);
+
+    quit = false;
+    encoder = std::thread(&FrameCapture::EncoderLoop, this);
+    initialized = true;
+    return true;
+}
+
+bool FrameCapture::StartRecording(const std::string& output, unsigned w, unsigned h, int fps)
+{
+    bool video = EndsWith(output, ".y4m");
+    CapturePattern png;
+    if (!video && !ParseCapturePattern(output, png))
+    {
+        std::cout << "Capture output must be *.y4m or a PNG pattern with one integer field "
+            "like frame_%05d.png: " << output << std::endl;
+        return false;
+    }
+
+    if (video)
+    {
+        y4m.open(output, std::ios::binary);
+        if (!y4m.is_open())
+        {
+            std::cout << "Failed to open capture file: " << output << std::endl;
+            return false;
+        }
+        y4m << "YUV4MPEG2 W" << w << " H" << h << " F" << fps << ":1 Ip A1:1 C420jpeg\n";
+    }
+
+    streamSink = video ? CaptureSink::Y4m : CaptureSink::Png;
+    pattern = png;
+    recordWidth = w;
+    recordHeight = h;
+    recordFrame = 0;
+    recording = true;
+    std::cout << "Capturing " << w << "x" << h << " to " << output
+        << (persistent ? " (persistent PBO ring)" : " (PBO ring)") << std::endl;
+    return true;
+}
+
+bool FrameCapture::StartSharedExport(const std::string& name, unsigned w, unsigned h)
+{
+    if (!shared.Create(name, w, h))
+        return false;
+
+    streamSink = CaptureSink::Shared;
+    recordWidth = w;
+    recordHeight = h;
+    recordFrame = 0;
+    recording = true;
+    return true;
+}
+
+void FrameCapture::RequestScreenshot(const std::string& filename)
+{
+    screenshot = filename;
+}
+
+void FrameCapture::EnsureCapacity(Slot& slot, size_t bytes)
+{
+    if (slot.capacity >= bytes)
+        return;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    if (persistent)
+    {
+        // storage неизменяемый — пересоздаём буфер
+        if (slot.mapped)
+        {
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glDeleteBuffers(1, &slot.pbo);
+            glGenBuffers(1, &slot.pbo);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        }
+        const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_PIXEL_PACK_BUFFER, bytes, nullptr, flags);
+        slot.mapped = (uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, flags);
+    }
+    else
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+    }
+    slot.capacity = bytes;
+}
+
+bool FrameCapture::RetireOldest(bool wait)
+{
+    if (pending == 0)
+        return false;
+
+    unsigned index = (head + (unsigned)slots.size() - pending) % slots.size();
+    Slot& slot = slots[index];
+    if (!FenceSignaled(slot.fence, 0))
+    {
+        if (!wait)
+            return false;
+        ++stalls;
+        while (!FenceSignaled(slot.fence, 100000000))
+        {
+        }
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    --pending;
+
+    Job job;
+    job.width = slot.width;
+    job.height = slot.height;
+    job.sink = slot.sink;
+    job.pngPath = slot.pngPath;
+    job.renderedNs = slot.renderedNs;
+    job.announce = slot.announce;
+    size_t bytes = (size_t)slot.width * slot.height * 4;
+
+    if (persistent)
+    {
+        job.slot = (int)index;
+        job.data = slot.mapped;
+        std::lock_guard<std::mutex> lock(mutex);
+        slot.busy = true;
+    }
+    else
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (queue.size() >= kMaxQueuedCopies)
+            {
+                ++stalls;
+                released.wait(lock, [&] { return queue.size() < kMaxQueuedCopies; });
+            }
+            if (!freeBuffers.empty())
+            {
+                job.pixels = std::move(freeBuffers.back());
+                freeBuffers.pop_back();
+            }
+        }
+        job.pixels.resize(bytes);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        const void* src = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+        if (src)
+            std::memcpy(job.pixels.data(), src, bytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    Push(std::move(job));
+    return true;
+}
+
+void FrameCapture::Push(Job&& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+void FrameCapture::Enqueue(unsigned w, unsigned h, CaptureSink sink, const std::string& pngPath, bool announce)
+{
+    // кольцо заполнено — ждём самый старый кадр
+    if (pending == slots.size())
+        RetireOldest(true);
+
+    Slot& slot = slots[head];
+    if (persistent)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (slot.busy)
+        {
+            ++stalls;
+            released.wait(lock, [&] { return !slot.busy; });
+        }
+    }
+
+    slot.width = w;
+    slot.height = h;
+    slot.sink = sink;
+    slot.pngPath = pngPath;
+    slot.renderedNs = SteadyNowNs();
+    slot.announce = announce;
+
+    EnsureCapacity(slot, (size_t)w * h * 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, (GLsizei)w, (GLsizei)h, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    head = (head + 1) % slots.size();
+    ++pending;
+}
+
+void FrameCapture::CaptureFrame(unsigned w, unsigned h)
+{
+    if (!initialized)
+        return;
+
+    sf::Clock clock;
+
+    // забираем всё, что GPU уже дописал
+    while (RetireOldest(false))
+    {
+    }
+
+    bool wantFrame = recording;
+    if (wantFrame && (w != recordWidth || h != recordHeight))
+    {
+        // размер потока фиксирован (Y4M и слоты кольца не меняют кадр на ходу)
+        ++dropped;
+        wantFrame = false;
+    }
+    if (!wantFrame && screenshot.empty())
+        return;
+
+    if (wantFrame)
+    {
+        std::string path = streamSink == CaptureSink::Png ? FormatPattern(pattern, recordFrame) : std::string();
+        Enqueue(w, h, streamSink, path, false);
+        ++recordFrame;
+    }
+    // скриншот во время записи — отдельный readback того же кадра
+    if (!screenshot.empty())
+    {
+        Enqueue(w, h, CaptureSink::Png, screenshot, true);
+        screenshot.clear();
+    }
+
+    mainThreadMs.Add(clock.getElapsedTime().asMicroseconds() / 1000.0);
+}
+
+void FrameCapture::Stop()
+{
+    if (!initialized)
+        return;
+
+    while (RetireOldest(true))
+    {
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_one();
+    if (encoder.joinable())
+        encoder.join();
+
+    for (Slot& s : slots)
+    {
+        if (s.mapped)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glDeleteBuffers(1, &s.pbo);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slots.clear();
+
+    if (y4m.is_open())
+        y4m.close();
+    shared.Close();
+    if (recording || mainThreadMs.Count() > 0)
+        std::cout << "Capture: " << Summary() << std::endl;
+
+    recording = false;
+    initialized = false;
+}
+
+std::string FrameCapture::Summary() const
+{
+    return "captured " + std::to_string(written.load()) + ", dropped " + std::to_string(dropped)
+        + ", stalls " + std::to_string(stalls) + ", main thread: " + mainThreadMs.Summary();
+}
+
+void FrameCapture::EncoderLoop()
+{
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return quit || !queue.empty(); });
+            if (queue.empty())
+                return;
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        const uint8_t* pixels = job.slot >= 0 ? job.data : job.pixels.data();
+        if (job.sink == CaptureSink::Y4m)
+            WriteY4mFrame(pixels, job.width, job.height);
+        else if (job.sink == CaptureSink::Shared)
+            shared.Publish(pixels, job.renderedNs);
+        else
+        {
+            sf::Image img({ job.width, job.height }, pixels);
+            img.flipVertically();   // GL отдаёт строки снизу вверх
+            if (!img.saveToFile(job.pngPath))
+                std::cout << "Failed to save capture: " << job.pngPath << std::endl;
+            else if (job.announce)
+                std::cout << "Screenshot saved: " << job.pngPath << std::endl;
+        }
+        ++written;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (job.slot >= 0)
+                slots[job.slot].busy = false;
+            else
+                freeBuffers.push_back(std::move(job.pixels));
+        }
+        released.notify_all();
+    }
+}
+
+void FrameCapture::WriteY4mFrame(const uint8_t* rgba, unsigned w, unsigned h)
+{
+    // BT.601, полный диапазон (C420jpeg): Y на пиксель, Cb/Cr на блок 2x2
+    unsigned cw = (w + 1) / 2;
+    unsigned ch = (h + 1) / 2;
+    yuv.resize((size_t)w * h + 2 * (size_t)cw * ch);
+    uint8_t* Y = yuv.data();
+    uint8_t* U = Y + (size_t)w * h;
+    uint8_t* V = U + (size_t)cw * ch;
+
+    auto pixel = [&](unsigned x, unsigned y) -> const uint8_t*
+        {
+            // строки в буфере снизу вверх
+            return rgba + ((size_t)(h - 1 - y) * w + x) * 4;
+        };
+
+    for (unsigned y = 0; y < h; ++y)
+    {
+        for (unsigned x = 0; x < w; ++x)
+        {
+            const uint8_t* p = pixel(x, y);
+            Y[(size_t)y * w + x] = (uint8_t)((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+        }
+    }
+
+    for (unsigned cy = 0; cy < ch; ++cy)
+    {
+        for (unsigned cx = 0; cx < cw; ++cx)
+        {
+            int r = 0, g = 0, b = 0;
+            for (unsigned k = 0; k < 4; ++k)
+            {
+                unsigned x = std::min(cx * 2 + (k & 1), w - 1);
+                unsigned y = std::min(cy * 2 + (k >> 1), h - 1);
+                const uint8_t* p = pixel(x, y);
+                r += p[0];
+                g += p[1];
+                b += p[2];
+            }
+            // суммы по 4 пикселям: делим на 4 вместе с >> 8
+            int cb = (-43 * r - 85 * g + 128 * b + 512) >> 10;
+            int cr = (128 * r - 107 * g - 21 * b + 512) >> 10;
+            U[(size_t)cy * cw + cx] = (uint8_t)std::clamp(cb + 128, 0, 255);
+            V[(size_t)cy * cw + cx] = (uint8_t)std::clamp(cr + 128, 0, 255);
+        }
+    }
+
+    y4m << "FRAME\n";
+    y4m.write((const char*)yuv.data(), (std::streamsize)yuv.size());
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "FrameStats.h"
+#include "SharedFrameRing.h"
+
+#include <GL/glew.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// =======================================================
+// АСИНХРОННЫЙ ЗАХВАТ КАДРОВ (скриншоты и видео)
+// =======================================================
+//
+// glReadPixels пишет в кольцо pixel pack buffer'ов и ставит fence;
+// буфер забирается через несколько кадров, когда GPU его заполнил,
+// поэтому основной поток не ждёт конвейер. Кодирование (PNG или
+// сырое Y4M 4:2:0) — в отдельном потоке.
+//
+// При GL 4.4 / ARB_buffer_storage буферы отображены постоянно и
+// кодировщик читает их напрямую; иначе кадр копируется после
+// glMapBufferRange в буфер из пула.
+//
+// Поток кадров идёт в один приёмник: Y4M, PNG по шаблону или
+// кольцо в разделяемой памяти для внешнего процесса.
+
+enum class CaptureSink
+{
+    Png,
+    Y4m,
+    Shared,
+};
+
+// разобранный шаблон PNG: номер кадра подставляется между prefix и suffix
+struct CapturePattern
+{
+    std::string prefix;
+    std::string suffix;
+    int width = 0;          // минимальная ширина номера
+    bool zeroPad = false;   // дополнять нулями (%05d), иначе пробелами
+};
+
+// шаблон должен содержать ровно одно целое поле %d / %u / %i с необязательными
+// флагом 0 и шириной (frame_%05d.png); %% — сам символ %
+bool ParseCapturePattern(const std::string& text, CapturePattern& out);
+
+class FrameCapture
+{
+public:
+    FrameCapture() = default;
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // нужен текущий GL-контекст; ringSize — глубина кольца PBO
+    bool Init(unsigned ringSize = 4);
+
+    // каждый кадр: *.y4m — видео, иначе шаблон PNG с номером кадра
+    // (например frames/frame_%05d.png, см. ParseCapturePattern); размер кадра фиксирован
+    bool StartRecording(const std::string& output, unsigned w, unsigned h, int fps = 60);
+    // каждый кадр в SharedFrameRing с именем name
+    bool StartSharedExport(const std::string& name, unsigned w, unsigned h);
+    // одиночный PNG со следующего CaptureFrame
+    void RequestScreenshot(const std::string& filename);
+
+    bool IsRecording() const { return recording; }
+
+    // после рендера кадра, до display(): читает текущий read framebuffer
+    void CaptureFrame(unsigned w, unsigned h);
+
+    // дожидается всех кадров, закрывает файлы, освобождает GL-ресурсы
+    void Stop();
+
+    // "captured N, dropped N, stalls N, main thread: <FrameTimeStats>"
+    std::string Summary() const;
+
+private:
+    struct Slot
+    {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        size_t capacity = 0;
+        uint8_t* mapped = nullptr;      // постоянное отображение
+        bool busy = false;              // кодировщик ещё читает mapped (под mutex)
+        unsigned width = 0;
+        unsigned height = 0;
+        CaptureSink sink = CaptureSink::Png;
+        std::string pngPath;
+        int64_t renderedNs = 0;
+        bool announce = false;          // сообщить о сохранении (скриншот)
+    };
+
+    struct Job
+    {
+        int slot = -1;                  // >= 0 — данные в mapped слота
+        const uint8_t* data = nullptr;
+        std::vector<uint8_t> pixels;    // иначе — копия
+        unsigned width = 0;
+        unsigned height = 0;
+        CaptureSink sink = CaptureSink::Png;
+        std::string pngPath;
+        int64_t renderedNs = 0;
+        bool announce = false;
+    };
+
+    void Enqueue(unsigned w, unsigned h, CaptureSink sink, const std::string& pngPath, bool announce);
+    bool RetireOldest(bool wait);
+    void EnsureCapacity(Slot& slot, size_t bytes);
+    void Push(Job&& job);
+    void EncoderLoop();
+    void WriteY4mFrame(const uint8_t* rgba, unsigned w, unsigned h);
+
+    bool initialized = false;
+    bool persistent = false;
+    std::vector<Slot> slots;
+    unsigned head = 0;          // следующий слот для записи
+    unsigned pending = 0;       // слоты, ждущие GPU
+
+    bool recording = false;
+    CaptureSink streamSink = CaptureSink::Png;
+    CapturePattern pattern;
+    unsigned recordWidth = 0;
+    unsigned recordHeight = 0;
+    uint64_t recordFrame = 0;
+    std::string screenshot;
+
+    // --- поток кодирования ---
+    std::thread encoder;
+    std::mutex mutex;
+    std::condition_variable wake;       // есть работа / стоп
+    std::condition_variable released;   // освободился слот или буфер
+    std::deque<Job> queue;
+    std::vector<std::vector<uint8_t>> freeBuffers;
+    bool quit = false;
+
+    std::ofstream y4m;
+    std::vector<uint8_t> yuv;
+    SharedFrameWriter shared;
+
+    // --- статистика ---
+    FrameTimeStats mainThreadMs;
+    std::atomic<uint64_t> written{ 0 };
+    uint64_t dropped = 0;
+    uint64_t stalls = 0;
+};
@@ -0,0 +1,138 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+namespace
+{
+    const size_t kWorkWindow = 32;       // кадров для оценки работы
+    const double kWorkMarginMs = 0.5;    // запас к оценке работы
+
+    double ToMs(FramePacer::Clock::duration d)
+    {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+}
+
+FramePacer::FramePacer()
+{
+#ifdef _WIN32
+    // квант планировщика по умолчанию 15.6 мс — для sleep нужен 1 мс
+    timeBeginPeriod(1);
+#endif
+}
+
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::SetTargetRate(double hz)
+{
+    targetHz = std::max(0.0, hz);
+    period = targetHz > 0.0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetHz))
+        : Clock::duration::zero();
+    started = false;
+}
+
+double FramePacer::WorkEstimateMs() const
+{
+    if (recentWorkMs.empty())
+        return 0.0;
+    std::vector<double> sorted = recentWorkMs;
+    size_t k = std::min(sorted.size() - 1, sorted.size() * 9 / 10);
+    std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    return sorted[k] + kWorkMarginMs;
+}
+
+void FramePacer::SleepUntil(Clock::time_point t)
+{
+    // спим с запасом на перелёт планировщика, остаток — активно
+    for (;;)
+    {
+        Clock::time_point now = Clock::now();
+        double remainingMs = ToMs(t - now);
+        if (remainingMs <= oversleepMs + 0.2)
+            break;
+
+        auto request = std::chrono::duration<double, std::milli>(remainingMs - oversleepMs);
+        std::this_thread::sleep_for(request);
+        double actualMs = ToMs(Clock::now() - now);
+        double overMs = std::max(0.0, actualMs - request.count());
+        // перелёт растёт сразу, уменьшается плавно
+        oversleepMs = overMs > oversleepMs ? overMs : oversleepMs * 0.95 + overMs * 0.05;
+        oversleepMs = std::clamp(oversleepMs, 0.1, 4.0);
+    }
+    while (Clock::now() < t)
+        std::this_thread::yield();
+}
+
+void FramePacer::WaitForNextFrame()
+{
+    if (targetHz > 0.0)
+    {
+        Clock::time_point now = Clock::now();
+        if (!started)
+            deadline = now;
+        else
+        {
+            deadline += period;
+            // отстали больше чем на кадр — не догоняем пачкой кадров
+            if (deadline < now)
+            {
+                ++missed;
+                deadline = now;
+            }
+        }
+
+        auto work = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double, std::milli>(WorkEstimateMs()));
+        SleepUntil(deadline - work);
+    }
+
+    frameStart = Clock::now();
+    if (started)
+    {
+        double intervalMs = ToMs(frameStart - lastStart);
+        intervals.Add(intervalMs);
+        if (targetHz > 0.0)
+            errors.Add(std::fabs(intervalMs - 1000.0 / targetHz));
+    }
+    lastStart = frameStart;
+    started = true;
+}
+
+void FramePacer::EndFrame()
+{
+    double workMs = ToMs(Clock::now() - frameStart);
+    if (recentWorkMs.size() < kWorkWindow)
+        recentWorkMs.push_back(workMs);
+    else
+        recentWorkMs[recentCursor] = workMs;
+    recentCursor = (recentCursor + 1) % kWorkWindow;
+}
+
+std::string FramePacer::Summary() const
+{
+    char buf[512];
+    if (targetHz > 0.0)
+        std::snprintf(buf, sizeof(buf), "Pacing %.1f Hz: interval %s\n  |error| %s, missed %zu",
+            targetHz, intervals.Summary().c_str(), errors.Summary().c_str(), missed);
+    else
+        std::snprintf(buf, sizeof(buf), "Uncapped: %.1f fps, interval %s",
+            intervals.Mean() > 0.0 ? 1000.0 / intervals.Mean() : 0.0, intervals.Summary().c_str());
+    return buf;
+}
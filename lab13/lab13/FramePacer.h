@@ -0,0 +1,62 @@
+#pragma once
+
+#include "FrameStats.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// =======================================================
+// ТЕМП КАДРОВ
+// =======================================================
+//
+// Замена window.setFramerateLimit: ожидание до срока кадра —
+// грубый sleep, пока до срока далеко, затем активное ожидание.
+// Срок сдвигается назад на оценку работы кадра (p90 последних кадров),
+// чтобы ввод опрашивался как можно позже перед показом.
+// targetHz == 0 — без ограничения (замер пропускной способности).
+
+class FramePacer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    FramePacer();
+    ~FramePacer();
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    void SetTargetRate(double hz);
+    double TargetRate() const { return targetHz; }
+
+    // в начале кадра, до опроса ввода
+    void WaitForNextFrame();
+    // после window.display()
+    void EndFrame();
+    // после простоя: пауза не считается интервалом кадра
+    void Restart() { started = false; }
+
+    // интервалы между кадрами и отклонение от целевого
+    std::string Summary() const;
+
+private:
+    void SleepUntil(Clock::time_point t);
+    double WorkEstimateMs() const;
+
+    double targetHz = 0.0;
+    Clock::duration period{};
+
+    Clock::time_point deadline{};      // срок показа текущего кадра
+    Clock::time_point frameStart{};
+    Clock::time_point lastStart{};
+    bool started = false;
+
+    std::vector<double> recentWorkMs;  // кольцо последних кадров
+    size_t recentCursor = 0;
+    double oversleepMs = 0.5;          // типичный перелёт sleep, адаптивно
+
+    FrameTimeStats intervals;
+    FrameTimeStats errors;             // |интервал - период|
+    size_t missed = 0;                 // кадры позже срока
+};
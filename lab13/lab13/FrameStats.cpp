@@ -0,0 +1,40 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+double FrameTimeStats::Mean() const
+{
+    if (samples.empty()) return 0.0;
+    return std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+double FrameTimeStats::Min() const
+{
+    return samples.empty() ? 0.0 : *std::min_element(samples.begin(), samples.end());
+}
+
+double FrameTimeStats::Max() const
+{
+    return samples.empty() ? 0.0 : *std::max_element(samples.begin(), samples.end());
+}
+
+double FrameTimeStats::Percentile(double p) const
+{
+    if (samples.empty()) return 0.0;
+    std::vector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+    rank = std::clamp<size_t>(rank, 1, sorted.size());
+    return sorted[rank - 1];
+}
+
+std::string FrameTimeStats::Summary() const
+{
+    char buf[160];
+    std::snprintf(buf, sizeof(buf), "n %zu, mean %.2f, p50 %.2f, p95 %.2f, p99 %.2f, max %.2f ms",
+        Count(), Mean(), Percentile(50), Percentile(95), Percentile(99), Max());
+    return buf;
+}
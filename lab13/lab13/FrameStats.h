@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// накопитель времён кадров (мс) со сводкой по перцентилям
+class FrameTimeStats
+{
+public:
+    void Add(double ms) { samples.push_back(ms); }
+    void Clear() { samples.clear(); }
+
+    size_t Count() const { return samples.size(); }
+    double Mean() const;
+    double Min() const;
+    double Max() const;
+    // p в [0, 100], ближайший ранг
+    double Percentile(double p) const;
+
+    // "n 600, mean 4.10, p50 4.02, p95 5.31, p99 6.80, max 9.12 ms"
+    std::string Summary() const;
+
+private:
+    std::vector<double> samples;
+};
@@ -0,0 +1,129 @@
+#include "FramesInFlight.h"
+
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <cstdio>
+
+bool FramesInFlight::Init(unsigned count)
+{
+    slots.resize(std::max(1u, count));
+    // метки времени — GL 3.3 / ARB_timer_query
+    timestamps = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+    for (Slot& s : slots)
+        if (timestamps)
+            glGenQueries(2, s.stamps);
+    current = 0;
+    frameIndex = 0;
+    return true;
+}
+
+void FramesInFlight::Destroy()
+{
+    for (Slot& s : slots)
+    {
+        if (s.fence)
+            glDeleteSync(s.fence);
+        if (timestamps)
+            glDeleteQueries(2, s.stamps);
+    }
+    slots.clear();
+}
+
+FramesInFlight::FrameRecord* FramesInFlight::Record(int64_t frame)
+{
+    for (FrameRecord& r : records)
+        if (r.frame == frame)
+            return &r;
+    return nullptr;
+}
+
+unsigned FramesInFlight::BeginFrame()
+{
+    Slot& slot = slots[current];
+
+    if (slot.fence)
+    {
+        sf::Clock clock;
+        GLenum r = glClientWaitSync(slot.fence, 0, 0);
+        while (r != GL_ALREADY_SIGNALED && r != GL_CONDITION_SATISFIED && r != GL_WAIT_FAILED)
+            r = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        waitMs.Add(clock.getElapsedTime().asMicroseconds() / 1000.0);
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+
+    // кадр слота завершён — его метки готовы
+    if (timestamps && slot.frame >= 0)
+    {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(slot.stamps[0], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(slot.stamps[1], GL_QUERY_RESULT, &end);
+        if (FrameRecord* rec = Record(slot.frame))
+        {
+            rec->gpuBegin = (int64_t)begin;
+            rec->gpuEnd = (int64_t)end;
+        }
+        slot.frame = -1;
+        ResolveOverlaps();
+    }
+
+    if (timestamps)
+    {
+        glQueryCounter(slot.stamps[0], GL_TIMESTAMP);
+        FrameRecord rec;
+        rec.frame = frameIndex;
+        records.push_back(rec);
+        slot.frame = frameIndex;
+    }
+    return current;
+}
+
+void FramesInFlight::EndFrame()
+{
+    Slot& slot = slots[current];
+    if (timestamps)
+    {
+        glQueryCounter(slot.stamps[1], GL_TIMESTAMP);
+        GLint64 now = 0;
+        glGetInteger64v(GL_TIMESTAMP, &now);
+        if (FrameRecord* rec = Record(frameIndex))
+            rec->cpuSubmit = now;
+        ResolveOverlaps();
+    }
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    current = (current + 1) % slots.size();
+    ++frameIndex;
+}
+
+void FramesInFlight::ResolveOverlaps()
+{
+    // кадр k считается, когда известны его интервал GPU и отправка кадра k + 1
+    while (records.size() >= 2)
+    {
+        const FrameRecord& cur = records[0];
+        const FrameRecord& next = records[1];
+        if (cur.gpuEnd < 0 || cur.cpuSubmit < 0 || next.cpuSubmit < 0)
+            break;
+
+        double gpu = (cur.gpuEnd - cur.gpuBegin) / 1e6;
+        int64_t from = std::max(cur.gpuBegin, cur.cpuSubmit);
+        int64_t to = std::min(cur.gpuEnd, next.cpuSubmit);
+        double overlap = to > from ? (to - from) / 1e6 : 0.0;
+
+        gpuMs.Add(gpu);
+        gpuTotalMs += gpu;
+        overlapTotalMs += overlap;
+        records.pop_front();
+    }
+}
+
+std::string FramesInFlight::Summary() const
+{
+    char buf[512];
+    std::snprintf(buf, sizeof(buf), "%zu frame(s) in flight: fence wait %s\n  GPU %s\n  overlap with next frame's CPU work: %.0f%% of GPU time",
+        slots.size(), waitMs.Summary().c_str(), gpuMs.Summary().c_str(),
+        gpuTotalMs > 0.0 ? 100.0 * overlapTotalMs / gpuTotalMs : 0.0);
+    return buf;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "FrameStats.h"
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// =======================================================
+// КАДРЫ В ПОЛЁТЕ
+// =======================================================
+//
+// N слотов, у каждого — fence последнего кадра, отправленного в этом
+// слоте. BeginFrame ждёт fence слота (CPU ушёл на N кадров вперёд),
+// после чего диапазоны буферов слота можно перезаписывать.
+//
+// Профиль: метки GL_TIMESTAMP в начале и конце команд кадра дают
+// интервал работы GPU, а glGetInteger64v(GL_TIMESTAMP) — момент
+// отправки кадра по тем же часам. Перекрытие — часть работы GPU над
+// кадром k, пришедшаяся на подготовку CPU кадра k + 1.
+
+class FramesInFlight
+{
+public:
+    bool Init(unsigned count);
+    void Destroy();
+
+    unsigned Count() const { return (unsigned)slots.size(); }
+
+    // номер слота для кадра; ждёт, пока GPU освободит его ресурсы
+    unsigned BeginFrame();
+    // после команд кадра, до display()
+    void EndFrame();
+
+    // "3 frames in flight: fence wait .., GPU .., overlap 71% of GPU time"
+    std::string Summary() const;
+
+private:
+    struct Slot
+    {
+        GLsync fence = nullptr;
+        GLuint stamps[2] = { 0, 0 };   // начало и конец команд кадра
+        int64_t frame = -1;            // кадр, чьи метки ждут чтения
+    };
+
+    struct FrameRecord
+    {
+        int64_t frame = 0;
+        int64_t cpuSubmit = -1;        // нс по часам GPU, -1 — ещё нет
+        int64_t gpuBegin = -1;
+        int64_t gpuEnd = -1;
+    };
+
+    FrameRecord* Record(int64_t frame);
+    void ResolveOverlaps();
+
+    std::vector<Slot> slots;
+    unsigned current = 0;
+    int64_t frameIndex = 0;
+    bool timestamps = false;
+
+    std::deque<FrameRecord> records;
+
+    FrameTimeStats waitMs;
+    FrameTimeStats gpuMs;
+    double gpuTotalMs = 0.0;
+    double overlapTotalMs = 0.0;
+};
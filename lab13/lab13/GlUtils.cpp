@@ -0,0 +1,227 @@
+#include "GlUtils.h"
+#include "Assets.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+void ShaderLog(GLuint shader)
+{
+    GLint infologLen = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infologLen);
+    if (infologLen > 1)
+    {
+        std::vector<char> infoLog(infologLen);
+        GLsizei charsWritten = 0;
+        glGetShaderInfoLog(shader, infologLen, &charsWritten, infoLog.data());
+        std::cout << "Shader log:\n" << infoLog.data() << std::endl;
+    }
+}
+
+void ProgramLog(GLuint prog)
+{
+    GLint infologLen = 0;
+    glGetProgramiv(prog, GL_INFO_LOG_LENGTH, &infologLen);
+    if (infologLen > 1)
+    {
+        std::vector<char> infoLog(infologLen);
+        GLsizei charsWritten = 0;
+        glGetProgramInfoLog(prog, infologLen, &charsWritten, infoLog.data());
+        std::cout << "Program log:\n" << infoLog.data() << std::endl;
+    }
+}
+
+GLuint CompileShader(GLenum type, const char* src)
+{
+    GLuint sh = glCreateShader(type);
+    glShaderSource(sh, 1, &src, nullptr);
+    glCompileShader(sh);
+    ShaderLog(sh);
+    return sh;
+}
+
+GLuint LinkProgram(GLuint vert, GLuint frag)
+{
+    GLuint prog = glCreateProgram();
+    glAttachShader(prog, vert);
+    glAttachShader(prog, frag);
+    glLinkProgram(prog);
+    GLint success = 0;
+    glGetProgramiv(prog, GL_LINK_STATUS, &success);
+    if (!success)
+        ProgramLog(prog);
+    return prog;
+}
+
+GLuint LinkComputeProgram(GLuint comp)
+{
+    GLuint prog = glCreateProgram();
+    glAttachShader(prog, comp);
+    glLinkProgram(prog);
+    GLint success = 0;
+    glGetProgramiv(prog, GL_LINK_STATUS, &success);
+    if (!success)
+        ProgramLog(prog);
+    return prog;
+}
+
+GLuint CreateTextureFromImage(const sf::Image& img)
+{
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
+        img.getSize().x, img.getSize().y,
+        0, GL_RGBA, GL_UNSIGNED_BYTE, img.getPixelsPtr());
+
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return tex;
+}
+
+GLuint LoadTextureFromFile(const std::string& filename)
+{
+    sf::Image img;
+    if (!LoadTextureImage(filename, img))
+        return 0;
+    return CreateTextureFromImage(img);
+}
+
+uint32_t PackSnorm1010102(float x, float y, float z, float w)
+{
+    auto snorm = [](float v, float scale, uint32_t mask)
+        {
+            int i = (int)std::lround(std::clamp(v, -1.0f, 1.0f) * scale);
+            return (uint32_t)i & mask;
+        };
+    return snorm(x, 511.0f, 0x3FF) | (snorm(y, 511.0f, 0x3FF) << 10) |
+        (snorm(z, 511.0f, 0x3FF) << 20) | (snorm(w, 1.0f, 0x3) << 30);
+}
+
+Mesh CreateMesh(const MeshData& data)
+{
+    Mesh m;
+    m.indexCount = static_cast<GLsizei>(data.indices.size());
+
+    std::vector<PackedVertex> vertices(data.VertexCount());
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        PackedVertex& v = vertices[i];
+        v.position[0] = data.positions[i].x;
+        v.position[1] = data.positions[i].y;
+        v.position[2] = data.positions[i].z;
+        v.texcoord[0] = data.texcoords[i * 2];
+        v.texcoord[1] = data.texcoords[i * 2 + 1];
+        const Vec3& n = data.normals[i];
+        const Vec4& t = data.tangents[i];
+        v.normal = PackSnorm1010102(n.x, n.y, n.z, 0.0f);
+        v.tangent = PackSnorm1010102(t.x, t.y, t.z, t.w);
+        m.boundingRadius = std::max(m.boundingRadius, Length(data.positions[i]));
+    }
+
+    glGenVertexArrays(1, &m.VAO);
+    glGenBuffers(1, &m.VBO);
+    glGenBuffers(1, &m.EBO);
+
+    glBindVertexArray(m.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m.VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(PackedVertex), vertices.data(), GL_STATIC_DRAW);
+
+    const GLsizei stride = sizeof(PackedVertex);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, texcoord));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(7, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(PackedVertex, normal));
+    glEnableVertexAttribArray(7);
+    glVertexAttribPointer(8, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(PackedVertex, tangent));
+    glEnableVertexAttribArray(8);
+
+    // индексы: 16 бит, если хватает
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m.EBO);
+    if (vertices.size() <= 0xFFFF)
+    {
+        std::vector<uint16_t> indices(data.indices.begin(), data.indices.end());
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+        m.indexType = GL_UNSIGNED_SHORT;
+    }
+    else
+    {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.indices.size() * sizeof(uint32_t), data.indices.data(), GL_STATIC_DRAW);
+        m.indexType = GL_UNSIGNED_INT;
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    return m;
+}
+
+void DestroyMesh(Mesh& mesh)
+{
+    glDeleteBuffers(1, &mesh.VBO);
+    glDeleteBuffers(1, &mesh.EBO);
+    glDeleteVertexArrays(1, &mesh.VAO);
+    mesh = Mesh();
+}
+
+RenderTarget CreateRenderTarget(unsigned w, unsigned h)
+{
+    RenderTarget rt;
+    rt.width = w;
+    rt.height = h;
+
+    glGenTextures(1, &rt.color);
+    glBindTexture(GL_TEXTURE_2D, rt.color);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &rt.depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, rt.depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &rt.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, rt.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, rt.color, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rt.depth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Render target is incomplete: " << w << "x" << h << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return rt;
+}
+
+void DestroyRenderTarget(RenderTarget& rt)
+{
+    glDeleteFramebuffers(1, &rt.fbo);
+    glDeleteRenderbuffers(1, &rt.depth);
+    glDeleteTextures(1, &rt.color);
+    rt = RenderTarget();
+}
+
+sf::Image ReadRenderTarget(const RenderTarget& rt)
+{
+    std::vector<std::uint8_t> pixels((size_t)rt.width * rt.height * 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, rt.fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, rt.width, rt.height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    sf::Image img({ rt.width, rt.height }, pixels.data());
+    img.flipVertically();
+    return img;
+}
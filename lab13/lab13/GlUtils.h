@@ -0,0 +1,64 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <SFML/Graphics/Image.hpp>
+
+#include "MeshData.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+void ShaderLog(GLuint shader);
+void ProgramLog(GLuint prog);
+GLuint CompileShader(GLenum type, const char* src);
+GLuint LinkProgram(GLuint vert, GLuint frag);
+// compute-программа (GL 4.3) из одного шейдера
+GLuint LinkComputeProgram(GLuint comp);
+
+GLuint CreateTextureFromImage(const sf::Image& img);
+GLuint LoadTextureFromFile(const std::string& filename);
+
+struct Mesh
+{
+    GLuint VAO = 0;
+    GLuint VBO = 0;
+    GLuint EBO = 0;
+    GLsizei indexCount = 0;
+    GLenum indexType = GL_UNSIGNED_INT;   // GL_UNSIGNED_SHORT, если вершин < 65536
+    float boundingRadius = 0.0f;          // от начала координат модели
+};
+
+// вершина на GPU, 28 байт вместо 56 в float:
+// location 0 — позиция, 1 — UV, 7 — нормаль, 8 — касательная (w — знак битангенса);
+// нормаль и касательная в GL_INT_2_10_10_10_REV (snorm)
+struct PackedVertex
+{
+    float position[3];
+    float texcoord[2];
+    uint32_t normal;
+    uint32_t tangent;
+};
+
+// snorm 10:10:10:2 для GL_INT_2_10_10_10_REV
+uint32_t PackSnorm1010102(float x, float y, float z, float w);
+
+// меш из LoadOBJ (вершины + индексы)
+Mesh CreateMesh(const MeshData& data);
+void DestroyMesh(Mesh& mesh);
+
+// offscreen-цель: цвет RGBA8 + глубина (headless-рендер, захват кадров)
+struct RenderTarget
+{
+    GLuint fbo = 0;
+    GLuint color = 0;
+    GLuint depth = 0;
+    unsigned width = 0;
+    unsigned height = 0;
+};
+
+RenderTarget CreateRenderTarget(unsigned w, unsigned h);
+void DestroyRenderTarget(RenderTarget& rt);
+
+// содержимое цели в sf::Image (строки сверху вниз, как на экране)
+sf::Image ReadRenderTarget(const RenderTarget& rt);
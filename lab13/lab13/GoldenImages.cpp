@@ -0,0 +1,229 @@
+#include "GoldenImages.h"
+
+#include "Assets.h"
+#include "HeadlessRenderer.h"
+#include "Scene.h"
+
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    const unsigned kGoldenWidth = 480;
+    const unsigned kGoldenHeight = 360;
+
+    const double kMinPsnr = 32.0;           // дБ
+    const double kMaxBadPixelRatio = 0.005; // 0.5% пикселей
+
+    const int kWarmupFrames = 2;
+    const int kTimedFrames = 10;
+
+    struct GoldenScene
+    {
+        const char* name;
+        unsigned seed;
+        float time;             // секунды симуляции от старта
+        Camera camera;
+        float glBudgetMs;       // медиана времени кадра, GL
+        float softBudgetMs;     // медиана времени кадра, CPU-бэкенд
+        int maxDrawCalls;
+    };
+
+    Camera MakeCamera(float x, float y, float z, float yaw, float pitch)
+    {
+        Camera c;
+        c.pos = Vec3(x, y, z);
+        c.yaw = yaw;
+        c.pitch = pitch;
+        return c;
+    }
+
+    std::vector<GoldenScene> GoldenScenes()
+    {
+        // все сцены — один инстансный проход без колец, следов и звёзд:
+        // и GL, и CPU-бэкенд рисуют планеты одним вызовом
+        return {
+            { "default_view",    1, 0.0f,  Camera(),                                     8.0f, 60.0f, 1 },
+            { "system_overview", 2, 20.0f, MakeCamera(0.0f, 70.0f, 70.0f, -90.0f, -45.0f), 8.0f, 60.0f, 1 },
+            { "dense_ring",      3, 7.5f,  MakeCamera(-30.0f, 0.5f, 2.0f, 0.0f, 0.0f),     8.0f, 60.0f, 1 },
+            { "near_sun",        4, 3.0f,  MakeCamera(0.0f, 1.0f, 6.5f, -90.0f, -5.0f),    8.0f, 60.0f, 1 },
+        };
+    }
+
+    double Median(std::vector<double> v)
+    {
+        std::sort(v.begin(), v.end());
+        return v.empty() ? 0.0 : v[v.size() / 2];
+    }
+
+    // кадр сцены: картинка, счётчики и медиана времени кадра
+    struct FrameResult
+    {
+        sf::Image image;
+        RenderStats stats;
+        double frameMs = 0.0;
+    };
+
+    FrameResult RenderScene(const GoldenScene& scene, HeadlessRenderer& headless)
+    {
+        std::vector<Planet> planets = CreatePlanets(kDefaultPlanetCount, scene.seed);
+        UpdatePlanets(planets, scene.time);
+
+        Mat4 view = scene.camera.View();
+        Mat4 proj = MakeProjection(kGoldenWidth, kGoldenHeight);
+
+        FrameResult result;
+        std::vector<double> times;
+        for (int i = 0; i < kWarmupFrames + kTimedFrames; ++i)
+        {
+            sf::Clock clock;
+            result.stats = headless.Render(planets, view, proj);
+            double ms = clock.getElapsedTime().asMicroseconds() / 1000.0;
+            if (i >= kWarmupFrames)
+                times.push_back(ms);
+        }
+        result.frameMs = Median(times);
+        result.image = headless.ReadImage();
+        return result;
+    }
+}
+
+ImageDiff CompareImages(const sf::Image& a, const sf::Image& b)
+{
+    ImageDiff diff;
+    if (a.getSize() != b.getSize())
+    {
+        diff.sizeMismatch = true;
+        return diff;
+    }
+
+    const std::uint8_t* pa = a.getPixelsPtr();
+    const std::uint8_t* pb = b.getPixelsPtr();
+    size_t count = (size_t)a.getSize().x * a.getSize().y;
+    if (count == 0)
+    {
+        diff.psnr = std::numeric_limits<double>::infinity();
+        diff.badPixelRatio = 0.0;
+        return diff;
+    }
+
+    double squared = 0.0;
+    size_t bad = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        int worst = 0;
+        for (int ch = 0; ch < 3; ++ch)
+        {
+            int d = (int)pa[i * 4 + ch] - (int)pb[i * 4 + ch];
+            squared += (double)d * d;
+            worst = std::max(worst, std::abs(d));
+        }
+        if (worst > kBadPixelDelta)
+            ++bad;
+    }
+
+    double mse = squared / (count * 3.0);
+    diff.psnr = mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse)
+        : std::numeric_limits<double>::infinity();
+    diff.badPixelRatio = (double)bad / count;
+    return diff;
+}
+
+int RunGoldenChecks(const GoldenOptions& opt)
+{
+    ThreadPool pool(opt.threads);
+    MeshData model;
+    if (!LoadOBJ("model.obj", model, pool))
+        return 1;
+
+    sf::Image texImage;
+    if (!LoadTextureImage("model_diffuse.png", texImage))
+        return 1;
+
+    HeadlessRenderer headless;
+    if (!headless.Init(opt.software, pool, kGoldenWidth, kGoldenHeight, model, texImage))
+        return 1;
+
+    std::error_code ec;
+    std::filesystem::create_directories(opt.directory, ec);
+
+    std::cout << "Golden checks (" << (opt.software ? "software" : "OpenGL") << ", "
+        << kGoldenWidth << "x" << kGoldenHeight << ")"
+        << (opt.update ? ", updating references" : "") << "\n";
+
+    int failures = 0;
+    for (const GoldenScene& scene : GoldenScenes())
+    {
+        FrameResult frame = RenderScene(scene, headless);
+        std::string refPath = opt.directory + "/" + scene.name + ".png";
+        std::string actualPath = opt.directory + "/" + scene.name + ".actual.png";
+
+        bool ok = true;
+        char line[256];
+
+        // --- изображение ---
+        if (opt.update)
+        {
+            if (!frame.image.saveToFile(refPath))
+            {
+                std::cout << "Failed to save reference: " << refPath << std::endl;
+                ok = false;
+            }
+            std::snprintf(line, sizeof(line), "%-16s reference written", scene.name);
+        }
+        else
+        {
+            sf::Image reference;
+            if (!std::filesystem::exists(refPath) || !reference.loadFromFile(refPath))
+            {
+                std::snprintf(line, sizeof(line), "%-16s missing reference %s (run with --golden-update)",
+                    scene.name, refPath.c_str());
+                ok = false;
+            }
+            else
+            {
+                ImageDiff diff = CompareImages(frame.image, reference);
+                bool imageOk = !diff.sizeMismatch && diff.psnr >= kMinPsnr &&
+                    diff.badPixelRatio <= kMaxBadPixelRatio;
+                if (diff.sizeMismatch)
+                    std::snprintf(line, sizeof(line), "%-16s size mismatch with reference", scene.name);
+                else
+                    std::snprintf(line, sizeof(line), "%-16s PSNR %6.2f dB (min %.0f), bad pixels %.3f%% (max %.1f%%)",
+                        scene.name, diff.psnr, kMinPsnr, diff.badPixelRatio * 100.0, kMaxBadPixelRatio * 100.0);
+                if (!imageOk)
+                {
+                    ok = false;
+                    (void)frame.image.saveToFile(actualPath);
+                }
+            }
+        }
+        std::cout << "  " << line << "\n";
+
+        // --- бюджеты ---
+        double budgetMs = (opt.software ? scene.softBudgetMs : scene.glBudgetMs) * opt.budgetScale;
+        bool timeOk = frame.frameMs <= budgetMs;
+        bool drawsOk = frame.stats.drawCalls <= scene.maxDrawCalls;
+        std::snprintf(line, sizeof(line), "%-16s frame %.2f ms (budget %.2f)%s, draw calls %d (budget %d)%s",
+            "", frame.frameMs, budgetMs, timeOk ? "" : " OVER",
+            frame.stats.drawCalls, scene.maxDrawCalls, drawsOk ? "" : " OVER");
+        std::cout << "  " << line << "\n";
+
+        // при обновлении эталонов бюджеты только печатаются
+        if (!opt.update)
+            ok = ok && timeOk && drawsOk;
+        std::cout << "  " << scene.name << ": " << (ok ? "PASS" : "FAIL") << "\n";
+        if (!ok)
+            ++failures;
+    }
+
+    std::cout << (failures == 0 ? "All golden checks passed" : "Golden checks FAILED: ")
+        << (failures == 0 ? "" : std::to_string(failures) + " scene(s)") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <SFML/Graphics/Image.hpp>
+
+#include <string>
+
+// =======================================================
+// ЭТАЛОННЫЕ КАДРЫ И БЮДЖЕТЫ (headless-проверка регрессий)
+// =======================================================
+//
+// Фиксированные сцены (seed + время + камера) рендерятся без окна,
+// сравниваются с картинками из каталога эталонов по PSNR и доле
+// сильно отличающихся пикселей, а время кадра и число draw call
+// проверяются по бюджетам сцены. Код возврата != 0 при любой ошибке.
+
+struct GoldenOptions
+{
+    std::string directory = "golden";
+    bool update = false;          // перезаписать эталоны текущим результатом
+    bool software = false;        // CPU-бэкенд вместо GL
+    unsigned threads = 0;         // потоки CPU-бэкенда
+    float budgetScale = 1.0f;     // множитель бюджетов времени (медленные машины)
+};
+
+struct ImageDiff
+{
+    double psnr = 0.0;            // дБ по RGB, бесконечность для одинаковых
+    double badPixelRatio = 1.0;   // доля пикселей с отличием канала > kBadPixelDelta
+    bool sizeMismatch = false;
+};
+
+const int kBadPixelDelta = 32;
+
+ImageDiff CompareImages(const sf::Image& a, const sf::Image& b);
+
+int RunGoldenChecks(const GoldenOptions& opt);
@@ -0,0 +1,205 @@
+#include "GpuPicker.h"
+
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+bool GpuPicker::Init(unsigned ringSize)
+{
+    slots.resize(std::max(2u, ringSize));
+    for (Slot& s : slots)
+    {
+        glGenBuffers(1, &s.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(uint32_t), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
+
+void GpuPicker::Destroy()
+{
+    for (Slot& s : slots)
+    {
+        if (s.fence)
+            glDeleteSync(s.fence);
+        glDeleteBuffers(1, &s.pbo);
+    }
+    slots.clear();
+    head = 0;
+    inFlight = 0;
+    requested = false;
+    Free();
+}
+
+void GpuPicker::Allocate(unsigned w, unsigned h)
+{
+    capacityWidth = w;
+    capacityHeight = h;
+
+    glGenTextures(1, &idTex);
+    glBindTexture(GL_TEXTURE_2D, idTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, w, h, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &colorRB);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorRB);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+    glGenRenderbuffers(1, &depthRB);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRB);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &sceneFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRB);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, idTex, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRB);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Picking target is incomplete: " << w << "x" << h << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void GpuPicker::Free()
+{
+    glDeleteFramebuffers(1, &sceneFBO);
+    glDeleteRenderbuffers(1, &colorRB);
+    glDeleteRenderbuffers(1, &depthRB);
+    glDeleteTextures(1, &idTex);
+    sceneFBO = colorRB = depthRB = idTex = 0;
+    capacityWidth = capacityHeight = 0;
+}
+
+void GpuPicker::RequestPick(float x, float y, unsigned w, unsigned h)
+{
+    requestX = std::clamp(x / std::max(1u, w), 0.0f, 1.0f);
+    requestY = std::clamp(y / std::max(1u, h), 0.0f, 1.0f);
+    requested = true;
+}
+
+void GpuPicker::BeginScene()
+{
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFBO);
+    glGetIntegerv(GL_VIEWPORT, targetViewport);
+
+    // номера лежат в тех же пикселях, что и viewport цели
+    unsigned w = (unsigned)std::max(1, targetViewport[0] + targetViewport[2]);
+    unsigned h = (unsigned)std::max(1, targetViewport[1] + targetViewport[3]);
+    if (w > capacityWidth || h > capacityHeight)
+    {
+        unsigned newW = std::max(w, capacityWidth);
+        unsigned newH = std::max(h, capacityHeight);
+        Free();
+        Allocate(newW, newH);
+        glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+    }
+
+    borrowed = targetFBO != 0;
+    if (borrowed)
+    {
+        idFBO = (GLuint)targetFBO;
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, idTex, 0);
+    }
+    else
+    {
+        idFBO = sceneFBO;
+        glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+    }
+}
+
+void GpuPicker::EndScene()
+{
+    if (requested)
+    {
+        sf::Clock clock;
+        requested = false;
+        ++picks;
+        if (inFlight == slots.size())
+        {
+            // GPU отстал на всё кольцо — не ждём, запрос теряется
+            ++dropped;
+        }
+        else
+        {
+            const GLint* vp = targetViewport;
+            GLint px = vp[0] + std::min((GLint)(requestX * vp[2]), vp[2] - 1);
+            GLint py = vp[1] + vp[3] - 1 - std::min((GLint)(requestY * vp[3]), vp[3] - 1);
+
+            Slot& slot = slots[head];
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, idFBO);
+            glReadBuffer(GL_COLOR_ATTACHMENT1);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            glPixelStorei(GL_PACK_ALIGNMENT, 4);
+            glReadPixels(px, py, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            glReadBuffer(GL_COLOR_ATTACHMENT0);
+            slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            slot.frame = frame;
+
+            head = (head + 1) % slots.size();
+            ++inFlight;
+        }
+        requestMs.Add(clock.getElapsedTime().asMicroseconds() / 1000.0);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, idFBO);
+    if (borrowed)
+    {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, 0, 0);
+    }
+    else
+    {
+        const GLint* vp = targetViewport;
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneFBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(vp[0], vp[1], vp[0] + vp[2], vp[1] + vp[3],
+            vp[0], vp[1], vp[0] + vp[2], vp[1] + vp[3], GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+    ++frame;
+}
+
+bool GpuPicker::Poll(uint32_t& instance, unsigned& latency)
+{
+    if (inFlight == 0)
+        return false;
+
+    // fence срабатывают по порядку: готов ли самый старый
+    Slot& slot = slots[(head + slots.size() - inFlight) % slots.size()];
+    GLenum r = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (r != GL_ALREADY_SIGNALED && r != GL_CONDITION_SATISFIED)
+        return false;
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    instance = kNoInstance;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    if (const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(uint32_t), GL_MAP_READ_BIT))
+    {
+        instance = *static_cast<const uint32_t*>(data);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    --inFlight;
+
+    latency = (unsigned)(frame - slot.frame);
+    ++resolved;
+    latencySum += latency;
+    latencyMax = std::max(latencyMax, latency);
+    return true;
+}
+
+std::string GpuPicker::Summary() const
+{
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        "%zu picks: %zu resolved, %zu dropped, latency %.1f frames (max %u), readback 1x1 R32UI, %zu PBOs, "
+        "ids attached to %s, CPU per request: ",
+        picks, resolved, dropped, resolved ? (double)latencySum / resolved : 0.0, latencyMax, slots.size(),
+        borrowed ? "scene FBO" : "own FBO (blit to window)");
+    return buf + requestMs.Summary();
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "FrameStats.h"
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// =======================================================
+// ВЫБОР ПЛАНЕТЫ ПО БУФЕРУ НОМЕРОВ (GPU, БЕЗ ОЖИДАНИЯ)
+// =======================================================
+//
+// Основной проход планет пишет вторым выходом (MRT) номер экземпляра
+// в R32UI-вложение цели (SceneRenderer::EnableIdOutput); фон —
+// kNoInstance. Если сцена рисуется в свой framebuffer (HDR, SSAO,
+// динамическое разрешение), вложение подключается к нему на время
+// кадра; если прямо в окно — сцена идёт в цель пикера (RGBA8 +
+// глубина + номера) и переносится в окно blit'ом.
+//
+// Читается только пиксель под курсором: glReadPixels 1x1 в pixel
+// pack buffer из кольца и fence. Результат забирается Poll через
+// кадр-другой, когда fence сработал, — синхронного glReadPixels и
+// ожидания конвейера нет (как у FrameCapture, но на 4 байта).
+
+class GpuPicker
+{
+public:
+    static const uint32_t kNoInstance = 0xFFFFFFFFu;
+
+    // ringSize — сколько выборов может ждать GPU одновременно
+    bool Init(unsigned ringSize = 3);
+    void Destroy();
+
+    // точка окна w x h (пиксели, y вниз); читается в ближайшем EndScene
+    void RequestPick(float x, float y, unsigned w, unsigned h);
+    // есть запрос или непрочитанный результат (кадр нужно рисовать)
+    bool Pending() const { return requested || inFlight > 0; }
+
+    // до рендера сцены: к текущему framebuffer подключается буфер номеров
+    // (к окну — своя цель), framebuffer и viewport запоминаются
+    void BeginScene();
+    // после сцены: чтение пикселя запроса в PBO, отключение вложения
+    // (или перенос своей цели в окно)
+    void EndScene();
+
+    // самый старый готовый результат; latency — кадров от EndScene
+    // запроса; false — GPU ещё не дописал (или запросов нет)
+    bool Poll(uint32_t& instance, unsigned& latency);
+
+    // "12 picks: 12 resolved, 0 dropped, latency 1.2 frames (max 2), readback 1x1 R32UI, 3 PBOs,
+    //  ids attached to scene FBO, CPU per request: <FrameTimeStats>"
+    std::string Summary() const;
+
+private:
+    struct Slot
+    {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        uint64_t frame = 0;            // кадр, в котором прочитан пиксель
+    };
+
+    void Allocate(unsigned w, unsigned h);
+    void Free();
+
+    std::vector<Slot> slots;
+    size_t head = 0;                   // следующий свободный слот
+    size_t inFlight = 0;
+    uint64_t frame = 0;
+
+    bool requested = false;
+    float requestX = 0.0f;             // доли окна, y вниз
+    float requestY = 0.0f;
+
+    // --- своя цель, когда сцена рисуется прямо в окно ---
+    GLuint sceneFBO = 0;
+    GLuint colorRB = 0;
+    GLuint depthRB = 0;
+    GLuint idTex = 0;                  // R32UI, общий для обоих режимов
+    unsigned capacityWidth = 0;
+    unsigned capacityHeight = 0;
+
+    GLint targetFBO = 0;
+    GLint targetViewport[4] = {};
+    GLuint idFBO = 0;                  // куда подключён idTex в этом кадре
+
+    // --- статистика ---
+    size_t picks = 0;
+    size_t resolved = 0;
+    size_t dropped = 0;                // кольцо занято
+    size_t latencySum = 0;
+    unsigned latencyMax = 0;
+    bool borrowed = false;             // последний кадр: вложение чужой цели
+    FrameTimeStats requestMs;
+};
@@ -0,0 +1,79 @@
+#include "GpuTimer.h"
+
+namespace
+{
+    const GLuint64 kMaxPlausibleNs = 1000000000ull;   // 1 с
+}
+
+void GpuTimer::Init(unsigned latency, bool useTimestamps)
+{
+    timestamps = useTimestamps;
+    queries.resize((latency < 2 ? 2 : latency) * (timestamps ? 2 : 1));
+    glGenQueries((GLsizei)queries.size(), queries.data());
+    head = 0;
+    pending = 0;
+    running = false;
+}
+
+void GpuTimer::Destroy()
+{
+    if (!queries.empty())
+        glDeleteQueries((GLsizei)queries.size(), queries.data());
+    queries.clear();
+}
+
+void GpuTimer::Begin()
+{
+    // все запросы заняты — кадр без замера, ждать результат не будем
+    if (queries.empty() || pending == Slots())
+        return;
+    if (timestamps)
+        glQueryCounter(queries[head * 2], GL_TIMESTAMP);
+    else
+        glBeginQuery(GL_TIME_ELAPSED, queries[head]);
+    running = true;
+}
+
+void GpuTimer::End()
+{
+    if (!running)
+        return;
+    if (timestamps)
+        glQueryCounter(queries[head * 2 + 1], GL_TIMESTAMP);
+    else
+        glEndQuery(GL_TIME_ELAPSED);
+    running = false;
+    head = (head + 1) % Slots();
+    ++pending;
+}
+
+bool GpuTimer::Poll(double& ms)
+{
+    bool got = false;
+    while (pending > 0)
+    {
+        unsigned oldest = (head + Slots() - pending) % Slots();
+        // конец замера готов — значит, и начало тоже
+        GLuint last = timestamps ? queries[oldest * 2 + 1] : queries[oldest];
+        GLint available = 0;
+        glGetQueryObjectiv(last, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(last, GL_QUERY_RESULT, &ns);
+        if (timestamps)
+        {
+            GLuint64 start = 0;
+            glGetQueryObjectui64v(queries[oldest * 2], GL_QUERY_RESULT, &start);
+            ns = ns >= start ? ns - start : ~0ull;
+        }
+        --pending;
+        // некоторые драйверы отдают мусор в первом запросе — отбрасываем
+        if (ns > kMaxPlausibleNs)
+            continue;
+        ms = ns / 1e6;
+        got = true;
+    }
+    return got;
+}
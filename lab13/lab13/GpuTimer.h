@@ -0,0 +1,37 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+
+// =======================================================
+// ЗАМЕР ВРЕМЕНИ GPU БЕЗ ОЖИДАНИЯ (GL_TIME_ELAPSED)
+// =======================================================
+//
+// Кольцо запросов: результат кадра забирается через несколько
+// кадров, когда GL_QUERY_RESULT_AVAILABLE, поэтому CPU не ждёт GPU.
+// Запросы GL_TIME_ELAPSED не вкладываются друг в друга; таймер
+// с timestamps пишет пару GL_TIMESTAMP и может стоять внутри другого.
+
+class GpuTimer
+{
+public:
+    // latency — сколько кадров может ждать результат
+    void Init(unsigned latency = 4, bool timestamps = false);
+    void Destroy();
+
+    void Begin();
+    void End();
+
+    // самый свежий готовый результат в мс; false — готовых нет
+    bool Poll(double& ms);
+
+private:
+    unsigned Slots() const { return (unsigned)queries.size() / (timestamps ? 2 : 1); }
+
+    std::vector<GLuint> queries;
+    unsigned head = 0;      // следующий запрос для Begin
+    unsigned pending = 0;   // замеры без результата
+    bool running = false;
+    bool timestamps = false;   // по два запроса на замер: начало и конец
+};
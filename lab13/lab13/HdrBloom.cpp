@@ -0,0 +1,453 @@
+#include "HdrBloom.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace
+{
+    const unsigned kMaxLevels = 6;
+    // цепочка не меньше 64 по оси, чтобы всегда было kMaxLevels мип-уровней
+    const unsigned kMinChainSize = 64;
+
+    // группа 16x16 -> тайл 32x32 уровня 0 (64x64 кадра) -> ... -> 1x1 уровня 5;
+    // уровни, которых нет в кадре, пишутся за пределами и отбрасываются
+    const char* downsampleSrc = R"(
+        #version 430 core
+        layout(local_size_x = 16, local_size_y = 16) in;
+
+        uniform sampler2D uSource;   // HDR-кадр
+        uniform ivec2 uSize;         // используемая часть uSource
+
+        layout(rgba16f, binding = 0) writeonly uniform image2D uLevel0;
+        layout(rgba16f, binding = 1) writeonly uniform image2D uLevel1;
+        layout(rgba16f, binding = 2) writeonly uniform image2D uLevel2;
+        layout(rgba16f, binding = 3) writeonly uniform image2D uLevel3;
+        layout(rgba16f, binding = 4) writeonly uniform image2D uLevel4;
+        layout(rgba16f, binding = 5) writeonly uniform image2D uLevel5;
+
+        shared vec3 sTile[32][32];
+
+        vec3 Fetch(ivec2 p)
+        {
+            return texelFetch(uSource, min(p, uSize - 1), 0).rgb;
+        }
+
+        // среднее Кариса: яркий одиночный пиксель не раздувается в пятно
+        float KarisWeight(vec3 c)
+        {
+            return 1.0 / (1.0 + dot(c, vec3(0.2126, 0.7152, 0.0722)));
+        }
+
+        void Store(int level, ivec2 p, vec3 c)
+        {
+            vec4 v = vec4(c, 1.0);
+            if (level == 1) imageStore(uLevel1, p, v);
+            else if (level == 2) imageStore(uLevel2, p, v);
+            else if (level == 3) imageStore(uLevel3, p, v);
+            else if (level == 4) imageStore(uLevel4, p, v);
+            else imageStore(uLevel5, p, v);
+        }
+
+        // следующий уровень из sTile: size x size потоков, каждый — среднее 2x2;
+        // barrier() — только вне ветвлений (GLSL 4.30)
+        #define REDUCE(level, size)                                              \
+            {                                                                    \
+                bool inside = all(lessThan(l, ivec2(size)));                     \
+                vec3 m = vec3(0.0);                                              \
+                if (inside)                                                      \
+                {                                                                \
+                    ivec2 q = l * 2;                                             \
+                    m = 0.25 * (sTile[q.y][q.x] + sTile[q.y][q.x + 1] +          \
+                        sTile[q.y + 1][q.x] + sTile[q.y + 1][q.x + 1]);          \
+                    Store(level, (tile >> level) + l, m);                        \
+                }                                                                \
+                barrier();                                                       \
+                if (inside)                                                      \
+                    sTile[l.y][l.x] = m;                                         \
+                barrier();                                                       \
+            }
+
+        void main()
+        {
+            ivec2 l = ivec2(gl_LocalInvocationID.xy);
+            ivec2 tile = ivec2(gl_WorkGroupID.xy) * 32;   // в текселях уровня 0
+
+            // уровень 0: поток — блок 2x2, тексель — 2x2 пикселя кадра
+            for (int j = 0; j < 2; ++j)
+            {
+                for (int i = 0; i < 2; ++i)
+                {
+                    ivec2 q = l * 2 + ivec2(i, j);
+                    ivec2 s = (tile + q) * 2;
+                    vec3 a = Fetch(s);
+                    vec3 b = Fetch(s + ivec2(1, 0));
+                    vec3 c = Fetch(s + ivec2(0, 1));
+                    vec3 d = Fetch(s + ivec2(1, 1));
+                    vec4 w = vec4(KarisWeight(a), KarisWeight(b), KarisWeight(c), KarisWeight(d));
+                    vec3 m = (a * w.x + b * w.y + c * w.z + d * w.w) / (w.x + w.y + w.z + w.w);
+                    imageStore(uLevel0, tile + q, vec4(m, 1.0));
+                    sTile[q.y][q.x] = m;
+                }
+            }
+            barrier();
+
+            REDUCE(1, 16)
+            REDUCE(2, 8)
+            REDUCE(3, 4)
+            REDUCE(4, 2)
+            REDUCE(5, 1)
+        }
+    )";
+
+    // уровень uLevel += тент 3x3 по uLevel + 1, затем билинейно вверх;
+    // группа 16x16 читает 12x12 нижнего уровня (8x8 + каёмки фильтров)
+    const char* upsampleSrc = R"(
+        #version 430 core
+        layout(local_size_x = 16, local_size_y = 16) in;
+
+        uniform sampler2D uChain;
+        uniform int uLevel;
+        uniform ivec2 uSize;         // используемая часть uLevel
+        uniform ivec2 uLowerSize;    // и uLevel + 1
+
+        layout(rgba16f, binding = 0) uniform image2D uTarget;
+
+        shared vec3 sLower[12][12];
+        shared vec3 sRows[12][12];
+
+        void main()
+        {
+            ivec2 l = ivec2(gl_LocalInvocationID.xy);
+            int t = l.y * 16 + l.x;
+            ivec2 origin = ivec2(gl_WorkGroupID.xy) * 16;
+            ivec2 base = origin / 2 - 2;
+
+            if (t < 144)
+            {
+                ivec2 p = clamp(base + ivec2(t % 12, t / 12), ivec2(0), uLowerSize - 1);
+                sLower[t / 12][t % 12] = texelFetch(uChain, p, uLevel + 1).rgb;
+            }
+            barrier();
+
+            // тент [1 2 1] / 4 по строкам: все 12 строк, столбцы 1..10
+            if (t < 120)
+            {
+                int y = t / 10, x = t % 10 + 1;
+                sRows[y][x] = 0.25 * (sLower[y][x - 1] + 2.0 * sLower[y][x] + sLower[y][x + 1]);
+            }
+            barrier();
+
+            // и по столбцам: строки и столбцы 1..10
+            if (t < 100)
+            {
+                int y = t / 10 + 1, x = t % 10 + 1;
+                sLower[y][x] = 0.25 * (sRows[y - 1][x] + 2.0 * sRows[y][x] + sRows[y + 1][x]);
+            }
+            barrier();
+
+            ivec2 p = origin + l;
+            if (any(greaterThanEqual(p, uSize)))
+                return;
+
+            // центр текселя p в текселях нижнего уровня, от base
+            vec2 u = vec2(p) * 0.5 - 0.25 - vec2(base);
+            ivec2 i = ivec2(floor(u));
+            vec2 f = u - vec2(i);
+            vec3 blurred = mix(mix(sLower[i.y][i.x], sLower[i.y][i.x + 1], f.x),
+                mix(sLower[i.y + 1][i.x], sLower[i.y + 1][i.x + 1], f.x), f.y);
+            imageStore(uTarget, p, imageLoad(uTarget, p) + vec4(blurred, 0.0));
+        }
+    )";
+
+    const char* compositeVertexSrc = R"(
+        #version 330 core
+        void main()
+        {
+            vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+            gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+        }
+    )";
+
+    const char* compositeFragmentSrc = R"(
+        #version 330 core
+        out vec4 FragColor;
+
+        uniform sampler2D uScene;
+        uniform sampler2D uBloom;    // уровень 0 цепочки: сумма всех уровней
+        uniform vec4 uViewport;
+        uniform vec2 uBloomUV;       // пиксель -> uv уровня 0
+        uniform vec2 uBloomMax;      // последний полутексель используемой части
+        uniform float uBloomScale;   // 1 / число уровней
+        uniform float uStrength;
+        uniform float uExposure;
+
+        // аппроксимация ACES (Narkowicz)
+        vec3 ACESFilm(vec3 x)
+        {
+            return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+        }
+
+        void main()
+        {
+            vec2 pixel = gl_FragCoord.xy - uViewport.xy;
+            vec3 color = texelFetch(uScene, ivec2(pixel), 0).rgb;
+            if (uStrength > 0.0)
+            {
+                vec3 bloom = textureLod(uBloom, min(pixel * uBloomUV, uBloomMax), 0.0).rgb * uBloomScale;
+                color = mix(color, bloom, uStrength);
+            }
+            color = ACESFilm(color * uExposure);
+            FragColor = vec4(pow(color, vec3(1.0 / 2.2)), 1.0);
+        }
+    )";
+
+    GLuint CheckLinked(GLuint prog)
+    {
+        GLint ok = 0;
+        glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+        if (ok)
+            return prog;
+        glDeleteProgram(prog);
+        return 0;
+    }
+
+    GLuint ComputeProgram(const char* src)
+    {
+        GLuint comp = CompileShader(GL_COMPUTE_SHADER, src);
+        GLuint prog = CheckLinked(LinkComputeProgram(comp));
+        glDeleteShader(comp);
+        return prog;
+    }
+
+    unsigned LevelSize(unsigned size, unsigned level)
+    {
+        return std::max(1u, size >> (level + 1));
+    }
+
+    GLuint Groups(unsigned size, unsigned groupSize)
+    {
+        return (size + groupSize - 1) / groupSize;
+    }
+}
+
+bool HdrBloom::Init(const HdrBloomSettings& s)
+{
+    settings = s;
+    settings.bloomLevels = std::clamp(settings.bloomLevels, 1u, kMaxLevels);
+
+    GLuint vert = CompileShader(GL_VERTEX_SHADER, compositeVertexSrc);
+    GLuint frag = CompileShader(GL_FRAGMENT_SHADER, compositeFragmentSrc);
+    compositeProg = CheckLinked(LinkProgram(vert, frag));
+    glDeleteShader(vert);
+    glDeleteShader(frag);
+    if (!compositeProg)
+        return false;
+
+    glUseProgram(compositeProg);
+    glUniform1i(glGetUniformLocation(compositeProg, "uScene"), 0);
+    glUniform1i(glGetUniformLocation(compositeProg, "uBloom"), 1);
+    glUseProgram(0);
+    compositeViewportLoc = glGetUniformLocation(compositeProg, "uViewport");
+    compositeBloomUVLoc = glGetUniformLocation(compositeProg, "uBloomUV");
+    compositeBloomMaxLoc = glGetUniformLocation(compositeProg, "uBloomMax");
+    compositeBloomScaleLoc = glGetUniformLocation(compositeProg, "uBloomScale");
+    compositeStrengthLoc = glGetUniformLocation(compositeProg, "uStrength");
+    compositeExposureLoc = glGetUniformLocation(compositeProg, "uExposure");
+
+    if (settings.bloomStrength > 0.0f && GLEW_VERSION_4_3)
+    {
+        downsampleProg = ComputeProgram(downsampleSrc);
+        upsampleProg = ComputeProgram(upsampleSrc);
+        if (!downsampleProg || !upsampleProg)
+        {
+            Destroy();
+            return false;
+        }
+        downSizeLoc = glGetUniformLocation(downsampleProg, "uSize");
+        upLevelLoc = glGetUniformLocation(upsampleProg, "uLevel");
+        upSizeLoc = glGetUniformLocation(upsampleProg, "uSize");
+        upLowerSizeLoc = glGetUniformLocation(upsampleProg, "uLowerSize");
+        glUseProgram(downsampleProg);
+        glUniform1i(glGetUniformLocation(downsampleProg, "uSource"), 0);
+        glUseProgram(upsampleProg);
+        glUniform1i(glGetUniformLocation(upsampleProg, "uChain"), 0);
+        glUseProgram(0);
+    }
+    else if (settings.bloomStrength > 0.0f)
+        std::cout << "Compute shaders need OpenGL 4.3, HDR without bloom" << std::endl;
+
+    glGenVertexArrays(1, &emptyVAO);
+    timer.Init(4, true);
+    return true;
+}
+
+void HdrBloom::Destroy()
+{
+    Free();
+    timer.Destroy();
+    glDeleteProgram(downsampleProg);
+    glDeleteProgram(upsampleProg);
+    glDeleteProgram(compositeProg);
+    glDeleteVertexArrays(1, &emptyVAO);
+    downsampleProg = upsampleProg = compositeProg = 0;
+    emptyVAO = 0;
+}
+
+void HdrBloom::Allocate(unsigned w, unsigned h)
+{
+    capacityWidth = w;
+    capacityHeight = h;
+
+    glGenTextures(1, &colorTex);
+    glBindTexture(GL_TEXTURE_2D, colorTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, w, h, 0, GL_RGBA, GL_HALF_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    if (UsesCompute())
+    {
+        glGenTextures(1, &chainTex);
+        glBindTexture(GL_TEXTURE_2D, chainTex);
+        glTexStorage2D(GL_TEXTURE_2D, kMaxLevels, GL_RGBA16F,
+            std::max(w / 2, kMinChainSize), std::max(h / 2, kMinChainSize));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &depthRB);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRB);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTex, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRB);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "HDR target is incomplete: " << w << "x" << h << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void HdrBloom::Free()
+{
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &depthRB);
+    glDeleteTextures(1, &colorTex);
+    glDeleteTextures(1, &chainTex);
+    fbo = depthRB = colorTex = chainTex = 0;
+    capacityWidth = capacityHeight = 0;
+}
+
+void HdrBloom::BeginScene()
+{
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFBO);
+    glGetIntegerv(GL_VIEWPORT, targetViewport);
+
+    width = std::max(1, targetViewport[2]);
+    height = std::max(1, targetViewport[3]);
+    if (width > capacityWidth || height > capacityHeight)
+    {
+        unsigned newW = std::max(width, capacityWidth);
+        unsigned newH = std::max(height, capacityHeight);
+        Free();
+        Allocate(newW, newH);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+}
+
+void HdrBloom::Bloom()
+{
+    // вниз: все уровни одним dispatch
+    glUseProgram(downsampleProg);
+    glUniform2i(downSizeLoc, width, height);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, colorTex);
+    for (unsigned level = 0; level < kMaxLevels; ++level)
+        glBindImageTexture(level, chainTex, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    glDispatchCompute(Groups(LevelSize(width, 0), 32), Groups(LevelSize(height, 0), 32), 1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    // вверх: уровень k += размытый k + 1, от мелких к крупным
+    glUseProgram(upsampleProg);
+    glBindTexture(GL_TEXTURE_2D, chainTex);
+    for (int level = (int)levels - 2; level >= 0; --level)
+    {
+        unsigned w = LevelSize(width, level), h = LevelSize(height, level);
+        glUniform1i(upLevelLoc, level);
+        glUniform2i(upSizeLoc, w, h);
+        glUniform2i(upLowerSizeLoc, LevelSize(width, level + 1), LevelSize(height, level + 1));
+        glBindImageTexture(0, chainTex, level, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA16F);
+        glDispatchCompute(Groups(w, 16), Groups(h, 16), 1);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+    }
+
+    for (unsigned level = 0; level < kMaxLevels; ++level)
+        glBindImageTexture(level, 0, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void HdrBloom::EndScene()
+{
+    double ms = 0.0;
+    if (timer.Poll(ms))
+        gpuMs.Add(ms);
+    timer.Begin();
+
+    levels = UsesCompute() ? settings.bloomLevels : 0;
+    if (levels > 0)
+        Bloom();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+    glViewport(targetViewport[0], targetViewport[1], targetViewport[2], targetViewport[3]);
+
+    glDisable(GL_DEPTH_TEST);
+    glUseProgram(compositeProg);
+    glUniform4f(compositeViewportLoc, (float)targetViewport[0], (float)targetViewport[1],
+        (float)width, (float)height);
+    glUniform1f(compositeExposureLoc, settings.exposure);
+    glUniform1f(compositeStrengthLoc, levels > 0 ? settings.bloomStrength : 0.0f);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, colorTex);
+    if (levels > 0)
+    {
+        // пиксель кадра -> тексель уровня 0 -> uv всей текстуры цепочки
+        float chainW = (float)std::max(capacityWidth / 2, kMinChainSize);
+        float chainH = (float)std::max(capacityHeight / 2, kMinChainSize);
+        unsigned w0 = LevelSize(width, 0), h0 = LevelSize(height, 0);
+        glUniform2f(compositeBloomUVLoc, w0 / (width * chainW), h0 / (height * chainH));
+        glUniform2f(compositeBloomMaxLoc, (w0 - 0.5f) / chainW, (h0 - 0.5f) / chainH);
+        glUniform1f(compositeBloomScaleLoc, 1.0f / levels);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, chainTex);
+    }
+
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    glEnable(GL_DEPTH_TEST);
+
+    timer.End();
+}
+
+std::string HdrBloom::Summary() const
+{
+    char buf[160];
+    if (UsesCompute())
+        std::snprintf(buf, sizeof(buf), "RGBA16F %ux%u, bloom %u levels (compute), post GPU: ",
+            capacityWidth, capacityHeight, settings.bloomLevels);
+    else
+        std::snprintf(buf, sizeof(buf), "RGBA16F %ux%u, no bloom, post GPU: ",
+            capacityWidth, capacityHeight);
+    return buf + gpuMs.Summary();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "FrameStats.h"
+#include "GlUtils.h"
+#include "GpuTimer.h"
+
+#include <string>
+
+// =======================================================
+// HDR-ЦЕЛЬ, BLOOM И ТОНАЛЬНАЯ КОМПРЕССИЯ
+// =======================================================
+//
+// Сцена рисуется в RGBA16F, поэтому яркость Солнца и светящихся планет
+// не обрезается на 1. Затем (GL 4.3, compute):
+//   вниз  — один dispatch: группа 16x16 сводит свой тайл 64x64 исходного
+//           кадра во все уровни цепочки (1/2 .. 1/64) через shared-память,
+//           без проходов на каждый уровень и без синхронизации между
+//           группами; первый уровень — среднее Кариса против вспышек;
+//   вверх — на каждый уровень dispatch: тент 3x3 по нижнему уровню
+//           раздельно (строки, затем столбцы в shared-памяти), билинейно
+//           вверх и сложение с уровнем.
+// Последний проход — фрагментный: смешение с bloom, экспозиция, ACES и
+// гамма сразу в целевой framebuffer. Без compute — только он, без bloom.
+
+struct HdrBloomSettings
+{
+    float exposure = 1.0f;
+    float bloomStrength = 0.06f;   // доля размытого в итоге, 0 — без bloom
+    unsigned bloomLevels = 6;      // 1..6, уровень k — 1/2^(k+1) кадра
+    float emission = 4.0f;         // множитель свечения для SceneRenderer::EnableHdrOutput
+};
+
+class HdrBloom
+{
+public:
+    bool Init(const HdrBloomSettings& settings);
+    void Destroy();
+
+    // привязывает HDR-цель размером с текущий viewport (ёмкость только
+    // растёт); framebuffer и viewport запоминаются для EndScene
+    void BeginScene();
+    // bloom, тональная компрессия и гамма — в запомненный framebuffer;
+    // время GPU всего этого — в Summary
+    void EndScene();
+
+    bool UsesCompute() const { return downsampleProg != 0; }
+
+    // "RGBA16F 1920x1080, bloom 6 levels (compute), post GPU: <FrameTimeStats>"
+    std::string Summary() const;
+
+private:
+    void Allocate(unsigned w, unsigned h);
+    void Free();
+    void Bloom();
+
+    HdrBloomSettings settings;
+
+    GLuint fbo = 0;
+    GLuint colorTex = 0;           // RGBA16F
+    GLuint depthRB = 0;
+    GLuint chainTex = 0;           // уровни bloom — мип-уровни одной текстуры
+    unsigned capacityWidth = 0;
+    unsigned capacityHeight = 0;
+    unsigned width = 0;            // используемая часть
+    unsigned height = 0;
+    unsigned levels = 0;           // уровней в текущем кадре
+
+    GLint targetFBO = 0;
+    GLint targetViewport[4] = {};
+
+    GLuint downsampleProg = 0;
+    GLuint upsampleProg = 0;
+    GLuint compositeProg = 0;
+    GLint downSizeLoc = -1;
+    GLint upLevelLoc = -1;
+    GLint upSizeLoc = -1;
+    GLint upLowerSizeLoc = -1;
+    GLint compositeViewportLoc = -1;
+    GLint compositeBloomUVLoc = -1;
+    GLint compositeBloomMaxLoc = -1;
+    GLint compositeBloomScaleLoc = -1;
+    GLint compositeStrengthLoc = -1;
+    GLint compositeExposureLoc = -1;
+    GLuint emptyVAO = 0;
+
+    GpuTimer timer;                // timestamps: может стоять внутри замера кадра
+    FrameTimeStats gpuMs;
+};
@@ -0,0 +1,233 @@
+#include "HeadlessRenderer.h"
+
+#include <iostream>
+
+HeadlessRenderer::~HeadlessRenderer()
+{
+    if (context)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        DestroyRenderTarget(target);
+        if (hdrEnabled)
+            hdr.Destroy();
+        if (aoEnabled)
+            ao.Destroy();
+        if (starsEnabled)
+            stars.Destroy();
+        if (beltEnabled)
+            belt.Destroy();
+        if (trailsEnabled)
+            trails.Destroy();
+        renderer.Destroy();
+    }
+}
+
+bool HeadlessRenderer::Init(bool useSoftware, ThreadPool& pool, unsigned w, unsigned h,
+    const MeshData& model, const sf::Image& texImage)
+{
+    software = useSoftware;
+    width = w;
+    height = h;
+
+    if (software)
+    {
+        raster = std::make_unique<SoftwareRasterizer>(pool);
+        raster->Resize(w, h);
+        softMesh = SoftMesh::FromMeshData(model);
+        softTex = SoftTexture::FromImage(texImage);
+        return true;
+    }
+
+    // контекст без окна + offscreen framebuffer
+    sf::ContextSettings settings;
+    settings.depthBits = 24;
+    context = std::make_unique<sf::Context>(settings, sf::Vector2u(w, h));
+
+    GLenum err = glewInit();
+    if (err != GLEW_OK)
+    {
+        std::cout << "glewInit failed: "
+            << reinterpret_cast<const char*>(glewGetErrorString(err))
+            << std::endl;
+        return false;
+    }
+
+    SetupSceneGLState();
+    if (!renderer.Init(model, texImage))
+        return false;
+
+    target = CreateRenderTarget(w, h);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+    glViewport(0, 0, w, h);
+    return true;
+}
+
+RenderStats HeadlessRenderer::Render(const std::vector<Planet>& planets, const Mat4& view, const Mat4& proj,
+    float time)
+{
+    if (software)
+    {
+        models.clear();
+        for (const auto& p : planets)
+            models.push_back(PlanetModelMatrix(p));
+        raster->Clear(0.02f, 0.02f, 0.05f);
+        raster->DrawInstances(softMesh, models, view, proj, softTex);
+
+        RenderStats stats;
+        stats.drawCalls = 1;
+        stats.triangles = raster->Stats().trianglesIn;
+        return stats;
+    }
+
+    if (hdrEnabled)
+        hdr.BeginScene();
+    if (aoEnabled)
+        ao.BeginScene();
+    RenderStats stats = renderer.Render(planets, view, proj);
+    if (trailsEnabled)
+    {
+        trails.Draw(planets, view, proj, time);
+        stats.drawCalls += 1;
+    }
+    if (beltEnabled)
+        stats.drawCalls += belt.Draw(view, proj, time);
+    if (starsEnabled)
+    {
+        stars.Draw(view, proj);
+        stats.drawCalls += 1;
+    }
+    stats.drawCalls += renderer.DrawTransparent();
+    if (aoEnabled)
+        ao.EndScene(view, proj);
+    if (hdrEnabled)
+        hdr.EndScene();
+    glFinish();
+    return stats;
+}
+
+bool HeadlessRenderer::EnableLighting(unsigned lightCount)
+{
+    if (lightCount == 0)
+        return true;
+    if (software)
+    {
+        std::cout << "Lighting is not supported by the software backend, rendering unlit" << std::endl;
+        return true;
+    }
+    return renderer.EnableLighting(lightCount);
+}
+
+bool HeadlessRenderer::EnableSunShadows(const SunShadowSettings& settings)
+{
+    return software || renderer.EnableSunShadows(settings);
+}
+
+bool HeadlessRenderer::SetShadingPath(ShadingPath path)
+{
+    if (path == ShadingPath::Forward)
+        return software || renderer.SetShadingPath(path);
+    if (software)
+    {
+        std::cout << "Deferred shading is not supported by the software backend" << std::endl;
+        return true;
+    }
+    return renderer.SetShadingPath(path);
+}
+
+bool HeadlessRenderer::EnableVisibilityBuffer(bool enable)
+{
+    if (software)
+    {
+        if (enable)
+            std::cout << "Visibility buffer is not supported by the software backend" << std::endl;
+        return true;
+    }
+    return renderer.EnableVisibilityBuffer(enable);
+}
+
+bool HeadlessRenderer::EnableRings(const PlanetRingSettings& settings)
+{
+    if (software)
+    {
+        std::cout << "Planet rings are not supported by the software backend" << std::endl;
+        return true;
+    }
+    return renderer.EnableRings(settings);
+}
+
+bool HeadlessRenderer::EnableProceduralPlanets(const ProceduralPlanetSettings& settings, ThreadPool& pool)
+{
+    if (software)
+    {
+        std::cout << "Procedural planets are not supported by the software backend" << std::endl;
+        return true;
+    }
+    return renderer.EnableProceduralPlanets(settings, pool);
+}
+
+bool HeadlessRenderer::EnableHdr(const HdrBloomSettings& settings)
+{
+    if (software)
+    {
+        std::cout << "HDR is not supported by the software backend" << std::endl;
+        return true;
+    }
+    if (hdrEnabled)
+        return true;
+    hdrEnabled = hdr.Init(settings);
+    renderer.EnableHdrOutput(settings.emission);
+    return hdrEnabled;
+}
+
+bool HeadlessRenderer::EnableAmbientOcclusion(const AmbientOcclusionSettings& settings)
+{
+    if (software)
+    {
+        std::cout << "Ambient occlusion is not supported by the software backend" << std::endl;
+        return true;
+    }
+    if (!aoEnabled)
+        aoEnabled = ao.Init(settings);
+    return aoEnabled;
+}
+
+bool HeadlessRenderer::EnableStarfield(const StarfieldSettings& settings)
+{
+    if (software)
+    {
+        std::cout << "Starfield is not supported by the software backend" << std::endl;
+        return true;
+    }
+    if (!starsEnabled)
+        starsEnabled = stars.Init(settings);
+    return starsEnabled;
+}
+
+bool HeadlessRenderer::EnableAsteroidBelt(const AsteroidBeltSettings& settings)
+{
+    if (software)
+    {
+        std::cout << "Asteroid belt is not supported by the software backend" << std::endl;
+        return true;
+    }
+    if (!beltEnabled)
+        beltEnabled = belt.Init(settings);
+    return beltEnabled;
+}
+
+bool HeadlessRenderer::EnableOrbitTrails(const OrbitTrailSettings& settings)
+{
+    if (software)
+    {
+        std::cout << "Orbit trails are not supported by the software backend" << std::endl;
+        return true;
+    }
+    if (!trailsEnabled)
+        trailsEnabled = trails.Init(settings);
+    return trailsEnabled;
+}
+
+sf::Image HeadlessRenderer::ReadImage()
+{
+    return software ? raster->ToImage() : ReadRenderTarget(target);
+}
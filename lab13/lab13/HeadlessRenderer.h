@@ -0,0 +1,106 @@
+#pragma once
+
+#include "AmbientOcclusion.h"
+#include "AsteroidBelt.h"
+#include "GlUtils.h"
+#include "HdrBloom.h"
+#include "OrbitTrails.h"
+#include "SceneRendererGL.h"
+#include "SoftwareRasterizer.h"
+#include "Starfield.h"
+
+#include <SFML/Window.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// =======================================================
+// РЕНДЕР БЕЗ ОКНА: GL в offscreen framebuffer или CPU-бэкенд
+// =======================================================
+
+class HeadlessRenderer
+{
+public:
+    HeadlessRenderer() = default;
+    ~HeadlessRenderer();
+
+    HeadlessRenderer(const HeadlessRenderer&) = delete;
+    HeadlessRenderer& operator=(const HeadlessRenderer&) = delete;
+
+    // software == true — без GL-контекста вообще; CPU-бэкенд работает
+    // на пуле вызывающего, пул должен пережить рендерер
+    bool Init(bool software, ThreadPool& pool, unsigned w, unsigned h,
+        const MeshData& model, const sf::Image& texImage);
+
+    // кадр целиком; для GL дожидается завершения работы GPU (glFinish),
+    // чтобы время вызова было временем кадра; time — время симуляции
+    // (нужно поясу астероидов и следам орбит)
+    RenderStats Render(const std::vector<Planet>& planets, const Mat4& view, const Mat4& proj,
+        float time = 0.0f);
+
+    // кластерное освещение (только GL; CPU-бэкенд рисует без освещения)
+    bool EnableLighting(unsigned lightCount);
+    std::string LightingSummary() const { return renderer.LightingSummary(); }
+    bool EnableSunShadows(const SunShadowSettings& settings);
+    std::string ShadowSummary() const { return renderer.ShadowSummary(); }
+    // прямое или отложенное освещение (только GL)
+    bool SetShadingPath(ShadingPath path);
+    std::string ShadingSummary() const { return renderer.ShadingSummary(); }
+    // visibility buffer (только GL)
+    bool EnableVisibilityBuffer(bool enable);
+    std::string VisibilitySummary() const { return renderer.VisibilitySummary(); }
+    // кольца планет с OIT (только GL)
+    bool EnableRings(const PlanetRingSettings& settings);
+    std::string RingSummary() const { return renderer.RingSummary(); }
+    // процедурные планеты с LOD вместо модели (только GL)
+    bool EnableProceduralPlanets(const ProceduralPlanetSettings& settings, ThreadPool& pool);
+    std::string ProceduralSummary() const { return renderer.ProceduralSummary(); }
+    // HDR-цель, bloom и тональная компрессия после сцены (только GL)
+    bool EnableHdr(const HdrBloomSettings& settings);
+    std::string HdrSummary() const { return hdr.Summary(); }
+    // SSAO поверх сцены, до HDR (только GL)
+    bool EnableAmbientOcclusion(const AmbientOcclusionSettings& settings);
+    std::string AoSummary() const { return ao.Summary(); }
+    // звёздное небо после планет (только GL)
+    bool EnableStarfield(const StarfieldSettings& settings);
+    std::string StarSummary() const { return stars.Summary(); }
+    // пояс астероидов (только GL)
+    bool EnableAsteroidBelt(const AsteroidBeltSettings& settings);
+    std::string BeltSummary() const { return belt.Summary(); }
+    // следы орбит (только GL)
+    bool EnableOrbitTrails(const OrbitTrailSettings& settings);
+    std::string TrailSummary() const { return trails.Summary(); }
+
+    sf::Image ReadImage();
+
+    bool IsSoftware() const { return software; }
+    unsigned Width() const { return width; }
+    unsigned Height() const { return height; }
+
+private:
+    bool software = false;
+    unsigned width = 0;
+    unsigned height = 0;
+
+    // --- CPU ---
+    std::unique_ptr<SoftwareRasterizer> raster;
+    SoftMesh softMesh;
+    SoftTexture softTex;
+    std::vector<Mat4> models;
+
+    // --- GL ---
+    std::unique_ptr<sf::Context> context;
+    SceneRenderer renderer;
+    RenderTarget target;
+    bool hdrEnabled = false;
+    HdrBloom hdr;
+    bool aoEnabled = false;
+    AmbientOcclusion ao;
+    bool starsEnabled = false;
+    Starfield stars;
+    bool beltEnabled = false;
+    AsteroidBelt belt;
+    bool trailsEnabled = false;
+    OrbitTrails trails;
+};
@@ -0,0 +1,176 @@
+#include "InputReplay.h"
+
+#include <SFML/Window/Keyboard.hpp>
+
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    const float kCameraSpeed = 7.0f;       // юнитов/сек
+    const float kRotationSpeed = 50.0f;    // град/сек для стрелок
+
+    const char kMagic[4] = { 'L', '1', '3', 'R' };
+    const uint32_t kVersion = 1;
+
+    // смещение поля frameCount от начала файла
+    const std::streamoff kFrameCountOffset = 4 + 4 + 4 + 4 + 4 + 3 * 4 + 4 + 4;
+
+    template <class T>
+    void WriteRaw(std::ostream& out, const T& v)
+    {
+        out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    template <class T>
+    bool ReadRaw(std::istream& in, T& v)
+    {
+        return (bool)in.read(reinterpret_cast<char*>(&v), sizeof(T));
+    }
+}
+
+FrameInput SampleKeyboard(float dt)
+{
+    using Key = sf::Keyboard::Key;
+    struct Binding { Key key; uint16_t bit; };
+    static const Binding bindings[] = {
+        { Key::W, kKeyForward }, { Key::S, kKeyBack },
+        { Key::A, kKeyLeft }, { Key::D, kKeyRight },
+        { Key::Space, kKeyUp }, { Key::LShift, kKeyDown },
+        { Key::Left, kKeyYawLeft }, { Key::Right, kKeyYawRight },
+        { Key::Up, kKeyPitchUp }, { Key::Down, kKeyPitchDown },
+    };
+
+    FrameInput input;
+    input.dt = dt;
+    for (const Binding& b : bindings)
+        if (sf::Keyboard::isKeyPressed(b.key))
+            input.keys |= b.bit;
+    return input;
+}
+
+void ApplyCameraInput(Camera& camera, const FrameInput& input)
+{
+    Vec3 camFront = camera.Front();
+    Vec3 camRight = Normalize(Cross(camFront, kWorldUp));
+    float move = kCameraSpeed * input.dt;
+    float turn = kRotationSpeed * input.dt;
+
+    if (input.keys & kKeyForward)
+        camera.pos = camera.pos + camFront * move;
+    if (input.keys & kKeyBack)
+        camera.pos = camera.pos - camFront * move;
+    if (input.keys & kKeyLeft)
+        camera.pos = camera.pos - camRight * move;
+    if (input.keys & kKeyRight)
+        camera.pos = camera.pos + camRight * move;
+    if (input.keys & kKeyUp)
+        camera.pos = camera.pos + kWorldUp * move;
+    if (input.keys & kKeyDown)
+        camera.pos = camera.pos - kWorldUp * move;
+
+    // поворот (стрелочки)
+    if (input.keys & kKeyYawLeft)
+        camera.yaw -= turn;
+    if (input.keys & kKeyYawRight)
+        camera.yaw += turn;
+    if (input.keys & kKeyPitchUp)
+        camera.pitch += turn * 0.5f;
+    if (input.keys & kKeyPitchDown)
+        camera.pitch -= turn * 0.5f;
+
+    if (camera.pitch > 89.0f) camera.pitch = 89.0f;
+    if (camera.pitch < -89.0f) camera.pitch = -89.0f;
+}
+
+bool InputRecorder::Open(const std::string& filename, const RecordingHeader& header)
+{
+    file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cout << "Failed to create recording: " << filename << std::endl;
+        return false;
+    }
+
+    file.write(kMagic, 4);
+    WriteRaw(file, kVersion);
+    WriteRaw(file, header.seed);
+    WriteRaw(file, header.planetCount);
+    WriteRaw(file, header.startTime);
+    WriteRaw(file, header.camera.pos.x);
+    WriteRaw(file, header.camera.pos.y);
+    WriteRaw(file, header.camera.pos.z);
+    WriteRaw(file, header.camera.yaw);
+    WriteRaw(file, header.camera.pitch);
+    frameCount = 0;
+    WriteRaw(file, frameCount);
+    return true;
+}
+
+void InputRecorder::Write(const FrameInput& input)
+{
+    if (!file.is_open()) return;
+    WriteRaw(file, input.keys);
+    WriteRaw(file, input.dt);
+    ++frameCount;
+}
+
+void InputRecorder::Close()
+{
+    if (!file.is_open()) return;
+    file.seekp(kFrameCountOffset);
+    WriteRaw(file, frameCount);
+    file.close();
+    std::cout << "Input recording saved: " << frameCount << " frames" << std::endl;
+}
+
+bool InputPlayer::Open(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Failed to open recording: " << filename << std::endl;
+        return false;
+    }
+
+    char magic[4] = {};
+    uint32_t version = 0;
+    file.read(magic, 4);
+    if (!file || std::memcmp(magic, kMagic, 4) != 0 || !ReadRaw(file, version) || version != kVersion)
+    {
+        std::cout << "Not an input recording (or unsupported version): " << filename << std::endl;
+        return false;
+    }
+
+    uint32_t frameCount = 0;
+    bool ok = ReadRaw(file, header.seed) && ReadRaw(file, header.planetCount) &&
+        ReadRaw(file, header.startTime) &&
+        ReadRaw(file, header.camera.pos.x) && ReadRaw(file, header.camera.pos.y) &&
+        ReadRaw(file, header.camera.pos.z) && ReadRaw(file, header.camera.yaw) &&
+        ReadRaw(file, header.camera.pitch) && ReadRaw(file, frameCount);
+    if (!ok)
+    {
+        std::cout << "Truncated recording header: " << filename << std::endl;
+        return false;
+    }
+
+    // кадры читаются до конца файла: если запись оборвалась (процесс убит
+    // до Close), счётчик в заголовке нулевой, но сами кадры на месте
+    FrameInput input;
+    while (ReadRaw(file, input.keys) && ReadRaw(file, input.dt))
+        frames.push_back(input);
+    if (frameCount != 0 && frameCount != frames.size())
+        std::cout << "Recording frame count mismatch: header " << frameCount
+            << ", file " << frames.size() << std::endl;
+    cursor = 0;
+    std::cout << "Input recording loaded: " << frames.size() << " frames" << std::endl;
+    return true;
+}
+
+bool InputPlayer::Next(FrameInput& input)
+{
+    if (cursor >= frames.size())
+        return false;
+    input = frames[cursor++];
+    return true;
+}
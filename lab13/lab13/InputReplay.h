@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Scene.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// =======================================================
+// ЗАПИСЬ И ВОСПРОИЗВЕДЕНИЕ УПРАВЛЕНИЯ
+// =======================================================
+//
+// За кадр сохраняется только то, что влияет на симуляцию:
+// маска нажатых клавиш камеры и dt (6 байт). Начальное состояние
+// (seed, время, камера) лежит в заголовке, поэтому воспроизведение
+// повторяет тот же пролёт без окна и без клавиатуры.
+
+enum InputKey : uint16_t
+{
+    kKeyForward   = 1 << 0,   // W
+    kKeyBack      = 1 << 1,   // S
+    kKeyLeft      = 1 << 2,   // A
+    kKeyRight     = 1 << 3,   // D
+    kKeyUp        = 1 << 4,   // Space
+    kKeyDown      = 1 << 5,   // LShift
+    kKeyYawLeft   = 1 << 6,   // стрелки
+    kKeyYawRight  = 1 << 7,
+    kKeyPitchUp   = 1 << 8,
+    kKeyPitchDown = 1 << 9,
+
+    kSimPaused    = 1 << 10,  // не клавиша: симуляция на паузе в этом кадре
+};
+
+const uint16_t kCameraKeys = (1 << 10) - 1;
+
+struct FrameInput
+{
+    uint16_t keys = 0;
+    float dt = 0.0f;
+};
+
+// опрос клавиатуры
+FrameInput SampleKeyboard(float dt);
+
+// движение и поворот камеры по маске клавиш
+void ApplyCameraInput(Camera& camera, const FrameInput& input);
+
+// шаг симуляции планет: 0 на паузе (камера при этом двигается)
+inline float SimulationDt(const FrameInput& input)
+{
+    return (input.keys & kSimPaused) ? 0.0f : input.dt;
+}
+
+struct RecordingHeader
+{
+    uint32_t seed = 0;
+    uint32_t planetCount = 0;
+    float startTime = 0.0f;
+    Camera camera;
+};
+
+class InputRecorder
+{
+public:
+    ~InputRecorder() { Close(); }
+
+    bool Open(const std::string& filename, const RecordingHeader& header);
+    void Write(const FrameInput& input);
+    // дописывает число кадров в заголовок
+    void Close();
+
+    bool IsOpen() const { return file.is_open(); }
+
+private:
+    std::ofstream file;
+    uint32_t frameCount = 0;
+};
+
+class InputPlayer
+{
+public:
+    bool Open(const std::string& filename);
+
+    const RecordingHeader& Header() const { return header; }
+    size_t FrameCount() const { return frames.size(); }
+
+    // false — запись закончилась
+    bool Next(FrameInput& input);
+
+private:
+    RecordingHeader header;
+    std::vector<FrameInput> frames;
+    size_t cursor = 0;
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+struct Vec3
+{
+    float x = 0, y = 0, z = 0;
+    Vec3() = default;
+    Vec3(float X, float Y, float Z) : x(X), y(Y), z(Z) {}
+};
+
+inline Vec3 operator+(const Vec3& a, const Vec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+inline Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+inline Vec3 operator*(const Vec3& a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+
+inline float Dot(const Vec3& a, const Vec3& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+inline Vec3 Cross(const Vec3& a, const Vec3& b)
+{
+    return Vec3(
+        a.y * b.z - a.z * b.y,
+        a.z * b.x - a.x * b.z,
+        a.x * b.y - a.y * b.x
+    );
+}
+
+inline float Length(const Vec3& v)
+{
+    return std::sqrt(Dot(v, v));
+}
+
+inline Vec3 Normalize(const Vec3& v)
+{
+    float len = Length(v);
+    if (len <= 1e-6f) return v;
+    return v * (1.0f / len);
+}
+
+struct Vec4
+{
+    float x = 0, y = 0, z = 0, w = 0;
+    Vec4() = default;
+    Vec4(float X, float Y, float Z, float W) : x(X), y(Y), z(Z), w(W) {}
+};
+
+// 4x4 матрица в формате column-major,
+// как ожидает OpenGL (m[col*4 + row])
+struct Mat4
+{
+    float m[16] = { 0 };
+
+    static Mat4 Identity()
+    {
+        Mat4 r;
+        r.m[0] = r.m[5] = r.m[10] = r.m[15] = 1.0f;
+        return r;
+    }
+
+    static Mat4 Translation(float x, float y, float z)
+    {
+        Mat4 r = Identity();
+        r.m[12] = x;
+        r.m[13] = y;
+        r.m[14] = z;
+        return r;
+    }
+
+    static Mat4 Scale(float x, float y, float z)
+    {
+        Mat4 r;
+        r.m[0] = x;
+        r.m[5] = y;
+        r.m[10] = z;
+        r.m[15] = 1.0f;
+        return r;
+    }
+
+    static Mat4 RotationY(float angleRad)
+    {
+        Mat4 r = Identity();
+        float c = std::cos(angleRad);
+        float s = std::sin(angleRad);
+        r.m[0] = c;
+        r.m[2] = s;
+        r.m[8] = -s;
+        r.m[10] = c;
+        return r;
+    }
+
+    static Mat4 Perspective(float fovyRad, float aspect, float zNear, float zFar)
+    {
+        Mat4 r;
+        float tanHalfFovy = std::tan(fovyRad / 2.0f);
+
+        r.m[0] = 1.0f / (aspect * tanHalfFovy);
+        r.m[5] = 1.0f / tanHalfFovy;
+        r.m[10] = -(zFar + zNear) / (zFar - zNear);
+        r.m[11] = -1.0f;
+        r.m[14] = -(2.0f * zFar * zNear) / (zFar - zNear);
+        return r;
+    }
+
+    static Mat4 LookAt(const Vec3& eye, const Vec3& center, const Vec3& up)
+    {
+        Vec3 f = Normalize(center - eye);
+        Vec3 s = Normalize(Cross(f, up));
+        Vec3 u = Cross(s, f);
+
+        Mat4 r = Identity();
+        r.m[0] = s.x;
+        r.m[4] = s.y;
+        r.m[8] = s.z;
+
+        r.m[1] = u.x;
+        r.m[5] = u.y;
+        r.m[9] = u.z;
+
+        r.m[2] = -f.x;
+        r.m[6] = -f.y;
+        r.m[10] = -f.z;
+
+        r.m[12] = -Dot(s, eye);
+        r.m[13] = -Dot(u, eye);
+        r.m[14] = Dot(f, eye);
+        return r;
+    }
+};
+
+inline Mat4 operator*(const Mat4& a, const Mat4& b)
+{
+    Mat4 r;
+    for (int col = 0; col < 4; ++col)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            r.m[col * 4 + row] =
+                a.m[0 * 4 + row] * b.m[col * 4 + 0] +
+                a.m[1 * 4 + row] * b.m[col * 4 + 1] +
+                a.m[2 * 4 + row] * b.m[col * 4 + 2] +
+                a.m[3 * 4 + row] * b.m[col * 4 + 3];
+        }
+    }
+    return r;
+}
+
+// обратная к повороту + переносу (например, к LookAt)
+inline Mat4 InverseRigid(const Mat4& a)
+{
+    Mat4 r = Mat4::Identity();
+    for (int col = 0; col < 3; ++col)
+        for (int row = 0; row < 3; ++row)
+            r.m[col * 4 + row] = a.m[row * 4 + col];
+    for (int row = 0; row < 3; ++row)
+        r.m[12 + row] = -(r.m[row] * a.m[12] + r.m[4 + row] * a.m[13] + r.m[8 + row] * a.m[14]);
+    return r;
+}
+
+// преобразование точки (w = 1) матрицей
+inline Vec4 TransformPoint(const Mat4& a, const Vec3& p)
+{
+    return Vec4(
+        a.m[0] * p.x + a.m[4] * p.y + a.m[8] * p.z + a.m[12],
+        a.m[1] * p.x + a.m[5] * p.y + a.m[9] * p.z + a.m[13],
+        a.m[2] * p.x + a.m[6] * p.y + a.m[10] * p.z + a.m[14],
+        a.m[3] * p.x + a.m[7] * p.y + a.m[11] * p.z + a.m[15]);
+}
+
+// плоскости пирамиды видимости (Gribb-Hartmann), внутрь, нормированные
+inline void FrustumPlanes(const Mat4& viewProj, float planes[6][4])
+{
+    auto row = [&](int r, int c) { return viewProj.m[c * 4 + r]; };
+    for (int i = 0; i < 6; ++i)
+    {
+        int axis = i / 2;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+        for (int c = 0; c < 4; ++c)
+            planes[i][c] = row(3, c) + sign * row(axis, c);
+        float len = std::sqrt(planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] +
+            planes[i][2] * planes[i][2]);
+        for (int c = 0; c < 4; ++c)
+            planes[i][c] /= len;
+    }
+}
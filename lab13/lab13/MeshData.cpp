@@ -0,0 +1,188 @@
+#include "MeshData.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // треугольников на задачу пула
+    const size_t kChunk = 4096;
+
+    void ParallelChunks(ThreadPool& pool, size_t count, const std::function<void(size_t, size_t)>& fn)
+    {
+        size_t chunks = (count + kChunk - 1) / kChunk;
+        pool.ParallelFor(chunks, [&](size_t c, unsigned)
+            {
+                size_t begin = c * kChunk;
+                fn(begin, std::min(count, begin + kChunk));
+            });
+    }
+
+    // углы элементов: key[i] -> список i (CSR, порядок внутри списка по возрастанию i)
+    void BuildLists(const std::vector<uint32_t>& key, uint32_t keyCount,
+        std::vector<uint32_t>& start, std::vector<uint32_t>& items)
+    {
+        start.assign(keyCount + 1, 0);
+        for (uint32_t k : key)
+            if (k < keyCount)
+                ++start[k + 1];
+        for (uint32_t k = 0; k < keyCount; ++k)
+            start[k + 1] += start[k];
+
+        items.resize(start[keyCount]);
+        std::vector<uint32_t> cursor(start.begin(), start.end() - 1);
+        for (uint32_t i = 0; i < (uint32_t)key.size(); ++i)
+            if (key[i] < keyCount)
+                items[cursor[key[i]]++] = i;
+    }
+
+    float AngleBetween(const Vec3& a, const Vec3& b)
+    {
+        float la = Length(a), lb = Length(b);
+        if (la <= 1e-12f || lb <= 1e-12f)
+            return 0.0f;
+        return std::acos(std::clamp(Dot(a, b) / (la * lb), -1.0f, 1.0f));
+    }
+
+    // углы треугольника при вершинах 0, 1, 2
+    void CornerAngles(const Vec3& p0, const Vec3& p1, const Vec3& p2, float angles[3])
+    {
+        angles[0] = AngleBetween(p1 - p0, p2 - p0);
+        angles[1] = AngleBetween(p2 - p1, p0 - p1);
+        angles[2] = (float)M_PI - angles[0] - angles[1];
+    }
+
+    // любой единичный вектор, перпендикулярный n
+    Vec3 AnyPerpendicular(const Vec3& n)
+    {
+        Vec3 axis = std::fabs(n.x) < 0.9f ? Vec3(1.0f, 0.0f, 0.0f) : Vec3(0.0f, 1.0f, 0.0f);
+        return Normalize(Cross(n, axis));
+    }
+}
+
+void GenerateNormals(MeshData& mesh, const std::vector<uint32_t>& normalGroup,
+    uint32_t groupCount, ThreadPool& pool)
+{
+    size_t triCount = mesh.TriangleCount();
+    mesh.normals.resize(mesh.VertexCount());
+    if (groupCount == 0)
+        return;
+
+    // --- вклад каждого угла: нормаль грани * угол ---
+    std::vector<Vec3> corner(triCount * 3);
+    ParallelChunks(pool, triCount, [&](size_t begin, size_t end)
+        {
+            for (size_t t = begin; t < end; ++t)
+            {
+                const uint32_t* idx = &mesh.indices[t * 3];
+                const Vec3& p0 = mesh.positions[idx[0]];
+                const Vec3& p1 = mesh.positions[idx[1]];
+                const Vec3& p2 = mesh.positions[idx[2]];
+                Vec3 n = Cross(p1 - p0, p2 - p0);
+                float len = Length(n);
+                float angles[3] = { 0, 0, 0 };
+                if (len > 1e-20f)
+                {
+                    n = n * (1.0f / len);
+                    CornerAngles(p0, p1, p2, angles);
+                }
+                for (int c = 0; c < 3; ++c)
+                    corner[t * 3 + c] = n * angles[c];
+            }
+        });
+
+    // --- группа -> её углы, сумма в каждой группе независимо ---
+    std::vector<uint32_t> cornerGroup(triCount * 3);
+    for (size_t i = 0; i < cornerGroup.size(); ++i)
+        cornerGroup[i] = normalGroup[mesh.indices[i]];
+
+    std::vector<uint32_t> start, items;
+    BuildLists(cornerGroup, groupCount, start, items);
+
+    std::vector<Vec3> groupNormal(groupCount);
+    ParallelChunks(pool, groupCount, [&](size_t begin, size_t end)
+        {
+            for (size_t g = begin; g < end; ++g)
+            {
+                Vec3 sum;
+                for (uint32_t i = start[g]; i < start[g + 1]; ++i)
+                    sum = sum + corner[items[i]];
+                float len = Length(sum);
+                groupNormal[g] = len > 1e-20f ? sum * (1.0f / len) : Vec3(0.0f, 1.0f, 0.0f);
+            }
+        });
+
+    for (size_t v = 0; v < mesh.VertexCount(); ++v)
+        if (normalGroup[v] != kNoNormalGroup)
+            mesh.normals[v] = groupNormal[normalGroup[v]];
+}
+
+void GenerateTangents(MeshData& mesh, ThreadPool& pool)
+{
+    size_t triCount = mesh.TriangleCount();
+    size_t vertexCount = mesh.VertexCount();
+    mesh.tangents.resize(vertexCount);
+
+    // --- касательная и битангенс угла в плоскости нормали вершины ---
+    std::vector<Vec3> cornerT(triCount * 3);
+    std::vector<Vec3> cornerB(triCount * 3);
+    ParallelChunks(pool, triCount, [&](size_t begin, size_t end)
+        {
+            for (size_t t = begin; t < end; ++t)
+            {
+                const uint32_t* idx = &mesh.indices[t * 3];
+                const Vec3& p0 = mesh.positions[idx[0]];
+                const Vec3& p1 = mesh.positions[idx[1]];
+                const Vec3& p2 = mesh.positions[idx[2]];
+                const float* uv0 = &mesh.texcoords[idx[0] * 2];
+                const float* uv1 = &mesh.texcoords[idx[1] * 2];
+                const float* uv2 = &mesh.texcoords[idx[2] * 2];
+
+                Vec3 e1 = p1 - p0, e2 = p2 - p0;
+                float s1 = uv1[0] - uv0[0], t1 = uv1[1] - uv0[1];
+                float s2 = uv2[0] - uv0[0], t2 = uv2[1] - uv0[1];
+                float det = s1 * t2 - s2 * t1;
+
+                Vec3 sdir, tdir;
+                if (std::fabs(det) > 1e-20f)
+                {
+                    float r = 1.0f / det;
+                    sdir = (e1 * t2 - e2 * t1) * r;
+                    tdir = (e2 * s1 - e1 * s2) * r;
+                }
+
+                float angles[3];
+                CornerAngles(p0, p1, p2, angles);
+                for (int c = 0; c < 3; ++c)
+                {
+                    const Vec3& n = mesh.normals[idx[c]];
+                    Vec3 tp = Normalize(sdir - n * Dot(n, sdir));
+                    Vec3 bp = Normalize(tdir - n * Dot(n, tdir));
+                    cornerT[t * 3 + c] = tp * angles[c];
+                    cornerB[t * 3 + c] = bp * angles[c];
+                }
+            }
+        });
+
+    // --- вершина -> её углы ---
+    std::vector<uint32_t> start, items;
+    BuildLists(mesh.indices, (uint32_t)vertexCount, start, items);
+
+    ParallelChunks(pool, vertexCount, [&](size_t begin, size_t end)
+        {
+            for (size_t v = begin; v < end; ++v)
+            {
+                Vec3 sumT, sumB;
+                for (uint32_t i = start[v]; i < start[v + 1]; ++i)
+                {
+                    sumT = sumT + cornerT[items[i]];
+                    sumB = sumB + cornerB[items[i]];
+                }
+                const Vec3& n = mesh.normals[v];
+                Vec3 tangent = sumT - n * Dot(n, sumT);
+                tangent = Length(tangent) > 1e-12f ? Normalize(tangent) : AnyPerpendicular(n);
+                float sign = Dot(Cross(n, tangent), sumB) < 0.0f ? -1.0f : 1.0f;
+                mesh.tangents[v] = Vec4(tangent.x, tangent.y, tangent.z, sign);
+            }
+        });
+}
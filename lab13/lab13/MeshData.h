@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Math3D.h"
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <vector>
+
+// =======================================================
+// ИНДЕКСИРОВАННЫЙ МЕШ (результат LoadOBJ)
+// =======================================================
+//
+// Вершина — уникальная комбинация позиции, UV и нормали. Нормали и
+// касательные, которых нет в файле, достраиваются параллельно по
+// треугольникам без атомарных операций: вклад каждого угла треугольника
+// пишется в свою ячейку, а вершина потом собирает вклады своих углов.
+
+struct MeshData
+{
+    std::vector<Vec3> positions;
+    std::vector<float> texcoords;   // по 2 на вершину
+    std::vector<Vec3> normals;
+    std::vector<Vec4> tangents;     // xyz — касательная, w — знак битангенса (+-1)
+    std::vector<uint32_t> indices;  // по 3 на треугольник
+
+    size_t VertexCount() const { return positions.size(); }
+    size_t TriangleCount() const { return indices.size() / 3; }
+};
+
+const uint32_t kNoNormalGroup = 0xFFFFFFFFu;
+
+// нормали с весом по углу при вершине. normalGroup[v] — группа вершины:
+// вершины одной группы получают общую нормаль (одна позиция в одной
+// группе сглаживания, даже если UV разные). kNoNormalGroup — нормаль
+// вершины уже задана и не меняется.
+void GenerateNormals(MeshData& mesh, const std::vector<uint32_t>& normalGroup,
+    uint32_t groupCount, ThreadPool& pool);
+
+// касательные в духе MikkTSpace: касательная треугольника по UV,
+// проекция на плоскость нормали вершины, вес по углу, знак — по
+// накопленному битангенсу. Нужны normals.
+void GenerateTangents(MeshData& mesh, ThreadPool& pool);
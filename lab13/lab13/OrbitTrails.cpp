@@ -0,0 +1,361 @@
+#include "OrbitTrails.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+namespace
+{
+    // голова следа: по вершине на орбиту, результат — в кольцо истории
+    const char* writeVertexSrc = R"(
+        #version 330 core
+        layout(location = 0) in vec4 aOrbit;   // радиус, скорость, угол при t = 0
+
+        uniform float uTime;
+
+        out vec4 vSample;                      // позиция, время записи
+
+        void main()
+        {
+            float a = aOrbit.z + aOrbit.y * uTime;
+            vSample = vec4(cos(a) * aOrbit.x, 0.0, sin(a) * aOrbit.x, uTime);
+        }
+    )";
+
+    const char* historyVertexSrc = R"(
+        #version 330 core
+        uniform samplerBuffer uHistory;
+        uniform int uHead;
+        uniform int uSamples;
+        uniform int uOrbits;
+        uniform float uTime;
+        uniform float uSeconds;
+        uniform mat4 uViewProj;
+
+        out float vFade;
+
+        void main()
+        {
+            // вершина — шаг назад по кольцу, экземпляр — столбец планеты
+            int row = (uHead - gl_VertexID + uSamples) % uSamples;
+            vec4 s = texelFetch(uHistory, row * uOrbits + gl_InstanceID);
+            vFade = clamp(1.0 - (uTime - s.w) / uSeconds, 0.0, 1.0);
+            gl_Position = uViewProj * vec4(s.xyz, 1.0);
+        }
+    )";
+
+    const char* arcVertexSrc = R"(
+        #version 330 core
+        layout(location = 0) in vec4 aOrbit;   // на экземпляр
+
+        uniform float uTime;
+        uniform float uSeconds;
+        uniform int uSegments;
+        uniform mat4 uViewProj;
+
+        out float vFade;
+
+        void main()
+        {
+            float age = float(gl_VertexID) / float(uSegments);
+            float a = aOrbit.z + aOrbit.y * (uTime - age * uSeconds);
+            vFade = 1.0 - age;
+            gl_Position = uViewProj * vec4(cos(a) * aOrbit.x, 0.0, sin(a) * aOrbit.x, 1.0);
+        }
+    )";
+
+    const char* trailFragmentSrc = R"(
+        #version 330 core
+        in float vFade;
+        out vec4 FragColor;
+
+        uniform vec3 uColor;
+
+        void main()
+        {
+            FragColor = vec4(uColor * vFade, 1.0);
+        }
+    )";
+
+    GLuint CheckLinked(GLuint prog)
+    {
+        GLint ok = 0;
+        glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+        if (ok)
+            return prog;
+        glDeleteProgram(prog);
+        return 0;
+    }
+
+    GLuint RenderProgram(const char* vertSrc, const char* fragSrc)
+    {
+        GLuint vert = CompileShader(GL_VERTEX_SHADER, vertSrc);
+        GLuint frag = CompileShader(GL_FRAGMENT_SHADER, fragSrc);
+        GLuint prog = CheckLinked(LinkProgram(vert, frag));
+        glDeleteShader(vert);
+        glDeleteShader(frag);
+        return prog;
+    }
+
+    // только вершинный шейдер; vSample уходит в буфер transform feedback
+    GLuint FeedbackProgram(const char* vertSrc)
+    {
+        GLuint vert = CompileShader(GL_VERTEX_SHADER, vertSrc);
+        GLuint prog = glCreateProgram();
+        glAttachShader(prog, vert);
+        const char* varyings[] = { "vSample" };
+        glTransformFeedbackVaryings(prog, 1, varyings, GL_INTERLEAVED_ATTRIBS);
+        glLinkProgram(prog);
+        glDeleteShader(vert);
+        GLint ok = 0;
+        glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+        if (!ok)
+            ProgramLog(prog);
+        return CheckLinked(prog);
+    }
+}
+
+bool OrbitTrails::Init(const OrbitTrailSettings& s)
+{
+    settings = s;
+    settings.seconds = std::max(0.01f, settings.seconds);
+    settings.samples = std::max(2u, settings.samples);
+    settings.segments = std::max(1u, settings.segments);
+
+    arcProg = RenderProgram(arcVertexSrc, trailFragmentSrc);
+    if (!settings.analytic)
+    {
+        writeProg = FeedbackProgram(writeVertexSrc);
+        historyProg = RenderProgram(historyVertexSrc, trailFragmentSrc);
+    }
+    if (!arcProg || (!settings.analytic && (!writeProg || !historyProg)))
+    {
+        Destroy();
+        return false;
+    }
+
+    // бледно-голубой след; для HDR-цели — в линейном цвете
+    float color[3] = { 0.45f, 0.65f, 1.00f };
+    if (settings.linearOutput)
+    {
+        for (float& c : color)
+            c = std::pow(c, 2.2f);
+    }
+
+    arcViewProjLoc = glGetUniformLocation(arcProg, "uViewProj");
+    arcTimeLoc = glGetUniformLocation(arcProg, "uTime");
+    glUseProgram(arcProg);
+    glUniform1f(glGetUniformLocation(arcProg, "uSeconds"), settings.seconds);
+    glUniform1i(glGetUniformLocation(arcProg, "uSegments"), (GLint)settings.segments);
+    glUniform3fv(glGetUniformLocation(arcProg, "uColor"), 1, color);
+    if (!settings.analytic)
+    {
+        writeTimeLoc = glGetUniformLocation(writeProg, "uTime");
+        historyViewProjLoc = glGetUniformLocation(historyProg, "uViewProj");
+        historyTimeLoc = glGetUniformLocation(historyProg, "uTime");
+        historyHeadLoc = glGetUniformLocation(historyProg, "uHead");
+        glUseProgram(historyProg);
+        glUniform1i(glGetUniformLocation(historyProg, "uHistory"), 0);
+        glUniform1f(glGetUniformLocation(historyProg, "uSeconds"), settings.seconds);
+        glUniform3fv(glGetUniformLocation(historyProg, "uColor"), 1, color);
+    }
+    glUseProgram(0);
+
+    // один буфер орбит: по вершине (запись голов) и по экземпляру (дуги)
+    glGenBuffers(1, &orbitBuffer);
+    glGenVertexArrays(1, &orbitVAO);
+    glGenVertexArrays(1, &arcVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, orbitBuffer);
+    glBindVertexArray(orbitVAO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glBindVertexArray(arcVAO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glVertexAttribDivisor(0, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (!settings.analytic)
+    {
+        glGenBuffers(1, &historyBuffer);
+        glGenTextures(1, &historyTexture);
+    }
+
+    timer.Init(4, true);
+    return true;
+}
+
+void OrbitTrails::Destroy()
+{
+    timer.Destroy();
+    glDeleteTextures(1, &historyTexture);
+    glDeleteBuffers(1, &historyBuffer);
+    glDeleteVertexArrays(1, &arcVAO);
+    glDeleteVertexArrays(1, &orbitVAO);
+    glDeleteBuffers(1, &orbitBuffer);
+    glDeleteProgram(arcProg);
+    glDeleteProgram(historyProg);
+    glDeleteProgram(writeProg);
+    historyTexture = historyBuffer = arcVAO = orbitVAO = orbitBuffer = 0;
+    arcProg = historyProg = writeProg = 0;
+    planetCount = 0;
+    orbits = head = written = 0;
+    sampleTimes.clear();
+}
+
+bool OrbitTrails::LoadOrbits(const std::vector<Planet>& planets, float time)
+{
+    // угол при t = 0: шейдер продолжает его так же, как UpdatePlanets
+    std::vector<float> data;
+    data.reserve(planets.size() * 4);
+    for (const Planet& p : planets)
+    {
+        if (p.orbitRadius <= 0.0f)
+            continue;
+        data.insert(data.end(), { p.orbitRadius, p.orbitSpeed, p.orbitAngle - p.orbitSpeed * time, 0.0f });
+    }
+    planetCount = planets.size();
+    orbits = (unsigned)(data.size() / 4);
+    head = written = 0;
+    if (orbits == 0)
+        return false;
+
+    glBindBuffer(GL_ARRAY_BUFFER, orbitBuffer);
+    glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (settings.analytic)
+        return true;
+
+    // кольцо должно поместиться в texture buffer
+    GLint maxTexels = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+    unsigned fit = (unsigned)std::max<GLint>(0, maxTexels) / orbits;
+    if (fit < settings.samples)
+    {
+        std::cout << "Trail history limited to " << fit << " samples for " << orbits << " orbits" << std::endl;
+        settings.samples = fit;
+    }
+    if (settings.samples < 2)
+    {
+        orbits = 0;
+        return false;
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, historyBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)settings.samples * orbits * 4 * sizeof(float), nullptr, GL_DYNAMIC_COPY);
+    glBindTexture(GL_TEXTURE_BUFFER, historyTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, historyBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    if (glGetError() == GL_OUT_OF_MEMORY)
+    {
+        std::cout << "Out of GPU memory for " << orbits << " orbit trails" << std::endl;
+        orbits = 0;
+        return false;
+    }
+
+    sampleTimes.assign(settings.samples, 0.0f);
+    glUseProgram(historyProg);
+    glUniform1i(glGetUniformLocation(historyProg, "uSamples"), (GLint)settings.samples);
+    glUniform1i(glGetUniformLocation(historyProg, "uOrbits"), (GLint)orbits);
+    glUseProgram(0);
+    return true;
+}
+
+void OrbitTrails::WriteHead(float time)
+{
+    if (written > 0)
+    {
+        float last = sampleTimes[head];
+        if (time == last)
+            return;          // пауза: голова на месте
+        if (time < last)
+            written = 0;     // время пошло назад (новый прогон) — старые точки не в счёт
+    }
+    head = (head + 1) % settings.samples;
+
+    glUseProgram(writeProg);
+    glUniform1f(writeTimeLoc, time);
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, historyBuffer,
+        (GLintptr)head * orbits * 4 * sizeof(float), (GLsizeiptr)orbits * 4 * sizeof(float));
+    glBindVertexArray(orbitVAO);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, (GLsizei)orbits);
+    glEndTransformFeedback();
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    sampleTimes[head] = time;
+    written = std::min(written + 1, settings.samples);
+}
+
+void OrbitTrails::Draw(const std::vector<Planet>& planets, const Mat4& view, const Mat4& proj, float time)
+{
+    if (!arcProg)
+        return;
+    if (planets.size() != planetCount && !LoadOrbits(planets, time))
+        return;
+    if (orbits == 0)
+        return;
+
+    double ms = 0.0;
+    if (timer.Poll(ms))
+        gpuMs.Add(ms);
+    timer.Begin();
+
+    GLsizei vertices = (GLsizei)settings.segments + 1;
+    if (!settings.analytic)
+    {
+        WriteHead(time);
+        // строки не старше seconds и одна за краем, где след гаснет до нуля
+        unsigned n = 0;
+        while (n < written && time - sampleTimes[(head + settings.samples - n) % settings.samples] < settings.seconds)
+            ++n;
+        vertices = (GLsizei)std::min(n + 1, written);
+    }
+
+    Mat4 viewProj = proj * view;
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glDepthMask(GL_FALSE);
+    glBindVertexArray(arcVAO);
+    if (settings.analytic)
+    {
+        glUseProgram(arcProg);
+        glUniformMatrix4fv(arcViewProjLoc, 1, GL_FALSE, viewProj.m);
+        glUniform1f(arcTimeLoc, time);
+        glDrawArraysInstanced(GL_LINE_STRIP, 0, vertices, (GLsizei)orbits);
+    }
+    else if (vertices >= 2)
+    {
+        glUseProgram(historyProg);
+        glUniformMatrix4fv(historyViewProjLoc, 1, GL_FALSE, viewProj.m);
+        glUniform1f(historyTimeLoc, time);
+        glUniform1i(historyHeadLoc, (GLint)head);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_BUFFER, historyTexture);
+        glDrawArraysInstanced(GL_LINE_STRIP, 0, vertices, (GLsizei)orbits);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+    glBindVertexArray(0);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    glUseProgram(0);
+
+    timer.End();
+}
+
+std::string OrbitTrails::Summary() const
+{
+    char buf[256];
+    if (settings.analytic)
+        std::snprintf(buf, sizeof(buf), "%u orbits, analytic arcs of %u segments, %.1f s, GPU: ",
+            orbits, settings.segments, settings.seconds);
+    else
+        std::snprintf(buf, sizeof(buf), "%u orbits, history %u x 16 B (transform feedback, %.1f KB/frame), %.1f s, GPU: ",
+            orbits, settings.samples, orbits * 16 / 1024.0, settings.seconds);
+    return buf + gpuMs.Summary();
+}
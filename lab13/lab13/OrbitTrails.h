@@ -0,0 +1,82 @@
+#pragma once
+
+#include "FrameStats.h"
+#include "GlUtils.h"
+#include "GpuTimer.h"
+#include "Math3D.h"
+#include "Scene.h"
+
+#include <string>
+#include <vector>
+
+// =======================================================
+// СЛЕДЫ ОРБИТ
+// =======================================================
+//
+// Орбиты (радиус, скорость, угол при t = 0) загружаются на GPU один
+// раз; положение планеты в момент t шейдер считает сам, как
+// PlanetPosition, поэтому на кадр CPU не передаёт ни одной вершины.
+//
+// История — кольцевой буфер из samples строк по строке на кадр; у
+// каждой планеты свой постоянный столбец. Раз в кадр проход transform
+// feedback (без растеризации) пишет строку голов в слот head, след
+// рисуется одним glDrawArraysInstanced(GL_LINE_STRIP): экземпляр —
+// планета, вершина — шаг назад по кольцу (texelFetch из texture
+// buffer). Яркость гаснет с возрастом точки.
+//
+// Аналитический режим — для круговых орбит история не нужна: дуга за
+// последние seconds строится вершинным шейдером из тех же параметров.
+
+struct OrbitTrailSettings
+{
+    bool analytic = false;        // дуга по формуле вместо истории
+    float seconds = 4.0f;         // длина следа во времени симуляции
+    unsigned samples = 256;       // строк в кольце истории
+    unsigned segments = 64;       // отрезков аналитической дуги
+    bool linearOutput = false;    // цель в линейном цвете (HDR)
+};
+
+class OrbitTrails
+{
+public:
+    bool Init(const OrbitTrailSettings& settings);
+    void Destroy();
+
+    // в текущий framebuffer поверх сцены; planets нужны только при первом
+    // кадре и при смене их числа, time — время симуляции (как у UpdatePlanets)
+    void Draw(const std::vector<Planet>& planets, const Mat4& view, const Mat4& proj, float time);
+
+    // "100 orbits, history 256 x 16 B (transform feedback, 1.6 KB/frame), 4.0 s, GPU: <FrameTimeStats>"
+    std::string Summary() const;
+
+private:
+    bool LoadOrbits(const std::vector<Planet>& planets, float time);
+    void WriteHead(float time);
+
+    OrbitTrailSettings settings;
+    size_t planetCount = 0;         // для чего загружены орбиты
+    unsigned orbits = 0;            // без Солнца
+
+    GLuint orbitBuffer = 0;         // vec4 на орбиту
+    GLuint orbitVAO = 0;            // по вершине на орбиту (transform feedback)
+    GLuint arcVAO = 0;              // по экземпляру на орбиту
+
+    GLuint historyBuffer = 0;       // samples * orbits * vec4 (позиция, время)
+    GLuint historyTexture = 0;
+    std::vector<float> sampleTimes; // время строк кольца, для числа вершин следа
+    unsigned head = 0;
+    unsigned written = 0;
+
+    GLuint writeProg = 0;
+    GLuint historyProg = 0;
+    GLuint arcProg = 0;
+    GLint writeTimeLoc = -1;
+    GLint historyViewProjLoc = -1;
+    GLint historyTimeLoc = -1;
+    GLint historyHeadLoc = -1;
+    GLint arcViewProjLoc = -1;
+    GLint arcTimeLoc = -1;
+
+    GpuTimer timer;                 // timestamps: может стоять внутри замера кадра
+    FrameTimeStats gpuMs;
+};
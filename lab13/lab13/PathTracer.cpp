@@ -0,0 +1,418 @@
+#include "PathTracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    const float kPi = 3.14159265f;
+    const float kRayOffset = 1e-3f;              // сдвиг начала вторичного луча по нормали
+    const Vec3 kSunColor(1.0f, 0.92f, 0.8f);     // как у источника Солнца (ClusteredLighting.cpp)
+    const float kBackground[3] = { 0.02f, 0.02f, 0.05f };   // фон GL-пути, sRGB
+
+    Vec3 Mul(const Vec3& a, const Vec3& b)
+    {
+        return Vec3(a.x * b.x, a.y * b.y, a.z * b.z);
+    }
+
+    uint32_t Hash(uint32_t x)
+    {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    // PCG: поток чисел пути одного пикселя и отсчёта
+    struct Rng
+    {
+        uint32_t state;
+
+        float Next()
+        {
+            state = state * 747796405u + 2891336453u;
+            uint32_t w = ((state >> ((state >> 28) + 4)) ^ state) * 277803737u;
+            w = (w >> 22) ^ w;
+            return (w >> 8) * (1.0f / 16777216.0f);
+        }
+    };
+
+    // базис вокруг единичного n: направление (x, y, z) в системе n
+    Vec3 AroundAxis(const Vec3& n, float x, float y, float z)
+    {
+        Vec3 t = std::fabs(n.x) > 0.9f ? Vec3(0.0f, 1.0f, 0.0f) : Vec3(1.0f, 0.0f, 0.0f);
+        Vec3 b1 = Normalize(Cross(t, n));
+        Vec3 b2 = Cross(n, b1);
+        return b1 * x + b2 * y + n * z;
+    }
+
+    Vec3 CosineHemisphere(const Vec3& n, float r1, float r2)
+    {
+        float r = std::sqrt(r1);
+        float phi = 2.0f * kPi * r2;
+        return AroundAxis(n, r * std::cos(phi), r * std::sin(phi), std::sqrt(std::max(0.0f, 1.0f - r1)));
+    }
+
+    // аппроксимация ACES (Narkowicz), как в HdrBloom.cpp
+    float AcesFilm(float x)
+    {
+        return std::clamp((x * (2.51f * x + 0.03f)) / (x * (2.43f * x + 0.59f) + 0.14f), 0.0f, 1.0f);
+    }
+
+    uint64_t PackRange(uint32_t begin, uint32_t end)
+    {
+        return ((uint64_t)begin << 32) | end;
+    }
+}
+
+PathTracer::PathTracer(ThreadPool& pool, const PathTracerSettings& settings)
+    : pool(pool), settings(settings), queues(pool.Size()), counters(pool.Size())
+{
+    this->settings.tileSize = std::max(4u, settings.tileSize / 4 * 4);
+    for (int i = 0; i < 256; ++i)
+        srgbToLinear[i] = std::pow(i / 255.0f, 2.2f);
+}
+
+void PathTracer::SetModel(const MeshData& model, const sf::Image& texImage)
+{
+    meshBvh.Build(model, pool);
+    texture.width = (int)texImage.getSize().x;
+    texture.height = (int)texImage.getSize().y;
+    texture.texels.resize((size_t)texture.width * texture.height);
+    if (!texture.texels.empty())
+        std::memcpy(texture.texels.data(), texImage.getPixelsPtr(), texture.texels.size() * 4);
+}
+
+void PathTracer::SetPlanets(const std::vector<Planet>& planets)
+{
+    sceneBvh.Build(planets, meshBvh, pool);
+    spin.resize(planets.size() * 2);
+    for (size_t i = 0; i < planets.size(); ++i)
+    {
+        spin[i * 2 + 0] = std::cos(planets[i].selfAngle);
+        spin[i * 2 + 1] = std::sin(planets[i].selfAngle);
+    }
+    // лучи тени идут в конус сферы вокруг Солнца: сфера с центром в начале
+    // координат модели охватывает её AABB (модель — не обязательно шар,
+    // промахи мимо неё просто не освещают)
+    const Aabb& box = meshBvh.Bounds();
+    Vec3 corner(std::max(std::fabs(box.min.x), std::fabs(box.max.x)), std::max(std::fabs(box.min.y), std::fabs(box.max.y)),
+        std::max(std::fabs(box.min.z), std::fabs(box.max.z)));
+    sunCenter = planets.empty() ? Vec3() : PlanetPosition(planets[0]);
+    sunRadius = planets.empty() ? 0.0f : Length(corner) * planets[0].scale;
+    std::fill(accum.begin(), accum.end(), 0.0f);
+    samples = 0;
+}
+
+void PathTracer::SetCamera(const Camera& cam, unsigned w, unsigned h)
+{
+    camera = cam;
+    width = std::max(1u, w);
+    height = std::max(1u, h);
+    tilesX = (width + settings.tileSize - 1) / settings.tileSize;
+    tilesY = (height + settings.tileSize - 1) / settings.tileSize;
+    accum.assign((size_t)width * height * 3, 0.0f);
+    samples = 0;
+}
+
+bool PathTracer::NextTile(unsigned queue, uint32_t& tile)
+{
+    // свой отрезок — с начала
+    TileQueue& own = queues[queue];
+    uint64_t r = own.range.load(std::memory_order_acquire);
+    while ((uint32_t)(r >> 32) < (uint32_t)r)
+    {
+        uint32_t begin = (uint32_t)(r >> 32);
+        if (own.range.compare_exchange_weak(r, PackRange(begin + 1, (uint32_t)r), std::memory_order_acq_rel))
+        {
+            tile = begin;
+            return true;
+        }
+    }
+
+    // свой пуст — половина чужого остатка с конца
+    for (size_t k = 1; k < queues.size(); ++k)
+    {
+        TileQueue& victim = queues[(queue + k) % queues.size()];
+        uint64_t v = victim.range.load(std::memory_order_acquire);
+        while ((uint32_t)(v >> 32) < (uint32_t)v)
+        {
+            uint32_t begin = (uint32_t)(v >> 32);
+            uint32_t end = (uint32_t)v;
+            uint32_t mid = begin + (end - begin) / 2;
+            if (victim.range.compare_exchange_weak(v, PackRange(begin, mid), std::memory_order_acq_rel))
+            {
+                // первый украденный — сразу в работу, остальные — в свой отрезок
+                tile = mid;
+                own.range.store(PackRange(mid + 1, end), std::memory_order_release);
+                counters[queue].stolen += end - mid;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void PathTracer::RenderPass()
+{
+    if (width == 0)
+        return;
+    auto t0 = std::chrono::steady_clock::now();
+
+    // тайлы по строкам, исполнителю — непрерывный отрезок
+    uint32_t tileCount = tilesX * tilesY;
+    size_t workers = queues.size();
+    for (size_t q = 0; q < workers; ++q)
+    {
+        uint32_t begin = (uint32_t)(tileCount * q / workers);
+        uint32_t end = (uint32_t)(tileCount * (q + 1) / workers);
+        queues[q].range.store(PackRange(begin, end), std::memory_order_relaxed);
+    }
+
+    pool.ParallelFor(workers, [&](size_t q, unsigned)
+        {
+            uint32_t tile = 0;
+            while (NextTile((unsigned)q, tile))
+                RenderTile(tile, counters[q]);
+        });
+
+    ++samples;
+    tilesRendered += tileCount;
+    renderSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+Vec3 PathTracer::Albedo(uint32_t triangle, float u, float v) const
+{
+    if (texture.texels.empty())
+        return Vec3(0.8f, 0.8f, 0.8f);
+    float uv[2];
+    meshBvh.TexCoord(triangle, u, v, uv);
+
+    // GL_LINEAR + GL_REPEAT, sRGB -> линейный до смешивания
+    float fx = uv[0] * texture.width - 0.5f;
+    float fy = uv[1] * texture.height - 0.5f;
+    float flx = std::floor(fx), fly = std::floor(fy);
+    float ax = fx - flx, ay = fy - fly;
+    int x0 = ((int)flx % texture.width + texture.width) % texture.width;
+    int y0 = ((int)fly % texture.height + texture.height) % texture.height;
+    int x1 = x0 + 1 == texture.width ? 0 : x0 + 1;
+    int y1 = y0 + 1 == texture.height ? 0 : y0 + 1;
+    const uint32_t corners[4] = {
+        texture.texels[(size_t)y0 * texture.width + x0], texture.texels[(size_t)y0 * texture.width + x1],
+        texture.texels[(size_t)y1 * texture.width + x0], texture.texels[(size_t)y1 * texture.width + x1] };
+    const float weights[4] = { (1 - ax) * (1 - ay), ax * (1 - ay), (1 - ax) * ay, ax * ay };
+    Vec3 c;
+    for (int k = 0; k < 4; ++k)
+    {
+        // RGBA8 в памяти: r, g, b, a
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&corners[k]);
+        c = c + Vec3(srgbToLinear[p[0]], srgbToLinear[p[1]], srgbToLinear[p[2]]) * weights[k];
+    }
+    return c;
+}
+
+void PathTracer::RenderTile(uint32_t tile, WorkerCounters& stats)
+{
+    const unsigned ts = settings.tileSize;
+    unsigned x0 = (tile % tilesX) * ts;
+    unsigned y0 = (tile / tilesX) * ts;
+    unsigned x1 = std::min(width, x0 + ts);
+    unsigned y1 = std::min(height, y0 + ts);
+    const Vec3 sunEmission = kSunColor * settings.sunRadiance;
+    const Vec3 background(std::pow(kBackground[0], 2.2f), std::pow(kBackground[1], 2.2f), std::pow(kBackground[2], 2.2f));
+
+    for (unsigned y = y0; y < y1; ++y)
+    {
+        for (unsigned x = x0; x < x1; x += 4)
+        {
+            // пакет — 4 соседних пикселя строки
+            RayPacket rays;
+            PacketHit hit;
+            Rng rng[4];
+            Vec3 throughput[4], radiance[4];
+            int alive = 0;
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                unsigned px = x + lane;
+                rng[lane].state = Hash((y * width + px) ^ Hash(samples * 0x9E3779B9u + settings.seed));
+                throughput[lane] = Vec3(1.0f, 1.0f, 1.0f);
+                if (px >= x1)
+                {
+                    rays.ox[lane] = rays.oy[lane] = rays.oz[lane] = 0.0f;
+                    rays.dx[lane] = rays.dy[lane] = 0.0f;
+                    rays.dz[lane] = 1.0f;
+                    continue;
+                }
+                float jx = rng[lane].Next(), jy = rng[lane].Next();
+                Ray ray = CameraRay(camera, px + jx, y + jy, width, height);
+                rays.ox[lane] = ray.origin.x; rays.oy[lane] = ray.origin.y; rays.oz[lane] = ray.origin.z;
+                rays.dx[lane] = ray.dir.x; rays.dy[lane] = ray.dir.y; rays.dz[lane] = ray.dir.z;
+                alive |= 1 << lane;
+            }
+
+            for (unsigned bounce = 0; alive && bounce <= settings.maxBounces; ++bounce)
+            {
+                hit = PacketHit();
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    if (!(alive & (1 << lane)))
+                        hit.t[lane] = 0.0f;
+                }
+                sceneBvh.IntersectPacket(rays, hit);
+
+                RayPacket shadow;
+                PacketHit shadowHit;
+                Vec3 sunLight[4];
+                int shadowMask = 0;
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    if (!(alive & (1 << lane)))
+                        continue;
+                    ++stats.rays;
+                    if (hit.instance[lane] == kNoHit)
+                    {
+                        if (bounce == 0)
+                            radiance[lane] = background;
+                        alive &= ~(1 << lane);
+                        continue;
+                    }
+                    uint32_t inst = hit.instance[lane];
+                    Vec3 d(rays.dx[lane], rays.dy[lane], rays.dz[lane]);
+                    Vec3 o(rays.ox[lane], rays.oy[lane], rays.oz[lane]);
+                    if (inst == 0)
+                    {
+                        // Солнце видно только с камеры: после отскока его свет пришёл лучом тени
+                        if (bounce == 0)
+                            radiance[lane] = radiance[lane] + Mul(throughput[lane], sunEmission);
+                        alive &= ~(1 << lane);
+                        continue;
+                    }
+
+                    Vec3 albedo = Albedo(hit.triangle[lane], hit.u[lane], hit.v[lane]);
+
+                    // нормаль модели -> мир: поворот на selfAngle вокруг Y
+                    Vec3 nm = meshBvh.Normal(hit.triangle[lane], hit.u[lane], hit.v[lane]);
+                    float cs = spin[inst * 2 + 0], sn = spin[inst * 2 + 1];
+                    Vec3 n = Normalize(Vec3(nm.x * cs - nm.z * sn, nm.y, nm.x * sn + nm.z * cs));
+                    if (Dot(n, d) > 0.0f)
+                        n = n * -1.0f;
+                    Vec3 p = o + d * hit.t[lane] + n * kRayOffset;
+
+                    // луч тени в конус Солнца: albedo / pi * L * cos / pdf, pdf = 1 / (2 pi (1 - cosMax))
+                    Vec3 toSun = sunCenter - p;
+                    float dist2 = Dot(toSun, toSun);
+                    if (dist2 > sunRadius * sunRadius)
+                    {
+                        float dist = std::sqrt(dist2);
+                        float cosMax = std::sqrt(1.0f - sunRadius * sunRadius / dist2);
+                        float cosT = 1.0f - rng[lane].Next() * (1.0f - cosMax);
+                        float sinT = std::sqrt(std::max(0.0f, 1.0f - cosT * cosT));
+                        float phi = 2.0f * kPi * rng[lane].Next();
+                        Vec3 l = AroundAxis(toSun * (1.0f / dist), sinT * std::cos(phi), sinT * std::sin(phi), cosT);
+                        float cosN = Dot(n, l);
+                        if (cosN > 0.0f)
+                        {
+                            shadow.ox[lane] = p.x; shadow.oy[lane] = p.y; shadow.oz[lane] = p.z;
+                            shadow.dx[lane] = l.x; shadow.dy[lane] = l.y; shadow.dz[lane] = l.z;
+                            shadowHit.t[lane] = dist + sunRadius;
+                            sunLight[lane] = Mul(Mul(throughput[lane], albedo), sunEmission) * (cosN * 2.0f * (1.0f - cosMax));
+                            shadowMask |= 1 << lane;
+                        }
+                    }
+
+                    // следующий отскок: косинус сокращается с pdf, остаётся albedo
+                    throughput[lane] = Mul(throughput[lane], albedo);
+                    if (bounce >= 2)
+                    {
+                        // русская рулетка
+                        float keep = std::clamp(std::max(throughput[lane].x, std::max(throughput[lane].y, throughput[lane].z)), 0.05f, 0.95f);
+                        if (rng[lane].Next() > keep)
+                        {
+                            alive &= ~(1 << lane);
+                            continue;
+                        }
+                        throughput[lane] = throughput[lane] * (1.0f / keep);
+                    }
+                    Vec3 next = CosineHemisphere(n, rng[lane].Next(), rng[lane].Next());
+                    rays.ox[lane] = p.x; rays.oy[lane] = p.y; rays.oz[lane] = p.z;
+                    rays.dx[lane] = next.x; rays.dy[lane] = next.y; rays.dz[lane] = next.z;
+                }
+
+                if (shadowMask)
+                {
+                    for (int lane = 0; lane < 4; ++lane)
+                    {
+                        if (!(shadowMask & (1 << lane)))
+                        {
+                            shadowHit.t[lane] = 0.0f;
+                            shadow.ox[lane] = shadow.oy[lane] = shadow.oz[lane] = 0.0f;
+                            shadow.dx[lane] = shadow.dy[lane] = 0.0f;
+                            shadow.dz[lane] = 1.0f;
+                        }
+                    }
+                    // Солнце видно, если ближайшее попадание — оно само
+                    sceneBvh.IntersectPacket(shadow, shadowHit);
+                    for (int lane = 0; lane < 4; ++lane)
+                    {
+                        if (!(shadowMask & (1 << lane)))
+                            continue;
+                        ++stats.rays;
+                        if (shadowHit.instance[lane] == 0)
+                            radiance[lane] = radiance[lane] + sunLight[lane];
+                    }
+                }
+            }
+
+            for (int lane = 0; lane < 4 && x + lane < x1; ++lane)
+            {
+                float* dst = &accum[((size_t)y * width + x + lane) * 3];
+                dst[0] += radiance[lane].x;
+                dst[1] += radiance[lane].y;
+                dst[2] += radiance[lane].z;
+            }
+        }
+    }
+}
+
+sf::Image PathTracer::ToImage() const
+{
+    sf::Image img({ width, height }, sf::Color::Black);
+    float scale = samples ? settings.exposure / samples : 0.0f;
+    for (unsigned y = 0; y < height; ++y)
+    {
+        for (unsigned x = 0; x < width; ++x)
+        {
+            const float* c = &accum[((size_t)y * width + x) * 3];
+            uint8_t rgb[3];
+            for (int k = 0; k < 3; ++k)
+                rgb[k] = (uint8_t)std::lround(std::pow(AcesFilm(c[k] * scale), 1.0f / 2.2f) * 255.0f);
+            img.setPixel({ x, y }, sf::Color(rgb[0], rgb[1], rgb[2]));
+        }
+    }
+    return img;
+}
+
+std::string PathTracer::Summary() const
+{
+    uint64_t rays = 0, stolen = 0;
+    for (const WorkerCounters& c : counters)
+    {
+        rays += c.rays;
+        stolen += c.stolen;
+    }
+    double paths = (double)width * height * samples;
+    double seconds = std::max(renderSeconds, 1e-9);
+    char buf[320];
+    std::snprintf(buf, sizeof(buf),
+        "%ux%u, %u spp, %u bounces, %ux%u tiles on %u threads: %.2f Msamples/s (%.3f per thread), "
+        "%.2f Mrays/s, %llu tiles stolen of %llu in %.1f s; ",
+        width, height, samples, settings.maxBounces, settings.tileSize, settings.tileSize, pool.Size(),
+        paths / seconds * 1e-6, paths / seconds * 1e-6 / pool.Size(), rays / seconds * 1e-6,
+        (unsigned long long)stolen, (unsigned long long)tilesRendered, renderSeconds);
+    return std::string(buf) + "model: " + meshBvh.Summary() + ", scene: " + sceneBvh.Summary();
+}
@@ -0,0 +1,446 @@
+#include "PlanetRings.h"
+
+#include "SceneRendererGL.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    const char* hashGlsl = R"(
+        uint Hash(uint x)
+        {
+            x ^= x >> 16; x *= 0x7feb352du;
+            x ^= x >> 15; x *= 0x846ca68bu;
+            x ^= x >> 16;
+            return x;
+        }
+
+        // k-е случайное число экземпляра в [0, 1]
+        float Rand(uint h, uint k)
+        {
+            return float(Hash(h + k * 0x9E3779B9u) & 0xFFFFu) / 65535.0;
+        }
+    )";
+
+    const char* ringVertexSrc = R"(
+        layout(location = 0) in vec3 aRing;    // cos, sin угла; 0 — внутренний край, 1 — внешний
+        layout(location = 2) in mat4 aModel;   // InstanceData планеты
+
+        layout(std140) uniform Camera
+        {
+            mat4 uView;
+            mat4 uProj;
+        };
+
+        uniform float uFraction;
+        uniform float uBodyRadius;             // радиус модели при масштабе 1
+
+        out vec3 vWorld;
+        out vec3 vNormal;
+        out float vRadial;
+        out float vDepth;
+        flat out uint vSeed;
+
+        vec3 Rotate(vec3 v, vec3 axis, float angle)
+        {
+            float c = cos(angle), s = sin(angle);
+            return v * c + cross(axis, v) * s + axis * dot(axis, v) * (1.0 - c);
+        }
+
+        void main()
+        {
+            uint h = Hash(uint(gl_InstanceID) + 1u);
+            vSeed = h;
+            if (gl_InstanceID == 0 || float(h & 0xFFFFu) >= uFraction * 65536.0)
+            {
+                // без кольца: за дальней плоскостью, отсекается до растеризации
+                gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+                vWorld = vNormal = vec3(0.0);
+                vRadial = vDepth = 0.0;
+                return;
+            }
+
+            // только перенос и масштаб: кольцо не крутится вместе с планетой
+            float r = uBodyRadius * length(aModel[0].xyz);
+            float inner = r * (1.2 + 0.3 * Rand(h, 1u));
+            float outer = inner + r * (0.5 + 0.9 * Rand(h, 2u));
+            float tilt = radians(8.0 + 25.0 * Rand(h, 3u));
+            float azimuth = 6.2831853 * Rand(h, 4u);
+            vec3 axis = vec3(cos(azimuth), 0.0, sin(azimuth));
+
+            vec3 local = vec3(aRing.x, 0.0, aRing.y) * mix(inner, outer, aRing.z);
+            vWorld = aModel[3].xyz + Rotate(local, axis, tilt);
+            vNormal = Rotate(vec3(0.0, 1.0, 0.0), axis, tilt);
+            vRadial = aRing.z;
+            vec4 viewPos = uView * vec4(vWorld, 1.0);
+            vDepth = -viewPos.z;
+            gl_Position = uProj * viewPos;
+        }
+    )";
+
+    const char* ringFragmentSrc = R"(
+        in vec3 vWorld;
+        in vec3 vNormal;
+        in float vRadial;
+        in float vDepth;
+        flat in uint vSeed;
+        layout(location = 0) out vec4 Accum;    // rgb — сумма цвета, a — revealage
+        layout(location = 1) out vec4 Weight;   // r — сумма весов
+
+        uniform bool uLinear;
+
+        void main()
+        {
+            // полосы и щель, как у Сатурна; края мягкие
+            float phase = 6.2831853 * Rand(vSeed, 5u);
+            float density = 0.55 + 0.3 * sin(vRadial * 37.0 + phase) * sin(vRadial * 11.0 + 2.0 * phase);
+            float gap = 0.45 + 0.3 * Rand(vSeed, 6u);
+            density *= smoothstep(0.015, 0.04, abs(vRadial - gap));
+            density *= smoothstep(0.0, 0.08, vRadial) * smoothstep(1.0, 0.9, vRadial);
+            float alpha = clamp(density * (0.5 + 0.4 * Rand(vSeed, 7u)), 0.0, 0.95);
+            if (alpha < 0.004)
+                discard;
+
+            vec3 sand = vec3(0.85, 0.75, 0.58);
+            vec3 ice = vec3(0.75, 0.82, 0.90);
+            vec3 rust = vec3(0.80, 0.55, 0.40);
+            float t = Rand(vSeed, 8u);
+            vec3 color = t < 0.5 ? mix(ice, sand, t * 2.0) : mix(sand, rust, t * 2.0 - 1.0);
+            color *= 0.85 + 0.15 * sin(vRadial * 53.0);
+            if (uLinear)
+                color = pow(color, vec3(2.2));
+
+            // Солнце в начале координат; тонкий слой светится с обеих сторон
+            float lit = 0.15 + 0.85 * abs(dot(normalize(vNormal), normalize(-vWorld)));
+            color *= lit;
+
+            // вес по глубине (McGuire, Bavoil 2013, ур. 10)
+            float w = alpha * clamp(10.0 / (1e-5 + pow(vDepth / 5.0, 2.0) + pow(vDepth / 200.0, 6.0)), 1e-2, 3e3);
+            Accum = vec4(color * w, alpha);
+            Weight = vec4(w, 0.0, 0.0, 0.0);
+        }
+    )";
+
+    const char* compositeVertexSrc = R"(
+        #version 330 core
+        void main()
+        {
+            vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+            gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+        }
+    )";
+
+    const char* compositeFragmentSrc = R"(
+        #version 330 core
+        out vec4 FragColor;
+
+        uniform sampler2D uAccum;
+        uniform sampler2D uWeight;
+        uniform ivec2 uOffset;   // начало viewport цели
+
+        void main()
+        {
+            ivec2 p = ivec2(gl_FragCoord.xy) - uOffset;
+            vec4 accum = texelFetch(uAccum, p, 0);
+            if (accum.a > 0.999)
+                discard;   // колец нет
+            float weight = texelFetch(uWeight, p, 0).r;
+            // смешивание: цвет * (1 - revealage) + сцена * revealage
+            FragColor = vec4(accum.rgb / max(weight, 1e-5), accum.a);
+        }
+    )";
+
+    uint32_t RingHash(uint32_t x)
+    {
+        x ^= x >> 16; x *= 0x7feb352du;
+        x ^= x >> 15; x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    GLuint CheckLinked(GLuint prog)
+    {
+        GLint ok = 0;
+        glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+        if (ok)
+            return prog;
+        glDeleteProgram(prog);
+        return 0;
+    }
+
+    GLuint RenderProgram(const std::string& vertSrc, const std::string& fragSrc)
+    {
+        GLuint vert = CompileShader(GL_VERTEX_SHADER, vertSrc.c_str());
+        GLuint frag = CompileShader(GL_FRAGMENT_SHADER, fragSrc.c_str());
+        GLuint prog = CheckLinked(LinkProgram(vert, frag));
+        glDeleteShader(vert);
+        glDeleteShader(frag);
+        return prog;
+    }
+
+    // формат глубины привязанной цели: blit глубины требует совпадения
+    GLenum TargetDepthFormat(GLint fbo)
+    {
+        GLenum attachment = fbo ? GL_DEPTH_ATTACHMENT : GL_DEPTH;
+        GLint type = GL_NONE;
+        glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER, attachment,
+            GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type);
+        if (type == GL_NONE)
+            return GL_NONE;
+        GLint depthBits = 0, stencilBits = 0, component = GL_UNSIGNED_NORMALIZED;
+        glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER, attachment,
+            GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &depthBits);
+        glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER, attachment,
+            GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &stencilBits);
+        glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER, attachment,
+            GL_FRAMEBUFFER_ATTACHMENT_COMPONENT_TYPE, &component);
+        if (component == GL_FLOAT)
+            return stencilBits ? GL_DEPTH32F_STENCIL8 : GL_DEPTH_COMPONENT32F;
+        if (stencilBits)
+            return GL_DEPTH24_STENCIL8;
+        return depthBits <= 16 ? GL_DEPTH_COMPONENT16 : depthBits <= 24 ? GL_DEPTH_COMPONENT24 : GL_DEPTH_COMPONENT32;
+    }
+
+    void BindCamera(GLuint prog, GLuint cameraBinding)
+    {
+        GLuint block = glGetUniformBlockIndex(prog, "Camera");
+        if (block != GL_INVALID_INDEX)
+            glUniformBlockBinding(prog, block, cameraBinding);
+    }
+}
+
+bool PlanetHasRing(size_t instance, float fraction)
+{
+    uint32_t h = RingHash((uint32_t)instance + 1u);
+    return instance > 0 && (float)(h & 0xFFFFu) < fraction * 65536.0f;
+}
+
+bool PlanetRings::Init(const PlanetRingSettings& s, GLuint cameraBinding)
+{
+    settings = s;
+    settings.fraction = std::clamp(settings.fraction, 0.0f, 1.0f);
+    settings.segments = std::max(8u, settings.segments);
+
+    const std::string version = "#version 330 core\n";
+    ringProg = RenderProgram(version + hashGlsl + ringVertexSrc, version + hashGlsl + ringFragmentSrc);
+    compositeProg = RenderProgram(compositeVertexSrc, compositeFragmentSrc);
+    if (!ringProg || !compositeProg)
+    {
+        Destroy();
+        return false;
+    }
+    BindCamera(ringProg, cameraBinding);
+    ringFractionLoc = glGetUniformLocation(ringProg, "uFraction");
+    ringBodyRadiusLoc = glGetUniformLocation(ringProg, "uBodyRadius");
+    ringLinearLoc = glGetUniformLocation(ringProg, "uLinear");
+    compositeOffsetLoc = glGetUniformLocation(compositeProg, "uOffset");
+    glUseProgram(compositeProg);
+    glUniform1i(glGetUniformLocation(compositeProg, "uAccum"), 0);
+    glUniform1i(glGetUniformLocation(compositeProg, "uWeight"), 1);
+    glUseProgram(0);
+
+    // кольцо — лента из треугольников, внутренний и внешний край по очереди
+    std::vector<float> strip;
+    for (unsigned i = 0; i <= settings.segments; ++i)
+    {
+        float a = 6.2831853f * i / settings.segments;
+        float c = std::cos(a), s = std::sin(a);
+        strip.insert(strip.end(), { c, s, 0.0f, c, s, 1.0f });
+    }
+    ringVertices = (GLsizei)(strip.size() / 3);
+
+    glGenVertexArrays(1, &ringVAO);
+    glGenBuffers(1, &ringVBO);
+    glBindVertexArray(ringVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, ringVBO);
+    glBufferData(GL_ARRAY_BUFFER, strip.size() * sizeof(float), strip.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    for (GLuint col = 0; col < 4; ++col)
+    {
+        glEnableVertexAttribArray(2 + col);
+        glVertexAttribDivisor(2 + col, 1);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glGenVertexArrays(1, &emptyVAO);
+
+    timer.Init(4, true);
+    return true;
+}
+
+void PlanetRings::Allocate(unsigned w, unsigned h, GLenum format)
+{
+    capacityWidth = w;
+    capacityHeight = h;
+    depthFormat = format;
+
+    auto target = [&](GLuint& tex, GLenum internal, GLenum format)
+        {
+            glGenTextures(1, &tex);
+            glBindTexture(GL_TEXTURE_2D, tex);
+            glTexImage2D(GL_TEXTURE_2D, 0, internal, w, h, 0, format, GL_FLOAT, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        };
+    target(accumTex, GL_RGBA16F, GL_RGBA);
+    target(weightTex, GL_R16F, GL_RED);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &depthRB);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRB);
+    glRenderbufferStorage(GL_RENDERBUFFER, format, w, h);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    bool stencil = format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accumTex, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, weightTex, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+        GL_RENDERBUFFER, depthRB);
+    const GLenum buffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, buffers);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Ring OIT target is incomplete: " << w << "x" << h << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void PlanetRings::Free()
+{
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &depthRB);
+    glDeleteTextures(1, &weightTex);
+    glDeleteTextures(1, &accumTex);
+    fbo = depthRB = weightTex = accumTex = 0;
+    capacityWidth = capacityHeight = 0;
+    depthFormat = GL_NONE;
+}
+
+void PlanetRings::Destroy()
+{
+    timer.Destroy();
+    Free();
+    glDeleteVertexArrays(1, &emptyVAO);
+    glDeleteVertexArrays(1, &ringVAO);
+    glDeleteBuffers(1, &ringVBO);
+    glDeleteProgram(compositeProg);
+    glDeleteProgram(ringProg);
+    emptyVAO = ringVAO = ringVBO = 0;
+    compositeProg = ringProg = 0;
+    instanceCount = ringed = 0;
+}
+
+int PlanetRings::Draw(const PlanetRingDraw& in)
+{
+    if (!ringProg || in.instanceCount == 0)
+        return 0;
+    if (in.instanceCount != instanceCount)
+    {
+        instanceCount = in.instanceCount;
+        ringed = 0;
+        for (size_t i = 0; i < instanceCount; ++i)
+            ringed += PlanetHasRing(i, settings.fraction);
+    }
+
+    double ms = 0.0;
+    if (timer.Poll(ms))
+        gpuMs.Add(ms);
+    timer.Begin();
+
+    GLint targetFBO = 0;
+    GLint viewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFBO);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    width = (unsigned)std::max(1, viewport[2]);
+    height = (unsigned)std::max(1, viewport[3]);
+    GLenum targetDepth = TargetDepthFormat(targetFBO);
+    GLenum format = targetDepth != GL_NONE ? targetDepth : GL_DEPTH_COMPONENT24;
+    if (width > capacityWidth || height > capacityHeight || format != depthFormat)
+    {
+        unsigned newW = std::max(width, capacityWidth);
+        unsigned newH = std::max(height, capacityHeight);
+        Free();
+        Allocate(newW, newH, format);
+    }
+
+    // глубина всего непрозрачного кадра — копией из цели, без повтора сцены
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    if (targetDepth != GL_NONE)
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, targetFBO);
+        glBlitFramebuffer(viewport[0], viewport[1], viewport[0] + width, viewport[1] + height,
+            0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    }
+    else
+    {
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+    glViewport(0, 0, width, height);
+    glEnable(GL_DEPTH_TEST);
+
+    const float accumClear[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    const float weightClear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, accumClear);
+    glClearBufferfv(GL_COLOR, 1, weightClear);
+
+    // все кольца одним вызовом, без сортировки: цвет и вес складываются,
+    // revealage умножается на (1 - a)
+    glDepthMask(GL_FALSE);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(ringProg);
+    glUniform1f(ringFractionLoc, settings.fraction);
+    glUniform1f(ringBodyRadiusLoc, in.bodyRadius > 0.0f ? in.bodyRadius : in.mesh->boundingRadius * 0.6f);
+    glUniform1i(ringLinearLoc, in.linearOutput ? 1 : 0);
+    glBindVertexArray(ringVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, in.instanceBuffer);
+    for (GLuint col = 0; col < 4; ++col)
+        glVertexAttribPointer(2 + col, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+            (void*)(in.instanceOffset + col * 4 * sizeof(float)));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, ringVertices, (GLsizei)in.instanceCount);
+
+    // композит поверх сцены
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glDisable(GL_DEPTH_TEST);
+    glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);
+    glUseProgram(compositeProg);
+    glUniform2i(compositeOffsetLoc, viewport[0], viewport[1]);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, weightTex);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, accumTex);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glDisable(GL_BLEND);
+    glEnable(GL_CULL_FACE);
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_TRUE);
+    glUseProgram(0);
+
+    timer.End();
+    return 2;
+}
+
+std::string PlanetRings::Summary() const
+{
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "%zu of %zu planets ringed (%d tris each), OIT %ux%u (RGBA16F + R16F + depth copy), GPU: ",
+        ringed, instanceCount, (int)ringVertices - 2, width, height);
+    return buf + gpuMs.Summary();
+}
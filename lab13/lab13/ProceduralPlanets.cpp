@@ -0,0 +1,527 @@
+#include "ProceduralPlanets.h"
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+
+namespace
+{
+    const char* planetVertexSrc = R"(
+        #version 330 core
+        layout(location = 0) in vec2 aGrid;     // узел сетки, 0..gridSize
+        layout(location = 1) in vec4 aQuad;     // u0, v0 на грани, размер, грань
+        layout(location = 2) in vec4 aPlanet;   // центр, радиус
+        layout(location = 3) in vec4 aLod;      // начало и конец морфинга, поворот, номер планеты
+
+        uniform mat4 uViewProj;
+        uniform vec3 uCamera;
+        uniform float uGridSize;
+        uniform float uAmplitude;
+        uniform samplerCube uHeight;
+
+        out vec3 vWorld;
+        out vec3 vNormal;
+        out float vHeight;
+        flat out int vPlanet;
+
+        // грани куба: нормаль, касательная (u), бинормаль (v); t x b = n
+        const vec3 kNormal[6] = vec3[6](vec3(1, 0, 0), vec3(-1, 0, 0), vec3(0, 1, 0),
+                                        vec3(0, -1, 0), vec3(0, 0, 1), vec3(0, 0, -1));
+        const vec3 kTangent[6] = vec3[6](vec3(0, 0, -1), vec3(0, 0, 1), vec3(1, 0, 0),
+                                         vec3(1, 0, 0), vec3(1, 0, 0), vec3(-1, 0, 0));
+        const vec3 kBitangent[6] = vec3[6](vec3(0, 1, 0), vec3(0, 1, 0), vec3(0, 0, -1),
+                                           vec3(0, 0, 1), vec3(0, 1, 0), vec3(0, 1, 0));
+
+        // чанк: грань, высота гор и свой поворот карты высот у каждой планеты
+        struct Patch
+        {
+            int face;
+            float amplitude;
+            mat3 relief;
+        };
+
+        uint Hash(uint x)
+        {
+            x ^= x >> 16; x *= 0x7feb352du;
+            x ^= x >> 15; x *= 0x846ca68bu;
+            x ^= x >> 16;
+            return x;
+        }
+
+        float Lattice(ivec3 p)
+        {
+            uint h = Hash(uint(p.x) * 73856093u ^ uint(p.y) * 19349663u ^ uint(p.z) * 83492791u);
+            return float(h & 0xFFFFu) / 32767.5 - 1.0;
+        }
+
+        float Noise(vec3 p)
+        {
+            ivec3 i = ivec3(floor(p));
+            vec3 f = fract(p);
+            f = f * f * (3.0 - 2.0 * f);
+            return mix(
+                mix(mix(Lattice(i), Lattice(i + ivec3(1, 0, 0)), f.x),
+                    mix(Lattice(i + ivec3(0, 1, 0)), Lattice(i + ivec3(1, 1, 0)), f.x), f.y),
+                mix(mix(Lattice(i + ivec3(0, 0, 1)), Lattice(i + ivec3(1, 0, 1)), f.x),
+                    mix(Lattice(i + ivec3(0, 1, 1)), Lattice(i + ivec3(1, 1, 1)), f.x), f.y), f.z);
+        }
+
+        vec3 Direction(Patch chunk, vec2 grid)
+        {
+            vec2 uv = aQuad.xy + grid / uGridSize * aQuad.z;
+            return normalize(kNormal[chunk.face] + kTangent[chunk.face] * uv.x + kBitangent[chunk.face] * uv.y);
+        }
+
+        // точка поверхности в системе планеты; h — высота для цвета
+        vec3 Surface(Patch chunk, vec2 grid, out float h)
+        {
+            vec3 dir = Direction(chunk, grid);
+            h = 0.0;
+            if (chunk.amplitude > 0.0)
+            {
+                vec3 d = chunk.relief * dir;
+                h = textureLod(uHeight, d, 0.0).r;
+                // мелкие детали, которых нет в карте высот
+                h += 0.08 * Noise(d * 64.0) + 0.04 * Noise(d * 131.0) + 0.02 * Noise(d * 263.0);
+            }
+            // море ровное
+            return dir * aPlanet.w * (1.0 + chunk.amplitude * max(h, 0.0));
+        }
+
+        void main()
+        {
+            vPlanet = int(aLod.w);
+            float a = aLod.w * 2.39996, b = aLod.w * 1.1;
+            Patch chunk;
+            chunk.face = int(aQuad.w);
+            chunk.amplitude = vPlanet == 0 ? 0.0 : uAmplitude;
+            chunk.relief = mat3(cos(b), sin(b), 0.0, -sin(b), cos(b), 0.0, 0.0, 0.0, 1.0) *
+                           mat3(1.0, 0.0, 0.0, 0.0, cos(a), sin(a), 0.0, -sin(a), cos(a));
+            float c = cos(aLod.z), s = sin(aLod.z);
+            mat3 spin = mat3(c, 0.0, s, 0.0, 1.0, 0.0, -s, 0.0, c);   // Mat4::RotationY
+
+            // морфинг по расстоянию до узла на гладкой сфере — у общих
+            // вершин соседних чанков он одинаковый
+            vec3 sphere = aPlanet.xyz + spin * (Direction(chunk, aGrid) * aPlanet.w);
+            float k = clamp((distance(sphere, uCamera) - aLod.x) / (aLod.y - aLod.x), 0.0, 1.0);
+
+            float h;
+            vec3 p0 = Surface(chunk, aGrid, h);
+            vec3 p = p0;
+            vec2 odd = mod(aGrid, 2.0);
+            if (k > 0.0 && odd != vec2(0.0))
+            {
+                // нечётный узел — к середине между чётными соседями (ребро или
+                // диагональ родительской сетки)
+                float h0, h1;
+                vec3 mid = 0.5 * (Surface(chunk, aGrid - odd, h0) + Surface(chunk, aGrid + odd, h1));
+                p = mix(p, mid, k);
+                h = mix(h, 0.5 * (h0 + h1), k);
+            }
+
+            // нормаль — разности по сетке; шаг растёт с морфингом
+            float stride = 1.0 + k, hx, hy;
+            vec3 px = Surface(chunk, aGrid + vec2(stride, 0.0), hx);
+            vec3 py = Surface(chunk, aGrid + vec2(0.0, stride), hy);
+            vNormal = spin * normalize(cross(px - p0, py - p0));
+
+            vHeight = h;
+            vWorld = aPlanet.xyz + spin * p;
+            gl_Position = uViewProj * vec4(vWorld, 1.0);
+        }
+    )";
+
+    const char* planetFragmentSrc = R"(
+        #version 330 core
+        in vec3 vWorld;
+        in vec3 vNormal;
+        in float vHeight;
+        flat in int vPlanet;
+        layout(location = 0) out vec4 FragColor;
+        layout(location = 1) out uint FragId;   // SceneRenderer::EnableIdOutput
+
+        uniform bool uLinear;
+        uniform float uEmission;
+
+        vec3 Material(vec3 srgb)
+        {
+            return uLinear ? pow(srgb, vec3(2.2)) : srgb;
+        }
+
+        void main()
+        {
+            FragId = uint(vPlanet);
+            if (vPlanet == 0)
+            {
+                FragColor = vec4(Material(vec3(1.0, 0.86, 0.5)) * uEmission, 1.0);
+                return;
+            }
+
+            float h = vHeight;
+            vec3 albedo;
+            if (h < 0.0)
+                albedo = mix(vec3(0.03, 0.10, 0.30), vec3(0.10, 0.32, 0.52), smoothstep(-0.5, 0.0, h));
+            else if (h < 0.05)
+                albedo = vec3(0.72, 0.66, 0.48);
+            else if (h < 0.5)
+                albedo = mix(vec3(0.22, 0.42, 0.16), vec3(0.42, 0.36, 0.28), smoothstep(0.15, 0.45, h));
+            else
+                albedo = mix(vec3(0.42, 0.36, 0.28), vec3(0.92, 0.93, 0.95), smoothstep(0.65, 0.8, h));
+            // у каждой планеты свой оттенок суши, снег белый
+            float tint = fract(float(vPlanet) * 0.618034);
+            if (h >= 0.05)
+                albedo *= mix(vec3(1.0), vec3(1.35, 0.8, 0.6), tint * (1.0 - smoothstep(0.6, 0.8, h)));
+
+            float diffuse = max(dot(normalize(vNormal), normalize(-vWorld)), 0.0);   // Солнце в начале координат
+            FragColor = vec4(Material(albedo) * (0.06 + diffuse), 1.0);
+        }
+    )";
+
+    // грани куба: нормаль, касательная (u), бинормаль (v) — как в шейдере
+    const float kFaces[6][3][3] = {
+        { { 1, 0, 0 }, { 0, 0, -1 }, { 0, 1, 0 } },
+        { { -1, 0, 0 }, { 0, 0, 1 }, { 0, 1, 0 } },
+        { { 0, 1, 0 }, { 1, 0, 0 }, { 0, 0, -1 } },
+        { { 0, -1, 0 }, { 1, 0, 0 }, { 0, 0, 1 } },
+        { { 0, 0, 1 }, { 1, 0, 0 }, { 0, 1, 0 } },
+        { { 0, 0, -1 }, { -1, 0, 0 }, { 0, 1, 0 } },
+    };
+
+    Vec3 CubePoint(int face, float u, float v)
+    {
+        const float (*f)[3] = kFaces[face];
+        return Vec3(f[0][0] + f[1][0] * u + f[2][0] * v,
+            f[0][1] + f[1][1] * u + f[2][1] * v,
+            f[0][2] + f[1][2] * u + f[2][2] * v);
+    }
+
+    // направление текселя (s, t) грани кубической карты по таблице GL
+    Vec3 CubeMapDirection(int face, float s, float t)
+    {
+        switch (face)
+        {
+        case 0: return Vec3(1.0f, -t, -s);
+        case 1: return Vec3(-1.0f, -t, s);
+        case 2: return Vec3(s, 1.0f, t);
+        case 3: return Vec3(s, -1.0f, -t);
+        case 4: return Vec3(s, -t, 1.0f);
+        default: return Vec3(-s, -t, -1.0f);
+        }
+    }
+
+    float Lattice(int x, int y, int z)
+    {
+        uint32_t h = (uint32_t)x * 73856093u ^ (uint32_t)y * 19349663u ^ (uint32_t)z * 83492791u;
+        h ^= h >> 16; h *= 0x7feb352du;
+        h ^= h >> 15; h *= 0x846ca68bu;
+        h ^= h >> 16;
+        return (h & 0xFFFFu) / 32767.5f - 1.0f;
+    }
+
+    float ValueNoise(const Vec3& p)
+    {
+        float fx = std::floor(p.x), fy = std::floor(p.y), fz = std::floor(p.z);
+        int x = (int)fx, y = (int)fy, z = (int)fz;
+        auto smooth = [](float t) { return t * t * (3.0f - 2.0f * t); };
+        float tx = smooth(p.x - fx), ty = smooth(p.y - fy), tz = smooth(p.z - fz);
+        auto lerp = [](float a, float b, float t) { return a + (b - a) * t; };
+        return lerp(
+            lerp(lerp(Lattice(x, y, z), Lattice(x + 1, y, z), tx),
+                lerp(Lattice(x, y + 1, z), Lattice(x + 1, y + 1, z), tx), ty),
+            lerp(lerp(Lattice(x, y, z + 1), Lattice(x + 1, y, z + 1), tx),
+                lerp(Lattice(x, y + 1, z + 1), Lattice(x + 1, y + 1, z + 1), tx), ty), tz);
+    }
+
+    // материки и горы: фрактальный шум, примерно [-1, 1]
+    float TerrainHeight(const Vec3& dir)
+    {
+        float sum = 0.0f, amp = 1.0f, freq = 1.7f;
+        for (int octave = 0; octave < 8; ++octave)
+        {
+            // сдвиг октав убирает совпадение узлов решёток
+            sum += amp * ValueNoise(dir * freq + Vec3(octave * 17.3f, octave * 5.1f, octave * 11.7f));
+            amp *= 0.5f;
+            freq *= 2.03f;
+        }
+        return std::clamp(sum, -1.0f, 1.0f);
+    }
+
+    // Mat4::RotationY
+    Vec3 RotateY(const Vec3& v, float angle)
+    {
+        float c = std::cos(angle), s = std::sin(angle);
+        return Vec3(v.x * c - v.z * s, v.y, v.x * s + v.z * c);
+    }
+}
+
+bool ProceduralPlanets::Init(const ProceduralPlanetSettings& s, ThreadPool& pool)
+{
+    settings = s;
+    settings.gridSize = std::clamp(settings.gridSize & ~1u, 2u, 64u);   // чётная: морфинг по парам
+    settings.maxLevel = std::min(settings.maxLevel, 16u);
+    settings.pixelError = std::max(0.1f, settings.pixelError);
+    settings.heightmapSize = std::clamp(settings.heightmapSize, 16u, 2048u);
+
+    GLuint vert = CompileShader(GL_VERTEX_SHADER, planetVertexSrc);
+    GLuint frag = CompileShader(GL_FRAGMENT_SHADER, planetFragmentSrc);
+    prog = LinkProgram(vert, frag);
+    glDeleteShader(vert);
+    glDeleteShader(frag);
+    GLint ok = 0;
+    glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+    if (!ok)
+    {
+        Destroy();
+        return false;
+    }
+    viewProjLoc = glGetUniformLocation(prog, "uViewProj");
+    cameraLoc = glGetUniformLocation(prog, "uCamera");
+    linearLoc = glGetUniformLocation(prog, "uLinear");
+    emissionLoc = glGetUniformLocation(prog, "uEmission");
+    glUseProgram(prog);
+    glUniform1i(glGetUniformLocation(prog, "uHeight"), 0);
+    glUniform1f(glGetUniformLocation(prog, "uGridSize"), (float)settings.gridSize);
+    glUniform1f(glGetUniformLocation(prog, "uAmplitude"), settings.amplitude);
+    glUseProgram(0);
+
+    // --- одна сетка чанка на все уровни; диагональ квада (i, j) - (i + 1, j + 1) ---
+    unsigned n = settings.gridSize;
+    std::vector<float> grid;
+    for (unsigned j = 0; j <= n; ++j)
+        for (unsigned i = 0; i <= n; ++i)
+            grid.insert(grid.end(), { (float)i, (float)j });
+    std::vector<uint16_t> indices;
+    for (unsigned j = 0; j < n; ++j)
+    {
+        for (unsigned i = 0; i < n; ++i)
+        {
+            uint16_t a = (uint16_t)(j * (n + 1) + i);
+            uint16_t b = (uint16_t)(a + 1);
+            uint16_t c = (uint16_t)(a + n + 2);
+            uint16_t d = (uint16_t)(a + n + 1);
+            indices.insert(indices.end(), { a, b, c, a, c, d });
+        }
+    }
+    gridIndices = (GLsizei)indices.size();
+
+    glGenVertexArrays(1, &gridVAO);
+    glGenBuffers(1, &gridVBO);
+    glGenBuffers(1, &gridEBO);
+    glGenBuffers(1, &chunkVBO);
+    glBindVertexArray(gridVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, gridVBO);
+    glBufferData(GL_ARRAY_BUFFER, grid.size() * sizeof(float), grid.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gridEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, chunkVBO);
+    for (GLuint attr = 1; attr < 4; ++attr)
+    {
+        glEnableVertexAttribArray(attr);
+        glVertexAttribPointer(attr, 4, GL_FLOAT, GL_FALSE, sizeof(Chunk), (void*)((attr - 1) * 4 * sizeof(float)));
+        glVertexAttribDivisor(attr, 1);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    GenerateHeightmap(pool);
+    timer.Init(4, true);
+    return true;
+}
+
+void ProceduralPlanets::GenerateHeightmap(ThreadPool& pool)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    unsigned size = settings.heightmapSize;
+    std::vector<float> texels((size_t)6 * size * size);
+    heightmapThreads = pool.Size();
+    pool.ParallelFor((size_t)6 * size, [&](size_t row, unsigned)
+        {
+            int face = (int)(row / size);
+            unsigned y = (unsigned)(row % size);
+            float t = (y + 0.5f) / size * 2.0f - 1.0f;
+            float* out = &texels[row * size];
+            for (unsigned x = 0; x < size; ++x)
+            {
+                float s = (x + 0.5f) / size * 2.0f - 1.0f;
+                out[x] = TerrainHeight(Normalize(CubeMapDirection(face, s, t)));
+            }
+        });
+
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+    glGenTextures(1, &heightmap);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, heightmap);
+    for (int face = 0; face < 6; ++face)
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_R16F, size, size, 0, GL_RED, GL_FLOAT,
+            &texels[(size_t)face * size * size]);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    heightmapMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void ProceduralPlanets::Destroy()
+{
+    timer.Destroy();
+    glDeleteTextures(1, &heightmap);
+    glDeleteBuffers(1, &chunkVBO);
+    glDeleteBuffers(1, &gridEBO);
+    glDeleteBuffers(1, &gridVBO);
+    glDeleteVertexArrays(1, &gridVAO);
+    glDeleteProgram(prog);
+    heightmap = chunkVBO = gridEBO = gridVBO = gridVAO = prog = 0;
+    chunkCapacity = 0;
+    chunks.clear();
+}
+
+void ProceduralPlanets::SelectNode(int face, float u0, float v0, float size, unsigned level)
+{
+    // угловой радиус узла на сфере
+    float half = size * 0.5f;
+    Vec3 center = Normalize(CubePoint(face, u0 + half, v0 + half));
+    float cosAngle = 1.0f;
+    for (int corner = 0; corner < 4; ++corner)
+    {
+        Vec3 p = Normalize(CubePoint(face, u0 + (corner & 1) * size, v0 + (corner >> 1) * size));
+        cosAngle = std::min(cosAngle, Dot(center, p));
+    }
+    float angle = std::acos(std::clamp(cosAngle, -1.0f, 1.0f));
+
+    // за горизонтом: угол до камеры больше видимой шапки (с учётом гор)
+    float R = planetRadius;
+    float outer = R * (1.0f + relief);
+    float D = Length(cameraLocal);
+    if (D > outer)
+    {
+        float limit = std::acos(R / D) + std::acos(R / outer);
+        float toCamera = std::acos(std::clamp(Dot(center, cameraLocal * (1.0f / D)), -1.0f, 1.0f));
+        if (toCamera - angle > limit)
+            return;
+    }
+
+    // сфера узла: участок поверхности и горы над ним
+    Vec3 local = center * R;
+    float radius = 2.0f * std::sin(angle * 0.5f) * R + relief * R;
+    Vec3 world = planetCenter + RotateY(local, planetSpin);
+    for (int i = 0; i < 6; ++i)
+    {
+        if (planes[i][0] * world.x + planes[i][1] * world.y + planes[i][2] * world.z + planes[i][3] < -radius)
+            return;
+    }
+
+    // шаг сетки уровня (угол клетки у центра грани), спроецированный на ближайшую точку
+    float cell = R * 1.5707963f / (settings.gridSize * (float)(1u << level));
+    float range = cell * projScale / settings.pixelError;
+    float dist = std::max(0.0f, Length(cameraLocal - local) - radius);
+    if (level < settings.maxLevel && dist < range)
+    {
+        SelectNode(face, u0, v0, half, level + 1);
+        SelectNode(face, u0 + half, v0, half, level + 1);
+        SelectNode(face, u0, v0 + half, half, level + 1);
+        SelectNode(face, u0 + half, v0 + half, half, level + 1);
+        return;
+    }
+
+    // морфинг к сетке родителя заканчивается там, где родитель перестаёт делиться
+    float morphEnd = level == 0 ? 1e30f : 2.0f * range;
+    Chunk chunk = {
+        { u0, v0, size, (float)face },
+        { planetCenter.x, planetCenter.y, planetCenter.z, R },
+        { 0.7f * morphEnd, morphEnd, planetSpin, planetIndex },
+    };
+    chunks.push_back(chunk);
+    maxLevelSeen = std::max(maxLevelSeen, level);
+}
+
+size_t ProceduralPlanets::Draw(const std::vector<Planet>& planets, const Mat4& view, const Mat4& proj,
+    bool linearOutput, float emission)
+{
+    if (!prog)
+        return 0;
+
+    double ms = 0.0;
+    if (timer.Poll(ms))
+        gpuMs.Add(ms);
+
+    // --- выбор чанков ---
+    auto t0 = std::chrono::steady_clock::now();
+    Mat4 viewProj = proj * view;
+    FrustumPlanes(viewProj, planes);
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    projScale = proj.m[5] * 0.5f * viewport[3];
+    Mat4 invView = InverseRigid(view);
+    Vec3 camera(invView.m[12], invView.m[13], invView.m[14]);
+
+    chunks.clear();
+    for (size_t i = 0; i < planets.size(); ++i)
+    {
+        const Planet& p = planets[i];
+        planetCenter = PlanetPosition(p);
+        planetRadius = p.scale * settings.radiusScale;
+        planetSpin = p.selfAngle;
+        planetIndex = (float)i;
+        relief = i == 0 ? 0.0f : settings.amplitude;
+        cameraLocal = RotateY(camera - planetCenter, -planetSpin);
+        for (int face = 0; face < 6; ++face)
+            SelectNode(face, -1.0f, -1.0f, 2.0f, 0);
+    }
+    planetCount = planets.size();
+    selectMs.Add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+    chunkCounts.Add((double)chunks.size());
+
+    timer.Begin();
+    if (!chunks.empty())
+    {
+        // буфер экземпляров пересоздаётся каждый кадр: драйвер не ждёт чтения прошлого
+        glBindBuffer(GL_ARRAY_BUFFER, chunkVBO);
+        chunkCapacity = std::max(chunkCapacity, chunks.size());
+        glBufferData(GL_ARRAY_BUFFER, chunkCapacity * sizeof(Chunk), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, chunks.size() * sizeof(Chunk), chunks.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glUseProgram(prog);
+        glUniformMatrix4fv(viewProjLoc, 1, GL_FALSE, viewProj.m);
+        glUniform3f(cameraLoc, camera.x, camera.y, camera.z);
+        glUniform1i(linearLoc, linearOutput ? 1 : 0);
+        glUniform1f(emissionLoc, emission);
+        Redraw();
+    }
+    timer.End();
+    return chunks.size() * (size_t)gridIndices / 3;
+}
+
+void ProceduralPlanets::Redraw() const
+{
+    if (chunks.empty())
+        return;
+    glUseProgram(prog);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, heightmap);
+    glBindVertexArray(gridVAO);
+    glDrawElementsInstanced(GL_TRIANGLES, gridIndices, GL_UNSIGNED_SHORT, nullptr, (GLsizei)chunks.size());
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+}
+
+std::string ProceduralPlanets::Summary() const
+{
+    double meanChunks = chunkCounts.Count() ? chunkCounts.Mean() : 0.0;
+    char buf[320];
+    std::snprintf(buf, sizeof(buf),
+        "%zu planets, %ux%u chunks, %.1f px: %.0f chunks (%.0fk tris) per frame, level <= %u, select %.2f ms; "
+        "heightmap 6 x %u^2 in %.0f ms on %u threads, GPU: ",
+        planetCount, settings.gridSize, settings.gridSize, settings.pixelError, meanChunks,
+        meanChunks * gridIndices / 3 / 1000.0, maxLevelSeen, selectMs.Count() ? selectMs.Mean() : 0.0,
+        settings.heightmapSize, heightmapMs, heightmapThreads);
+    return buf + gpuMs.Summary();
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "FrameStats.h"
+#include "GlUtils.h"
+#include "GpuTimer.h"
+#include "Math3D.h"
+#include "Scene.h"
+#include "ThreadPool.h"
+
+#include <string>
+#include <vector>
+
+// =======================================================
+// ПРОЦЕДУРНЫЕ ПЛАНЕТЫ (CUBE-SPHERE, НЕПРЕРЫВНЫЙ LOD)
+// =======================================================
+//
+// Планета — куб, спроецированный на сферу: на каждой из 6 граней
+// квадродерево чанков. Все чанки всех планет — экземпляры одной
+// сетки gridSize x gridSize: экземпляр задаёт грань, квадрат на ней,
+// планету и диапазон морфинга; положение и рельеф считает вершинный
+// шейдер (кубическая карта высот + мелкие октавы шума в шейдере).
+//
+// Выбор чанков на CPU, каждый кадр: узел делится, пока его ошибка на
+// экране (шаг сетки уровня, спроецированный на ближайшую точку узла)
+// больше pixelError. Узлы за горизонтом планеты и вне пирамиды
+// видимости отбрасываются, поэтому далёкая планета стоит 6 корневых
+// чанков (а то и меньше), а детали получает только близкая.
+//
+// Геоморфинг: нечётные вершины чанка с ростом расстояния плавно
+// сдвигаются на середину отрезка между чётными соседями — к моменту
+// смены уровня сетка совпадает с сеткой родителя, без скачков. Середина
+// (а не «прилипание» к соседу, как в CDLOD) не зависит от направления
+// сетки, поэтому швы между гранями куба не расходятся.
+//
+// Карта высот (фрактальный шум по направлению) генерируется при
+// старте на пуле приложения: строки 6 граней раздаются исполнителям.
+
+struct ProceduralPlanetSettings
+{
+    unsigned gridSize = 16;        // квадов на сторону чанка
+    unsigned maxLevel = 8;         // глубина квадродерева грани
+    float pixelError = 4.0f;       // допустимая ошибка на экране, пикселей
+    float radiusScale = 0.5f;      // радиус сферы при масштабе планеты 1
+    float amplitude = 0.04f;       // высота гор, доля радиуса
+    unsigned heightmapSize = 256;  // текселей на сторону грани карты высот
+};
+
+class ProceduralPlanets
+{
+public:
+    // pool — пул приложения для генерации карты высот
+    bool Init(const ProceduralPlanetSettings& settings, ThreadPool& pool);
+    void Destroy();
+
+    // выбор чанков и отрисовка в текущий framebuffer (цвет + глубина);
+    // свет — от Солнца в начале координат, Солнце (планета 0) светится само;
+    // emission — множитель его свечения (HDR); возвращает число треугольников
+    size_t Draw(const std::vector<Planet>& planets, const Mat4& view, const Mat4& proj,
+        bool linearOutput, float emission);
+    // те же чанки ещё раз (для прохода глубины колец, PlanetRings.h)
+    void Redraw() const;
+
+    float SphereRadius() const { return settings.radiusScale; }
+
+    // "101 planets, 16x16 chunks, 4.0 px: 620 chunks (317k tris), level <= 3, select 0.15 ms;
+    //  heightmap 6 x 256^2 in 40 ms on 8 threads, GPU: <FrameTimeStats>"
+    std::string Summary() const;
+
+private:
+    struct Chunk
+    {
+        float quad[4];     // u0, v0 на грани [-1, 1], размер, грань
+        float planet[4];   // центр, радиус
+        float lod[4];      // начало и конец морфинга (расстояние), поворот планеты, номер планеты
+    };
+
+    void GenerateHeightmap(ThreadPool& pool);
+    void SelectNode(int face, float u0, float v0, float size, unsigned level);
+
+    ProceduralPlanetSettings settings;
+
+    GLuint prog = 0;
+    GLint viewProjLoc = -1;
+    GLint cameraLoc = -1;
+    GLint linearLoc = -1;
+    GLint emissionLoc = -1;
+
+    GLuint gridVAO = 0;
+    GLuint gridVBO = 0;
+    GLuint gridEBO = 0;
+    GLsizei gridIndices = 0;
+    GLuint chunkVBO = 0;
+    size_t chunkCapacity = 0;
+    GLuint heightmap = 0;          // кубическая, R16F
+
+    // --- выбор чанков текущего кадра ---
+    std::vector<Chunk> chunks;
+    float planes[6][4] = {};
+    float projScale = 1.0f;        // пикселей на единицу при расстоянии 1
+    Vec3 cameraLocal;              // камера в системе планеты
+    Vec3 planetCenter;
+    float planetRadius = 0.0f;
+    float planetSpin = 0.0f;
+    float planetIndex = 0.0f;
+    float relief = 0.0f;           // amplitude текущей планеты (у Солнца 0)
+
+    // --- статистика ---
+    double heightmapMs = 0.0;
+    unsigned heightmapThreads = 0;
+    size_t planetCount = 0;
+    FrameTimeStats chunkCounts;
+    FrameTimeStats selectMs;
+    unsigned maxLevelSeen = 0;
+    GpuTimer timer;                // timestamps: может стоять внутри замера кадра
+    FrameTimeStats gpuMs;
+};
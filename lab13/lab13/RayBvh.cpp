@@ -0,0 +1,987 @@
+#include "RayBvh.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define RAY_BVH_SSE2 1
+#endif
+
+Ray CameraRay(const Camera& camera, float x, float y, unsigned w, unsigned h)
+{
+    Vec3 front = camera.Front();
+    Vec3 right = Normalize(Cross(front, kWorldUp));
+    Vec3 up = Cross(right, front);
+    float tanHalf = std::tan(Deg2Rad(kFovY) * 0.5f);
+    float aspect = h == 0 ? 1.0f : (float)w / (float)h;
+    float sx = (2.0f * x / std::max(1u, w) - 1.0f) * tanHalf * aspect;
+    float sy = (1.0f - 2.0f * y / std::max(1u, h)) * tanHalf;
+    return { camera.pos, Normalize(front + right * sx + up * sy) };
+}
+
+bool IntersectPlanetSpheres(const std::vector<Planet>& planets, float radius, const Ray& ray, RayHit& hit)
+{
+    float a = Dot(ray.dir, ray.dir);
+    if (a <= 0.0f)
+        return false;
+    bool found = false;
+    for (size_t i = 0; i < planets.size(); ++i)
+    {
+        // |o + t d - c|^2 = r^2, ближний корень; камера внутри — дальний
+        Vec3 oc = ray.origin - PlanetPosition(planets[i]);
+        float r = radius * planets[i].scale;
+        float b = Dot(oc, ray.dir);
+        float c = Dot(oc, oc) - r * r;
+        float disc = b * b - a * c;
+        if (disc < 0.0f)
+            continue;
+        float root = std::sqrt(disc);
+        float t = (-b - root) / a;
+        if (t <= 0.0f)
+            t = (-b + root) / a;
+        if (t <= 0.0f || t >= hit.t)
+            continue;
+        hit.t = t;
+        hit.instance = (uint32_t)i;
+        hit.triangle = kNoHit;
+        found = true;
+    }
+    return found;
+}
+
+namespace
+{
+    const unsigned kBins = 16;
+    const uint32_t kMaxLeaf = 4;                   // = ширина пакета треугольников
+    const uint32_t kParallelBinning = 1u << 15;    // узлы крупнее — корзины на всех потоках
+    const size_t kBinChunk = (size_t)1 << 14;
+    const int kStackSize = 256;
+
+    float Axis(const Vec3& v, int axis)
+    {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    // --- построение: двоичное дерево по бинированному SAH ---
+
+    struct BuildNode
+    {
+        Aabb box;
+        uint32_t first = 0;
+        uint32_t count = 0;
+        uint32_t left = 0;            // 0 — лист (корень ничей не ребёнок)
+    };
+
+    // примитив переставляется вместе с AABB: разбиение читает память подряд
+    struct PrimRef
+    {
+        Aabb box;
+        uint32_t id;
+
+        Vec3 Centroid() const { return (box.min + box.max) * 0.5f; }
+    };
+
+    struct BuildInput
+    {
+        std::vector<PrimRef>& prims;
+        bool packetLeaves;            // лист до kMaxLeaf проверяется одним пакетом: не делить
+    };
+
+    struct Bins
+    {
+        Aabb box[3][kBins];
+        uint32_t count[3][kBins] = {};
+    };
+
+    struct BinMapping
+    {
+        float origin[3];
+        float scale[3];               // корзин на единицу; 0 — ось вырождена
+        unsigned bins;                // у мелких узлов меньше kBins
+
+        unsigned Bin(const Vec3& c, int axis) const
+        {
+            int b = (int)((Axis(c, axis) - origin[axis]) * scale[axis]);
+            return (unsigned)std::clamp(b, 0, (int)bins - 1);
+        }
+    };
+
+    struct Split
+    {
+        bool leaf = true;
+        uint32_t mid = 0;
+        Aabb left, right;
+    };
+
+    Aabb CentroidBounds(const BuildInput& in, size_t first, size_t last)
+    {
+        Aabb b;
+        for (size_t i = first; i < last; ++i)
+            b.Grow(in.prims[i].Centroid());
+        return b;
+    }
+
+    void Accumulate(const BuildInput& in, size_t first, size_t last, const BinMapping& map, Bins& bins)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            const PrimRef& prim = in.prims[i];
+            Vec3 c = prim.Centroid();
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                unsigned b = map.Bin(c, axis);
+                bins.box[axis][b].Grow(prim.box);
+                ++bins.count[axis][b];
+            }
+        }
+    }
+
+    // pool != nullptr — узел большой, центроиды и корзины считаются
+    // кусками на всех потоках; иначе узел целиком на одном потоке
+    Split FindSplit(BuildInput& in, const BuildNode& node, ThreadPool* pool)
+    {
+        size_t first = node.first, last = (size_t)node.first + node.count;
+        Split split;
+        if (node.count <= 1 || (in.packetLeaves && node.count <= kMaxLeaf))
+            return split;
+
+        Aabb cb;
+        Bins bins;
+        BinMapping map;
+        auto makeMapping = [&]()
+            {
+                map.bins = std::min(kBins, std::max(4u, node.count));
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    float lo = Axis(cb.min, axis);
+                    float extent = Axis(cb.max, axis) - lo;
+                    map.origin[axis] = lo;
+                    map.scale[axis] = extent > 1e-12f ? map.bins / extent * 0.9999f : 0.0f;
+                }
+            };
+        if (pool)
+        {
+            size_t chunks = (node.count + kBinChunk - 1) / kBinChunk;
+            std::vector<Aabb> partialBounds(chunks);
+            pool->ParallelFor(chunks, [&](size_t c, unsigned)
+                {
+                    partialBounds[c] = CentroidBounds(in, first + c * kBinChunk, std::min(last, first + (c + 1) * kBinChunk));
+                });
+            for (const Aabb& b : partialBounds)
+                cb.Grow(b);
+            makeMapping();
+            std::vector<Bins> partialBins(chunks);
+            pool->ParallelFor(chunks, [&](size_t c, unsigned)
+                {
+                    Accumulate(in, first + c * kBinChunk, std::min(last, first + (c + 1) * kBinChunk), map, partialBins[c]);
+                });
+            for (const Bins& p : partialBins)
+            {
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    for (unsigned b = 0; b < kBins; ++b)
+                    {
+                        bins.box[axis][b].Grow(p.box[axis][b]);
+                        bins.count[axis][b] += p.count[axis][b];
+                    }
+                }
+            }
+        }
+        else
+        {
+            cb = CentroidBounds(in, first, last);
+            makeMapping();
+            Accumulate(in, first, last, map, bins);
+        }
+
+        // SAH: площадь * число примитивов по обе стороны плоскости
+        float bestCost = 1e30f;
+        int bestAxis = -1;
+        unsigned bestBin = 0;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (map.scale[axis] == 0.0f)
+                continue;
+            float rightArea[kBins];
+            uint32_t rightCount[kBins];
+            Aabb acc;
+            uint32_t n = 0;
+            for (unsigned b = map.bins - 1; b > 0; --b)
+            {
+                acc.Grow(bins.box[axis][b]);
+                n += bins.count[axis][b];
+                rightArea[b] = n ? acc.HalfArea() : 0.0f;
+                rightCount[b] = n;
+            }
+            acc = Aabb();
+            n = 0;
+            for (unsigned b = 0; b + 1 < map.bins; ++b)
+            {
+                acc.Grow(bins.box[axis][b]);
+                n += bins.count[axis][b];
+                if (n == 0 || rightCount[b + 1] == 0)
+                    continue;
+                float cost = acc.HalfArea() * n + rightArea[b + 1] * rightCount[b + 1];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = b;
+                }
+            }
+        }
+
+        // лист дешевле обхода (стоимость обхода узла = одной проверке)
+        float area = node.box.HalfArea();
+        if (node.count <= kMaxLeaf && (bestAxis < 0 || node.count * area <= area + bestCost))
+            return split;
+
+        split.leaf = false;
+        if (bestAxis < 0)
+        {
+            // все центроиды совпали: пополам по порядку
+            split.mid = (uint32_t)(first + node.count / 2);
+            for (size_t i = first; i < split.mid; ++i)
+                split.left.Grow(in.prims[i].box);
+            for (size_t i = split.mid; i < last; ++i)
+                split.right.Grow(in.prims[i].box);
+            return split;
+        }
+
+        auto mid = std::partition(in.prims.begin() + first, in.prims.begin() + last,
+            [&](const PrimRef& prim) { return map.Bin(prim.Centroid(), bestAxis) <= bestBin; });
+        split.mid = (uint32_t)(mid - in.prims.begin());
+        for (unsigned b = 0; b < map.bins; ++b)
+            (b <= bestBin ? split.left : split.right).Grow(bins.box[bestAxis][b]);
+        return split;
+    }
+
+    // уровень за уровнем: узлы уровня не пересекаются по prims
+    void BuildBinary(BuildInput& in, ThreadPool& pool, std::vector<BuildNode>& out)
+    {
+        out.clear();
+        BuildNode root;
+        root.count = (uint32_t)in.prims.size();
+        for (const PrimRef& prim : in.prims)
+            root.box.Grow(prim.box);
+        out.push_back(root);
+
+        std::vector<uint32_t> frontier = { 0 }, next;
+        std::vector<Split> splits;
+        std::vector<size_t> small;
+        while (!frontier.empty())
+        {
+            splits.assign(frontier.size(), Split());
+            small.clear();
+            for (size_t i = 0; i < frontier.size(); ++i)
+            {
+                if (out[frontier[i]].count >= kParallelBinning)
+                    splits[i] = FindSplit(in, out[frontier[i]], &pool);
+                else
+                    small.push_back(i);
+            }
+            pool.ParallelFor(small.size(), [&](size_t k, unsigned)
+                {
+                    size_t i = small[k];
+                    splits[i] = FindSplit(in, out[frontier[i]], nullptr);
+                });
+
+            next.clear();
+            for (size_t i = 0; i < frontier.size(); ++i)
+            {
+                const Split& s = splits[i];
+                if (s.leaf)
+                    continue;
+                uint32_t parent = frontier[i];
+                uint32_t left = (uint32_t)out.size();
+                BuildNode l, r;
+                l.box = s.left;
+                l.first = out[parent].first;
+                l.count = s.mid - l.first;
+                r.box = s.right;
+                r.first = s.mid;
+                r.count = out[parent].first + out[parent].count - s.mid;
+                out[parent].left = left;
+                out.push_back(l);
+                out.push_back(r);
+                next.push_back(left);
+                next.push_back(left + 1);
+            }
+            frontier.swap(next);
+        }
+    }
+
+    // --- схлопывание в BVH4 ---
+
+    template <typename MakeLeaf>
+    uint32_t Collapse(const std::vector<BuildNode>& bin, uint32_t index, std::vector<Bvh4Node>& out,
+        unsigned level, unsigned& depth, MakeLeaf& makeLeaf)
+    {
+        // дети: раскрываем внутреннего ребёнка с наибольшей площадью, пока их меньше 4
+        uint32_t kids[4];
+        unsigned n = 0;
+        if (bin[index].left == 0)
+        {
+            kids[n++] = index;
+        }
+        else
+        {
+            kids[n++] = bin[index].left;
+            kids[n++] = bin[index].left + 1;
+            while (n < 4)
+            {
+                int best = -1;
+                float bestArea = -1.0f;
+                for (unsigned k = 0; k < n; ++k)
+                {
+                    if (bin[kids[k]].left != 0 && bin[kids[k]].box.HalfArea() > bestArea)
+                    {
+                        best = (int)k;
+                        bestArea = bin[kids[k]].box.HalfArea();
+                    }
+                }
+                if (best < 0)
+                    break;
+                uint32_t left = bin[kids[best]].left;
+                kids[best] = left;
+                kids[n++] = left + 1;
+            }
+        }
+
+        uint32_t self = (uint32_t)out.size();
+        out.emplace_back();
+        depth = std::max(depth, level + 1);
+        for (unsigned k = 0; k < n; ++k)
+        {
+            const BuildNode& c = bin[kids[k]];
+            int32_t ref;
+            uint32_t count = 0;
+            if (c.left == 0)
+            {
+                ref = ~(int32_t)makeLeaf(c);
+                count = c.count;
+            }
+            else
+            {
+                ref = (int32_t)Collapse(bin, kids[k], out, level + 1, depth, makeLeaf);
+            }
+            Bvh4Node& node = out[self];
+            node.minX[k] = c.box.min.x;
+            node.minY[k] = c.box.min.y;
+            node.minZ[k] = c.box.min.z;
+            node.maxX[k] = c.box.max.x;
+            node.maxY[k] = c.box.max.y;
+            node.maxZ[k] = c.box.max.z;
+            node.child[k] = ref;
+            node.count[k] = count;
+        }
+        out[self].childCount = n;
+        return self;
+    }
+
+    // --- обход ---
+
+    float SafeInverse(float d)
+    {
+        return std::fabs(d) > 1e-20f ? 1.0f / d : std::copysign(1e30f, d);
+    }
+
+    // leaf(first, count) для листьев, ближние раньше; t — текущее ближайшее попадание
+    template <typename Leaf>
+    void Traverse(const std::vector<Bvh4Node>& nodes, const Ray& ray, const float& t, Leaf&& leaf)
+    {
+        if (nodes.empty())
+            return;
+        float ix = SafeInverse(ray.dir.x), iy = SafeInverse(ray.dir.y), iz = SafeInverse(ray.dir.z);
+#ifdef RAY_BVH_SSE2
+        const __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+        const __m128 vix = _mm_set1_ps(ix), viy = _mm_set1_ps(iy), viz = _mm_set1_ps(iz);
+#endif
+        uint32_t stack[kStackSize];
+        int sp = 0;
+        stack[sp++] = 0;
+        while (sp > 0)
+        {
+            const Bvh4Node& node = nodes[stack[--sp]];
+            alignas(16) float tNear[4];
+            int mask = 0;
+#ifdef RAY_BVH_SSE2
+            // четыре AABB за раз: плиты по трём осям
+            __m128 x0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minX), ox), vix);
+            __m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxX), ox), vix);
+            __m128 y0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minY), oy), viy);
+            __m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxY), oy), viy);
+            __m128 z0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minZ), oz), viz);
+            __m128 z1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxZ), oz), viz);
+            __m128 tmin = _mm_max_ps(_mm_max_ps(_mm_min_ps(x0, x1), _mm_min_ps(y0, y1)),
+                _mm_max_ps(_mm_min_ps(z0, z1), _mm_setzero_ps()));
+            __m128 tmax = _mm_min_ps(_mm_min_ps(_mm_max_ps(x0, x1), _mm_max_ps(y0, y1)),
+                _mm_min_ps(_mm_max_ps(z0, z1), _mm_set1_ps(t)));
+            mask = _mm_movemask_ps(_mm_cmple_ps(tmin, tmax));
+            _mm_store_ps(tNear, tmin);
+#else
+            for (int k = 0; k < 4; ++k)
+            {
+                float x0 = (node.minX[k] - ray.origin.x) * ix, x1 = (node.maxX[k] - ray.origin.x) * ix;
+                float y0 = (node.minY[k] - ray.origin.y) * iy, y1 = (node.maxY[k] - ray.origin.y) * iy;
+                float z0 = (node.minZ[k] - ray.origin.z) * iz, z1 = (node.maxZ[k] - ray.origin.z) * iz;
+                float tmin = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), 0.0f));
+                float tmax = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::min(std::max(z0, z1), t));
+                tNear[k] = tmin;
+                if (tmin <= tmax)
+                    mask |= 1 << k;
+            }
+#endif
+            mask &= (1 << node.childCount) - 1;
+            if (!mask)
+                continue;
+
+            // попавшие дети по возрастанию расстояния до входа
+            int hits[4];
+            int n = 0;
+            for (int k = 0; k < 4; ++k)
+            {
+                if (!(mask & (1 << k)))
+                    continue;
+                int j = n++;
+                while (j > 0 && tNear[hits[j - 1]] > tNear[k])
+                {
+                    hits[j] = hits[j - 1];
+                    --j;
+                }
+                hits[j] = k;
+            }
+            for (int j = 0; j < n; ++j)
+            {
+                int k = hits[j];
+                if (node.child[k] < 0 && tNear[k] <= t)
+                    leaf((uint32_t)~node.child[k], node.count[k]);
+            }
+            // внутренние: дальние в стек первыми
+            for (int j = n - 1; j >= 0; --j)
+            {
+                int k = hits[j];
+                if (node.child[k] >= 0 && sp < kStackSize)
+                    stack[sp++] = (uint32_t)node.child[k];
+            }
+        }
+    }
+
+    // пакет: дорожки — 4 луча, дети узла по одному; leaf(first, count, mask)
+    // получает лучи, задевшие AABB листа; t[lane] == 0 — луч выключен
+    template <typename Leaf>
+    void TraversePacket(const std::vector<Bvh4Node>& nodes, const RayPacket& rays, const float* t, Leaf&& leaf)
+    {
+        if (nodes.empty())
+            return;
+        int active = 0;
+        alignas(16) float ix[4], iy[4], iz[4];
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            ix[lane] = SafeInverse(rays.dx[lane]);
+            iy[lane] = SafeInverse(rays.dy[lane]);
+            iz[lane] = SafeInverse(rays.dz[lane]);
+            if (t[lane] > 0.0f)
+                active |= 1 << lane;
+        }
+        if (!active)
+            return;
+#ifdef RAY_BVH_SSE2
+        const __m128 ox = _mm_load_ps(rays.ox), oy = _mm_load_ps(rays.oy), oz = _mm_load_ps(rays.oz);
+        const __m128 vix = _mm_load_ps(ix), viy = _mm_load_ps(iy), viz = _mm_load_ps(iz);
+#endif
+        struct Entry
+        {
+            uint32_t node;
+            int mask;
+        };
+        Entry stack[kStackSize];
+        int sp = 0;
+        stack[sp++] = { 0, active };
+        while (sp > 0)
+        {
+            Entry entry = stack[--sp];
+            const Bvh4Node& node = nodes[entry.node];
+            int masks[4] = {};
+            float nearest[4];
+            int hits[4];
+            int n = 0;
+#ifdef RAY_BVH_SSE2
+            const __m128 tFar = _mm_load_ps(t);
+#endif
+            for (uint32_t k = 0; k < node.childCount; ++k)
+            {
+                alignas(16) float tNear[4];
+                int mask = 0;
+#ifdef RAY_BVH_SSE2
+                // одна AABB против четырёх лучей
+                __m128 x0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.minX[k]), ox), vix);
+                __m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.maxX[k]), ox), vix);
+                __m128 y0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.minY[k]), oy), viy);
+                __m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.maxY[k]), oy), viy);
+                __m128 z0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.minZ[k]), oz), viz);
+                __m128 z1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.maxZ[k]), oz), viz);
+                __m128 tmin = _mm_max_ps(_mm_max_ps(_mm_min_ps(x0, x1), _mm_min_ps(y0, y1)),
+                    _mm_max_ps(_mm_min_ps(z0, z1), _mm_setzero_ps()));
+                __m128 tmax = _mm_min_ps(_mm_min_ps(_mm_max_ps(x0, x1), _mm_max_ps(y0, y1)),
+                    _mm_min_ps(_mm_max_ps(z0, z1), tFar));
+                mask = _mm_movemask_ps(_mm_cmple_ps(tmin, tmax)) & entry.mask;
+                _mm_store_ps(tNear, tmin);
+#else
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    if (!(entry.mask & (1 << lane)))
+                        continue;
+                    float x0 = (node.minX[k] - rays.ox[lane]) * ix[lane], x1 = (node.maxX[k] - rays.ox[lane]) * ix[lane];
+                    float y0 = (node.minY[k] - rays.oy[lane]) * iy[lane], y1 = (node.maxY[k] - rays.oy[lane]) * iy[lane];
+                    float z0 = (node.minZ[k] - rays.oz[lane]) * iz[lane], z1 = (node.maxZ[k] - rays.oz[lane]) * iz[lane];
+                    float tmin = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), 0.0f));
+                    float tmax = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::min(std::max(z0, z1), t[lane]));
+                    tNear[lane] = tmin;
+                    if (tmin <= tmax)
+                        mask |= 1 << lane;
+                }
+#endif
+                if (!mask)
+                    continue;
+
+                // порядок детей — по ближайшему входу среди лучей пакета
+                float d = 1e30f;
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    if (mask & (1 << lane))
+                        d = std::min(d, tNear[lane]);
+                }
+                masks[k] = mask;
+                nearest[k] = d;
+                int j = n++;
+                while (j > 0 && nearest[hits[j - 1]] > d)
+                {
+                    hits[j] = hits[j - 1];
+                    --j;
+                }
+                hits[j] = (int)k;
+            }
+
+            for (int j = 0; j < n; ++j)
+            {
+                int k = hits[j];
+                if (node.child[k] < 0)
+                    leaf((uint32_t)~node.child[k], node.count[k], masks[k]);
+            }
+            for (int j = n - 1; j >= 0; --j)
+            {
+                int k = hits[j];
+                if (node.child[k] >= 0 && sp < kStackSize)
+                    stack[sp++] = { (uint32_t)node.child[k], masks[k] };
+            }
+        }
+    }
+}
+
+// ---------------- MeshBvh ----------------
+
+void MeshBvh::Build(const MeshData& mesh, ThreadPool& pool)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    size_t triCount = mesh.TriangleCount();
+    std::vector<PrimRef> prims(triCount);
+    triangleUV.assign(triCount * 6, 0.0f);
+    triangleNormal.assign(triCount * 3, Vec3());
+    bounds = Aabb();
+    bool smooth = mesh.normals.size() == mesh.positions.size();
+    for (size_t t = 0; t < triCount; ++t)
+    {
+        const uint32_t* idx = &mesh.indices[t * 3];
+        Vec3 face = Cross(mesh.positions[idx[1]] - mesh.positions[idx[0]], mesh.positions[idx[2]] - mesh.positions[idx[0]]);
+        for (int c = 0; c < 3; ++c)
+        {
+            uint32_t vi = idx[c];
+            prims[t].box.Grow(mesh.positions[vi]);
+            if (mesh.texcoords.size() >= (size_t)(vi + 1) * 2)
+            {
+                triangleUV[t * 6 + c * 2 + 0] = mesh.texcoords[vi * 2 + 0];
+                triangleUV[t * 6 + c * 2 + 1] = mesh.texcoords[vi * 2 + 1];
+            }
+            triangleNormal[t * 3 + c] = smooth ? mesh.normals[vi] : face;
+        }
+        prims[t].id = (uint32_t)t;
+        bounds.Grow(prims[t].box);
+    }
+
+    BuildInput in{ prims, true };
+    std::vector<BuildNode> binary;
+    BuildBinary(in, pool, binary);
+
+    // лист — один пакет; пустые дорожки с нулевыми рёбрами не пересекаются
+    packets.clear();
+    auto makeLeaf = [&](const BuildNode& leaf) -> uint32_t
+        {
+            TrianglePacket p = {};
+            for (uint32_t lane = 0; lane < 4; ++lane)
+            {
+                p.id[lane] = kNoHit;
+                if (lane >= leaf.count)
+                    continue;
+                uint32_t t = prims[leaf.first + lane].id;
+                const Vec3& a = mesh.positions[mesh.indices[t * 3 + 0]];
+                Vec3 e1 = mesh.positions[mesh.indices[t * 3 + 1]] - a;
+                Vec3 e2 = mesh.positions[mesh.indices[t * 3 + 2]] - a;
+                p.v0x[lane] = a.x;  p.v0y[lane] = a.y;  p.v0z[lane] = a.z;
+                p.e1x[lane] = e1.x; p.e1y[lane] = e1.y; p.e1z[lane] = e1.z;
+                p.e2x[lane] = e2.x; p.e2y[lane] = e2.y; p.e2z[lane] = e2.z;
+                p.id[lane] = t;
+            }
+            packets.push_back(p);
+            return (uint32_t)(packets.size() - 1);
+        };
+    nodes.clear();
+    depth = 0;
+    if (triCount > 0)
+        Collapse(binary, 0, nodes, 0, depth, makeLeaf);
+    buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+bool MeshBvh::Intersect(const Ray& ray, RayHit& hit) const
+{
+    bool found = false;
+    const float kMinT = 1e-6f;
+    Traverse(nodes, ray, hit.t, [&](uint32_t first, uint32_t)
+        {
+            const TrianglePacket& p = packets[first];
+            alignas(16) float tt[4], uu[4], vv[4];
+            int mask = 0;
+#ifdef RAY_BVH_SSE2
+            // Мёллер — Трумбор по 4 треугольникам
+            __m128 dx = _mm_set1_ps(ray.dir.x), dy = _mm_set1_ps(ray.dir.y), dz = _mm_set1_ps(ray.dir.z);
+            __m128 e1x = _mm_load_ps(p.e1x), e1y = _mm_load_ps(p.e1y), e1z = _mm_load_ps(p.e1z);
+            __m128 e2x = _mm_load_ps(p.e2x), e2y = _mm_load_ps(p.e2y), e2z = _mm_load_ps(p.e2z);
+            __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+            __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+            __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+            __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+            __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), det);
+            __m128 sx = _mm_sub_ps(_mm_set1_ps(ray.origin.x), _mm_load_ps(p.v0x));
+            __m128 sy = _mm_sub_ps(_mm_set1_ps(ray.origin.y), _mm_load_ps(p.v0y));
+            __m128 sz = _mm_sub_ps(_mm_set1_ps(ray.origin.z), _mm_load_ps(p.v0z));
+            __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inv);
+            __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+            __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+            __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+            __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inv);
+            __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inv);
+
+            __m128 absDet = _mm_and_ps(det, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)));
+            __m128 ok = _mm_cmpgt_ps(absDet, _mm_set1_ps(1e-12f));
+            ok = _mm_and_ps(ok, _mm_cmpge_ps(u, _mm_setzero_ps()));
+            ok = _mm_and_ps(ok, _mm_cmpge_ps(v, _mm_setzero_ps()));
+            ok = _mm_and_ps(ok, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+            ok = _mm_and_ps(ok, _mm_cmpgt_ps(t, _mm_set1_ps(kMinT)));
+            ok = _mm_and_ps(ok, _mm_cmplt_ps(t, _mm_set1_ps(hit.t)));
+            mask = _mm_movemask_ps(ok);
+            if (!mask)
+                return;
+            _mm_store_ps(tt, t);
+            _mm_store_ps(uu, u);
+            _mm_store_ps(vv, v);
+#else
+            const Vec3& d = ray.dir;
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                Vec3 e1(p.e1x[lane], p.e1y[lane], p.e1z[lane]);
+                Vec3 e2(p.e2x[lane], p.e2y[lane], p.e2z[lane]);
+                Vec3 pv = Cross(d, e2);
+                float det = Dot(e1, pv);
+                if (std::fabs(det) <= 1e-12f)
+                    continue;
+                float inv = 1.0f / det;
+                Vec3 s = ray.origin - Vec3(p.v0x[lane], p.v0y[lane], p.v0z[lane]);
+                float u = Dot(s, pv) * inv;
+                Vec3 q = Cross(s, e1);
+                float v = Dot(d, q) * inv;
+                float t = Dot(e2, q) * inv;
+                if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t > kMinT && t < hit.t)
+                {
+                    mask |= 1 << lane;
+                    tt[lane] = t;
+                    uu[lane] = u;
+                    vv[lane] = v;
+                }
+            }
+#endif
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                if ((mask & (1 << lane)) && tt[lane] < hit.t)
+                {
+                    hit.t = tt[lane];
+                    hit.u = uu[lane];
+                    hit.v = vv[lane];
+                    hit.triangle = p.id[lane];
+                    found = true;
+                }
+            }
+        });
+    return found;
+}
+
+int MeshBvh::IntersectPacket(const RayPacket& rays, PacketHit& hit) const
+{
+    int found = 0;
+    const float kMinT = 1e-6f;
+    TraversePacket(nodes, rays, hit.t, [&](uint32_t first, uint32_t, int mask)
+        {
+            const TrianglePacket& p = packets[first];
+#ifdef RAY_BVH_SSE2
+            const __m128 dx = _mm_load_ps(rays.dx), dy = _mm_load_ps(rays.dy), dz = _mm_load_ps(rays.dz);
+            const __m128 ox = _mm_load_ps(rays.ox), oy = _mm_load_ps(rays.oy), oz = _mm_load_ps(rays.oz);
+#endif
+            // пустые дорожки пакета треугольников — в конце
+            for (int tri = 0; tri < 4 && p.id[tri] != kNoHit; ++tri)
+            {
+                alignas(16) float tt[4], uu[4], vv[4];
+                int m = 0;
+#ifdef RAY_BVH_SSE2
+                // Мёллер — Трумбор: один треугольник, 4 луча
+                __m128 e1x = _mm_set1_ps(p.e1x[tri]), e1y = _mm_set1_ps(p.e1y[tri]), e1z = _mm_set1_ps(p.e1z[tri]);
+                __m128 e2x = _mm_set1_ps(p.e2x[tri]), e2y = _mm_set1_ps(p.e2y[tri]), e2z = _mm_set1_ps(p.e2z[tri]);
+                __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+                __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+                __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+                __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+                __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), det);
+                __m128 sx = _mm_sub_ps(ox, _mm_set1_ps(p.v0x[tri]));
+                __m128 sy = _mm_sub_ps(oy, _mm_set1_ps(p.v0y[tri]));
+                __m128 sz = _mm_sub_ps(oz, _mm_set1_ps(p.v0z[tri]));
+                __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inv);
+                __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+                __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+                __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+                __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inv);
+                __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inv);
+
+                __m128 absDet = _mm_and_ps(det, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)));
+                __m128 ok = _mm_cmpgt_ps(absDet, _mm_set1_ps(1e-12f));
+                ok = _mm_and_ps(ok, _mm_cmpge_ps(u, _mm_setzero_ps()));
+                ok = _mm_and_ps(ok, _mm_cmpge_ps(v, _mm_setzero_ps()));
+                ok = _mm_and_ps(ok, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+                ok = _mm_and_ps(ok, _mm_cmpgt_ps(t, _mm_set1_ps(kMinT)));
+                ok = _mm_and_ps(ok, _mm_cmplt_ps(t, _mm_load_ps(hit.t)));
+                m = _mm_movemask_ps(ok) & mask;
+                if (!m)
+                    continue;
+                _mm_store_ps(tt, t);
+                _mm_store_ps(uu, u);
+                _mm_store_ps(vv, v);
+#else
+                Vec3 e1(p.e1x[tri], p.e1y[tri], p.e1z[tri]);
+                Vec3 e2(p.e2x[tri], p.e2y[tri], p.e2z[tri]);
+                Vec3 v0(p.v0x[tri], p.v0y[tri], p.v0z[tri]);
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    if (!(mask & (1 << lane)))
+                        continue;
+                    Vec3 d(rays.dx[lane], rays.dy[lane], rays.dz[lane]);
+                    Vec3 pv = Cross(d, e2);
+                    float det = Dot(e1, pv);
+                    if (std::fabs(det) <= 1e-12f)
+                        continue;
+                    float inv = 1.0f / det;
+                    Vec3 s = Vec3(rays.ox[lane], rays.oy[lane], rays.oz[lane]) - v0;
+                    float u = Dot(s, pv) * inv;
+                    Vec3 q = Cross(s, e1);
+                    float v = Dot(d, q) * inv;
+                    float t = Dot(e2, q) * inv;
+                    if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t > kMinT && t < hit.t[lane])
+                    {
+                        m |= 1 << lane;
+                        tt[lane] = t;
+                        uu[lane] = u;
+                        vv[lane] = v;
+                    }
+                }
+#endif
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    if (!(m & (1 << lane)))
+                        continue;
+                    hit.t[lane] = tt[lane];
+                    hit.u[lane] = uu[lane];
+                    hit.v[lane] = vv[lane];
+                    hit.triangle[lane] = p.id[tri];
+                }
+                found |= m;
+            }
+        });
+    return found;
+}
+
+void MeshBvh::TexCoord(uint32_t triangle, float u, float v, float uv[2]) const
+{
+    const float* t = &triangleUV[(size_t)triangle * 6];
+    float w = 1.0f - u - v;
+    uv[0] = w * t[0] + u * t[2] + v * t[4];
+    uv[1] = w * t[1] + u * t[3] + v * t[5];
+}
+
+Vec3 MeshBvh::Normal(uint32_t triangle, float u, float v) const
+{
+    const Vec3* n = &triangleNormal[(size_t)triangle * 3];
+    return n[0] * (1.0f - u - v) + n[1] * u + n[2] * v;
+}
+
+std::string MeshBvh::Summary() const
+{
+    char buf[160];
+    std::snprintf(buf, sizeof(buf), "%zu tris, %zu nodes, %zu leaves, depth %u, SAH %u bins, built in %.1f ms",
+        TriangleCount(), nodes.size(), packets.size(), depth, kBins, buildMs);
+    return buf;
+}
+
+// ---------------- SceneBvh ----------------
+
+void SceneBvh::Build(const std::vector<Planet>& planets, const MeshBvh& meshBvh, ThreadPool& pool)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    mesh = &meshBvh;
+    threads = pool.Size();
+    size_t count = planets.size();
+    std::vector<PrimRef> prims(count);
+
+    // мировой AABB — по 8 углам AABB модели
+    const Aabb& local = meshBvh.Bounds();
+    size_t chunks = (count + kBinChunk - 1) / kBinChunk;
+    pool.ParallelFor(chunks, [&](size_t c, unsigned)
+        {
+            size_t end = std::min(count, (c + 1) * kBinChunk);
+            for (size_t i = c * kBinChunk; i < end; ++i)
+            {
+                const Planet& p = planets[i];
+                Vec3 pos = PlanetPosition(p);
+                float cs = std::cos(p.selfAngle), sn = std::sin(p.selfAngle);
+                Aabb box;
+                for (int corner = 0; corner < 8; ++corner)
+                {
+                    float x = (corner & 1) ? local.max.x : local.min.x;
+                    float y = (corner & 2) ? local.max.y : local.min.y;
+                    float z = (corner & 4) ? local.max.z : local.min.z;
+                    // Mat4::RotationY, затем масштаб и сдвиг
+                    box.Grow(pos + Vec3(x * cs - z * sn, y, x * sn + z * cs) * p.scale);
+                }
+                prims[i].box = box;
+                prims[i].id = (uint32_t)i;
+            }
+        });
+
+    BuildInput in{ prims, false };
+    std::vector<BuildNode> binary;
+    BuildBinary(in, pool, binary);
+
+    nodes.clear();
+    depth = 0;
+    auto makeLeaf = [](const BuildNode& leaf) -> uint32_t { return leaf.first; };
+    if (count > 0)
+        Collapse(binary, 0, nodes, 0, depth, makeLeaf);
+
+    // обратные преобразования в порядке листьев — рядом в памяти при обходе
+    order.resize(count);
+    inverses.resize(count);
+    pool.ParallelFor(chunks, [&](size_t c, unsigned)
+        {
+            size_t end = std::min(count, (c + 1) * kBinChunk);
+            for (size_t i = c * kBinChunk; i < end; ++i)
+            {
+                order[i] = prims[i].id;
+                const Planet& p = planets[order[i]];
+                Vec3 pos = PlanetPosition(p);
+                InstanceInverse& inv = inverses[i];
+                inv.position[0] = pos.x;
+                inv.position[1] = pos.y;
+                inv.position[2] = pos.z;
+                inv.cosA = std::cos(p.selfAngle);
+                inv.sinA = std::sin(p.selfAngle);
+                inv.invScale = p.scale != 0.0f ? 1.0f / p.scale : 0.0f;
+            }
+        });
+    buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+bool SceneBvh::Intersect(const Ray& ray, RayHit& hit) const
+{
+    if (!mesh)
+        return false;
+    bool found = false;
+    Traverse(nodes, ray, hit.t, [&](uint32_t first, uint32_t count)
+        {
+            for (uint32_t i = first; i < first + count; ++i)
+            {
+                // в систему модели: сдвиг, поворот на -selfAngle, масштаб
+                const InstanceInverse& inv = inverses[i];
+                Vec3 o(ray.origin.x - inv.position[0], ray.origin.y - inv.position[1], ray.origin.z - inv.position[2]);
+                const Vec3& d = ray.dir;
+                Ray local;
+                local.origin = Vec3(o.x * inv.cosA + o.z * inv.sinA, o.y, o.z * inv.cosA - o.x * inv.sinA) * inv.invScale;
+                local.dir = Vec3(d.x * inv.cosA + d.z * inv.sinA, d.y, d.z * inv.cosA - d.x * inv.sinA) * inv.invScale;
+                if (mesh->Intersect(local, hit))
+                {
+                    hit.instance = order[i];
+                    found = true;
+                }
+            }
+        });
+    return found;
+}
+
+int SceneBvh::IntersectPacket(const RayPacket& rays, PacketHit& hit) const
+{
+    if (!mesh)
+        return 0;
+    int found = 0;
+    TraversePacket(nodes, rays, hit.t, [&](uint32_t first, uint32_t count, int mask)
+        {
+            for (uint32_t i = first; i < first + count; ++i)
+            {
+                // все 4 луча в систему планеты; лучи мимо листа выключены
+                const InstanceInverse& inv = inverses[i];
+                RayPacket local;
+                PacketHit sub = hit;
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    float ox = rays.ox[lane] - inv.position[0];
+                    float oy = rays.oy[lane] - inv.position[1];
+                    float oz = rays.oz[lane] - inv.position[2];
+                    local.ox[lane] = (ox * inv.cosA + oz * inv.sinA) * inv.invScale;
+                    local.oy[lane] = oy * inv.invScale;
+                    local.oz[lane] = (oz * inv.cosA - ox * inv.sinA) * inv.invScale;
+                    local.dx[lane] = (rays.dx[lane] * inv.cosA + rays.dz[lane] * inv.sinA) * inv.invScale;
+                    local.dy[lane] = rays.dy[lane] * inv.invScale;
+                    local.dz[lane] = (rays.dz[lane] * inv.cosA - rays.dx[lane] * inv.sinA) * inv.invScale;
+                    if (!(mask & (1 << lane)))
+                        sub.t[lane] = 0.0f;
+                }
+                int m = mesh->IntersectPacket(local, sub);
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    if (!(m & (1 << lane)))
+                        continue;
+                    hit.t[lane] = sub.t[lane];
+                    hit.u[lane] = sub.u[lane];
+                    hit.v[lane] = sub.v[lane];
+                    hit.triangle[lane] = sub.triangle[lane];
+                    hit.instance[lane] = order[i];
+                }
+                found |= m;
+            }
+        });
+    return found;
+}
+
+std::string SceneBvh::Summary() const
+{
+    char buf[160];
+    std::snprintf(buf, sizeof(buf), "%zu instances, %zu nodes, depth %u, built in %.1f ms on %u threads",
+        order.size(), nodes.size(), depth, buildMs, threads);
+    return buf;
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "Math3D.h"
+#include "MeshData.h"
+#include "Scene.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// =======================================================
+// BVH ДЛЯ ЛУЧЕЙ (ВЫБОР МЫШЬЮ, ЭТАЛОННАЯ ТРАССИРОВКА)
+// =======================================================
+//
+// Два уровня: MeshBvh — по треугольникам модели LoadOBJ (в системе
+// модели, строится один раз), SceneBvh — по экземплярам-планетам
+// (мировые AABB модели, перестраивается, когда планеты сдвинулись).
+// Луч в лист SceneBvh переводится в систему планеты обратным
+// преобразованием (сдвиг, поворот вокруг Y, масштаб) и идёт в MeshBvh;
+// параметр t при этом не меняется, направление не нормируется.
+//
+// Построение: бинированный SAH (16 корзин по каждой оси) даёт двоичное
+// дерево, которое затем схлопывается в 4-арное. Узлы одного уровня
+// независимы (у каждого свой отрезок order) и строятся параллельно;
+// большие узлы у корня раскладываются по корзинам кусками на всех
+// потоках пула.
+//
+// Обход: узел BVH4 хранит AABB четырёх детей в SoA, и луч проверяется
+// со всеми четырьмя одной SSE-инструкцией на шаг; лист MeshBvh — пакет
+// до 4 треугольников, Мёллер — Трумбор тоже по 4 дорожкам. Без SSE2 —
+// те же формулы скалярно.
+//
+// Пакетный обход (IntersectPacket) — наоборот: 4 луча в дорожках SSE,
+// дети узла и треугольники листа перебираются по одному. Узел
+// загружается один раз на 4 луча, что окупается на соседних пикселях
+// (трассировщик путей, PathTracer.h); маска дорожек сужается по пути
+// вниз, узел без попаданий ни одного луча пропускается.
+
+struct Aabb
+{
+    Vec3 min = Vec3(1e30f, 1e30f, 1e30f);
+    Vec3 max = Vec3(-1e30f, -1e30f, -1e30f);
+
+    void Grow(const Vec3& p)
+    {
+        min = Vec3(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+        max = Vec3(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+    }
+    void Grow(const Aabb& b)
+    {
+        min = Vec3(std::min(min.x, b.min.x), std::min(min.y, b.min.y), std::min(min.z, b.min.z));
+        max = Vec3(std::max(max.x, b.max.x), std::max(max.y, b.max.y), std::max(max.z, b.max.z));
+    }
+    float HalfArea() const
+    {
+        Vec3 e = max - min;
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+};
+
+struct Ray
+{
+    Vec3 origin;
+    Vec3 dir;   // не обязательно единичный
+};
+
+const uint32_t kNoHit = 0xFFFFFFFFu;
+
+struct RayHit
+{
+    float t = 1e30f;              // ближе этого попадания не ищутся
+    uint32_t instance = kNoHit;   // планета (SceneBvh)
+    uint32_t triangle = kNoHit;   // треугольник модели
+    float u = 0.0f;               // барицентрические: вершины 1 и 2
+    float v = 0.0f;
+};
+
+// луч из камеры через точку (x, y) окна w x h (пиксели, y вниз)
+Ray CameraRay(const Camera& camera, float x, float y, unsigned w, unsigned h);
+
+// ближайшая планета-сфера радиуса radius * scale вокруг PlanetPosition —
+// для процедурных планет (ProceduralPlanets::SphereRadius), у которых нет
+// треугольников модели; перебором, hit.triangle остаётся kNoHit
+bool IntersectPlanetSpheres(const std::vector<Planet>& planets, float radius, const Ray& ray, RayHit& hit);
+
+// 4 луча в SoA для пакетного обхода
+struct alignas(16) RayPacket
+{
+    float ox[4], oy[4], oz[4];
+    float dx[4], dy[4], dz[4];
+};
+
+// попадания пакета; t[lane] == 0 — дорожка выключена
+struct alignas(16) PacketHit
+{
+    float t[4] = { 1e30f, 1e30f, 1e30f, 1e30f };
+    uint32_t instance[4] = { kNoHit, kNoHit, kNoHit, kNoHit };
+    uint32_t triangle[4] = { kNoHit, kNoHit, kNoHit, kNoHit };
+    float u[4] = {};
+    float v[4] = {};
+};
+
+// узел 4-арного дерева: дети в SoA; child >= 0 — узел, < 0 — лист ~first
+struct alignas(16) Bvh4Node
+{
+    float minX[4], minY[4], minZ[4];
+    float maxX[4], maxY[4], maxZ[4];
+    int32_t child[4];
+    uint32_t count[4];            // примитивов в листе
+    uint32_t childCount;
+};
+
+class MeshBvh
+{
+public:
+    void Build(const MeshData& mesh, ThreadPool& pool);
+
+    // луч в системе модели; true, если нашлось попадание ближе hit.t
+    bool Intersect(const Ray& ray, RayHit& hit) const;
+    // 4 луча в системе модели; маска дорожек, где нашлось попадание ближе
+    int IntersectPacket(const RayPacket& rays, PacketHit& hit) const;
+    // UV точки попадания по texcoords модели
+    void TexCoord(uint32_t triangle, float u, float v, float uv[2]) const;
+    // сглаженная нормаль точки попадания (система модели, не единичная)
+    Vec3 Normal(uint32_t triangle, float u, float v) const;
+
+    const Aabb& Bounds() const { return bounds; }
+    size_t TriangleCount() const { return triangleUV.size() / 6; }
+
+    // "4672 tris, 412 nodes, 1203 leaves, depth 8, SAH 16 bins, built in 3.1 ms"
+    std::string Summary() const;
+
+private:
+    // до 4 треугольников листа в SoA: вершина 0 и два ребра
+    struct alignas(16) TrianglePacket
+    {
+        float v0x[4], v0y[4], v0z[4];
+        float e1x[4], e1y[4], e1z[4];
+        float e2x[4], e2y[4], e2z[4];
+        uint32_t id[4];           // kNoHit — пустая дорожка
+    };
+
+    std::vector<Bvh4Node> nodes;
+    std::vector<TrianglePacket> packets;
+    std::vector<float> triangleUV;   // по 6 на треугольник
+    std::vector<Vec3> triangleNormal;   // по 3 на треугольник
+    Aabb bounds;
+    unsigned depth = 0;
+    double buildMs = 0.0;
+};
+
+class SceneBvh
+{
+public:
+    // мировые AABB модели mesh по PlanetModelMatrix каждой планеты
+    void Build(const std::vector<Planet>& planets, const MeshBvh& mesh, ThreadPool& pool);
+
+    // ближайшая планета на луче (мировые координаты); hit.instance — её номер
+    bool Intersect(const Ray& ray, RayHit& hit) const;
+    // то же для 4 лучей; маска дорожек с попаданием
+    int IntersectPacket(const RayPacket& rays, PacketHit& hit) const;
+
+    // "1000001 instances, 333k nodes, depth 14, built in 610 ms on 8 threads"
+    std::string Summary() const;
+
+private:
+    // обратное преобразование планеты: мир -> модель
+    struct InstanceInverse
+    {
+        float position[3];
+        float cosA, sinA;         // поворот на -selfAngle вокруг Y
+        float invScale;
+    };
+
+    const MeshBvh* mesh = nullptr;
+    std::vector<Bvh4Node> nodes;
+    std::vector<uint32_t> order;  // номера планет по листам
+    std::vector<InstanceInverse> inverses;
+    unsigned depth = 0;
+    unsigned threads = 0;
+    double buildMs = 0.0;
+};
@@ -0,0 +1,89 @@
+#include "Scene.h"
+
+#include <random>
+
+std::vector<Planet> CreatePlanets(int planetCount, unsigned seed)
+{
+    // mt19937 одинаков на всех платформах (в отличие от rand()),
+    // поэтому один seed даёт одну и ту же сцену и для эталонных картинок
+    std::mt19937 rng(seed);
+    auto frand = [&](float a, float b)
+        {
+            return a + (b - a) * (float)(rng() / 4294967295.0);
+        };
+
+    std::vector<Planet> planets;
+    planets.push_back({ 0.0f, 0.0f, 0.2f, 4.0f });   // Солнце — в центре, большое
+
+    for (int i = 0; i < planetCount; i++) {
+        float orbitRadius = i/2 + 4.0f;
+        float orbitSpeed = frand(0.5f, 1.5f) / orbitRadius;
+        float selfSpeed = frand(0.3f, 1.5f);
+        float scale = frand(0.4f, 1.5f);
+        float orbitAngle = frand(0.0f, 360.0f);
+        float selfAngle = frand(0.0f, 360.0f);
+
+        planets.push_back({
+            orbitRadius,
+            orbitSpeed,
+            selfSpeed,
+            scale,
+            orbitAngle,
+            selfAngle
+            });
+    }
+    return planets;
+}
+
+void UpdatePlanets(std::vector<Planet>& planets, float dt)
+{
+    for (auto& p : planets)
+    {
+        p.orbitAngle += p.orbitSpeed * dt;
+        p.selfAngle += p.selfSpeed * dt;
+    }
+}
+
+Vec3 PlanetPosition(const Planet& p)
+{
+    float x = 0.0f;
+    float z = 0.0f;
+    if (p.orbitRadius > 0.0f)
+    {
+        x = std::cos(p.orbitAngle) * p.orbitRadius;
+        z = std::sin(p.orbitAngle) * p.orbitRadius;
+    }
+    return Vec3(x, 0.0f, z);
+}
+
+Mat4 PlanetModelMatrix(const Planet& p)
+{
+    Vec3 pos = PlanetPosition(p);
+    return Mat4::Translation(pos.x, pos.y, pos.z) *
+        Mat4::RotationY(p.selfAngle) *
+        Mat4::Scale(p.scale, p.scale, p.scale);
+}
+
+Vec3 Camera::Front() const
+{
+    float cy = std::cos(Deg2Rad(yaw));
+    float sy = std::sin(Deg2Rad(yaw));
+    float cp = std::cos(Deg2Rad(pitch));
+    float sp = std::sin(Deg2Rad(pitch));
+    Vec3 front;
+    front.x = cy * cp;
+    front.y = sp;
+    front.z = sy * cp;
+    return Normalize(front);
+}
+
+Mat4 Camera::View() const
+{
+    return Mat4::LookAt(pos, pos + Front(), kWorldUp);
+}
+
+Mat4 MakeProjection(unsigned w, unsigned h)
+{
+    float aspect = (h == 0) ? 1.0f : (float)w / (float)h;
+    return Mat4::Perspective(Deg2Rad(kFovY), aspect, kNearPlane, kFarPlane);
+}
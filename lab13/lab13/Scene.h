@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Math3D.h"
+
+#include <vector>
+
+// =======================================================
+// ПЛАНЕТЫ И КАМЕРА (общие для GL и программного рендера)
+// =======================================================
+
+struct Planet
+{
+    float orbitRadius;    // радиус орбиты
+    float orbitSpeed;     // скорость по орбите (рад/сек)
+    float selfSpeed;      // скорость вращения вокруг своей оси
+    float scale;          // масштаб модели
+    float orbitAngle = 0; // текущий угол на орбите
+    float selfAngle = 0;  // текущий угол собственного вращения
+};
+
+const int kDefaultPlanetCount = 100;
+
+// 0-я планета — "Солнце", остальные на кольцах орбит
+std::vector<Planet> CreatePlanets(int planetCount, unsigned seed);
+
+void UpdatePlanets(std::vector<Planet>& planets, float dt);
+
+Vec3 PlanetPosition(const Planet& p);
+Mat4 PlanetModelMatrix(const Planet& p);
+
+inline float Deg2Rad(float d) { return d * (float)M_PI / 180.0f; }
+
+struct Camera
+{
+    Vec3 pos = Vec3(0.0f, 3.0f, 12.0f);
+    float yaw = -90.0f;       // в градусах
+    float pitch = -15.0f;
+
+    Vec3 Front() const;
+    Mat4 View() const;
+};
+
+const Vec3 kWorldUp(0.0f, 1.0f, 0.0f);
+
+const float kFovY = 60.0f;
+const float kNearPlane = 0.1f;
+const float kFarPlane = 1000.0f;
+
+Mat4 MakeProjection(unsigned w, unsigned h);
@@ -0,0 +1,684 @@
+#include "SceneRendererGL.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+const char* vertexShaderSrc = R"(
+    #version 330 core
+    layout(location = 0) in vec3 aPos;
+    layout(location = 1) in vec2 aTex;
+    layout(location = 2) in mat4 aModel;   // на экземпляр, location 2..5
+    layout(location = 6) in vec4 aEmission;
+    layout(location = 7) in vec3 aNormal;
+
+    layout(std140) uniform Camera
+    {
+        mat4 uView;
+        mat4 uProj;
+    };
+
+    out vec2 vTex;
+    out vec3 vViewPos;
+    out vec3 vNormal;
+    out vec3 vEmission;
+    flat out uint vInstance;
+
+    void main()
+    {
+        vTex = aTex;
+        vEmission = aEmission.rgb;
+        vInstance = uint(gl_InstanceID);
+        mat4 modelView = uView * aModel;
+        // масштаб планет равномерный, обратная транспонированная не нужна
+        vNormal = mat3(modelView) * aNormal;
+        vec4 viewPos = modelView * vec4(aPos, 1.0);
+        vViewPos = viewPos.xyz;
+        gl_Position = uProj * viewPos;
+    }
+)";
+
+const char* fragmentShaderSrc = R"(
+    #version 330 core
+    in vec2 vTex;
+    flat in uint vInstance;
+    layout(location = 0) out vec4 FragColor;
+    layout(location = 1) out uint FragId;   // буфер номеров (EnableIdOutput)
+
+    uniform sampler2D uTexture;
+
+    void main()
+    {
+        FragColor = texture(uTexture, vTex);
+        FragId = vInstance;
+    }
+)";
+
+// освещение: фрагмент перебирает только источники своего кластера
+const char* litFragmentShaderSrc = R"(
+    #version 330 core
+    in vec2 vTex;
+    in vec3 vViewPos;
+    in vec3 vNormal;
+    in vec3 vEmission;
+    flat in uint vInstance;
+    layout(location = 0) out vec4 FragColor;
+    layout(location = 1) out uint FragId;
+
+    uniform sampler2D uTexture;
+    uniform samplerBuffer uLights;       // 2 texel на источник: позиция + радиус, цвет
+    uniform usamplerBuffer uClusters;    // начало списка, число источников
+    uniform usamplerBuffer uLightIndex;
+
+    uniform vec4 uViewport;              // x, y, w, h
+    uniform uvec3 uGrid;
+    uniform vec2 uSlice;                 // срез = log(глубина) * x + y
+
+    uniform samplerCubeShadow uShadowCube;
+    uniform bool uSunShadows;
+    uniform mat4 uInvView;
+    uniform vec3 uSunPos;
+    uniform float uShadowRange;
+
+    const vec3 kAmbient = vec3(0.06);
+
+    // 1 — освещено, 0 — в тени; точка сдвинута по нормали против акне
+    float SunShadow(vec3 n)
+    {
+        vec3 world = (uInvView * vec4(vViewPos, 1.0)).xyz;
+        vec3 worldN = mat3(uInvView) * n;
+        vec3 d = world - uSunPos;
+        d += worldN * (0.02 + 0.002 * length(d));
+        return texture(uShadowCube, vec4(d, length(d) / uShadowRange - 0.0005));
+    }
+
+    void main()
+    {
+        vec4 albedo = texture(uTexture, vTex);
+        vec3 n = normalize(vNormal);
+
+        vec2 uv = clamp((gl_FragCoord.xy - uViewport.xy) / uViewport.zw, 0.0, 0.9999);
+        uvec2 tile = uvec2(uv * vec2(uGrid.xy));
+        float slice = clamp(log(-vViewPos.z) * uSlice.x + uSlice.y, 0.0, float(uGrid.z - 1u));
+        int cluster = int((uint(slice) * uGrid.y + tile.y) * uGrid.x + tile.x);
+        uvec2 range = texelFetch(uClusters, cluster).xy;
+
+        vec3 light = kAmbient + vEmission;
+        for (uint i = 0u; i < range.y; ++i)
+        {
+            int index = int(texelFetch(uLightIndex, int(range.x + i)).r);
+            vec4 posRadius = texelFetch(uLights, 2 * index);
+            vec3 d = posRadius.xyz - vViewPos;
+            float dist2 = dot(d, d);
+            float f = clamp(1.0 - dist2 / (posRadius.w * posRadius.w), 0.0, 1.0);
+            if (f > 0.0)
+            {
+                vec4 color = texelFetch(uLights, 2 * index + 1);   // w — тень Солнца
+                float lit = f * f * max(dot(n, d * inversesqrt(dist2)), 0.0);
+                if (uSunShadows && color.w > 0.5 && lit > 0.0)
+                    lit *= SunShadow(n);
+                light += color.rgb * lit;
+            }
+        }
+        FragColor = vec4(albedo.rgb * light, albedo.a);
+        FragId = vInstance;
+    }
+)";
+
+// G-буфер отложенного освещения (DeferredShading.h): фон и свечение
+// сразу в буфер света, нормаль — октаэдрическая развёртка в [0, 1]
+const char* gbufferFragmentShaderSrc = R"(
+    #version 330 core
+    in vec2 vTex;
+    in vec3 vViewPos;
+    in vec3 vNormal;
+    in vec3 vEmission;
+    layout(location = 0) out vec4 Light;
+    layout(location = 1) out vec4 Albedo;
+    layout(location = 2) out vec2 Normal;
+
+    uniform sampler2D uTexture;
+
+    const vec3 kAmbient = vec3(0.06);
+
+    vec2 EncodeNormal(vec3 n)
+    {
+        n /= abs(n.x) + abs(n.y) + abs(n.z);
+        vec2 e = n.xy;
+        if (n.z < 0.0)
+            e = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+        return e * 0.5 + 0.5;
+    }
+
+    void main()
+    {
+        vec4 albedo = texture(uTexture, vTex);
+        Light = vec4(albedo.rgb * (kAmbient + vEmission), 1.0);
+        Albedo = albedo;
+        Normal = EncodeNormal(normalize(vNormal));
+    }
+)";
+
+namespace
+{
+    const GLuint kCameraBinding = 0;
+    const GLuint kLightTextureUnit = 1;   // 1..3 — TBO кластеров
+    const GLuint kShadowTextureUnit = 4;
+    const size_t kMinInstanceCapacity = 128;
+
+    GLsizeiptr AlignUp(GLsizeiptr v, GLsizeiptr a)
+    {
+        return (v + a - 1) / a * a;
+    }
+
+    // буфер на все кадры: постоянное отображение при GL 4.4, иначе обычный
+    uint8_t* CreateFrameBuffer(GLenum target, GLuint& buffer, GLsizeiptr size, bool persistent)
+    {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(target, buffer);
+        uint8_t* mapped = nullptr;
+        if (persistent)
+        {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(target, size, nullptr, flags);
+            mapped = (uint8_t*)glMapBufferRange(target, 0, size, flags);
+        }
+        else
+        {
+            glBufferData(target, size, nullptr, GL_STREAM_DRAW);
+        }
+        glBindBuffer(target, 0);
+        return mapped;
+    }
+
+    // запись в диапазон кадра: без синхронизации драйвера, её дают fence кадров
+    void WriteFrameRange(GLenum target, GLuint buffer, uint8_t* mapped,
+        GLintptr offset, const void* data, GLsizeiptr size)
+    {
+        if (mapped)
+        {
+            std::memcpy(mapped + offset, data, size);
+            return;
+        }
+        glBindBuffer(target, buffer);
+        void* dst = glMapBufferRange(target, offset, size,
+            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        if (dst)
+        {
+            std::memcpy(dst, data, size);
+            glUnmapBuffer(target);
+        }
+        glBindBuffer(target, 0);
+    }
+
+    void DeleteFrameBuffer(GLenum target, GLuint& buffer, uint8_t*& mapped)
+    {
+        if (mapped)
+        {
+            glBindBuffer(target, buffer);
+            glUnmapBuffer(target);
+            glBindBuffer(target, 0);
+        }
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+        mapped = nullptr;
+    }
+}
+
+void SetupSceneGLState()
+{
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+}
+
+bool SceneRenderer::Init(const MeshData& model, const sf::Image& texImage,
+    unsigned framesInFlight)
+{
+    // --- шейдерная программа ---
+    GLuint vert = CompileShader(GL_VERTEX_SHADER, vertexShaderSrc);
+    GLuint frag = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSrc);
+    prog = LinkProgram(vert, frag);
+    glDeleteShader(vert);
+    glDeleteShader(frag);
+
+    uTexLoc = glGetUniformLocation(prog, "uTexture");
+    GLuint cameraBlock = glGetUniformBlockIndex(prog, "Camera");
+    if (cameraBlock != GL_INVALID_INDEX)
+        glUniformBlockBinding(prog, cameraBlock, kCameraBinding);
+
+    mesh = CreateMesh(model);
+
+    // --- текстура для всех объектов (можно потом добавить разные) ---
+    tex = CreateTextureFromImage(texImage);
+
+    // --- буферы кадров в полёте ---
+    frameCount = std::max(1u, framesInFlight);
+    persistent = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+    AllocateFrameBuffers(kMinInstanceCapacity);
+
+    return prog != 0 && tex != 0;
+}
+
+void SceneRenderer::AllocateFrameBuffers(size_t instances)
+{
+    GLint uboAlign = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboAlign);
+
+    instanceCapacity = instances;
+    instanceStride = AlignUp((GLsizeiptr)(instances * sizeof(InstanceData)), 256);
+    cameraStride = AlignUp(2 * sizeof(Mat4), std::max(uboAlign, 16));
+
+    instanceMapped = CreateFrameBuffer(GL_ARRAY_BUFFER, instanceVBO, instanceStride * frameCount, persistent);
+    cameraMapped = CreateFrameBuffer(GL_UNIFORM_BUFFER, cameraUBO, cameraStride * frameCount, persistent);
+
+    // матрица экземпляра — 4 атрибута vec4, за ней свечение;
+    // смещение диапазона задаётся в Render
+    glBindVertexArray(mesh.VAO);
+    for (GLuint attr = 2; attr <= 6; ++attr)
+    {
+        glEnableVertexAttribArray(attr);
+        glVertexAttribDivisor(attr, 1);
+    }
+    glBindVertexArray(0);
+}
+
+void SceneRenderer::FreeFrameBuffers()
+{
+    DeleteFrameBuffer(GL_ARRAY_BUFFER, instanceVBO, instanceMapped);
+    DeleteFrameBuffer(GL_UNIFORM_BUFFER, cameraUBO, cameraMapped);
+    instanceCapacity = 0;
+}
+
+bool SceneRenderer::EnableLighting(unsigned count)
+{
+    lightCount = std::min(count, kMaxLights);
+    if (lightCount == 0 || litProg != 0)
+        return true;
+
+    GLuint vert = CompileShader(GL_VERTEX_SHADER, vertexShaderSrc);
+    GLuint frag = CompileShader(GL_FRAGMENT_SHADER, litFragmentShaderSrc);
+    litProg = LinkProgram(vert, frag);
+    glDeleteShader(vert);
+    glDeleteShader(frag);
+    if (litProg == 0)
+    {
+        lightCount = 0;
+        return false;
+    }
+
+    GLuint cameraBlock = glGetUniformBlockIndex(litProg, "Camera");
+    if (cameraBlock != GL_INVALID_INDEX)
+        glUniformBlockBinding(litProg, cameraBlock, kCameraBinding);
+
+    glUseProgram(litProg);
+    glUniform1i(glGetUniformLocation(litProg, "uTexture"), 0);
+    glUniform1i(glGetUniformLocation(litProg, "uLights"), kLightTextureUnit);
+    glUniform1i(glGetUniformLocation(litProg, "uClusters"), kLightTextureUnit + 1);
+    glUniform1i(glGetUniformLocation(litProg, "uLightIndex"), kLightTextureUnit + 2);
+    glUniform1i(glGetUniformLocation(litProg, "uShadowCube"), kShadowTextureUnit);
+    glUseProgram(0);
+    litShadowsLoc = glGetUniformLocation(litProg, "uSunShadows");
+    litInvViewLoc = glGetUniformLocation(litProg, "uInvView");
+    litSunPosLoc = glGetUniformLocation(litProg, "uSunPos");
+    litShadowRangeLoc = glGetUniformLocation(litProg, "uShadowRange");
+    litViewportLoc = glGetUniformLocation(litProg, "uViewport");
+    litGridLoc = glGetUniformLocation(litProg, "uGrid");
+    litSliceLoc = glGetUniformLocation(litProg, "uSlice");
+
+    clusterBuffers.Init(frameCount);
+    return true;
+}
+
+bool SceneRenderer::EnableSunShadows(const SunShadowSettings& settings)
+{
+    if (settings.size == 0 || shadows)
+        return true;
+    if (litProg == 0)
+        return false;
+    shadows = sunShadows.Init(settings, mesh);
+    return shadows;
+}
+
+bool SceneRenderer::SetShadingPath(ShadingPath path)
+{
+    if (path == shading)
+        return true;
+    if (shading != ShadingPath::Forward)
+        deferred.Destroy();
+    shading = ShadingPath::Forward;
+    if (path == ShadingPath::Forward)
+        return true;
+    if (litProg == 0)
+        return false;
+
+    if (gbufferProg == 0)
+    {
+        GLuint vert = CompileShader(GL_VERTEX_SHADER, vertexShaderSrc);
+        GLuint frag = CompileShader(GL_FRAGMENT_SHADER, gbufferFragmentShaderSrc);
+        gbufferProg = LinkProgram(vert, frag);
+        glDeleteShader(vert);
+        glDeleteShader(frag);
+
+        GLuint cameraBlock = glGetUniformBlockIndex(gbufferProg, "Camera");
+        if (cameraBlock != GL_INVALID_INDEX)
+            glUniformBlockBinding(gbufferProg, cameraBlock, kCameraBinding);
+        glUseProgram(gbufferProg);
+        glUniform1i(glGetUniformLocation(gbufferProg, "uTexture"), 0);
+        glUseProgram(0);
+    }
+    if (!deferred.Init(path, kLightTextureUnit, kShadowTextureUnit))
+        return false;
+    shading = path;
+    return true;
+}
+
+bool SceneRenderer::EnableVisibilityBuffer(bool enable)
+{
+    if (enable == visibility)
+        return true;
+    if (visibility)
+        visBuffer.Destroy();
+    visibility = enable && visBuffer.Init(mesh, kCameraBinding, kLightTextureUnit, kShadowTextureUnit);
+    return visibility == enable;
+}
+
+bool SceneRenderer::EnableRings(const PlanetRingSettings& settings)
+{
+    if (rings)
+        planetRings.Destroy();
+    rings = planetRings.Init(settings, kCameraBinding);
+    return rings;
+}
+
+bool SceneRenderer::EnableProceduralPlanets(const ProceduralPlanetSettings& settings, ThreadPool& pool)
+{
+    if (procedural)
+        proceduralPlanets.Destroy();
+    procedural = proceduralPlanets.Init(settings, pool);
+    return procedural;
+}
+
+void SceneRenderer::EnableHdrOutput(float emission)
+{
+    emissionScale = emission;
+    if (linearMaterial)
+        return;
+
+    // те же текселы, но формат sRGB: выборка и мипмапы — в линейном пространстве
+    GLint w = 0, h = 0;
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &w);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &h);
+    std::vector<uint8_t> pixels((size_t)w * h * 4);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8_ALPHA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    linearMaterial = true;
+}
+
+std::string SceneRenderer::ShadingSummary() const
+{
+    return shading == ShadingPath::Forward ? std::string("forward, clustered") : deferred.Summary();
+}
+
+void SceneRenderer::Destroy()
+{
+    if (shading != ShadingPath::Forward)
+    {
+        deferred.Destroy();
+        shading = ShadingPath::Forward;
+    }
+    glDeleteProgram(gbufferProg);
+    gbufferProg = 0;
+    if (visibility)
+    {
+        visBuffer.Destroy();
+        visibility = false;
+    }
+    if (rings)
+    {
+        planetRings.Destroy();
+        rings = false;
+    }
+    if (procedural)
+    {
+        proceduralPlanets.Destroy();
+        procedural = false;
+    }
+    if (shadows)
+    {
+        sunShadows.Destroy();
+        shadows = false;
+    }
+    if (litProg)
+    {
+        clusterBuffers.Destroy();
+        glDeleteProgram(litProg);
+        litProg = 0;
+    }
+    lightCount = 0;
+    emissionScale = 1.0f;
+    linearMaterial = false;
+    FreeFrameBuffers();
+    DestroyMesh(mesh);
+    glDeleteTextures(1, &tex);
+    glDeleteProgram(prog);
+    tex = 0;
+    prog = 0;
+}
+
+RenderStats SceneRenderer::Render(const std::vector<Planet>& planets, const Mat4& view, const Mat4& proj,
+    unsigned frame)
+{
+    RenderStats stats;
+    frame %= frameCount;
+
+    if (planets.size() > instanceCapacity)
+    {
+        // редкий случай: старые буферы могут читаться GPU — дождёмся его
+        glFinish();
+        FreeFrameBuffers();
+        AllocateFrameBuffers(std::max(planets.size(), instanceCapacity * 2));
+    }
+
+    // --- данные кадра ---
+    instances.resize(planets.size());
+    for (size_t i = 0; i < planets.size(); ++i)
+    {
+        InstanceData& inst = instances[i];
+        inst.model = PlanetModelMatrix(planets[i]);
+        Vec3 e = PlanetEmission(i, lightCount) * emissionScale;
+        inst.emission[0] = e.x;
+        inst.emission[1] = e.y;
+        inst.emission[2] = e.z;
+    }
+    Mat4 camera[2] = { view, proj };
+
+    bool lit = lightCount > 0 && !procedural;
+    if (lit)
+    {
+        GatherSceneLights(planets, lightCount, lights);
+        if (shadows && !lights.empty())
+        {
+            sunShadows.Update(planets);
+            lights[0].castsShadow = true;
+        }
+        clusterBuilder.Build(lights, view, proj);
+        clusterBuffers.Upload(frame, clusterBuilder);
+    }
+
+    GLintptr instanceOffset = frame * instanceStride;
+    GLintptr cameraOffset = frame * cameraStride;
+    framePlanets = planets.size();
+    frameInstanceOffset = instanceOffset;
+    frameCameraOffset = cameraOffset;
+    if (!instances.empty())
+        WriteFrameRange(GL_ARRAY_BUFFER, instanceVBO, instanceMapped, instanceOffset,
+            instances.data(), instances.size() * sizeof(InstanceData));
+    WriteFrameRange(GL_UNIFORM_BUFFER, cameraUBO, cameraMapped, cameraOffset, camera, sizeof(camera));
+
+    float clearColor[3] = { 0.02f, 0.02f, 0.05f };
+    if (linearMaterial)
+    {
+        // тот же фон после гаммы на выходе HDR
+        for (float& c : clearColor)
+            c = std::pow(c, 2.2f);
+    }
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    // отложенный путь: планеты в G-буфер, источники — в Resolve;
+    // visibility buffer: только номера, цвет и глубина цели — в Resolve
+    bool deferredPass = lit && shading != ShadingPath::Forward && !visibility;
+    if (!deferredPass && !visibility)
+    {
+        glClearColor(clearColor[0], clearColor[1], clearColor[2], 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+    // номера — только от планет: кольца, следы и звёзды пишут один цвет
+    const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    bool ids = idOutput && !deferredPass && !visibility;
+    if (ids)
+    {
+        const GLuint none = 0xFFFFFFFFu;
+        glDrawBuffers(2, drawBuffers);
+        glClearBufferuiv(GL_COLOR, 1, &none);
+    }
+
+    if (procedural)
+    {
+        // экземпляры нужны только кольцам
+        stats.triangles = proceduralPlanets.Draw(planets, view, proj, linearMaterial, emissionScale);
+        stats.drawCalls = stats.triangles ? 1 : 0;
+        if (ids)
+            glDrawBuffers(1, drawBuffers);
+        glUseProgram(0);
+        return stats;
+    }
+
+    if (visibility)
+    {
+        visBuffer.BeginGeometry(viewport[2], viewport[3]);
+        glUseProgram(visBuffer.GeometryProgram());
+        if (lit)
+            clusterBuffers.Bind(frame, kLightTextureUnit);
+    }
+    else if (deferredPass)
+    {
+        deferred.BeginGeometry(viewport[2], viewport[3], clearColor);
+        glUseProgram(gbufferProg);
+        clusterBuffers.Bind(frame, kLightTextureUnit);
+    }
+    else if (lit)
+    {
+        const ClusterGrid& grid = clusterBuilder.Grid();
+
+        glUseProgram(litProg);
+        glUniform4f(litViewportLoc, (float)viewport[0], (float)viewport[1], (float)viewport[2], (float)viewport[3]);
+        glUniform3ui(litGridLoc, grid.x, grid.y, grid.z);
+        glUniform2f(litSliceLoc, clusterBuilder.SliceScale(), clusterBuilder.SliceBias());
+        clusterBuffers.Bind(frame, kLightTextureUnit);
+
+        glUniform1i(litShadowsLoc, shadows ? 1 : 0);
+        if (shadows)
+        {
+            Mat4 invView = InverseRigid(view);
+            Vec3 sun = sunShadows.LightPosition();
+            glUniformMatrix4fv(litInvViewLoc, 1, GL_FALSE, invView.m);
+            glUniform3f(litSunPosLoc, sun.x, sun.y, sun.z);
+            glUniform1f(litShadowRangeLoc, sunShadows.Range());
+            glActiveTexture(GL_TEXTURE0 + kShadowTextureUnit);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, sunShadows.Texture());
+        }
+    }
+    else
+    {
+        glUseProgram(prog);
+        glUniform1i(uTexLoc, 0);
+    }
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glBindBufferRange(GL_UNIFORM_BUFFER, kCameraBinding, cameraUBO, cameraOffset, sizeof(camera));
+
+    glBindVertexArray(mesh.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    for (GLuint col = 0; col < 4; ++col)
+        glVertexAttribPointer(2 + col, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+            (void*)(instanceOffset + col * 4 * sizeof(float)));
+    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+        (void*)(instanceOffset + offsetof(InstanceData, emission)));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (!planets.empty())
+    {
+        glDrawElementsInstanced(GL_TRIANGLES, mesh.indexCount, mesh.indexType, nullptr, (GLsizei)planets.size());
+        stats.drawCalls = 1;
+        stats.triangles = (size_t)mesh.indexCount / 3 * planets.size();
+    }
+
+    glBindVertexArray(0);
+    if (ids)
+        glDrawBuffers(1, drawBuffers);
+
+    if (visibility)
+    {
+        VisibilityResolve in;
+        in.instanceBuffer = instanceVBO;
+        in.instanceOffset = instanceOffset;
+        in.clusters = lit ? &clusterBuilder : nullptr;
+        in.shadows = shadows ? &sunShadows : nullptr;
+        in.view = view;
+        std::copy(clearColor, clearColor + 3, in.clearColor);
+        visBuffer.Resolve(in);
+        stats.drawCalls += 1;   // материал по пикселям
+    }
+    else if (deferredPass)
+    {
+        DeferredLights in;
+        in.clusters = &clusterBuilder;
+        in.shadows = shadows ? &sunShadows : nullptr;
+        in.view = view;
+        in.proj = proj;
+        deferred.Resolve(in);
+        stats.drawCalls += 2;   // освещение и перенос в цель
+    }
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, kCameraBinding, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (lit)
+        clusterBuffers.Unbind(kLightTextureUnit);
+    if (shadows)
+    {
+        glActiveTexture(GL_TEXTURE0 + kShadowTextureUnit);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    glUseProgram(0);
+    return stats;
+}
+
+int SceneRenderer::DrawTransparent()
+{
+    if (!rings || framePlanets == 0)
+        return 0;
+    glBindBufferRange(GL_UNIFORM_BUFFER, kCameraBinding, cameraUBO, frameCameraOffset, 2 * sizeof(Mat4));
+    int drawCalls = DrawRings();
+    glBindBufferBase(GL_UNIFORM_BUFFER, kCameraBinding, 0);
+    return drawCalls;
+}
+
+int SceneRenderer::DrawRings()
+{
+    PlanetRingDraw in;
+    in.mesh = &mesh;
+    if (procedural)
+        in.bodyRadius = proceduralPlanets.SphereRadius();
+    in.instanceBuffer = instanceVBO;
+    in.instanceOffset = frameInstanceOffset;
+    in.instanceCount = framePlanets;
+    in.linearOutput = linearMaterial;
+    return planetRings.Draw(in);
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "ClusteredLighting.h"
+#include "DeferredShading.h"
+#include "GlUtils.h"
+#include "PlanetRings.h"
+#include "ProceduralPlanets.h"
+#include "Scene.h"
+#include "SunShadows.h"
+#include "VisibilityBuffer.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// счётчики кадра для бюджетов и профилирования
+struct RenderStats
+{
+    int drawCalls = 0;
+    size_t triangles = 0;
+};
+
+// =======================================================
+// GL-РЕНДЕР СЦЕНЫ (планеты с одной моделью и текстурой)
+// =======================================================
+//
+// Все планеты — один instanced draw call. Матрицы экземпляров и
+// камеры пишутся в буферы с отдельным диапазоном на каждый кадр
+// в полёте, поэтому CPU готовит кадр N+1, пока GPU читает кадр N.
+// Свободу диапазона гарантирует вызывающий (fence кадра, FramesInFlight
+// или glFinish).
+//
+// Без EnableLighting планеты не освещены (только текстура); с ним —
+// кластерное освещение от точечных источников (ClusteredLighting.h)
+// или, после SetShadingPath, отложенное (DeferredShading.h).
+// С EnableVisibilityBuffer планеты сначала попадают в visibility buffer,
+// а материал и освещение считаются одним проходом по пикселям
+// (VisibilityBuffer.h); путь освещения тогда не важен.
+// С EnableRings полупрозрачные кольца (PlanetRings.h) рисует отдельный
+// DrawTransparent — после всего непрозрачного в кадре, по тому же
+// диапазону экземпляров, что и Render.
+// С EnableProceduralPlanets вместо модели рисуются процедурные сферы с
+// LOD (ProceduralPlanets.h) со своим освещением от Солнца; кластерное
+// освещение, отложенные пути и visibility buffer тогда не участвуют.
+// С EnableIdOutput прямой проход планет вторым выходом пишет номер
+// экземпляра в GL_COLOR_ATTACHMENT1 цели (GpuPicker.h).
+
+// данные экземпляра: матрица модели и собственное свечение
+struct InstanceData
+{
+    Mat4 model;
+    float emission[4] = { 0, 0, 0, 0 };
+};
+
+struct SceneRenderer
+{
+    GLuint prog = 0;
+    GLint uTexLoc = -1;
+
+    Mesh mesh;
+    GLuint tex = 0;
+
+    // --- данные кадров в полёте ---
+    GLuint instanceVBO = 0;        // InstanceData на планету
+    GLuint cameraUBO = 0;          // view + proj (std140)
+    unsigned frameCount = 1;
+    size_t instanceCapacity = 0;   // планет на кадр
+    GLsizeiptr instanceStride = 0; // байт на диапазон кадра
+    GLsizeiptr cameraStride = 0;
+    bool persistent = false;       // GL 4.4: буферы отображены постоянно
+    uint8_t* instanceMapped = nullptr;
+    uint8_t* cameraMapped = nullptr;
+    std::vector<InstanceData> instances;   // данные текущего кадра
+
+    // --- кластерное освещение ---
+    GLuint litProg = 0;
+    GLint litViewportLoc = -1;
+    GLint litGridLoc = -1;
+    GLint litSliceLoc = -1;
+    unsigned lightCount = 0;
+    float emissionScale = 1.0f;   // > 1 — только для HDR-цели
+    bool linearMaterial = false;  // текстура материала в sRGB-формате
+    std::vector<PointLight> lights;
+    LightClusterBuilder clusterBuilder;
+    ClusterLightBuffers clusterBuffers;
+
+    // --- тени от Солнца ---
+    bool shadows = false;
+    SunShadowMap sunShadows;
+    GLint litShadowsLoc = -1;
+    GLint litInvViewLoc = -1;
+    GLint litSunPosLoc = -1;
+    GLint litShadowRangeLoc = -1;
+
+    // --- отложенное освещение ---
+    ShadingPath shading = ShadingPath::Forward;
+    DeferredShading deferred;
+    GLuint gbufferProg = 0;       // проход геометрии: тот же вершинный шейдер
+
+    // --- visibility buffer ---
+    bool visibility = false;
+    VisibilityBuffer visBuffer;
+
+    // --- кольца планет ---
+    bool rings = false;
+    PlanetRings planetRings;
+    size_t framePlanets = 0;       // последний Render: для DrawTransparent
+    GLintptr frameInstanceOffset = 0;
+    GLintptr frameCameraOffset = 0;
+
+    // --- процедурные планеты ---
+    bool procedural = false;
+    ProceduralPlanets proceduralPlanets;
+
+    // --- буфер номеров для выбора мышью ---
+    bool idOutput = false;
+
+    // model — результат LoadOBJ, texImage — результат LoadTextureImage,
+    // framesInFlight — сколько кадров одновременно могут быть у GPU
+    bool Init(const MeshData& model, const sf::Image& texImage,
+        unsigned framesInFlight = 1);
+    void Destroy();
+
+    // lightCount источников (Солнце, светящиеся планеты, светлячки); 0 — без освещения
+    bool EnableLighting(unsigned lightCount);
+    std::string LightingSummary() const { return clusterBuilder.Summary(); }
+
+    // кубическая карта теней Солнца; только после EnableLighting, size == 0 — без теней
+    bool EnableSunShadows(const SunShadowSettings& settings);
+    std::string ShadowSummary() const { return sunShadows.Summary(); }
+
+    // путь освещения; отложенные — только после EnableLighting
+    bool SetShadingPath(ShadingPath path);
+    std::string ShadingSummary() const;
+
+    // номера экземпляра и треугольника вместо материала в проходе геометрии
+    bool EnableVisibilityBuffer(bool enable);
+    std::string VisibilitySummary() const { return visBuffer.Summary(); }
+
+    // кольца у части планет, weighted blended OIT после непрозрачной сцены
+    bool EnableRings(const PlanetRingSettings& settings);
+    std::string RingSummary() const { return planetRings.Summary(); }
+
+    // процедурные планеты вместо модели; только прямой путь без visibility buffer
+    bool EnableProceduralPlanets(const ProceduralPlanetSettings& settings, ThreadPool& pool);
+    std::string ProceduralSummary() const { return proceduralPlanets.Summary(); }
+
+    // для HDR-цели с гаммой на выходе (HdrBloom.h): материал читается
+    // линейным (sRGB-текстура), свечение планет умножается на emission
+    void EnableHdrOutput(float emission);
+
+    // номер планеты (фон — 0xFFFFFFFF) в R32UI-вложение 1 текущего
+    // framebuffer; вложение подключает вызывающий (GpuPicker::BeginScene),
+    // отложенные пути и visibility buffer номеров не пишут
+    void EnableIdOutput(bool enable) { idOutput = enable; }
+
+    // очистка и отрисовка всех планет в текущий framebuffer;
+    // frame — слот кадра в полёте, его диапазоны буферов должны быть свободны
+    RenderStats Render(const std::vector<Planet>& planets, const Mat4& view, const Mat4& proj,
+        unsigned frame = 0);
+
+    // полупрозрачное (кольца) в тот же framebuffer после Render и всего
+    // непрозрачного кадра (пояс), а также следов и звёзд — чтобы они
+    // оказались под кольцами; глубина берётся из framebuffer.
+    // Возвращает число вызовов отрисовки
+    int DrawTransparent();
+
+private:
+    void AllocateFrameBuffers(size_t instances);
+    void FreeFrameBuffers();
+    int DrawRings();
+};
+
+// глобальное GL-состояние, которое предполагает рендер сцены
+void SetupSceneGLState();
@@ -0,0 +1,350 @@
+#include "SharedFrameRing.h"
+
+#include "FrameStats.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    size_t AlignUp(size_t v, size_t a)
+    {
+        return (v + a - 1) / a * a;
+    }
+
+    size_t SlotsOffset()
+    {
+        return AlignUp(sizeof(SharedFrameHeader), 64);
+    }
+
+    size_t PixelsOffset(uint32_t slotCount)
+    {
+        return AlignUp(SlotsOffset() + slotCount * sizeof(SharedFrameSlot), 4096);
+    }
+
+#ifndef _WIN32
+    // POSIX требует имя вида "/name"
+    std::string ShmName(const std::string& name)
+    {
+        return name.empty() || name[0] != '/' ? "/" + name : name;
+    }
+#endif
+}
+
+int64_t SteadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// =================== SharedMemory ===================
+
+bool SharedMemory::Create(const std::string& shmName, size_t bytes)
+{
+    Close();
+    name = shmName;
+#ifdef _WIN32
+    std::string winName = "Local\\" + name;
+    mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        (DWORD)((uint64_t)bytes >> 32), (DWORD)(bytes & 0xffffffffu), winName.c_str());
+    if (!mapping)
+    {
+        std::cout << "CreateFileMapping failed: " << GetLastError() << std::endl;
+        return false;
+    }
+    data = (uint8_t*)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+    if (!data)
+    {
+        std::cout << "MapViewOfFile failed: " << GetLastError() << std::endl;
+        Close();
+        return false;
+    }
+#else
+    std::string posixName = ShmName(name);
+    shm_unlink(posixName.c_str());   // остаток упавшего прошлого запуска
+    int fd = shm_open(posixName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        std::cout << "shm_open failed: " << posixName << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, (off_t)bytes) != 0)
+    {
+        std::cout << "ftruncate failed for shared memory " << posixName << std::endl;
+        close(fd);
+        shm_unlink(posixName.c_str());
+        return false;
+    }
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+    {
+        std::cout << "mmap failed for shared memory " << posixName << std::endl;
+        shm_unlink(posixName.c_str());
+        return false;
+    }
+    data = (uint8_t*)p;
+#endif
+    size = bytes;
+    owner = true;
+    return true;
+}
+
+bool SharedMemory::Open(const std::string& shmName)
+{
+    Close();
+    name = shmName;
+#ifdef _WIN32
+    std::string winName = "Local\\" + name;
+    mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, winName.c_str());
+    if (!mapping)
+        return false;
+    data = (uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data)
+    {
+        Close();
+        return false;
+    }
+    MEMORY_BASIC_INFORMATION info;
+    VirtualQuery(data, &info, sizeof(info));
+    size = info.RegionSize;
+#else
+    int fd = shm_open(ShmName(name).c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return false;
+    data = (uint8_t*)p;
+    size = (size_t)st.st_size;
+#endif
+    owner = false;
+    return true;
+}
+
+void SharedMemory::Close()
+{
+#ifdef _WIN32
+    if (data)
+        UnmapViewOfFile(data);
+    if (mapping)
+        CloseHandle(mapping);
+    mapping = nullptr;
+#else
+    if (data)
+        munmap(data, size);
+    if (data && owner)
+        shm_unlink(ShmName(name).c_str());
+#endif
+    data = nullptr;
+    size = 0;
+    owner = false;
+}
+
+// =================== писатель ===================
+
+bool SharedFrameWriter::Create(const std::string& name, unsigned w, unsigned h, unsigned slotCount)
+{
+    uint64_t slotBytes = AlignUp((size_t)w * h * 4, 64);
+    size_t total = PixelsOffset(slotCount) + slotCount * slotBytes;
+    if (!memory.Create(name, total))
+        return false;
+
+    uint8_t* base = memory.Data();
+    header = new (base) SharedFrameHeader();
+    slots = reinterpret_cast<SharedFrameSlot*>(base + SlotsOffset());
+    for (unsigned i = 0; i < slotCount; ++i)
+        new (&slots[i]) SharedFrameSlot();
+    pixels = base + PixelsOffset(slotCount);
+
+    header->slotCount = slotCount;
+    header->width = w;
+    header->height = h;
+    header->stride = w * 4;
+    header->slotBytes = slotBytes;
+    header->published.store(0, std::memory_order_relaxed);
+    header->closed.store(0, std::memory_order_relaxed);
+    header->version = kSharedFrameVersion;
+    // magic последним: читатель, увидевший его, видит готовый заголовок
+    header->magic.store(kSharedFrameMagic, std::memory_order_release);
+    next = 0;
+
+    std::cout << "Shared frame ring: " << name << ", " << w << "x" << h
+        << ", " << slotCount << " slots, " << total / (1024 * 1024) << " MB" << std::endl;
+    return true;
+}
+
+void SharedFrameWriter::Publish(const uint8_t* rgba, int64_t renderedNs)
+{
+    if (!header)
+        return;
+
+    uint64_t frame = next++;
+    SharedFrameSlot& slot = slots[frame % header->slotCount];
+
+    slot.seq.store(2 * frame + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(pixels + (frame % header->slotCount) * header->slotBytes, rgba,
+        (size_t)header->stride * header->height);
+    slot.frameIndex = frame;
+    slot.renderedNs = renderedNs;
+    slot.publishedNs = SteadyNowNs();
+
+    slot.seq.store(2 * (frame + 1), std::memory_order_release);
+    header->published.store(frame + 1, std::memory_order_release);
+}
+
+void SharedFrameWriter::Close()
+{
+    if (header)
+        header->closed.store(1, std::memory_order_release);
+    header = nullptr;
+    slots = nullptr;
+    pixels = nullptr;
+    memory.Close();
+}
+
+// =================== читатель ===================
+
+bool SharedFrameReader::Open(const std::string& name)
+{
+    if (!memory.Open(name) || memory.Size() < sizeof(SharedFrameHeader))
+        return false;
+
+    const uint8_t* base = memory.Data();
+    header = reinterpret_cast<const SharedFrameHeader*>(base);
+    if (header->magic.load(std::memory_order_acquire) != kSharedFrameMagic)
+        return false;
+    if (header->version != kSharedFrameVersion ||
+        memory.Size() < PixelsOffset(header->slotCount) + header->slotCount * header->slotBytes)
+    {
+        std::cout << "Shared frame ring has an unexpected layout: " << name << std::endl;
+        return false;
+    }
+    slots = reinterpret_cast<const SharedFrameSlot*>(base + SlotsOffset());
+    pixels = base + PixelsOffset(header->slotCount);
+    return true;
+}
+
+bool SharedFrameReader::AcquireLatest(uint64_t after, const SharedFrameSlot*& slot,
+    const uint8_t*& outPixels, uint64_t& seq) const
+{
+    uint64_t published = header->published.load(std::memory_order_acquire);
+    if (published <= after)
+        return false;
+
+    uint64_t frame = published - 1;
+    slot = &slots[frame % header->slotCount];
+    seq = slot->seq.load(std::memory_order_acquire);
+    if (seq != 2 * (frame + 1))
+        return false;   // уже пишется следующий круг
+    outPixels = pixels + (frame % header->slotCount) * header->slotBytes;
+    return true;
+}
+
+bool SharedFrameReader::Validate(const SharedFrameSlot* slot, uint64_t seq) const
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot->seq.load(std::memory_order_relaxed) == seq;
+}
+
+// =================== эталонный потребитель ===================
+
+int RunSharedFrameConsumer(const std::string& name)
+{
+    // писатель может стартовать позже
+    SharedFrameReader reader;
+    int attempts = 0;
+    while (!reader.Open(name))
+    {
+        if (++attempts == 1)
+            std::cout << "Waiting for shared frame ring " << name << "..." << std::endl;
+        if (attempts > 3000)
+        {
+            std::cout << "Shared frame ring not found: " << name << std::endl;
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    const SharedFrameHeader& header = reader.Header();
+    std::cout << "Consuming " << name << ": " << header.width << "x" << header.height
+        << ", " << header.slotCount << " slots" << std::endl;
+
+    FrameTimeStats renderLatency;    // конец рендера -> получение
+    FrameTimeStats publishLatency;   // публикация -> получение
+    uint64_t received = 0;
+    uint64_t dropped = 0;
+    uint64_t torn = 0;
+    uint64_t lastFrame = 0;
+    bool first = true;
+    uint32_t checksum = 0;
+    const size_t bytes = (size_t)header.stride * header.height;
+
+    for (;;)
+    {
+        const SharedFrameSlot* slot = nullptr;
+        const uint8_t* pixels = nullptr;
+        uint64_t seq = 0;
+        if (!reader.AcquireLatest(first ? 0 : lastFrame + 1, slot, pixels, seq))
+        {
+            if (header.closed.load(std::memory_order_acquire))
+                break;
+            std::this_thread::yield();
+            continue;
+        }
+
+        int64_t now = SteadyNowNs();
+        uint64_t frame = slot->frameIndex;
+        int64_t renderedNs = slot->renderedNs;
+        int64_t publishedNs = slot->publishedNs;
+
+        // "обработка" прямо по разделяемой памяти: прочитать весь кадр
+        uint32_t sum = 0;
+        for (size_t i = 0; i < bytes; i += 64)
+            sum += pixels[i];
+
+        if (!reader.Validate(slot, seq))
+        {
+            ++torn;   // писатель обогнал нас на целый круг
+            continue;
+        }
+
+        if (!first && frame > lastFrame + 1)
+            dropped += frame - lastFrame - 1;
+        first = false;
+        lastFrame = frame;
+        checksum += sum;
+        ++received;
+        renderLatency.Add((now - renderedNs) / 1e6);
+        publishLatency.Add((now - publishedNs) / 1e6);
+    }
+
+    std::cout << "Received " << received << " frames, dropped " << dropped
+        << ", torn reads " << torn << " (checksum " << checksum << ")\n"
+        << "  render -> consumer:  " << renderLatency.Summary() << "\n"
+        << "  publish -> consumer: " << publishLatency.Summary() << std::endl;
+    return 0;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// =======================================================
+// ЭКСПОРТ КАДРОВ В РАЗДЕЛЯЕМУЮ ПАМЯТЬ
+// =======================================================
+//
+// Кольцо слотов в именованной разделяемой памяти (POSIX shm_open,
+// на Windows — CreateFileMapping). Писатель не ждёт читателя:
+// каждый слот защищён seqlock'ом, читатель работает прямо по памяти
+// слота и после чтения проверяет, что слот не перезаписали.
+// Пропуски видны по разрывам frameIndex.
+//
+// Раскладка: SharedFrameHeader | SharedFrameSlot[slotCount] | пиксели слотов.
+// Пиксели — RGBA8, строки снизу вверх (как отдаёт glReadPixels).
+
+const uint32_t kSharedFrameMagic = 0x4633314C;   // "L13F"
+const uint32_t kSharedFrameVersion = 1;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared ring needs lock-free 64-bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared ring needs lock-free 32-bit atomics");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "atomic magic must keep the header layout");
+
+struct alignas(64) SharedFrameHeader
+{
+    std::atomic<uint32_t> magic;        // пишется последним (release), читатель — acquire
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;                    // байт на строку
+    uint64_t slotBytes;                 // байт пикселей на слот (кратно 64)
+    std::atomic<uint64_t> published;    // опубликовано кадров; последний — published - 1
+    std::atomic<uint32_t> closed;       // писатель завершился
+};
+
+struct alignas(64) SharedFrameSlot
+{
+    // нечётное — слот пишется; 2 * (frameIndex + 1) — кадр frameIndex готов
+    std::atomic<uint64_t> seq;
+    uint64_t frameIndex;
+    int64_t renderedNs;                 // конец рендера кадра (SteadyNowNs)
+    int64_t publishedNs;                // кадр целиком в памяти
+};
+
+// монотонные часы, общие для процессов одной машины
+int64_t SteadyNowNs();
+
+// именованный блок разделяемой памяти
+class SharedMemory
+{
+public:
+    SharedMemory() = default;
+    ~SharedMemory() { Close(); }
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    bool Create(const std::string& name, size_t size);
+    bool Open(const std::string& name);
+    void Close();
+
+    uint8_t* Data() const { return data; }
+    size_t Size() const { return size; }
+
+private:
+    std::string name;
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    bool owner = false;
+#ifdef _WIN32
+    void* mapping = nullptr;
+#endif
+};
+
+class SharedFrameWriter
+{
+public:
+    bool Create(const std::string& name, unsigned w, unsigned h, unsigned slotCount = 4);
+    // rgba — w * h * 4 байт, строки снизу вверх
+    void Publish(const uint8_t* rgba, int64_t renderedNs);
+    void Close();
+
+    bool IsOpen() const { return header != nullptr; }
+    uint64_t Published() const { return next; }
+
+private:
+    SharedMemory memory;
+    SharedFrameHeader* header = nullptr;
+    SharedFrameSlot* slots = nullptr;
+    uint8_t* pixels = nullptr;
+    uint64_t next = 0;
+};
+
+class SharedFrameReader
+{
+public:
+    bool Open(const std::string& name);
+
+    const SharedFrameHeader& Header() const { return *header; }
+
+    // последний готовый кадр без копирования; false — нового кадра нет
+    // или слот сейчас пишется. После работы с pixels вызвать Validate.
+    bool AcquireLatest(uint64_t after, const SharedFrameSlot*& slot,
+        const uint8_t*& pixels, uint64_t& seq) const;
+    // true — слот не перезаписали, пока его читали
+    bool Validate(const SharedFrameSlot* slot, uint64_t seq) const;
+
+private:
+    SharedMemory memory;
+    const SharedFrameHeader* header = nullptr;
+    const SharedFrameSlot* slots = nullptr;
+    const uint8_t* pixels = nullptr;
+};
+
+// эталонный потребитель: читает кадры, пока писатель не закроет кольцо,
+// и печатает задержку от рендера до получения и число пропусков
+int RunSharedFrameConsumer(const std::string& name);
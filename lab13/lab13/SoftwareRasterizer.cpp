@@ -0,0 +1,564 @@
+#include "SoftwareRasterizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SOFT_RASTER_SSE2 1
+#endif
+
+namespace
+{
+    using SteadyClock = std::chrono::steady_clock;
+
+    double MsSince(SteadyClock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(SteadyClock::now() - t0).count();
+    }
+
+    struct ClipVert
+    {
+        float x, y, z, w;
+        float u, v;
+    };
+
+    ClipVert Lerp(const ClipVert& a, const ClipVert& b, float t)
+    {
+        return {
+            a.x + (b.x - a.x) * t,
+            a.y + (b.y - a.y) * t,
+            a.z + (b.z - a.z) * t,
+            a.w + (b.w - a.w) * t,
+            a.u + (b.u - a.u) * t,
+            a.v + (b.v - a.v) * t
+        };
+    }
+
+    // привязка к сетке 1/256 пикселя (субпиксельная точность как у GPU)
+    float Snap(float v)
+    {
+        return std::floor(v * 256.0f + 0.5f) * (1.0f / 256.0f);
+    }
+
+    uint32_t PackRGBA(float r, float g, float b, float a)
+    {
+        auto c = [](float v) { return (uint32_t)std::clamp(v + 0.5f, 0.0f, 255.0f); };
+        return c(r) | (c(g) << 8) | (c(b) << 16) | (c(a) << 24);
+    }
+
+    struct Color4
+    {
+        float r, g, b, a;
+    };
+
+    Color4 Unpack(uint32_t c)
+    {
+        return { (float)(c & 0xFF), (float)((c >> 8) & 0xFF), (float)((c >> 16) & 0xFF), (float)(c >> 24) };
+    }
+
+    int Wrap(int i, int n)
+    {
+        i %= n;
+        return i < 0 ? i + n : i;
+    }
+
+    // GL_LINEAR + GL_REPEAT на одном уровне, результат 0..255
+    Color4 SampleBilinear(const SoftTexture::Level& lv, float u, float v)
+    {
+        float fx = u * lv.width - 0.5f;
+        float fy = v * lv.height - 0.5f;
+        float flx = std::floor(fx);
+        float fly = std::floor(fy);
+        float ax = fx - flx;
+        float ay = fy - fly;
+
+        int x0 = Wrap((int)flx, lv.width);
+        int y0 = Wrap((int)fly, lv.height);
+        int x1 = (x0 + 1 == lv.width) ? 0 : x0 + 1;
+        int y1 = (y0 + 1 == lv.height) ? 0 : y0 + 1;
+
+        Color4 c00 = Unpack(lv.texels[(size_t)y0 * lv.width + x0]);
+        Color4 c10 = Unpack(lv.texels[(size_t)y0 * lv.width + x1]);
+        Color4 c01 = Unpack(lv.texels[(size_t)y1 * lv.width + x0]);
+        Color4 c11 = Unpack(lv.texels[(size_t)y1 * lv.width + x1]);
+
+        auto mix = [&](float a, float b, float c, float d)
+            {
+                float top = a + (b - a) * ax;
+                float bottom = c + (d - c) * ax;
+                return top + (bottom - top) * ay;
+            };
+        return {
+            mix(c00.r, c10.r, c01.r, c11.r),
+            mix(c00.g, c10.g, c01.g, c11.g),
+            mix(c00.b, c10.b, c01.b, c11.b),
+            mix(c00.a, c10.a, c01.a, c11.a)
+        };
+    }
+
+    // GL_LINEAR_MIPMAP_LINEAR, уровень по производным UV в пикселе
+    uint32_t SampleTrilinear(const SoftTexture& tex, float u, float v,
+        float dudx, float dvdx, float dudy, float dvdy)
+    {
+        const auto& base = tex.levels[0];
+        float w = (float)base.width;
+        float h = (float)base.height;
+        float lenX = (dudx * w) * (dudx * w) + (dvdx * h) * (dvdx * h);
+        float lenY = (dudy * w) * (dudy * w) + (dvdy * h) * (dvdy * h);
+        float lod = 0.5f * std::log2(std::max(lenX, lenY));
+
+        int maxLevel = (int)tex.levels.size() - 1;
+        if (!(lod > 0.0f))
+        {
+            Color4 c = SampleBilinear(base, u, v);
+            return PackRGBA(c.r, c.g, c.b, c.a);
+        }
+        if (lod >= (float)maxLevel)
+        {
+            Color4 c = SampleBilinear(tex.levels[maxLevel], u, v);
+            return PackRGBA(c.r, c.g, c.b, c.a);
+        }
+
+        int d0 = (int)lod;
+        float t = lod - (float)d0;
+        Color4 a = SampleBilinear(tex.levels[d0], u, v);
+        Color4 b = SampleBilinear(tex.levels[d0 + 1], u, v);
+        return PackRGBA(
+            a.r + (b.r - a.r) * t,
+            a.g + (b.g - a.g) * t,
+            a.b + (b.b - a.b) * t,
+            a.a + (b.a - a.a) * t);
+    }
+}
+
+SoftMesh SoftMesh::FromMeshData(const MeshData& data)
+{
+    SoftMesh m;
+    m.positions.reserve(data.indices.size());
+    m.texcoords.reserve(data.indices.size() * 2);
+    for (uint32_t v : data.indices)
+    {
+        m.positions.push_back(data.positions[v]);
+        m.texcoords.push_back(data.texcoords[v * 2]);
+        m.texcoords.push_back(data.texcoords[v * 2 + 1]);
+    }
+    m.triangleCount = data.TriangleCount();
+    return m;
+}
+
+SoftTexture SoftTexture::FromImage(const sf::Image& img)
+{
+    SoftTexture t;
+    Level level;
+    level.width = (int)img.getSize().x;
+    level.height = (int)img.getSize().y;
+    level.texels.resize((size_t)level.width * level.height);
+    if (!level.texels.empty())
+        std::memcpy(level.texels.data(), img.getPixelsPtr(), level.texels.size() * 4);
+    t.levels.push_back(std::move(level));
+
+    // box-фильтр 2x2, как glGenerateMipmap
+    while (t.levels.back().width > 1 || t.levels.back().height > 1)
+    {
+        const Level& src = t.levels.back();
+        Level dst;
+        dst.width = std::max(1, src.width / 2);
+        dst.height = std::max(1, src.height / 2);
+        dst.texels.resize((size_t)dst.width * dst.height);
+        for (int y = 0; y < dst.height; ++y)
+        {
+            int sy0 = std::min(y * 2, src.height - 1);
+            int sy1 = std::min(y * 2 + 1, src.height - 1);
+            for (int x = 0; x < dst.width; ++x)
+            {
+                int sx0 = std::min(x * 2, src.width - 1);
+                int sx1 = std::min(x * 2 + 1, src.width - 1);
+                uint32_t c[4] = {
+                    src.texels[(size_t)sy0 * src.width + sx0],
+                    src.texels[(size_t)sy0 * src.width + sx1],
+                    src.texels[(size_t)sy1 * src.width + sx0],
+                    src.texels[(size_t)sy1 * src.width + sx1]
+                };
+                uint32_t out = 0;
+                for (int ch = 0; ch < 4; ++ch)
+                {
+                    uint32_t sum = 2;
+                    for (uint32_t v : c)
+                        sum += (v >> (ch * 8)) & 0xFF;
+                    out |= (sum / 4) << (ch * 8);
+                }
+                dst.texels[(size_t)y * dst.width + x] = out;
+            }
+        }
+        t.levels.push_back(std::move(dst));
+    }
+    return t;
+}
+
+SoftwareRasterizer::SoftwareRasterizer(ThreadPool& pool)
+    : pool(pool)
+{
+}
+
+void SoftwareRasterizer::Resize(unsigned w, unsigned h)
+{
+    width = w;
+    height = h;
+    tilesX = (w + kTileSize - 1) / kTileSize;
+    tilesY = (h + kTileSize - 1) / kTileSize;
+    color.assign((size_t)w * h, 0);
+    depth.assign((size_t)w * h, 1.0f);
+}
+
+void SoftwareRasterizer::Clear(float r, float g, float b)
+{
+    std::fill(color.begin(), color.end(), PackRGBA(r * 255.0f, g * 255.0f, b * 255.0f, 255.0f));
+    std::fill(depth.begin(), depth.end(), 1.0f);
+}
+
+sf::Image SoftwareRasterizer::ToImage() const
+{
+    sf::Image img({ width, height }, reinterpret_cast<const std::uint8_t*>(color.data()));
+    img.flipVertically();
+    return img;
+}
+
+void SoftwareRasterizer::DrawInstances(const SoftMesh& mesh, const std::vector<Mat4>& models,
+    const Mat4& view, const Mat4& proj, const SoftTexture& tex)
+{
+    stats = SoftFrameStats();
+    stats.trianglesIn = mesh.triangleCount * models.size();
+
+    size_t unitsPerInstance = (mesh.triangleCount + kUnitTriangles - 1) / kUnitTriangles;
+    size_t unitCount = unitsPerInstance * models.size();
+    if (unitCount == 0 || width == 0 || height == 0 || tex.levels.empty())
+        return;
+
+    // --- геометрия: трансформация, отсечение, setup и раскладка по тайлам ---
+    auto t0 = SteadyClock::now();
+    const size_t tileCount = (size_t)tilesX * tilesY;
+    if (units.size() < unitCount)
+        units.resize(unitCount);
+    unitTileCount.assign(unitCount * tileCount, 0);
+
+    Mat4 viewProj = proj * view;
+    pool.ParallelFor(unitCount, [&](size_t u, unsigned)
+        {
+            size_t instance = u / unitsPerInstance;
+            size_t first = (u % unitsPerInstance) * kUnitTriangles;
+            size_t count = std::min(kUnitTriangles, mesh.triangleCount - first);
+
+            SetupUnit(units[u], mesh, viewProj * models[instance], first, count);
+
+            uint32_t* counts = &unitTileCount[u * tileCount];
+            for (uint32_t tile : units[u].binTile)
+                ++counts[tile];
+        });
+    stats.geometryMs = MsSince(t0);
+
+    // --- сборка списков тайлов в порядке отправки треугольников ---
+    auto t1 = SteadyClock::now();
+    tileStart.assign(tileCount + 1, 0);
+    uint32_t total = 0;
+    for (size_t tile = 0; tile < tileCount; ++tile)
+    {
+        tileStart[tile] = total;
+        for (size_t u = 0; u < unitCount; ++u)
+        {
+            uint32_t& c = unitTileCount[u * tileCount + tile];
+            uint32_t n = c;
+            c = total;     // теперь это смещение записи для (unit, tile)
+            total += n;
+        }
+    }
+    tileStart[tileCount] = total;
+    tileEntries.resize(total);
+
+    pool.ParallelFor(unitCount, [&](size_t u, unsigned)
+        {
+            uint32_t* offsets = &unitTileCount[u * tileCount];
+            const Unit& unit = units[u];
+            for (size_t i = 0; i < unit.binTile.size(); ++i)
+                tileEntries[offsets[unit.binTile[i]]++] = ((uint32_t)u << 11) | unit.binTri[i];
+        });
+
+    for (size_t u = 0; u < unitCount; ++u)
+        stats.trianglesSetup += units[u].tris.size();
+    stats.binEntries = total;
+    stats.binMs = MsSince(t1);
+
+    // --- растеризация: тайлы независимы, раздаются потокам ---
+    auto t2 = SteadyClock::now();
+    pool.ParallelFor(tileCount, [&](size_t tile, unsigned)
+        {
+            RasterTile((unsigned)tile, tex);
+        });
+    stats.rasterMs = MsSince(t2);
+}
+
+void SoftwareRasterizer::SetupUnit(Unit& unit, const SoftMesh& mesh, const Mat4& mvp,
+    size_t firstTri, size_t triCount)
+{
+    unit.tris.clear();
+    unit.binTile.clear();
+    unit.binTri.clear();
+
+    const float fw = (float)width;
+    const float fh = (float)height;
+
+    auto emit = [&](const ClipVert& a, const ClipVert& b, const ClipVert& c)
+        {
+            const ClipVert* v[3] = { &a, &b, &c };
+            float sx[3], sy[3], sz[3], iw[3], uw[3], vw[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                iw[k] = 1.0f / v[k]->w;
+                sx[k] = Snap((v[k]->x * iw[k] * 0.5f + 0.5f) * fw);
+                sy[k] = Snap((v[k]->y * iw[k] * 0.5f + 0.5f) * fh);
+                sz[k] = v[k]->z * iw[k] * 0.5f + 0.5f;
+                uw[k] = v[k]->u * iw[k];
+                vw[k] = v[k]->v * iw[k];
+            }
+
+            // лицевые грани — против часовой стрелки (glCullFace(GL_BACK))
+            float area2 = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sx[2] - sx[0]) * (sy[1] - sy[0]);
+            if (!(area2 > 0.0f))
+                return;
+
+            // пиксели, центры которых (i + 0.5) попадают в прямоугольник
+            float fMinX = std::ceil(std::min({ sx[0], sx[1], sx[2] }) - 0.5f);
+            float fMaxX = std::floor(std::max({ sx[0], sx[1], sx[2] }) - 0.5f);
+            float fMinY = std::ceil(std::min({ sy[0], sy[1], sy[2] }) - 0.5f);
+            float fMaxY = std::floor(std::max({ sy[0], sy[1], sy[2] }) - 0.5f);
+            if (fMaxX < 0.0f || fMaxY < 0.0f || fMinX > fw - 1.0f || fMinY > fh - 1.0f ||
+                fMinX > fMaxX || fMinY > fMaxY)
+                return;
+
+            SetupTri t;
+            t.minX = (int)std::max(fMinX, 0.0f);
+            t.maxX = (int)std::min(fMaxX, fw - 1.0f);
+            t.minY = (int)std::max(fMinY, 0.0f);
+            t.maxY = (int)std::min(fMaxY, fh - 1.0f);
+
+            // рёбра в каноническом порядке вершин: у соседних треугольников
+            // общее ребро вычисляется одинаково с точностью до знака,
+            // поэтому пиксель на ребре достаётся ровно одному из них
+            t.tieMask = 0;
+            for (int k = 0; k < 3; ++k)
+            {
+                int ia = (k + 1) % 3;
+                int ib = (k + 2) % 3;
+                bool swapped = (sx[ib] < sx[ia]) || (sx[ib] == sx[ia] && sy[ib] < sy[ia]);
+                if (swapped)
+                    std::swap(ia, ib);
+                float sign = swapped ? -1.0f : 1.0f;
+                t.ex[k] = sx[ia];
+                t.ey[k] = sy[ia];
+                t.edx[k] = (sx[ib] - sx[ia]) * sign;
+                t.edy[k] = (sy[ib] - sy[ia]) * sign;
+                if (!swapped)
+                    t.tieMask |= 1u << k;
+            }
+
+            // барицентрические плоскости для атрибутов
+            float inv = 1.0f / area2;
+            float l1a = -(sy[0] - sy[2]) * inv, l1b = (sx[0] - sx[2]) * inv;
+            float l1c = -(l1a * sx[2] + l1b * sy[2]);
+            float l2a = -(sy[1] - sy[0]) * inv, l2b = (sx[1] - sx[0]) * inv;
+            float l2c = -(l2a * sx[0] + l2b * sy[0]);
+            auto plane = [&](const float* f, float* out)
+                {
+                    float d1 = f[1] - f[0];
+                    float d2 = f[2] - f[0];
+                    out[0] = l1a * d1 + l2a * d2;
+                    out[1] = l1b * d1 + l2b * d2;
+                    out[2] = f[0] + l1c * d1 + l2c * d2;
+                };
+            plane(sz, t.z);
+            plane(iw, t.invW);
+            plane(uw, t.uOverW);
+            plane(vw, t.vOverW);
+
+            uint16_t index = (uint16_t)unit.tris.size();
+            unit.tris.push_back(t);
+
+            // раскладка по тайлам с отбрасыванием тайлов целиком снаружи ребра
+            int tx0 = t.minX / kTileSize, tx1 = t.maxX / kTileSize;
+            int ty0 = t.minY / kTileSize, ty1 = t.maxY / kTileSize;
+            bool single = (tx0 == tx1 && ty0 == ty1);
+            for (int ty = ty0; ty <= ty1; ++ty)
+            {
+                for (int tx = tx0; tx <= tx1; ++tx)
+                {
+                    if (!single)
+                    {
+                        bool outside = false;
+                        for (int k = 0; k < 3 && !outside; ++k)
+                        {
+                            // угол тайла, наиболее "внутренний" для ребра k
+                            float cx = (float)(t.edy[k] < 0.0f ? (tx + 1) * kTileSize : tx * kTileSize);
+                            float cy = (float)(t.edx[k] > 0.0f ? (ty + 1) * kTileSize : ty * kTileSize);
+                            float e = (cy - t.ey[k]) * t.edx[k] - (cx - t.ex[k]) * t.edy[k];
+                            outside = e < 0.0f;
+                        }
+                        if (outside)
+                            continue;
+                    }
+                    unit.binTile.push_back((uint32_t)(ty * tilesX + tx));
+                    unit.binTri.push_back(index);
+                }
+            }
+        };
+
+    for (size_t tri = firstTri; tri < firstTri + triCount; ++tri)
+    {
+        ClipVert v[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            size_t vi = tri * 3 + k;
+            Vec4 c = TransformPoint(mvp, mesh.positions[vi]);
+            v[k] = { c.x, c.y, c.z, c.w, mesh.texcoords[vi * 2], mesh.texcoords[vi * 2 + 1] };
+        }
+
+        // тривиальное отбрасывание: все три вершины за одной плоскостью
+        auto allOutside = [&](auto pred) { return pred(v[0]) && pred(v[1]) && pred(v[2]); };
+        if (allOutside([](const ClipVert& p) { return p.x > p.w; }) ||
+            allOutside([](const ClipVert& p) { return p.x < -p.w; }) ||
+            allOutside([](const ClipVert& p) { return p.y > p.w; }) ||
+            allOutside([](const ClipVert& p) { return p.y < -p.w; }) ||
+            allOutside([](const ClipVert& p) { return p.z > p.w; }) ||
+            allOutside([](const ClipVert& p) { return p.z < -p.w; }))
+            continue;
+
+        bool crossesNear = v[0].z < -v[0].w || v[1].z < -v[1].w || v[2].z < -v[2].w;
+        if (!crossesNear)
+        {
+            emit(v[0], v[1], v[2]);
+            continue;
+        }
+
+        // отсечение ближней плоскостью (z = -w), остальные — через guard band
+        ClipVert poly[4];
+        int n = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            const ClipVert& a = v[k];
+            const ClipVert& b = v[(k + 1) % 3];
+            float da = a.z + a.w;
+            float db = b.z + b.w;
+            if (da >= 0.0f)
+                poly[n++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f))
+                poly[n++] = Lerp(a, b, da / (da - db));
+        }
+        for (int k = 1; k + 1 < n; ++k)
+            emit(poly[0], poly[k], poly[k + 1]);
+    }
+}
+
+void SoftwareRasterizer::RasterTile(unsigned tile, const SoftTexture& tex)
+{
+    int tileX0 = (int)(tile % tilesX) * kTileSize;
+    int tileY0 = (int)(tile / tilesX) * kTileSize;
+    int tileX1 = std::min(tileX0 + kTileSize, (int)width) - 1;
+    int tileY1 = std::min(tileY0 + kTileSize, (int)height) - 1;
+
+    for (uint32_t e = tileStart[tile]; e < tileStart[tile + 1]; ++e)
+    {
+        uint32_t entry = tileEntries[e];
+        const SetupTri& t = units[entry >> 11].tris[entry & 2047];
+
+        int minX = std::max(t.minX, tileX0);
+        int maxX = std::min(t.maxX, tileX1);
+        int minY = std::max(t.minY, tileY0);
+        int maxY = std::min(t.maxY, tileY1);
+        if (minX > maxX || minY > maxY)
+            continue;
+
+#ifdef SOFT_RASTER_SSE2
+        const __m128 laneOffset = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+        __m128 ex[3], edx[3], edy[3], tie[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            ex[k] = _mm_set1_ps(t.ex[k]);
+            edx[k] = _mm_set1_ps(t.edx[k]);
+            edy[k] = _mm_set1_ps(t.edy[k]);
+            tie[k] = _mm_castsi128_ps(_mm_set1_epi32((t.tieMask >> k) & 1 ? -1 : 0));
+        }
+#endif
+
+        for (int y = minY; y <= maxY; ++y)
+        {
+            float py = (float)y + 0.5f;
+            size_t row = (size_t)y * width;
+
+            for (int x = minX & ~3; x <= maxX; x += 4)
+            {
+                // пиксели за правой границей кадра не трогаем
+                int laneValid = (int)width - x >= 4 ? 0xF : (1 << ((int)width - x)) - 1;
+                int covered = 0;
+
+#ifdef SOFT_RASTER_SSE2
+                __m128 px = _mm_add_ps(_mm_set1_ps((float)x), laneOffset);
+                __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (int k = 0; k < 3; ++k)
+                {
+                    __m128 dy = _mm_set1_ps(py - t.ey[k]);
+                    __m128 ev = _mm_sub_ps(_mm_mul_ps(dy, edx[k]),
+                        _mm_mul_ps(_mm_sub_ps(px, ex[k]), edy[k]));
+                    __m128 in = _mm_or_ps(_mm_cmpgt_ps(ev, zero),
+                        _mm_and_ps(_mm_cmpeq_ps(ev, zero), tie[k]));
+                    inside = _mm_and_ps(inside, in);
+                }
+                covered = _mm_movemask_ps(inside);
+#else
+                for (int l = 0; l < 4; ++l)
+                {
+                    float pxl = (float)(x + l) + 0.5f;
+                    bool in = true;
+                    for (int k = 0; k < 3 && in; ++k)
+                    {
+                        float ev = (py - t.ey[k]) * t.edx[k] - (pxl - t.ex[k]) * t.edy[k];
+                        in = ev > 0.0f || (ev == 0.0f && ((t.tieMask >> k) & 1));
+                    }
+                    if (in) covered |= 1 << l;
+                }
+#endif
+                covered &= laneValid;
+
+                while (covered)
+                {
+                    int l = 0;
+                    while (!((covered >> l) & 1)) ++l;
+                    covered &= covered - 1;
+
+                    int pxi = x + l;
+                    float fx = (float)pxi + 0.5f;
+                    size_t idx = row + pxi;
+
+                    // GL_LESS + отсечение дальней плоскостью
+                    float z = t.z[0] * fx + t.z[1] * py + t.z[2];
+                    if (!(z < depth[idx]) || z > 1.0f)
+                        continue;
+
+                    float invW = t.invW[0] * fx + t.invW[1] * py + t.invW[2];
+                    float w = 1.0f / invW;
+                    float u = (t.uOverW[0] * fx + t.uOverW[1] * py + t.uOverW[2]) * w;
+                    float v = (t.vOverW[0] * fx + t.vOverW[1] * py + t.vOverW[2]) * w;
+
+                    // аналитические производные UV для выбора mip-уровня
+                    float dudx = (t.uOverW[0] - u * t.invW[0]) * w;
+                    float dvdx = (t.vOverW[0] - v * t.invW[0]) * w;
+                    float dudy = (t.uOverW[1] - u * t.invW[1]) * w;
+                    float dvdy = (t.vOverW[1] - v * t.invW[1]) * w;
+
+                    depth[idx] = z;
+                    color[idx] = SampleTrilinear(tex, u, v, dudx, dvdx, dudy, dvdy);
+                }
+            }
+        }
+    }
+}
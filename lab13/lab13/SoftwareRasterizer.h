@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Math3D.h"
+#include "MeshData.h"
+#include "ThreadPool.h"
+
+#include <SFML/Graphics/Image.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// =======================================================
+// ПРОГРАММНЫЙ РАСТЕРИЗАТОР (CPU-бэкенд без GPU)
+// =======================================================
+//
+// Тайловый растеризатор: треугольники трансформируются и
+// раскладываются по тайлам (binning), затем тайлы параллельно
+// растеризуются пулом потоков. Состояние повторяет GL-путь:
+// отсечение задних граней (CCW), тест глубины GL_LESS,
+// GL_LINEAR_MIPMAP_LINEAR + GL_REPEAT, перспективно-корректные UV.
+
+// копия меша для CPU: позиции и UV без GL-буферов
+struct SoftMesh
+{
+    std::vector<Vec3> positions;
+    std::vector<float> texcoords;   // по 2 на вершину
+    size_t triangleCount = 0;
+
+    // меш LoadOBJ, развёрнутый по индексам в треугольники
+    static SoftMesh FromMeshData(const MeshData& data);
+};
+
+// текстура с mip-цепочкой (как после glGenerateMipmap)
+struct SoftTexture
+{
+    struct Level
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<uint32_t> texels;   // RGBA8, строки снизу вверх
+    };
+    std::vector<Level> levels;
+
+    // img уже перевёрнут по вертикали, как при загрузке в GL
+    static SoftTexture FromImage(const sf::Image& img);
+};
+
+struct SoftFrameStats
+{
+    size_t trianglesIn = 0;
+    size_t trianglesSetup = 0;    // после отсечения и отбраковки
+    size_t binEntries = 0;
+    double geometryMs = 0.0;
+    double binMs = 0.0;
+    double rasterMs = 0.0;
+};
+
+class SoftwareRasterizer
+{
+public:
+    explicit SoftwareRasterizer(ThreadPool& pool);
+
+    void Resize(unsigned w, unsigned h);
+    void Clear(float r, float g, float b);
+
+    // рисует mesh для каждой матрицы модели (аналог цикла glDrawArrays)
+    void DrawInstances(const SoftMesh& mesh, const std::vector<Mat4>& models,
+        const Mat4& view, const Mat4& proj, const SoftTexture& tex);
+
+    unsigned Width() const { return width; }
+    unsigned Height() const { return height; }
+
+    // RGBA8, строки снизу вверх (как glReadPixels)
+    const std::vector<uint32_t>& ColorBuffer() const { return color; }
+    sf::Image ToImage() const;
+
+    const SoftFrameStats& Stats() const { return stats; }
+
+    static const int kTileSize = 64;
+    static const size_t kUnitTriangles = 1024;   // треугольников на задачу геометрии
+
+    // треугольник после setup: рёбра и плоскости атрибутов в оконных координатах
+    struct SetupTri
+    {
+        // ребро k: e = (py - ey) * edx - (px - ex) * edy, внутри e > 0
+        float ex[3], ey[3], edx[3], edy[3];
+        uint32_t tieMask;            // бит k: пиксель на ребре (e == 0) принадлежит треугольнику
+        float z[3];                  // плоскость a*x + b*y + c для глубины
+        float invW[3], uOverW[3], vOverW[3];
+        int minX, minY, maxX, maxY;  // ограничивающий прямоугольник, включительно
+    };
+
+    // одна задача геометрии: часть треугольников одного экземпляра
+    struct Unit
+    {
+        std::vector<SetupTri> tris;
+        std::vector<uint32_t> binTile;     // для каждой записи: номер тайла
+        std::vector<uint16_t> binTri;      // и треугольник внутри unit
+    };
+
+private:
+    void SetupUnit(Unit& unit, const SoftMesh& mesh, const Mat4& mvp,
+        size_t firstTri, size_t triCount);
+    void RasterTile(unsigned tile, const SoftTexture& tex);
+
+    ThreadPool& pool;
+
+    unsigned width = 0;
+    unsigned height = 0;
+    unsigned tilesX = 0;
+    unsigned tilesY = 0;
+
+    std::vector<uint32_t> color;
+    std::vector<float> depth;
+
+    std::vector<Unit> units;
+    std::vector<uint32_t> tileStart;
+    std::vector<uint32_t> unitTileCount;  // [unit * tiles + tile]
+    std::vector<uint32_t> tileEntries;    // (unit << 11) | треугольник внутри unit
+
+    SoftFrameStats stats;
+};
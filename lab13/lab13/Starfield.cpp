@@ -0,0 +1,379 @@
+#include "Starfield.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const char* starVertexSrc = R"(
+        #version 330 core
+        layout(location = 0) in vec3 aPosition;
+        layout(location = 1) in vec4 aColor;    // sRGB + величина в альфе
+
+        uniform mat4 uViewProj;
+        uniform float uLimit;
+        uniform float uBrightness;
+        uniform bool uLinear;
+
+        out vec3 vColor;
+
+        void main()
+        {
+            float magnitude = aColor.a * (255.0 / 16.0) - 2.0;
+            if (magnitude > uLimit)
+            {
+                // за дальней плоскостью: точка отсекается до растеризации
+                gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+                gl_PointSize = 1.0;
+                vColor = vec3(0.0);
+                return;
+            }
+
+            // только направление: w = 0 убирает перенос камеры
+            vec4 clip = uViewProj * vec4(normalize(aPosition), 0.0);
+            gl_Position = clip.xyww;
+
+            // поток относительно предела; яркие звёзды крупнее, а не ярче
+            float flux = uBrightness * pow(10.0, -0.4 * (magnitude - uLimit));
+            float size = clamp(sqrt(flux) * 1.5, 1.0, 5.0);
+            gl_PointSize = size;
+
+            vec3 color = uLinear ? pow(aColor.rgb, vec3(2.2)) : aColor.rgb;
+            vColor = color * flux / max(1.0, 0.2 * size * size);
+        }
+    )";
+
+    const char* starFragmentSrc = R"(
+        #version 330 core
+        in vec3 vColor;
+        out vec4 FragColor;
+
+        void main()
+        {
+            vec2 d = gl_PointCoord * 2.0 - 1.0;
+            float r2 = dot(d, d);
+            if (r2 > 1.0)
+                discard;
+            FragColor = vec4(vColor * exp(-4.0 * r2), 1.0);
+        }
+    )";
+
+    float MagnitudeOf(const StarRecord& s)
+    {
+        return s.magnitude / 16.0f - 2.0f;
+    }
+
+    // файл только для чтения, отображённый в память
+    class MappedFile
+    {
+    public:
+        ~MappedFile() { Close(); }
+
+        bool Open(const std::string& path)
+        {
+#ifdef _WIN32
+            file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                return false;
+            LARGE_INTEGER bytes;
+            if (!GetFileSizeEx(file, &bytes) || bytes.QuadPart == 0)
+            {
+                Close();
+                return false;
+            }
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            data = mapping ? (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            if (!data)
+            {
+                Close();
+                return false;
+            }
+            size = (size_t)bytes.QuadPart;
+#else
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return false;
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size <= 0)
+            {
+                close(fd);
+                return false;
+            }
+            void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (p == MAP_FAILED)
+                return false;
+            // читается один раз от начала до конца
+            madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+            data = (const uint8_t*)p;
+            size = (size_t)st.st_size;
+#endif
+            return true;
+        }
+
+        void Close()
+        {
+#ifdef _WIN32
+            if (data)
+                UnmapViewOfFile(data);
+            if (mapping)
+                CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE)
+                CloseHandle(file);
+            mapping = nullptr;
+            file = INVALID_HANDLE_VALUE;
+#else
+            if (data)
+                munmap((void*)data, size);
+#endif
+            data = nullptr;
+            size = 0;
+        }
+
+        const uint8_t* Data() const { return data; }
+        size_t Size() const { return size; }
+
+    private:
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#endif
+    };
+}
+
+std::vector<StarRecord> GenerateStars(unsigned count, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    auto frand = [&](float a, float b)
+        {
+            return a + (b - a) * (float)(rng() / 4294967295.0);
+        };
+
+    // цвет по температуре: голубые -> белые -> жёлтые -> оранжевые
+    const float palette[4][3] = {
+        { 0.68f, 0.78f, 1.00f },
+        { 1.00f, 1.00f, 1.00f },
+        { 1.00f, 0.90f, 0.70f },
+        { 1.00f, 0.72f, 0.48f },
+    };
+    // плоскость Млечного Пути наклонена к плоскости орбит
+    const float tilt = 1.05f;
+    const float cosTilt = std::cos(tilt), sinTilt = std::sin(tilt);
+    const float faintest = 13.5f;
+
+    std::vector<StarRecord> stars(count);
+    for (StarRecord& s : stars)
+    {
+        float lon = frand(0.0f, 6.2831853f);
+        float sinLat;
+        if (frand(0.0f, 1.0f) < 0.4f)
+            sinLat = frand(-1.0f, 1.0f);   // равномерно по сфере
+        else
+            sinLat = (frand(-1.0f, 1.0f) + frand(-1.0f, 1.0f) + frand(-1.0f, 1.0f)) * 0.08f;   // полоса
+        float cosLat = std::sqrt(std::max(0.0f, 1.0f - sinLat * sinLat));
+        float x = cosLat * std::cos(lon);
+        float y = sinLat;
+        float z = cosLat * std::sin(lon);
+        float distance = frand(5.0f, 2000.0f);
+        s.position[0] = x * distance;
+        s.position[1] = (y * cosTilt - z * sinTilt) * distance;
+        s.position[2] = (y * sinTilt + z * cosTilt) * distance;
+
+        // обратная функция N(<m) ~ 10^(0.45 m), m <= faintest
+        float m = faintest + std::log10(std::max(frand(0.0f, 1.0f), 1e-9f)) / 0.45f;
+        s.magnitude = (uint8_t)std::clamp((m + 2.0f) * 16.0f + 0.5f, 0.0f, 255.0f);
+
+        float t = frand(0.0f, 2.999f);
+        int i = (int)t;
+        float f = t - i;
+        for (int c = 0; c < 3; ++c)
+        {
+            float v = palette[i][c] + (palette[i + 1][c] - palette[i][c]) * f;
+            s.color[c] = (uint8_t)(v * 255.0f + 0.5f);
+        }
+    }
+    return stars;
+}
+
+bool WriteStarCatalog(const std::string& path, const std::vector<StarRecord>& stars)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Failed to create star catalog: " << path << std::endl;
+        return false;
+    }
+    StarCatalogHeader header;
+    header.count = (uint32_t)stars.size();
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)stars.data(), stars.size() * sizeof(StarRecord));
+    return file.good();
+}
+
+bool Starfield::Init(const StarfieldSettings& s)
+{
+    settings = s;
+
+    GLuint vert = CompileShader(GL_VERTEX_SHADER, starVertexSrc);
+    GLuint frag = CompileShader(GL_FRAGMENT_SHADER, starFragmentSrc);
+    prog = LinkProgram(vert, frag);
+    glDeleteShader(vert);
+    glDeleteShader(frag);
+    GLint ok = 0;
+    glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+    if (!ok)
+    {
+        Destroy();
+        return false;
+    }
+    viewProjLoc = glGetUniformLocation(prog, "uViewProj");
+    limitLoc = glGetUniformLocation(prog, "uLimit");
+    brightnessLoc = glGetUniformLocation(prog, "uBrightness");
+    linearLoc = glGetUniformLocation(prog, "uLinear");
+
+    auto t0 = std::chrono::steady_clock::now();
+    bool loaded = false;
+    if (!settings.catalog.empty())
+    {
+        MappedFile file;
+        if (!file.Open(settings.catalog))
+            std::cout << "Failed to open star catalog: " << settings.catalog << ", generating stars" << std::endl;
+        else
+        {
+            StarCatalogHeader header;
+            bool valid = file.Size() >= sizeof(header);
+            if (valid)
+            {
+                std::memcpy(&header, file.Data(), sizeof(header));
+                valid = std::memcmp(header.magic, "STAR", 4) == 0 && header.version == 1 &&
+                    header.recordSize == sizeof(StarRecord) &&
+                    file.Size() >= sizeof(header) + (size_t)header.count * sizeof(StarRecord);
+            }
+            if (!valid)
+                std::cout << "Bad star catalog: " << settings.catalog << ", generating stars" << std::endl;
+            else
+            {
+                // записи читаются прямо из отображения
+                loaded = Upload((const StarRecord*)(file.Data() + sizeof(header)), header.count);
+            }
+        }
+        if (!loaded)
+            settings.catalog.clear();
+    }
+    if (!loaded)
+    {
+        std::vector<StarRecord> stars = GenerateStars(settings.count, settings.seed);
+        Upload(stars.data(), stars.size());
+    }
+    loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    timer.Init(4, true);
+    return true;
+}
+
+bool Starfield::Upload(const StarRecord* stars, size_t n)
+{
+    count = n;
+    visible = 0;
+    for (size_t i = 0; i < n; ++i)
+        visible += MagnitudeOf(stars[i]) <= settings.magnitudeLimit;
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, n * sizeof(StarRecord), stars, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(StarRecord), (void*)offsetof(StarRecord, position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(StarRecord), (void*)offsetof(StarRecord, color));
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (glGetError() == GL_OUT_OF_MEMORY)
+    {
+        std::cout << "Out of GPU memory for " << n << " stars" << std::endl;
+        glDeleteBuffers(1, &vbo);
+        glDeleteVertexArrays(1, &vao);
+        vbo = vao = 0;
+        count = visible = 0;
+        return false;
+    }
+    return true;
+}
+
+void Starfield::Destroy()
+{
+    timer.Destroy();
+    glDeleteBuffers(1, &vbo);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteProgram(prog);
+    vbo = vao = prog = 0;
+    count = visible = 0;
+}
+
+void Starfield::Draw(const Mat4& view, const Mat4& proj)
+{
+    if (count == 0)
+        return;
+
+    double ms = 0.0;
+    if (timer.Poll(ms))
+        gpuMs.Add(ms);
+    timer.Begin();
+
+    Mat4 viewProj = proj * view;
+    glUseProgram(prog);
+    glUniformMatrix4fv(viewProjLoc, 1, GL_FALSE, viewProj.m);
+    glUniform1f(limitLoc, settings.magnitudeLimit);
+    glUniform1f(brightnessLoc, settings.brightness);
+    glUniform1i(linearLoc, settings.linearOutput ? 1 : 0);
+
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_FALSE);
+
+    glBindVertexArray(vao);
+    glDrawArrays(GL_POINTS, 0, (GLsizei)count);
+    glBindVertexArray(0);
+
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
+    glDisable(GL_BLEND);
+    glDisable(GL_PROGRAM_POINT_SIZE);
+    glUseProgram(0);
+
+    timer.End();
+}
+
+std::string Starfield::Summary() const
+{
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "%zu stars (%s), %.1f MB, load %.0f ms, limit %.1f mag (%zu visible), GPU: ",
+        count, settings.catalog.empty() ? "procedural" : ("catalog " + settings.catalog + ", mapped").c_str(),
+        count * sizeof(StarRecord) / (1024.0 * 1024.0), loadMs, settings.magnitudeLimit, visible);
+    return buf + gpuMs.Summary();
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "FrameStats.h"
+#include "GlUtils.h"
+#include "GpuTimer.h"
+#include "Math3D.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// =======================================================
+// ЗВЁЗДНОЕ НЕБО ИЗ КАТАЛОГА
+// =======================================================
+//
+// Звёзды — точки на бесконечности: один glDrawArrays(GL_POINTS) на
+// весь каталог, буфер загружается один раз, на кадр CPU передаёт
+// только матрицу. Вершинный шейдер отбрасывает звёзды слабее
+// предельной величины и по блеску задаёт размер и яркость спрайта.
+// Рисуется после сцены: глубина на дальней плоскости (z = w),
+// GL_LEQUAL, без записи глубины, аддитивно — планеты закрывают звёзды
+// на любом пути освещения, а фрагменты за ними отсекаются тестом.
+//
+// Каталог — бинарный файл: StarCatalogHeader, затем count записей
+// StarRecord. Файл отображается в память (mmap / MapViewOfFile) и
+// отдаётся в glBufferData без копии в куче. Без каталога звёзды
+// генерируются процедурно (WriteStarCatalog сохраняет такой набор).
+
+// 16 байт на звезду
+struct StarRecord
+{
+    float position[3];     // в парсеках от Солнца; на небе важно только направление
+    uint8_t color[3];      // sRGB
+    uint8_t magnitude;     // (звёздная величина + 2) * 16: от -2 до 13.9
+};
+
+struct StarCatalogHeader
+{
+    char magic[4] = { 'S', 'T', 'A', 'R' };
+    uint32_t version = 1;
+    uint32_t count = 0;
+    uint32_t recordSize = sizeof(StarRecord);
+};
+
+struct StarfieldSettings
+{
+    std::string catalog;          // пусто — процедурные звёзды
+    unsigned count = 1000000;     // для процедурных
+    unsigned seed = 1;
+    float magnitudeLimit = 9.5f;  // слабее — отбрасываются в вершинном шейдере
+    float brightness = 0.06f;     // яркость звезды на пределе видимости
+    bool linearOutput = false;    // цель в линейном цвете (HDR)
+};
+
+// звёзды с распределением величин N(<m) ~ 10^(0.45 m) и сгущением к
+// полосе Млечного Пути; один seed — один и тот же набор
+std::vector<StarRecord> GenerateStars(unsigned count, unsigned seed);
+bool WriteStarCatalog(const std::string& path, const std::vector<StarRecord>& stars);
+
+class Starfield
+{
+public:
+    bool Init(const StarfieldSettings& settings);
+    void Destroy();
+
+    // в текущий framebuffer поверх сцены (её глубина уже в нём)
+    void Draw(const Mat4& view, const Mat4& proj);
+
+    size_t Count() const { return count; }
+
+    // "1000000 stars (procedural), 15.3 MB, load 210 ms, limit 9.5 mag (16400 visible), GPU: <FrameTimeStats>"
+    std::string Summary() const;
+
+private:
+    bool Upload(const StarRecord* stars, size_t n);
+
+    StarfieldSettings settings;
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    size_t count = 0;
+    size_t visible = 0;            // не слабее предела (для Summary)
+    double loadMs = 0.0;
+
+    GLuint prog = 0;
+    GLint viewProjLoc = -1;
+    GLint limitLoc = -1;
+    GLint brightnessLoc = -1;
+    GLint linearLoc = -1;
+
+    GpuTimer timer;                // timestamps: может стоять внутри замера кадра
+    FrameTimeStats gpuMs;
+};
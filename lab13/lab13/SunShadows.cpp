@@ -0,0 +1,341 @@
+#include "SunShadows.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    const char* shadowVertexSrc = R"(
+        #version 330 core
+        layout(location = 0) in vec3 aPos;
+        layout(location = 2) in mat4 aModel;
+        layout(location = 6) in uint aFaces;
+
+        out vec3 vWorld;
+        flat out uint vFaces;
+
+        void main()
+        {
+            vWorld = (aModel * vec4(aPos, 1.0)).xyz;
+            vFaces = aFaces;
+            gl_Position = vec4(vWorld, 1.0);
+        }
+    )";
+
+    // треугольник уходит только в грани из маски планеты
+    const char* shadowGeometrySrc = R"(
+        #version 330 core
+        layout(triangles) in;
+        layout(triangle_strip, max_vertices = 18) out;
+
+        in vec3 vWorld[];
+        flat in uint vFaces[];
+
+        uniform mat4 uFaceViewProj[6];
+        uniform uint uDirtyFaces;
+
+        out vec3 gWorld;
+
+        void main()
+        {
+            uint mask = vFaces[0] & uDirtyFaces;
+            for (int face = 0; face < 6; ++face)
+            {
+                if ((mask & (1u << uint(face))) == 0u)
+                    continue;
+                for (int i = 0; i < 3; ++i)
+                {
+                    gl_Layer = face;
+                    gWorld = vWorld[i];
+                    gl_Position = uFaceViewProj[face] * vec4(vWorld[i], 1.0);
+                    EmitVertex();
+                }
+                EndPrimitive();
+            }
+        }
+    )";
+
+    const char* shadowFragmentSrc = R"(
+        #version 330 core
+        in vec3 gWorld;
+
+        uniform vec3 uLightPos;
+        uniform float uRange;
+
+        void main()
+        {
+            gl_FragDepth = length(gWorld - uLightPos) / uRange;
+        }
+    )";
+
+    // оси граней в порядке GL_TEXTURE_CUBE_MAP_POSITIVE_X + i
+    const Vec3 kFaceDir[6] = {
+        Vec3(1, 0, 0), Vec3(-1, 0, 0), Vec3(0, 1, 0), Vec3(0, -1, 0), Vec3(0, 0, 1), Vec3(0, 0, -1)
+    };
+    const Vec3 kFaceUp[6] = {
+        Vec3(0, -1, 0), Vec3(0, -1, 0), Vec3(0, 0, 1), Vec3(0, 0, -1), Vec3(0, -1, 0), Vec3(0, -1, 0)
+    };
+
+    // сфера (c относительно света) задевает пирамиду грани с углом 90°:
+    // пирамида — |u| <= a, |v| <= a, расстояние до плоскости a - u = 0
+    // равно (a - u) / sqrt 2
+    bool SphereTouchesFace(const Vec3& c, float r, int face)
+    {
+        const float k = 1.41421356f * r;
+        const float* p = &c.x;
+        int axis = face / 2;
+        float a = (face % 2 == 0) ? p[axis] : -p[axis];
+        float u = p[(axis + 1) % 3];
+        float v = p[(axis + 2) % 3];
+        return a - u >= -k && a + u >= -k && a - v >= -k && a + v >= -k;
+    }
+
+    uint64_t HashBytes(uint64_t h, const void* data, size_t size)
+    {
+        const unsigned char* b = (const unsigned char*)data;
+        for (size_t i = 0; i < size; ++i)
+        {
+            h ^= b[i];
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    const uint64_t kHashSeed = 14695981039346656037ull;
+}
+
+bool SunShadowMap::Init(const SunShadowSettings& s, const Mesh& mesh)
+{
+    settings = s;
+    settings.interval = std::max(1u, settings.interval);
+    meshRadius = mesh.boundingRadius;
+
+    GLuint vert = CompileShader(GL_VERTEX_SHADER, shadowVertexSrc);
+    GLuint geom = CompileShader(GL_GEOMETRY_SHADER, shadowGeometrySrc);
+    GLuint frag = CompileShader(GL_FRAGMENT_SHADER, shadowFragmentSrc);
+    prog = glCreateProgram();
+    glAttachShader(prog, vert);
+    glAttachShader(prog, geom);
+    glAttachShader(prog, frag);
+    glLinkProgram(prog);
+    glDeleteShader(vert);
+    glDeleteShader(geom);
+    glDeleteShader(frag);
+
+    GLint ok = 0;
+    glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+    if (!ok)
+    {
+        ProgramLog(prog);
+        glDeleteProgram(prog);
+        prog = 0;
+        return false;
+    }
+    uFaceViewProjLoc = glGetUniformLocation(prog, "uFaceViewProj");
+    uDirtyFacesLoc = glGetUniformLocation(prog, "uDirtyFaces");
+    uLightPosLoc = glGetUniformLocation(prog, "uLightPos");
+    uRangeLoc = glGetUniformLocation(prog, "uRange");
+
+    // --- кубическая карта глубины со сравнением ---
+    glGenTextures(1, &cube);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cube);
+    for (int face = 0; face < 6; ++face)
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_DEPTH_COMPONENT24,
+            settings.size, settings.size, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+    glGenFramebuffers(1, &layeredFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, layeredFBO);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, cube, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    glGenFramebuffers(6, faceFBO);
+    for (int face = 0; face < 6; ++face)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, faceFBO[face]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, cube, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete)
+    {
+        std::cout << "Sun shadow map framebuffer is incomplete" << std::endl;
+        return false;
+    }
+
+    // --- VAO: позиции меша + данные планет ---
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &instanceVBO);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, position));
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    for (GLuint col = 0; col < 4; ++col)
+    {
+        glVertexAttribPointer(2 + col, 4, GL_FLOAT, GL_FALSE, sizeof(Caster), (void*)(col * 4 * sizeof(float)));
+        glEnableVertexAttribArray(2 + col);
+        glVertexAttribDivisor(2 + col, 1);
+    }
+    glVertexAttribIPointer(6, 1, GL_UNSIGNED_INT, sizeof(Caster), (void*)offsetof(Caster, faces));
+    glEnableVertexAttribArray(6);
+    glVertexAttribDivisor(6, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    indexCount = mesh.indexCount;
+    indexType = mesh.indexType;
+    valid = false;
+    frame = 0;
+    return true;
+}
+
+void SunShadowMap::Destroy()
+{
+    glDeleteProgram(prog);
+    glDeleteTextures(1, &cube);
+    glDeleteFramebuffers(1, &layeredFBO);
+    glDeleteFramebuffers(6, faceFBO);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &instanceVBO);
+    prog = cube = layeredFBO = vao = instanceVBO = 0;
+    std::memset(faceFBO, 0, sizeof(faceFBO));
+}
+
+void SunShadowMap::Update(const std::vector<Planet>& planets)
+{
+    if (planets.empty())
+        return;
+    ++frames;
+    casterFacesAll += (planets.size() - 1) * 6;
+    lightPos = PlanetPosition(planets[0]);
+    if (valid && frame++ % settings.interval != 0)
+        return;
+
+    // --- маски граней и "подписи" граней ---
+    casters.clear();
+    uint64_t hash[6];
+    for (uint64_t& h : hash)
+        h = kHashSeed;
+    for (size_t i = 1; i < planets.size(); ++i)
+    {
+        Vec3 c = PlanetPosition(planets[i]) - lightPos;
+        float r = planets[i].scale * meshRadius;
+        if (Length(c) - r > settings.range)
+            continue;
+
+        Caster caster;
+        caster.model = PlanetModelMatrix(planets[i]);
+        caster.faces = 0;
+        for (int face = 0; face < 6; ++face)
+        {
+            if (!SphereTouchesFace(c, r, face))
+                continue;
+            caster.faces |= 1u << face;
+            uint32_t index = (uint32_t)i;
+            hash[face] = HashBytes(hash[face], &index, sizeof(index));
+            hash[face] = HashBytes(hash[face], caster.model.m, sizeof(caster.model.m));
+        }
+        if (caster.faces)
+            casters.push_back(caster);
+    }
+
+    uint32_t dirty = 0;
+    for (int face = 0; face < 6; ++face)
+        if (!valid || hash[face] != faceHash[face])
+            dirty |= 1u << face;
+    if (!dirty)
+        return;
+
+    // --- сохранение состояния вызывающего ---
+    GLint prevFBO = 0;
+    GLint prevViewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prevFBO);
+    glGetIntegerv(GL_VIEWPORT, prevViewport);
+    GLboolean scissor = glIsEnabled(GL_SCISSOR_TEST);
+    GLboolean cull = glIsEnabled(GL_CULL_FACE);
+    glDisable(GL_SCISSOR_TEST);
+    // грани куба зеркальны, а меш не обязан быть замкнутым — рисуем обе стороны
+    glDisable(GL_CULL_FACE);
+
+    glViewport(0, 0, settings.size, settings.size);
+    for (int face = 0; face < 6; ++face)
+    {
+        if (!(dirty & (1u << face)))
+            continue;
+        glBindFramebuffer(GL_FRAMEBUFFER, faceFBO[face]);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        faceHash[face] = hash[face];
+        ++facesRedrawn;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, casters.size() * sizeof(Caster), casters.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    for (const Caster& c : casters)
+    {
+        uint32_t drawn = c.faces & dirty;
+        while (drawn)
+        {
+            drawn &= drawn - 1;
+            ++casterFaces;
+        }
+    }
+
+    Mat4 proj = Mat4::Perspective(Deg2Rad(90.0f), 1.0f, 0.05f, settings.range);
+    float faceViewProj[6 * 16];
+    for (int face = 0; face < 6; ++face)
+    {
+        Mat4 vp = proj * Mat4::LookAt(lightPos, lightPos + kFaceDir[face], kFaceUp[face]);
+        std::memcpy(&faceViewProj[face * 16], vp.m, sizeof(vp.m));
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, layeredFBO);
+    glUseProgram(prog);
+    glUniformMatrix4fv(uFaceViewProjLoc, 6, GL_FALSE, faceViewProj);
+    glUniform1ui(uDirtyFacesLoc, dirty);
+    glUniform3f(uLightPosLoc, lightPos.x, lightPos.y, lightPos.z);
+    glUniform1f(uRangeLoc, settings.range);
+    glBindVertexArray(vao);
+    if (!casters.empty())
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount, indexType, nullptr, (GLsizei)casters.size());
+    glBindVertexArray(0);
+    glUseProgram(0);
+    valid = true;
+
+    // --- восстановление ---
+    glBindFramebuffer(GL_FRAMEBUFFER, prevFBO);
+    glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+    if (scissor)
+        glEnable(GL_SCISSOR_TEST);
+    if (cull)
+        glEnable(GL_CULL_FACE);
+}
+
+std::string SunShadowMap::Summary() const
+{
+    double perFrame = frames ? 1.0 / frames : 0.0;
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        "%u^2 x 6 (%.1f MB), every %u frame(s), faces redrawn %.2f per frame, caster-faces %.1f of %.1f per frame",
+        settings.size, 6.0 * settings.size * settings.size * 4 / (1024.0 * 1024.0), settings.interval,
+        facesRedrawn * perFrame, casterFaces * perFrame, casterFacesAll * perFrame);
+    return buf;
+}
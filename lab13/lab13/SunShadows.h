@@ -0,0 +1,83 @@
+#pragma once
+
+#include "ClusteredLighting.h"
+#include "FrameStats.h"
+#include "GlUtils.h"
+#include "Scene.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// =======================================================
+// ТЕНИ ОТ СОЛНЦА (кубическая карта глубины за один проход)
+// =======================================================
+//
+// Все шесть граней рисуются одним instanced draw call в слоистый
+// framebuffer: геометрический шейдер выбирает грань через gl_Layer.
+// Маска граней считается на CPU для каждой планеты (сфера против
+// пирамиды грани), и треугольник уходит только в грани из маски.
+// Грань, в которой ни одна планета не сдвинулась, не перерисовывается.
+// В карте — расстояние до Солнца / far, сравнение через samplerCubeShadow.
+
+struct SunShadowSettings
+{
+    unsigned size = 1024;        // сторона грани в texel; память = 6 * size^2 * 4 байт
+    unsigned interval = 1;       // обновлять грани не чаще раза в interval кадров
+    float range = kSunLightRadius;
+};
+
+class SunShadowMap
+{
+public:
+    bool Init(const SunShadowSettings& settings, const Mesh& mesh);
+    void Destroy();
+
+    // планета 0 — само Солнце, тень не отбрасывает;
+    // сохраняет и восстанавливает framebuffer, viewport и scissor
+    void Update(const std::vector<Planet>& planets);
+
+    GLuint Texture() const { return cube; }
+    Vec3 LightPosition() const { return lightPos; }
+    float Range() const { return settings.range; }
+
+    // "1024^2 x 6 (24.0 MB), faces redrawn 2.3 per frame, caster-faces 41 of 594"
+    std::string Summary() const;
+
+private:
+    SunShadowSettings settings;
+    Vec3 lightPos;
+    float meshRadius = 1.0f;
+
+    GLuint prog = 0;
+    GLint uFaceViewProjLoc = -1;
+    GLint uDirtyFacesLoc = -1;
+    GLint uLightPosLoc = -1;
+    GLint uRangeLoc = -1;
+
+    GLuint cube = 0;
+    GLuint layeredFBO = 0;       // вся кубическая карта, для отрисовки
+    GLuint faceFBO[6] = {};      // по грани, для очистки только грязных
+
+    GLuint vao = 0;
+    GLuint instanceVBO = 0;
+    GLsizei indexCount = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+
+    struct Caster
+    {
+        Mat4 model;
+        uint32_t faces;
+        uint32_t pad[3];
+    };
+    std::vector<Caster> casters;
+
+    uint64_t faceHash[6] = {};
+    bool valid = false;          // карта хоть раз нарисована целиком
+    unsigned frame = 0;
+
+    size_t frames = 0;
+    size_t facesRedrawn = 0;
+    size_t casterFaces = 0;      // пары планета-грань в нарисованных гранях
+    size_t casterFacesAll = 0;   // то же без отсечения: планеты * 6
+};
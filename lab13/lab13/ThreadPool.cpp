@@ -0,0 +1,83 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+        threadCount = 1;
+
+    for (unsigned i = 1; i < threadCount; ++i)
+        workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : workers)
+        t.join();
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t, unsigned)>& fn)
+{
+    if (count == 0) return;
+
+    if (workers.empty() || count == 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            fn(i, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        jobCount = count;
+        nextIndex.store(0, std::memory_order_relaxed);
+        busyWorkers = (unsigned)workers.size();
+        ++generation;
+    }
+    wake.notify_all();
+
+    RunJob(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return busyWorkers == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::RunJob(unsigned worker)
+{
+    for (;;)
+    {
+        size_t i = nextIndex.fetch_add(1, std::memory_order_relaxed);
+        if (i >= jobCount) break;
+        (*job)(i, worker);
+    }
+}
+
+void ThreadPool::WorkerLoop(unsigned worker)
+{
+    unsigned seenGeneration = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+        }
+
+        RunJob(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busyWorkers == 0)
+                done.notify_one();
+        }
+    }
+}
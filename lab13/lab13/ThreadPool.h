@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Простой пул потоков для параллельных циклов.
+// Вызывающий поток тоже участвует в работе, индексы раздаются
+// через атомарный счётчик, поэтому мелкие задачи балансируются сами.
+class ThreadPool
+{
+public:
+    // threadCount == 0 -> по числу ядер
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // число исполнителей (включая вызывающий поток)
+    unsigned Size() const { return (unsigned)workers.size() + 1; }
+
+    // fn(index, worker) для index = 0..count-1, worker < Size()
+    void ParallelFor(size_t count, const std::function<void(size_t, unsigned)>& fn);
+
+private:
+    void WorkerLoop(unsigned worker);
+    void RunJob(unsigned worker);
+
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void(size_t, unsigned)>* job = nullptr;
+    size_t jobCount = 0;
+    std::atomic<size_t> nextIndex{ 0 };
+    unsigned busyWorkers = 0;
+    unsigned generation = 0;
+    bool stopping = false;
+};
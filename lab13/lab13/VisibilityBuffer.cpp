@@ -0,0 +1,391 @@
+#include "VisibilityBuffer.h"
+
+#include "DeferredShading.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace
+{
+    // блоки для буферов прохода материала (0 — текстура, 1..4 — свет и тени)
+    const GLuint kVisibilityUnit = 5;   // 5 — id, 6 — вершины, 7 — индексы, 8 — экземпляры
+
+    const char* visVertexSrc = R"(
+        #version 330 core
+        layout(location = 0) in vec3 aPos;
+        layout(location = 2) in mat4 aModel;
+
+        layout(std140) uniform Camera
+        {
+            mat4 uView;
+            mat4 uProj;
+        };
+
+        flat out uint vInstance;
+
+        void main()
+        {
+            vInstance = uint(gl_InstanceID) + 1u;
+            gl_Position = uProj * (uView * (aModel * vec4(aPos, 1.0)));
+        }
+    )";
+
+    const char* visFragmentSrc = R"(
+        #version 330 core
+        flat in uint vInstance;
+        out uvec2 Visibility;
+
+        void main()
+        {
+            Visibility = uvec2(vInstance, uint(gl_PrimitiveID));
+        }
+    )";
+
+    const char* resolveVertexSrc = R"(
+        #version 330 core
+        void main()
+        {
+            vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+            gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+        }
+    )";
+
+    // после pointLightGlsl (DeferredShading.h)
+    const char* resolveFragmentSrc = R"(
+        out vec4 FragColor;
+
+        layout(std140) uniform Camera
+        {
+            mat4 uView;
+            mat4 uProj;
+        };
+
+        uniform usampler2D uVisibility;      // экземпляр + 1 (0 — фон), треугольник
+        uniform usamplerBuffer uVertices;    // PackedVertex: 7 uint на вершину
+        uniform usamplerBuffer uIndices;
+        uniform samplerBuffer uInstances;    // InstanceData: 5 texel на экземпляр
+        uniform int uInstanceBase;           // диапазон кадра, в texel
+        uniform sampler2D uTexture;
+
+        uniform vec4 uViewport;              // x, y, w, h цели
+        uniform vec3 uBackground;
+
+        uniform bool uLit;
+        uniform usamplerBuffer uClusters;
+        uniform usamplerBuffer uLightIndex;
+        uniform uvec3 uGrid;
+        uniform vec2 uSlice;
+
+        const vec3 kAmbient = vec3(0.06);
+
+        // GL_INT_2_10_10_10_REV: знаковые 10 бит на компоненту
+        vec3 DecodeSnorm10(uint v)
+        {
+            ivec3 i = ivec3(int(v << 22u) >> 22, int(v << 12u) >> 22, int(v << 2u) >> 22);
+            return max(vec3(i) / 511.0, -1.0);
+        }
+
+        // луч из камеры через точку ndc
+        vec3 PixelRay(vec2 ndc)
+        {
+            return vec3(ndc.x / uProj[0][0], ndc.y / uProj[1][1], -1.0);
+        }
+
+        // барицентрики точки пересечения луча с плоскостью треугольника
+        // (Möller–Trumbore без проверки границ — годится и для соседних пикселей)
+        vec3 RayBarycentrics(vec3 d, vec3 v0, vec3 v1, vec3 v2)
+        {
+            vec3 e1 = v1 - v0;
+            vec3 e2 = v2 - v0;
+            vec3 p = cross(d, e2);
+            float det = dot(e1, p);
+            if (abs(det) < 1e-20)
+                return vec3(1.0, 0.0, 0.0);
+            vec3 t = -v0;
+            vec3 q = cross(t, e1);
+            float u = dot(t, p) / det;
+            float v = dot(d, q) / det;
+            return vec3(1.0 - u - v, u, v);
+        }
+
+        void main()
+        {
+            ivec2 pixel = ivec2(gl_FragCoord.xy - uViewport.xy);
+            uvec2 id = texelFetch(uVisibility, pixel, 0).xy;
+            if (id.x == 0u)
+            {
+                FragColor = vec4(uBackground, 1.0);
+                gl_FragDepth = 1.0;
+                return;
+            }
+
+            int base = uInstanceBase + int(id.x - 1u) * 5;
+            mat4 model = mat4(texelFetch(uInstances, base), texelFetch(uInstances, base + 1),
+                texelFetch(uInstances, base + 2), texelFetch(uInstances, base + 3));
+            vec3 emission = texelFetch(uInstances, base + 4).rgb;
+            mat4 modelView = uView * model;
+
+            vec3 v[3];
+            vec2 uv[3];
+            vec3 n[3];
+            for (int i = 0; i < 3; ++i)
+            {
+                int o = int(texelFetch(uIndices, int(id.y) * 3 + i).r) * 7;
+                vec3 pos = uintBitsToFloat(uvec3(texelFetch(uVertices, o).r,
+                    texelFetch(uVertices, o + 1).r, texelFetch(uVertices, o + 2).r));
+                v[i] = (modelView * vec4(pos, 1.0)).xyz;
+                uv[i] = uintBitsToFloat(uvec2(texelFetch(uVertices, o + 3).r, texelFetch(uVertices, o + 4).r));
+                n[i] = DecodeSnorm10(texelFetch(uVertices, o + 5).r);
+            }
+
+            vec2 ndc = (gl_FragCoord.xy - uViewport.xy) / uViewport.zw * 2.0 - 1.0;
+            vec2 step = 2.0 / uViewport.zw;
+            vec3 b = RayBarycentrics(PixelRay(ndc), v[0], v[1], v[2]);
+            vec3 bx = RayBarycentrics(PixelRay(ndc + vec2(step.x, 0.0)), v[0], v[1], v[2]);
+            vec3 by = RayBarycentrics(PixelRay(ndc + vec2(0.0, step.y)), v[0], v[1], v[2]);
+
+            vec2 texUV = b.x * uv[0] + b.y * uv[1] + b.z * uv[2];
+            vec2 dx = bx.x * uv[0] + bx.y * uv[1] + bx.z * uv[2] - texUV;
+            vec2 dy = by.x * uv[0] + by.y * uv[1] + by.z * uv[2] - texUV;
+            vec4 albedo = textureGrad(uTexture, texUV, dx, dy);
+
+            vec3 p = b.x * v[0] + b.y * v[1] + b.z * v[2];
+            vec4 clip = uProj * vec4(p, 1.0);
+            gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;
+
+            if (!uLit)
+            {
+                FragColor = albedo;
+                return;
+            }
+
+            vec3 normal = normalize(mat3(modelView) * (b.x * n[0] + b.y * n[1] + b.z * n[2]));
+            vec2 screen = clamp((gl_FragCoord.xy - uViewport.xy) / uViewport.zw, 0.0, 0.9999);
+            uvec2 tile = uvec2(screen * vec2(uGrid.xy));
+            float slice = clamp(log(-p.z) * uSlice.x + uSlice.y, 0.0, float(uGrid.z - 1u));
+            int cluster = int((uint(slice) * uGrid.y + tile.y) * uGrid.x + tile.x);
+            uvec2 range = texelFetch(uClusters, cluster).xy;
+
+            vec3 light = kAmbient + emission;
+            for (uint i = 0u; i < range.y; ++i)
+                light += PointLight(int(texelFetch(uLightIndex, int(range.x + i)).r), p, normal);
+            FragColor = vec4(albedo.rgb * light, albedo.a);
+        }
+    )";
+
+    GLuint CreateTextureBuffer(GLenum format, GLuint buffer)
+    {
+        GLuint tex = 0;
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_BUFFER, tex);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        return tex;
+    }
+
+    void BindUnit(GLuint unit, GLenum target, GLuint tex)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, tex);
+    }
+}
+
+bool VisibilityBuffer::Init(const Mesh& mesh, GLuint cameraBinding, GLuint lightUnit, GLuint shadows)
+{
+    shadowUnit = shadows;
+
+    GLuint vert = CompileShader(GL_VERTEX_SHADER, visVertexSrc);
+    GLuint frag = CompileShader(GL_FRAGMENT_SHADER, visFragmentSrc);
+    visProg = LinkProgram(vert, frag);
+    glDeleteShader(vert);
+    glDeleteShader(frag);
+
+    std::string resolveSrc = std::string("#version 330 core\n") + pointLightGlsl + resolveFragmentSrc;
+    vert = CompileShader(GL_VERTEX_SHADER, resolveVertexSrc);
+    frag = CompileShader(GL_FRAGMENT_SHADER, resolveSrc.c_str());
+    resolveProg = LinkProgram(vert, frag);
+    glDeleteShader(vert);
+    glDeleteShader(frag);
+
+    GLint visOk = 0, resolveOk = 0;
+    glGetProgramiv(visProg, GL_LINK_STATUS, &visOk);
+    glGetProgramiv(resolveProg, GL_LINK_STATUS, &resolveOk);
+    if (!visOk || !resolveOk)
+    {
+        Destroy();
+        return false;
+    }
+
+    for (GLuint prog : { visProg, resolveProg })
+    {
+        GLuint cameraBlock = glGetUniformBlockIndex(prog, "Camera");
+        if (cameraBlock != GL_INVALID_INDEX)
+            glUniformBlockBinding(prog, cameraBlock, cameraBinding);
+    }
+
+    glUseProgram(resolveProg);
+    glUniform1i(glGetUniformLocation(resolveProg, "uTexture"), 0);
+    glUniform1i(glGetUniformLocation(resolveProg, "uLights"), lightUnit);
+    glUniform1i(glGetUniformLocation(resolveProg, "uClusters"), lightUnit + 1);
+    glUniform1i(glGetUniformLocation(resolveProg, "uLightIndex"), lightUnit + 2);
+    glUniform1i(glGetUniformLocation(resolveProg, "uShadowCube"), shadowUnit);
+    glUniform1i(glGetUniformLocation(resolveProg, "uVisibility"), kVisibilityUnit);
+    glUniform1i(glGetUniformLocation(resolveProg, "uVertices"), kVisibilityUnit + 1);
+    glUniform1i(glGetUniformLocation(resolveProg, "uIndices"), kVisibilityUnit + 2);
+    glUniform1i(glGetUniformLocation(resolveProg, "uInstances"), kVisibilityUnit + 3);
+    glUseProgram(0);
+    instanceBaseLoc = glGetUniformLocation(resolveProg, "uInstanceBase");
+    viewportLoc = glGetUniformLocation(resolveProg, "uViewport");
+    backgroundLoc = glGetUniformLocation(resolveProg, "uBackground");
+    litLoc = glGetUniformLocation(resolveProg, "uLit");
+    gridLoc = glGetUniformLocation(resolveProg, "uGrid");
+    sliceLoc = glGetUniformLocation(resolveProg, "uSlice");
+    sunShadowsLoc = glGetUniformLocation(resolveProg, "uSunShadows");
+    invViewLoc = glGetUniformLocation(resolveProg, "uInvView");
+    sunPosLoc = glGetUniformLocation(resolveProg, "uSunPos");
+    shadowRangeLoc = glGetUniformLocation(resolveProg, "uShadowRange");
+
+    // вершины и индексы — те же буферы, что рисует проход геометрии
+    vertexTex = CreateTextureBuffer(GL_R32UI, mesh.VBO);
+    indexTex = CreateTextureBuffer(mesh.indexType == GL_UNSIGNED_SHORT ? GL_R16UI : GL_R32UI, mesh.EBO);
+    glGenTextures(1, &instanceTex);
+    glGenVertexArrays(1, &emptyVAO);
+    return true;
+}
+
+void VisibilityBuffer::Destroy()
+{
+    Free();
+    glDeleteProgram(visProg);
+    glDeleteProgram(resolveProg);
+    GLuint textures[3] = { vertexTex, indexTex, instanceTex };
+    glDeleteTextures(3, textures);
+    glDeleteVertexArrays(1, &emptyVAO);
+    visProg = resolveProg = 0;
+    vertexTex = indexTex = instanceTex = 0;
+    instanceSource = 0;
+    emptyVAO = 0;
+}
+
+void VisibilityBuffer::Allocate(unsigned w, unsigned h)
+{
+    capacityWidth = w;
+    capacityHeight = h;
+
+    glGenTextures(1, &idTex);
+    glBindTexture(GL_TEXTURE_2D, idTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32UI, w, h, 0, GL_RG_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &depthRB);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRB);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, idTex, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRB);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Visibility buffer is incomplete: " << w << "x" << h << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void VisibilityBuffer::Free()
+{
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &depthRB);
+    glDeleteTextures(1, &idTex);
+    fbo = depthRB = idTex = 0;
+    capacityWidth = capacityHeight = 0;
+}
+
+void VisibilityBuffer::BeginGeometry(unsigned w, unsigned h)
+{
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFBO);
+    glGetIntegerv(GL_VIEWPORT, targetViewport);
+
+    w = std::max(1u, w);
+    h = std::max(1u, h);
+    if (w > capacityWidth || h > capacityHeight)
+    {
+        unsigned newW = std::max(w, capacityWidth);
+        unsigned newH = std::max(h, capacityHeight);
+        Free();
+        Allocate(newW, newH);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, w, h);
+    const GLuint background[4] = { 0, 0, 0, 0 };
+    glClearBufferuiv(GL_COLOR, 0, background);
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void VisibilityBuffer::Resolve(const VisibilityResolve& in)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+    glViewport(targetViewport[0], targetViewport[1], targetViewport[2], targetViewport[3]);
+
+    // буфер экземпляров пересоздаётся при росте числа планет
+    if (in.instanceBuffer != instanceSource)
+    {
+        glBindTexture(GL_TEXTURE_BUFFER, instanceTex);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, in.instanceBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        instanceSource = in.instanceBuffer;
+    }
+
+    glUseProgram(resolveProg);
+    glUniform1i(instanceBaseLoc, (GLint)(in.instanceOffset / 16));
+    glUniform4f(viewportLoc, (float)targetViewport[0], (float)targetViewport[1],
+        (float)targetViewport[2], (float)targetViewport[3]);
+    glUniform3f(backgroundLoc, in.clearColor[0], in.clearColor[1], in.clearColor[2]);
+    glUniform1i(litLoc, in.clusters ? 1 : 0);
+    if (in.clusters)
+    {
+        const ClusterGrid& grid = in.clusters->Grid();
+        glUniform3ui(gridLoc, grid.x, grid.y, grid.z);
+        glUniform2f(sliceLoc, in.clusters->SliceScale(), in.clusters->SliceBias());
+    }
+    glUniform1i(sunShadowsLoc, in.shadows ? 1 : 0);
+    if (in.shadows)
+    {
+        Mat4 invView = InverseRigid(in.view);
+        Vec3 sun = in.shadows->LightPosition();
+        glUniformMatrix4fv(invViewLoc, 1, GL_FALSE, invView.m);
+        glUniform3f(sunPosLoc, sun.x, sun.y, sun.z);
+        glUniform1f(shadowRangeLoc, in.shadows->Range());
+        BindUnit(shadowUnit, GL_TEXTURE_CUBE_MAP, in.shadows->Texture());
+    }
+
+    BindUnit(kVisibilityUnit, GL_TEXTURE_2D, idTex);
+    BindUnit(kVisibilityUnit + 1, GL_TEXTURE_BUFFER, vertexTex);
+    BindUnit(kVisibilityUnit + 2, GL_TEXTURE_BUFFER, indexTex);
+    BindUnit(kVisibilityUnit + 3, GL_TEXTURE_BUFFER, instanceTex);
+
+    // глубина пишется, чтобы поверх можно было рисовать прямым проходом
+    glDepthFunc(GL_ALWAYS);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glDepthFunc(GL_LESS);
+
+    BindUnit(kVisibilityUnit, GL_TEXTURE_2D, 0);
+    for (GLuint unit = kVisibilityUnit + 1; unit <= kVisibilityUnit + 3; ++unit)
+        BindUnit(unit, GL_TEXTURE_BUFFER, 0);
+    if (in.shadows)
+        BindUnit(shadowUnit, GL_TEXTURE_CUBE_MAP, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glUseProgram(0);
+}
+
+std::string VisibilityBuffer::Summary() const
+{
+    char buf[128];
+    std::snprintf(buf, sizeof(buf), "RG32UI %ux%u (8 B/px + depth)", capacityWidth, capacityHeight);
+    return buf;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "ClusteredLighting.h"
+#include "GlUtils.h"
+#include "SunShadows.h"
+
+#include <string>
+
+// =======================================================
+// VISIBILITY BUFFER (много мелких экземпляров)
+// =======================================================
+//
+// Проход геометрии пишет в один RG32UI только номер экземпляра + 1
+// и gl_PrimitiveID — фрагментный шейдер пустой, интерполировать нечего,
+// поэтому перерисовка и 2x2-квады мелких треугольников почти ничего
+// не стоят. Затем один полноэкранный проход на пиксель: по номерам
+// достаёт индексы и вершины из TBO поверх буферов меша, экземпляр —
+// из буфера экземпляров кадра, барицентрики считает аналитически
+// (пересечение луча пикселя с треугольником в видовых координатах,
+// работает и для треугольников, пересекающих near), производные UV —
+// по лучам соседних пикселей. Цена материала — по пикселям, а не по
+// треугольникам.
+
+struct VisibilityResolve
+{
+    GLuint instanceBuffer = 0;   // InstanceData (SceneRendererGL.h) всех кадров
+    GLintptr instanceOffset = 0; // начало диапазона кадра, кратно 16 байтам
+    const LightClusterBuilder* clusters = nullptr;   // nullptr — без освещения
+    const SunShadowMap* shadows = nullptr;
+    Mat4 view;
+    float clearColor[3] = { 0, 0, 0 };
+};
+
+class VisibilityBuffer
+{
+public:
+    // cameraBinding — блок Camera (view + proj); lightUnit..lightUnit+2 — TBO
+    // кластеров, shadowUnit — карта теней; текстура материала — блок 0
+    bool Init(const Mesh& mesh, GLuint cameraBinding, GLuint lightUnit, GLuint shadowUnit);
+    void Destroy();
+
+    // программа прохода геометрии: VAO меша с атрибутами экземпляров 2..5
+    GLuint GeometryProgram() const { return visProg; }
+
+    // привязывает свой framebuffer (не меньше w x h) и очищает его;
+    // текущие framebuffer и viewport запоминаются для Resolve
+    void BeginGeometry(unsigned w, unsigned h);
+    // материал и освещение по пикселям в запомненный framebuffer (цвет + глубина)
+    void Resolve(const VisibilityResolve& in);
+
+    // "RG32UI 1200x900 (8 B/px + depth)"
+    std::string Summary() const;
+
+private:
+    void Allocate(unsigned w, unsigned h);
+    void Free();
+
+    GLuint visProg = 0;
+    GLuint resolveProg = 0;
+    GLint instanceBaseLoc = -1;
+    GLint viewportLoc = -1;
+    GLint backgroundLoc = -1;
+    GLint litLoc = -1;
+    GLint gridLoc = -1;
+    GLint sliceLoc = -1;
+    GLint sunShadowsLoc = -1;
+    GLint invViewLoc = -1;
+    GLint sunPosLoc = -1;
+    GLint shadowRangeLoc = -1;
+    GLuint shadowUnit = 4;
+
+    // TBO поверх буферов меша и буфера экземпляров
+    GLuint vertexTex = 0;
+    GLuint indexTex = 0;
+    GLuint instanceTex = 0;
+    GLuint instanceSource = 0;   // буфер, на который сейчас смотрит instanceTex
+
+    GLuint fbo = 0;
+    GLuint idTex = 0;
+    GLuint depthRB = 0;
+    unsigned capacityWidth = 0;
+    unsigned capacityHeight = 0;
+
+    GLint targetFBO = 0;
+    GLint targetViewport[4] = {};
+    GLuint emptyVAO = 0;
+};
@@ -3,422 +3,794 @@
 #include <SFML/OpenGL.hpp>
 #include <SFML/Graphics/Image.hpp>
 
+#include "AmbientOcclusion.h"
+#include "AsteroidBelt.h"
+#include "Assets.h"
+#include "Benchmark.h"
+#include "CameraPath.h"
+#include "DynamicResolution.h"
+#include "FrameCapture.h"
+#include "FramePacer.h"
+#include "FramesInFlight.h"
+#include "FrameStats.h"
+#include "GlUtils.h"
+#include "GoldenImages.h"
+#include "GpuPicker.h"
+#include "HdrBloom.h"
+#include "HeadlessRenderer.h"
+#include "InputReplay.h"
+#include "Math3D.h"
+#include "OrbitTrails.h"
+#include "PathTracer.h"
+#include "RayBvh.h"
+#include "Scene.h"
+#include "SceneRendererGL.h"
+#include "SharedFrameRing.h"
+#include "SoftwareRasterizer.h"
+#include "Starfield.h"
+#include "ThreadPool.h"
+
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <vector>
 #include <string>
 #include <cmath>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <utility>
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
-void ShaderLog(GLuint shader)
-{
-    GLint infologLen = 0;
-    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infologLen);
-    if (infologLen > 1)
-    {
-        std::vector<char> infoLog(infologLen);
-        GLsizei charsWritten = 0;
-        glGetShaderInfoLog(shader, infologLen, &charsWritten, infoLog.data());
-        std::cout << "Shader log:\n" << infoLog.data() << std::endl;
-    }
-}
-
-void ProgramLog(GLuint prog)
-{
-    GLint infologLen = 0;
-    glGetProgramiv(prog, GL_INFO_LOG_LENGTH, &infologLen);
-    if (infologLen > 1)
-    {
-        std::vector<char> infoLog(infologLen);
-        GLsizei charsWritten = 0;
-        glGetProgramInfoLog(prog, infologLen, &charsWritten, infoLog.data());
-        std::cout << "Program log:\n" << infoLog.data() << std::endl;
-    }
-}
-
-GLuint CompileShader(GLenum type, const char* src)
-{
-    GLuint sh = glCreateShader(type);
-    glShaderSource(sh, 1, &src, nullptr);
-    glCompileShader(sh);
-    ShaderLog(sh);
-    return sh;
-}
-
-GLuint LinkProgram(GLuint vert, GLuint frag)
-{
-    GLuint prog = glCreateProgram();
-    glAttachShader(prog, vert);
-    glAttachShader(prog, frag);
-    glLinkProgram(prog);
-    GLint success = 0;
-    glGetProgramiv(prog, GL_LINK_STATUS, &success);
-    if (!success)
-        ProgramLog(prog);
-    return prog;
-}
+// =======================================================
+// ПАРАМЕТРЫ ЗАПУСКА
+// =======================================================
 
-struct Vec3
+struct AppOptions
 {
-    float x = 0, y = 0, z = 0;
-    Vec3() = default;
-    Vec3(float X, float Y, float Z) : x(X), y(Y), z(Z) {}
+    bool software = false;        // --software: рендер на CPU без окна и GPU
+    int frames = 1;               // --frames N: сколько кадров отрисовать на CPU
+    float startTime = 0.0f;       // --time T: сдвиг симуляции на T секунд
+    bool hasSeed = false;         // --seed N: фиксированный набор планет
+    unsigned seed = 0;
+    unsigned threads = 0;         // --threads N: 0 — по числу ядер
+    unsigned width = 1200;        // --size WxH
+    unsigned height = 900;
+    std::string output;           // --out файл: последний кадр CPU-рендера / воспроизведения
+
+    bool golden = false;          // --golden DIR: проверка эталонных кадров
+    std::string goldenDir = "golden";
+    bool goldenUpdate = false;    // --golden-update: перезаписать эталоны
+    float budgetScale = 1.0f;     // --budget-scale X: множитель бюджетов времени
+
+    std::string recordPath;       // --record FILE: запись управления и dt
+    std::string replayPath;       // --replay FILE: воспроизведение записи
+    float fixedDt = 0.0f;         // --fixed-dt SEC: dt вместо записанного
+    bool headless = false;        // --headless: воспроизведение или бенчмарк без окна
+
+    std::string benchPath;        // --bench FILE: пролёт по сценарию с отчётом по участкам
+
+    std::string capturePath;      // --capture FILE: каждый кадр в *.y4m или PNG по шаблону с одним %d
+    std::string shmExport;        // --shm-export NAME: кадры в разделяемую память
+    std::string shmConsume;       // --shm-consume NAME: эталонный потребитель кадров
+
+    double fps = 60.0;            // --fps N: целевая частота окна
+    bool hasFps = false;
+    bool uncapped = false;        // --uncapped: без ограничения частоты и без vsync
+
+    bool onDemand = false;        // --on-demand: не рисовать, пока ничего не меняется
+    bool startPaused = false;     // --paused: старт с симуляцией на паузе (P)
+
+    float dynresTargetMs = 0.0f;  // --dynres MS: разрешение подстраивается под время GPU
+    float dynresMinScale = 0.5f;  // --dynres-min S: нижний предел масштаба по оси
+
+    unsigned framesInFlight = 2;  // --frames-in-flight N: насколько CPU может опережать GPU
+
+    unsigned lights = 0;          // --lights N: кластерное освещение от N точечных источников
+    unsigned shadowSize = 0;      // --shadows N: тени от Солнца, грань кубической карты N x N
+    unsigned shadowInterval = 1;  // --shadow-interval N: обновлять тени раз в N кадров
+    ShadingPath shading = ShadingPath::Forward;   // --shading forward|volumes|tiled
+    bool visibility = false;      // --visibility: visibility buffer, материал по пикселям
+    bool rings = false;           // --rings: кольца планет (weighted blended OIT)
+    PlanetRingSettings ringSettings;   // --ring-fraction F
+    bool procedural = false;      // --procedural: процедурные планеты с LOD вместо модели
+    ProceduralPlanetSettings proceduralSettings;   // --lod-error PX, --lod-max-level N
+    bool hdr = false;             // --hdr: RGBA16F, bloom, тональная компрессия и гамма
+    HdrBloomSettings hdrSettings; // --bloom S, --exposure E
+    bool ao = false;              // --ao: SSAO в пониженном разрешении
+    AmbientOcclusionSettings aoSettings;   // --ao-res, --ao-samples, --ao-radius, --ao-strength, --ao-history
+    bool stars = false;           // --stars: звёздное небо (процедурное или --star-catalog FILE)
+    StarfieldSettings starSettings;   // --star-count N, --star-mag M
+    std::string writeStars;       // --write-stars FILE: сохранить процедурный каталог и выйти
+    bool belt = false;            // --belt: пояс астероидов
+    AsteroidBeltSettings beltSettings;   // --belt-count N, --belt-radius A,B, --belt-mesh-distance D
+    bool trails = false;          // --trails history|analytic: следы орбит
+    OrbitTrailSettings trailSettings;   // --trail-seconds S, --trail-samples N
+
+    // --compare-shading 1,64,4096 [--compare-sizes 640x360,1920x1080]:
+    // прямое и отложенное освещение по всем сочетаниям (с --bench --headless)
+    std::vector<unsigned> compareLights;
+    std::vector<std::pair<unsigned, unsigned>> compareSizes;
+
+    unsigned rayBench = 0;        // --ray-bench N: лучи через BVH над N планетами и выход
+    bool gpuPick = false;         // --gpu-pick: выбор мышью по буферу номеров на GPU вместо BVH
+    unsigned pathTrace = 0;       // --path-trace SPP: эталонный кадр трассировкой путей на CPU и выход
+    PathTracerSettings pathSettings;   // --pt-bounces N, --pt-sun L, --exposure E
 };
 
-Vec3 operator+(const Vec3& a, const Vec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
-Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
-Vec3 operator*(const Vec3& a, float s) { return { a.x * s, a.y * s, a.z * s }; }
-
-float Dot(const Vec3& a, const Vec3& b)
+void PrintUsage()
 {
-    return a.x * b.x + a.y * b.y + a.z * b.z;
+    std::cout << "Usage: lab13 [--software] [--frames N] [--time T] [--seed N]\n"
+        << "             [--threads N] [--size WxH] [--out file.png]\n"
+        << "       lab13 --golden DIR [--golden-update] [--budget-scale X] [--software]\n"
+        << "       lab13 --record FILE [--seed N] [--time T]\n"
+        << "       lab13 --replay FILE [--fixed-dt SEC] [--headless [--software] [--out file.png]]\n"
+        << "             [--capture video.y4m | frames/frame_%05d.png | --shm-export NAME]\n"
+        << "             (PNG pattern: exactly one integer field %d/%u/%i, optional 0 flag and width; %% for %)\n"
+        << "       lab13 --shm-consume NAME\n"
+        << "       lab13 --bench FILE.path [--fixed-dt SEC] [--size WxH] [--headless [--software]]\n"
+        << "       GL paths: [--lights N]  (clustered lighting: Sun, glowing planets, small orbiting lights)\n"
+        << "                 [--shadows SIZE [--shadow-interval N]]  (Sun cube shadow map, implies --lights 1)\n"
+        << "                 [--shading forward|volumes|tiled]  (deferred paths imply --lights 1)\n"
+        << "                 [--visibility]  (visibility buffer: instance/triangle IDs, shading per pixel)\n"
+        << "                 [--rings [--ring-fraction F]]  (planet rings, order-independent transparency)\n"
+        << "                 [--procedural [--lod-error PX] [--lod-max-level N]]  (cube-sphere planets, quadtree LOD)\n"
+        << "                 [--hdr [--bloom S] [--exposure E]]  (HDR target, compute bloom, ACES; implies --lights 1)\n"
+        << "                 [--ao [--ao-res half|full] [--ao-samples N] [--ao-radius R] [--ao-strength S] [--ao-history W]]\n"
+        << "                 (screen-space ambient occlusion, temporal accumulation, bilateral upsample)\n"
+        << "                 [--stars [--star-catalog FILE] [--star-count N] [--star-mag M]]  (point-sprite starfield)\n"
+        << "                 [--belt [--belt-count N] [--belt-radius A,B] [--belt-mesh-distance D]]  (GPU asteroid belt)\n"
+        << "                 [--trails history|analytic [--trail-seconds S] [--trail-samples N]]  (orbit trails)\n"
+        << "       lab13 --write-stars FILE [--star-count N]  (save a procedural star catalog)\n"
+        << "       lab13 --bench FILE.path --headless --compare-shading N,N,... [--compare-sizes WxH,WxH,...]\n"
+        << "       lab13 --ray-bench N [--size WxH] [--threads N] [--seed N]  (CPU BVH rays over N planet instances)\n"
+        << "       lab13 --path-trace SPP [--time T] [--seed N | --bench FILE.path] [--size WxH] [--threads N] [--out file.png]\n"
+        << "             [--pt-bounces N] [--pt-sun L] [--exposure E]  (CPU path-traced reference still, progressive)\n"
+        << "       window: [--fps N | --uncapped]  (--bench in a window is uncapped unless --fps is given)\n"
+        << "               [--on-demand] [--paused]  (P pauses the simulation, left click picks a planet)\n"
+        << "               [--dynres MS [--dynres-min S]] [--frames-in-flight N]\n"
+        << "               [--gpu-pick]  (pick from a GPU instance-ID buffer read back asynchronously instead of the CPU BVH)\n";
 }
 
-Vec3 Cross(const Vec3& a, const Vec3& b)
+// "640x360" -> w, h
+bool ParseSize(const std::string& text, unsigned& w, unsigned& h)
 {
-    return Vec3(
-        a.y * b.z - a.z * b.y,
-        a.z * b.x - a.x * b.z,
-        a.x * b.y - a.y * b.x
-    );
+    return std::sscanf(text.c_str(), "%ux%u", &w, &h) == 2 && w > 0 && h > 0;
 }
 
-float Length(const Vec3& v)
+// "a,b,c" -> {"a", "b", "c"}
+std::vector<std::string> SplitList(const std::string& text)
 {
-    return std::sqrt(Dot(v, v));
-}
-
-Vec3 Normalize(const Vec3& v)
-{
-    float len = Length(v);
-    if (len <= 1e-6f) return v;
-    return v * (1.0f / len);
+    std::vector<std::string> items;
+    size_t begin = 0;
+    while (begin <= text.size())
+    {
+        size_t end = std::min(text.find(',', begin), text.size());
+        if (end > begin)
+            items.push_back(text.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return items;
 }
 
-// 4x4 матрица в формате column-major,
-// как ожидает OpenGL (m[col*4 + row])
-struct Mat4
+bool ParseArgs(int argc, char** argv, AppOptions& opt)
 {
-    float m[16] = { 0 };
-
-    static Mat4 Identity()
+    for (int i = 1; i < argc; ++i)
     {
-        Mat4 r;
-        r.m[0] = r.m[5] = r.m[10] = r.m[15] = 1.0f;
-        return r;
+        std::string arg = argv[i];
+        auto next = [&]() -> const char*
+            {
+                return (i + 1 < argc) ? argv[++i] : nullptr;
+            };
+
+        const char* value = nullptr;
+        if (arg == "--software")
+            opt.software = true;
+        else if (arg == "--frames" && (value = next()))
+            opt.frames = std::max(1, std::atoi(value));
+        else if (arg == "--time" && (value = next()))
+            opt.startTime = (float)std::atof(value);
+        else if (arg == "--seed" && (value = next()))
+        {
+            opt.hasSeed = true;
+            opt.seed = (unsigned)std::strtoul(value, nullptr, 10);
+        }
+        else if (arg == "--threads" && (value = next()))
+            opt.threads = (unsigned)std::atoi(value);
+        else if (arg == "--size" && (value = next()))
+        {
+            unsigned w = 0, h = 0;
+            if (!ParseSize(value, w, h))
+            {
+                std::cout << "Bad --size: " << value << std::endl;
+                return false;
+            }
+            opt.width = w;
+            opt.height = h;
+        }
+        else if (arg == "--out" && (value = next()))
+            opt.output = value;
+        else if (arg == "--golden" && (value = next()))
+        {
+            opt.golden = true;
+            opt.goldenDir = value;
+        }
+        else if (arg == "--golden-update")
+            opt.goldenUpdate = true;
+        else if (arg == "--budget-scale" && (value = next()))
+            opt.budgetScale = (float)std::atof(value);
+        else if (arg == "--record" && (value = next()))
+            opt.recordPath = value;
+        else if (arg == "--replay" && (value = next()))
+            opt.replayPath = value;
+        else if (arg == "--fixed-dt" && (value = next()))
+            opt.fixedDt = (float)std::atof(value);
+        else if (arg == "--headless")
+            opt.headless = true;
+        else if (arg == "--bench" && (value = next()))
+            opt.benchPath = value;
+        else if (arg == "--capture" && (value = next()))
+            opt.capturePath = value;
+        else if (arg == "--shm-export" && (value = next()))
+            opt.shmExport = value;
+        else if (arg == "--shm-consume" && (value = next()))
+            opt.shmConsume = value;
+        else if (arg == "--fps" && (value = next()))
+        {
+            opt.fps = std::max(1.0, std::atof(value));
+            opt.hasFps = true;
+        }
+        else if (arg == "--uncapped")
+            opt.uncapped = true;
+        else if (arg == "--on-demand")
+            opt.onDemand = true;
+        else if (arg == "--paused")
+            opt.startPaused = true;
+        else if (arg == "--dynres" && (value = next()))
+            opt.dynresTargetMs = (float)std::atof(value);
+        else if (arg == "--dynres-min" && (value = next()))
+            opt.dynresMinScale = (float)std::atof(value);
+        else if (arg == "--frames-in-flight" && (value = next()))
+            opt.framesInFlight = (unsigned)std::max(1, std::atoi(value));
+        else if (arg == "--lights" && (value = next()))
+            opt.lights = (unsigned)std::max(0, std::atoi(value));
+        else if (arg == "--shadows" && (value = next()))
+            opt.shadowSize = (unsigned)std::max(0, std::atoi(value));
+        else if (arg == "--shadow-interval" && (value = next()))
+            opt.shadowInterval = (unsigned)std::max(1, std::atoi(value));
+        else if (arg == "--shading" && (value = next()))
+        {
+            if (!ParseShadingPath(value, opt.shading))
+            {
+                std::cout << "Bad --shading: " << value << " (forward, volumes or tiled)" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--visibility")
+            opt.visibility = true;
+        else if (arg == "--gpu-pick")
+            opt.gpuPick = true;
+        else if (arg == "--rings")
+            opt.rings = true;
+        else if (arg == "--ring-fraction" && (value = next()))
+            opt.ringSettings.fraction = std::clamp((float)std::atof(value), 0.0f, 1.0f);
+        else if (arg == "--procedural")
+            opt.procedural = true;
+        else if (arg == "--lod-error" && (value = next()))
+            opt.proceduralSettings.pixelError = std::max(0.1f, (float)std::atof(value));
+        else if (arg == "--lod-max-level" && (value = next()))
+            opt.proceduralSettings.maxLevel = (unsigned)std::clamp(std::atoi(value), 0, 16);
+        else if (arg == "--hdr")
+            opt.hdr = true;
+        else if (arg == "--bloom" && (value = next()))
+            opt.hdrSettings.bloomStrength = std::max(0.0f, (float)std::atof(value));
+        else if (arg == "--exposure" && (value = next()))
+            opt.hdrSettings.exposure = std::max(0.0f, (float)std::atof(value));
+        else if (arg == "--ao")
+            opt.ao = true;
+        else if (arg == "--ao-res" && (value = next()))
+        {
+            std::string res = value;
+            if (res == "half")
+                opt.aoSettings.downscale = 2;
+            else if (res == "full")
+                opt.aoSettings.downscale = 1;
+            else
+            {
+                std::cout << "Bad --ao-res: " << value << " (half or full)" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--ao-samples" && (value = next()))
+            opt.aoSettings.samples = (unsigned)std::max(1, std::atoi(value));
+        else if (arg == "--ao-radius" && (value = next()))
+            opt.aoSettings.radius = std::max(0.01f, (float)std::atof(value));
+        else if (arg == "--ao-strength" && (value = next()))
+            opt.aoSettings.strength = std::clamp((float)std::atof(value), 0.0f, 1.0f);
+        else if (arg == "--ao-history" && (value = next()))
+            opt.aoSettings.history = std::clamp((float)std::atof(value), 0.0f, 0.98f);
+        else if (arg == "--stars")
+            opt.stars = true;
+        else if (arg == "--star-catalog" && (value = next()))
+        {
+            opt.stars = true;
+            opt.starSettings.catalog = value;
+        }
+        else if (arg == "--star-count" && (value = next()))
+            opt.starSettings.count = (unsigned)std::max(1, std::atoi(value));
+        else if (arg == "--star-mag" && (value = next()))
+            opt.starSettings.magnitudeLimit = std::clamp((float)std::atof(value), -2.0f, 14.0f);
+        else if (arg == "--write-stars" && (value = next()))
+            opt.writeStars = value;
+        else if (arg == "--belt")
+            opt.belt = true;
+        else if (arg == "--belt-count" && (value = next()))
+            opt.beltSettings.count = (unsigned)std::max(1, std::atoi(value));
+        else if (arg == "--belt-radius" && (value = next()))
+        {
+            std::vector<std::string> radii = SplitList(value);
+            if (radii.size() != 2)
+            {
+                std::cout << "Bad --belt-radius: " << value << " (expected INNER,OUTER)" << std::endl;
+                return false;
+            }
+            opt.beltSettings.innerRadius = (float)std::atof(radii[0].c_str());
+            opt.beltSettings.outerRadius = (float)std::atof(radii[1].c_str());
+        }
+        else if (arg == "--belt-mesh-distance" && (value = next()))
+            opt.beltSettings.meshDistance = std::max(0.0f, (float)std::atof(value));
+        else if (arg == "--trails" && (value = next()))
+        {
+            std::string mode = value;
+            if (mode != "history" && mode != "analytic")
+            {
+                std::cout << "Bad --trails: " << value << " (history or analytic)" << std::endl;
+                return false;
+            }
+            opt.trails = true;
+            opt.trailSettings.analytic = mode == "analytic";
+        }
+        else if (arg == "--trail-seconds" && (value = next()))
+            opt.trailSettings.seconds = std::max(0.01f, (float)std::atof(value));
+        else if (arg == "--trail-samples" && (value = next()))
+            opt.trailSettings.samples = (unsigned)std::max(2, std::atoi(value));
+        else if (arg == "--ray-bench" && (value = next()))
+            opt.rayBench = (unsigned)std::max(1, std::atoi(value));
+        else if (arg == "--path-trace" && (value = next()))
+            opt.pathTrace = (unsigned)std::max(1, std::atoi(value));
+        else if (arg == "--pt-bounces" && (value = next()))
+            opt.pathSettings.maxBounces = (unsigned)std::max(0, std::atoi(value));
+        else if (arg == "--pt-sun" && (value = next()))
+            opt.pathSettings.sunRadiance = std::max(0.0f, (float)std::atof(value));
+        else if (arg == "--compare-shading" && (value = next()))
+        {
+            opt.compareLights.clear();
+            for (const std::string& item : SplitList(value))
+                opt.compareLights.push_back((unsigned)std::max(1, std::atoi(item.c_str())));
+        }
+        else if (arg == "--compare-sizes" && (value = next()))
+        {
+            opt.compareSizes.clear();
+            for (const std::string& item : SplitList(value))
+            {
+                unsigned w = 0, h = 0;
+                if (!ParseSize(item, w, h))
+                {
+                    std::cout << "Bad --compare-sizes entry: " << item << std::endl;
+                    return false;
+                }
+                opt.compareSizes.push_back({ w, h });
+            }
+        }
+        else
+        {
+            std::cout << "Unknown or incomplete argument: " << arg << std::endl;
+            PrintUsage();
+            return false;
+        }
     }
 
-    static Mat4 Translation(float x, float y, float z)
+    if (opt.headless && opt.replayPath.empty() && opt.benchPath.empty())
     {
-        Mat4 r = Identity();
-        r.m[12] = x;
-        r.m[13] = y;
-        r.m[14] = z;
-        return r;
+        std::cout << "--headless needs --replay FILE or --bench FILE" << std::endl;
+        return false;
     }
-
-    static Mat4 Scale(float x, float y, float z)
+    if (!opt.benchPath.empty() && (!opt.recordPath.empty() || !opt.replayPath.empty()))
     {
-        Mat4 r;
-        r.m[0] = x;
-        r.m[5] = y;
-        r.m[10] = z;
-        r.m[15] = 1.0f;
-        return r;
+        std::cout << "--bench can't be combined with --record / --replay" << std::endl;
+        return false;
     }
-
-    static Mat4 RotationY(float angleRad)
+    if (opt.uncapped && opt.hasFps)
     {
-        Mat4 r = Identity();
-        float c = std::cos(angleRad);
-        float s = std::sin(angleRad);
-        r.m[0] = c;
-        r.m[2] = s;
-        r.m[8] = -s;
-        r.m[10] = c;
-        return r;
+        std::cout << "--uncapped and --fps are mutually exclusive" << std::endl;
+        return false;
     }
-
-    static Mat4 Perspective(float fovyRad, float aspect, float zNear, float zFar)
+    if (!opt.capturePath.empty() && !opt.shmExport.empty())
     {
-        Mat4 r;
-        float tanHalfFovy = std::tan(fovyRad / 2.0f);
-
-        r.m[0] = 1.0f / (aspect * tanHalfFovy);
-        r.m[5] = 1.0f / tanHalfFovy;
-        r.m[10] = -(zFar + zNear) / (zFar - zNear);
-        r.m[11] = -1.0f;
-        r.m[14] = -(2.0f * zFar * zNear) / (zFar - zNear);
-        return r;
+        std::cout << "--capture and --shm-export are mutually exclusive" << std::endl;
+        return false;
     }
-
-    static Mat4 LookAt(const Vec3& eye, const Vec3& center, const Vec3& up)
+    if ((!opt.capturePath.empty() || !opt.shmExport.empty()) && opt.headless && opt.software)
     {
-        Vec3 f = Normalize(center - eye);
-        Vec3 s = Normalize(Cross(f, up));
-        Vec3 u = Cross(s, f);
-
-        Mat4 r = Identity();
-        r.m[0] = s.x;
-        r.m[4] = s.y;
-        r.m[8] = s.z;
-
-        r.m[1] = u.x;
-        r.m[5] = u.y;
-        r.m[9] = u.z;
-
-        r.m[2] = -f.x;
-        r.m[6] = -f.y;
-        r.m[10] = -f.z;
-
-        r.m[12] = -Dot(s, eye);
-        r.m[13] = -Dot(u, eye);
-        r.m[14] = Dot(f, eye);
-        return r;
+        std::cout << "--capture / --shm-export need the OpenGL backend" << std::endl;
+        return false;
     }
-};
-
-Mat4 operator*(const Mat4& a, const Mat4& b)
-{
-    Mat4 r;
-    for (int col = 0; col < 4; ++col)
+    if (!opt.recordPath.empty() && !opt.replayPath.empty())
     {
-        for (int row = 0; row < 4; ++row)
-        {
-            r.m[col * 4 + row] =
-                a.m[0 * 4 + row] * b.m[col * 4 + 0] +
-                a.m[1 * 4 + row] * b.m[col * 4 + 1] +
-                a.m[2 * 4 + row] * b.m[col * 4 + 2] +
-                a.m[3 * 4 + row] * b.m[col * 4 + 3];
-        }
+        std::cout << "--record and --replay are mutually exclusive" << std::endl;
+        return false;
+    }
+    if (!opt.compareLights.empty() && (opt.benchPath.empty() || !opt.headless || opt.software))
+    {
+        std::cout << "--compare-shading needs --bench FILE --headless on OpenGL" << std::endl;
+        return false;
+    }
+    if (opt.visibility && (opt.shading != ShadingPath::Forward || !opt.compareLights.empty()))
+    {
+        std::cout << "--visibility replaces deferred shading, use it without --shading/--compare-shading" << std::endl;
+        return false;
     }
-    return r;
+    // до подстановки lights = 1 ниже: отвергаются только заданные --lights
+    if (opt.procedural && (opt.lights > 0 || opt.visibility || opt.shading != ShadingPath::Forward ||
+        opt.shadowSize > 0 || !opt.compareLights.empty()))
+    {
+        std::cout << "--procedural lights planets by the Sun only, use it without "
+            "--lights/--visibility/--shading/--shadows/--compare-shading" << std::endl;
+        return false;
+    }
+    if (opt.gpuPick && (opt.visibility || opt.shading != ShadingPath::Forward || opt.headless || opt.software))
+    {
+        std::cout << "--gpu-pick needs the forward OpenGL path in a window (no --visibility/--shading/--headless/--software)"
+            << std::endl;
+        return false;
+    }
+    // тени — от света Солнца, отложенное освещение без источников не нужно,
+    // HDR нужно свечение Солнца
+    if ((opt.shadowSize > 0 || opt.shading != ShadingPath::Forward || opt.hdr) && opt.lights == 0)
+        opt.lights = 1;
+    opt.starSettings.linearOutput = opt.hdr;
+    opt.beltSettings.linearOutput = opt.hdr;
+    opt.trailSettings.linearOutput = opt.hdr;
+    return true;
 }
 
+// size == 0 — теней нет
+SunShadowSettings ShadowSettings(const AppOptions& opt)
+{
+    SunShadowSettings s;
+    s.size = opt.shadowSize;
+    s.interval = opt.shadowInterval;
+    return s;
+}
+
+// период проверки файлов ассетов и таймаут ожидания событий в простое, мс
+const int kAssetPollMs = 500;
 
-GLuint LoadTextureFromFile(const std::string& filename)
+// имя скриншота по текущему времени: screenshot_20240131_235959.png
+std::string ScreenshotFileName()
 {
-    sf::Image img;
-    if (!img.loadFromFile(filename))
-    {
-        std::cout << "Failed to load texture: " << filename << std::endl;
-        return 0;
-    }
-    img.flipVertically();
+    std::time_t now = std::time(nullptr);
+    char buf[64];
+    std::strftime(buf, sizeof(buf), "screenshot_%Y%m%d_%H%M%S.png", std::localtime(&now));
+    return buf;
+}
+
+// поток кадров из --capture / --shm-export (ничего не делает без них)
+bool StartFrameStream(FrameCapture& capture, const AppOptions& opt, unsigned w, unsigned h)
+{
+    if (!opt.capturePath.empty())
+        return capture.StartRecording(opt.capturePath, w, h);
+    if (!opt.shmExport.empty())
+        return capture.StartSharedExport(opt.shmExport, w, h);
+    return true;
+}
 
-    GLuint tex;
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
+// =======================================================
+// CPU-РЕНДЕР (без окна)
+// =======================================================
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
-        img.getSize().x, img.getSize().y,
-        0, GL_RGBA, GL_UNSIGNED_BYTE, img.getPixelsPtr());
+int RunSoftwareRenderer(const AppOptions& opt)
+{
+    ThreadPool pool(opt.threads);
+    MeshData model;
+    if (!LoadOBJ("model.obj", model, pool))
+        return 1;
 
-    glGenerateMipmap(GL_TEXTURE_2D);
+    sf::Image texImage;
+    if (!LoadTextureImage("model_diffuse.png", texImage))
+        return 1;
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    SoftMesh mesh = SoftMesh::FromMeshData(model);
+    SoftTexture tex = SoftTexture::FromImage(texImage);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    SoftwareRasterizer raster(pool);
+    raster.Resize(opt.width, opt.height);
 
-    glBindTexture(GL_TEXTURE_2D, 0);
-    return tex;
-}
+    unsigned seed = opt.hasSeed ? opt.seed : static_cast<unsigned>(time(nullptr));
+    std::vector<Planet> planets = CreatePlanets(kDefaultPlanetCount, seed);
+    UpdatePlanets(planets, opt.startTime);
 
-bool LoadOBJ(const std::string& filename, std::vector<float>& outVertices)
-{
-    std::ifstream file(filename);
-    if (!file.is_open())
-    {
-        std::cout << "Failed to open OBJ: " << filename << std::endl;
-        return false;
-    }
+    Camera camera;
+    Mat4 view = camera.View();
+    Mat4 proj = MakeProjection(opt.width, opt.height);
 
-    std::vector<Vec3> positions;
-    std::vector<sf::Vector2f> texcoords;
+    std::cout << "Software renderer: " << opt.width << "x" << opt.height
+        << ", threads: " << pool.Size() << "\n";
 
-    std::string line;
-    while (std::getline(file, line))
+    const float frameDt = 1.0f / 60.0f;
+    double totalMs = 0.0;
+    std::vector<Mat4> models;
+    for (int frame = 0; frame < opt.frames; ++frame)
     {
-        if (line.empty()) continue;
-        std::istringstream iss(line);
-        std::string prefix;
-        iss >> prefix;
+        if (frame > 0)
+            UpdatePlanets(planets, frameDt);
 
-        if (prefix == "v")
-        {
-            float x, y, z;
-            iss >> x >> y >> z;
-            positions.emplace_back(x, y, z);
-        }
-        else if (prefix == "vt")
-        {
-            float u, v;
-            iss >> u >> v;
-            texcoords.emplace_back(u, v);
-        }
-        else if (prefix == "f")
-        {
-            // поддержка треугольников и квадов, индексы вида v/vt или v/vt/vn
-            std::vector<std::string> tokens;
-            std::string token;
-            while (iss >> token)
-                tokens.push_back(token);
+        sf::Clock frameClock;
+        models.clear();
+        for (const auto& p : planets)
+            models.push_back(PlanetModelMatrix(p));
+
+        raster.Clear(0.02f, 0.02f, 0.05f);
+        raster.DrawInstances(mesh, models, view, proj, tex);
+        double ms = frameClock.getElapsedTime().asMicroseconds() / 1000.0;
+        totalMs += ms;
+
+        const SoftFrameStats& st = raster.Stats();
+        std::cout << "frame " << frame << ": " << ms << " ms"
+            << " (geometry " << st.geometryMs << ", bin " << st.binMs
+            << ", raster " << st.rasterMs << "), triangles "
+            << st.trianglesSetup << "/" << st.trianglesIn << "\n";
+    }
+    std::cout << "average: " << totalMs / opt.frames << " ms/frame" << std::endl;
 
-            auto parseIndex = [&](const std::string& s, int& vi, int& ti)
-                {
-                    vi = 0; ti = 0;
-                    size_t firstSlash = s.find('/');
-                    if (firstSlash == std::string::npos)
-                    {
-                        vi = std::stoi(s);
-                        return;
-                    }
-                    std::string vStr = s.substr(0, firstSlash);
-                    if (!vStr.empty())
-                        vi = std::stoi(vStr);
-
-                    size_t secondSlash = s.find('/', firstSlash + 1);
-                    std::string vtStr;
-                    if (secondSlash == std::string::npos)
-                        vtStr = s.substr(firstSlash + 1);
-                    else
-                        vtStr = s.substr(firstSlash + 1, secondSlash - firstSlash - 1);
+    std::string output = opt.output.empty() ? "software_frame.png" : opt.output;
+    if (!raster.ToImage().saveToFile(output))
+    {
+        std::cout << "Failed to save image: " << output << std::endl;
+        return 1;
+    }
+    std::cout << "Saved: " << output << std::endl;
+    return 0;
+}
 
-                    if (!vtStr.empty())
-                        ti = std::stoi(vtStr);
-                };
+// =======================================================
+// ЭТАЛОННЫЙ КАДР ТРАССИРОВКОЙ ПУТЕЙ
+// =======================================================
 
-            auto pushVertex = [&](int vi, int ti)
-                {
-                    if (vi <= 0 || vi > (int)positions.size())
-                        return;
-                    Vec3 p = positions[vi - 1];
-                    sf::Vector2f t(0.f, 0.f);
-                    if (ti > 0 && ti <= (int)texcoords.size())
-                        t = texcoords[ti - 1];
-
-                    outVertices.push_back(p.x);
-                    outVertices.push_back(p.y);
-                    outVertices.push_back(p.z);
-                    outVertices.push_back(t.x);
-                    outVertices.push_back(t.y);
-                };
-
-            if (tokens.size() < 3) continue;
-
-            // triangulation: (0, i-1, i) для i = 2..n-1
-            int v0i, v0t;
-            parseIndex(tokens[0], v0i, v0t);
-            for (size_t i = 1; i + 1 < tokens.size(); ++i)
-            {
-                int v1i, v1t, v2i, v2t;
-                parseIndex(tokens[i], v1i, v1t);
-                parseIndex(tokens[i + 1], v2i, v2t);
+// сцена на момент --time: своя (--seed) или из сценария --bench с его камерой
+int RunPathTracer(const AppOptions& opt)
+{
+    ThreadPool pool(opt.threads);
+    MeshData model;
+    if (!LoadOBJ("model.obj", model, pool))
+        return 1;
+    sf::Image texImage;
+    if (!LoadTextureImage("model_diffuse.png", texImage))
+        return 1;
 
-                pushVertex(v0i, v0t);
-                pushVertex(v1i, v1t);
-                pushVertex(v2i, v2t);
-            }
-        }
+    unsigned seed = opt.hasSeed ? opt.seed : static_cast<unsigned>(time(nullptr));
+    int planetCount = kDefaultPlanetCount;
+    float simTime = opt.startTime;
+    Camera camera;
+    if (!opt.benchPath.empty())
+    {
+        CameraPath path;
+        if (!path.Load(opt.benchPath))
+            return 1;
+        seed = path.Seed();
+        planetCount = path.PlanetCount();
+        simTime = path.StartTime() + opt.startTime;
+        camera = path.Evaluate(opt.startTime);
     }
-
-    if (outVertices.empty())
+    std::vector<Planet> planets = CreatePlanets(planetCount, seed);
+    UpdatePlanets(planets, simTime);
+
+    PathTracerSettings settings = opt.pathSettings;
+    settings.seed = seed;
+    settings.exposure = opt.hdrSettings.exposure;
+    PathTracer tracer(pool, settings);
+    tracer.SetModel(model, texImage);
+    tracer.SetPlanets(planets);
+    tracer.SetCamera(camera, opt.width, opt.height);
+
+    // промежуточные кадры на 4, 8, 16... отсчётах — в тот же файл
+    std::string output = opt.output.empty() ? "path_traced.png" : opt.output;
+    sf::Clock clock;
+    for (unsigned s = 1; s <= opt.pathTrace; ++s)
     {
-        std::cout << "OBJ has no vertices: " << filename << std::endl;
-        return false;
+        tracer.RenderPass();
+        bool checkpoint = s == opt.pathTrace || (s >= 4 && (s & (s - 1)) == 0);
+        if (!checkpoint)
+            continue;
+        if (!tracer.ToImage().saveToFile(output))
+        {
+            std::cout << "Failed to save image: " << output << std::endl;
+            return 1;
+        }
+        std::cout << "Path traced " << s << "/" << opt.pathTrace << " spp, "
+            << clock.getElapsedTime().asSeconds() << " s -> " << output << std::endl;
     }
-
-    std::cout << "OBJ loaded: " << filename
-        << ", vertices: " << outVertices.size() / 5 << std::endl;
-    return true;
+    std::cout << "Path tracer (t = " << simTime << " s): " << tracer.Summary() << std::endl;
+    return 0;
 }
 
-struct Mesh
-{
-    GLuint VAO = 0;
-    GLuint VBO = 0;
-    GLsizei vertexCount = 0;
-};
+// =======================================================
+// ВОСПРОИЗВЕДЕНИЕ ЗАПИСИ БЕЗ ОКНА
+// =======================================================
 
-Mesh CreateMeshFromInterleaved(const std::vector<float>& data)
+int RunHeadlessReplay(const AppOptions& opt)
 {
-    Mesh m;
-    m.vertexCount = static_cast<GLsizei>(data.size() / 5);
+    InputPlayer player;
+    if (!player.Open(opt.replayPath))
+        return 1;
 
-    glGenVertexArrays(1, &m.VAO);
-    glGenBuffers(1, &m.VBO);
+    ThreadPool pool(opt.threads);
+    MeshData model;
+    if (!LoadOBJ("model.obj", model, pool))
+        return 1;
 
-    glBindVertexArray(m.VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m.VBO);
-    glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STATIC_DRAW);
+    sf::Image texImage;
+    if (!LoadTextureImage("model_diffuse.png", texImage))
+        return 1;
 
-    // layout (location=0) vec3 position
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    HeadlessRenderer headless;
+    if (!headless.Init(opt.software, pool, opt.width, opt.height, model, texImage))
+        return 1;
+    if (!headless.EnableLighting(opt.lights) || !headless.EnableSunShadows(ShadowSettings(opt)) ||
+        !headless.SetShadingPath(opt.shading) || !headless.EnableVisibilityBuffer(opt.visibility) ||
+        (opt.rings && !headless.EnableRings(opt.ringSettings)) ||
+        (opt.procedural && !headless.EnableProceduralPlanets(opt.proceduralSettings, pool)) ||
+        (opt.hdr && !headless.EnableHdr(opt.hdrSettings)) ||
+        (opt.ao && !headless.EnableAmbientOcclusion(opt.aoSettings)) ||
+        (opt.stars && !headless.EnableStarfield(opt.starSettings)) ||
+        (opt.belt && !headless.EnableAsteroidBelt(opt.beltSettings)) ||
+        (opt.trails && !headless.EnableOrbitTrails(opt.trailSettings)))
+        return 1;
 
-    // layout (location=1) vec2 texcoord
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+    const RecordingHeader& header = player.Header();
+    std::vector<Planet> planets = CreatePlanets((int)header.planetCount, header.seed);
+    UpdatePlanets(planets, header.startTime);
+    float simTime = header.startTime;
+    Camera camera = header.camera;
+    Mat4 proj = MakeProjection(opt.width, opt.height);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    FrameCapture capture;
+    if (!opt.capturePath.empty() || !opt.shmExport.empty())
+    {
+        capture.Init();
+        if (!StartFrameStream(capture, opt, opt.width, opt.height))
+            return 1;
+    }
+
+    FrameTimeStats frameStats;
+    FrameInput input;
+    while (player.Next(input))
+    {
+        if (opt.fixedDt > 0.0f)
+            input.dt = opt.fixedDt;
+
+        sf::Clock frameClock;
+        ApplyCameraInput(camera, input);
+        UpdatePlanets(planets, SimulationDt(input));
+        simTime += SimulationDt(input);
+        headless.Render(planets, camera.View(), proj, simTime);
+        capture.CaptureFrame(opt.width, opt.height);
+        frameStats.Add(frameClock.getElapsedTime().asMicroseconds() / 1000.0);
+    }
+    capture.Stop();
 
-    return m;
+    std::cout << "Replay (" << (headless.IsSoftware() ? "software" : "OpenGL") << ", "
+        << opt.width << "x" << opt.height << "): " << frameStats.Summary() << std::endl;
+
+    if (!opt.output.empty())
+    {
+        if (!headless.ReadImage().saveToFile(opt.output))
+        {
+            std::cout << "Failed to save image: " << opt.output << std::endl;
+            return 1;
+        }
+        std::cout << "Last frame saved: " << opt.output << std::endl;
+    }
+    return 0;
 }
 
-const char* vertexShaderSrc = R"(
-    #version 330 core
-    layout(location = 0) in vec3 aPos;
-    layout(location = 1) in vec2 aTex;
+int main(int argc, char** argv)
+{
+    setlocale(LC_ALL, "ru_RU.utf8");
 
-    uniform mat4 uModel;
-    uniform mat4 uView;
-    uniform mat4 uProj;
+    AppOptions opt;
+    if (!ParseArgs(argc, argv, opt))
+        return 1;
 
-    out vec2 vTex;
+    if (!opt.shmConsume.empty())
+        return RunSharedFrameConsumer(opt.shmConsume);
 
-    void main()
+    if (!opt.writeStars.empty())
     {
-        vTex = aTex;
-        gl_Position = uProj * uView * uModel * vec4(aPos, 1.0);
+        std::vector<StarRecord> stars = GenerateStars(opt.starSettings.count, opt.starSettings.seed);
+        if (!WriteStarCatalog(opt.writeStars, stars))
+            return 1;
+        std::cout << "Star catalog: " << stars.size() << " stars -> " << opt.writeStars << std::endl;
+        return 0;
     }
-)";
-
-const char* fragmentShaderSrc = R"(
-    #version 330 core
-    in vec2 vTex;
-    out vec4 FragColor;
 
-    uniform sampler2D uTexture;
+    if (opt.golden)
+    {
+        GoldenOptions golden;
+        golden.directory = opt.goldenDir;
+        golden.update = opt.goldenUpdate;
+        golden.software = opt.software;
+        golden.threads = opt.threads;
+        golden.budgetScale = opt.budgetScale;
+        return RunGoldenChecks(golden);
+    }
 
-    void main()
+    BenchmarkOptions bench;
+    bench.pathFile = opt.benchPath;
+    bench.software = opt.software;
+    bench.threads = opt.threads;
+    bench.width = opt.width;
+    bench.height = opt.height;
+    if (opt.fixedDt > 0.0f)
+        bench.dt = opt.fixedDt;
+    bench.lights = opt.lights;
+    bench.shadows = ShadowSettings(opt);
+    bench.shading = opt.shading;
+    bench.visibility = opt.visibility;
+    bench.rings = opt.rings;
+    bench.ringSettings = opt.ringSettings;
+    bench.procedural = opt.procedural;
+    bench.proceduralSettings = opt.proceduralSettings;
+    bench.hdr = opt.hdr;
+    bench.hdrSettings = opt.hdrSettings;
+    bench.ao = opt.ao;
+    bench.aoSettings = opt.aoSettings;
+    bench.stars = opt.stars;
+    bench.starSettings = opt.starSettings;
+    bench.belt = opt.belt;
+    bench.beltSettings = opt.beltSettings;
+    bench.trails = opt.trails;
+    bench.trailSettings = opt.trailSettings;
+    bench.compareLights = opt.compareLights;
+    bench.compareSizes = opt.compareSizes;
+    if (opt.hasSeed)
+        bench.raySeed = opt.seed;
+
+    if (opt.rayBench > 0)
     {
-        FragColor = texture(uTexture, vTex);
+        bench.rayInstances = opt.rayBench;
+        return RunRayBenchmark(bench);
     }
-)";
+    if (opt.pathTrace > 0)
+        return RunPathTracer(opt);
 
-// =======================================================
-// ПЛАНЕТЫ
-// =======================================================
+    if (opt.headless && !opt.compareLights.empty())
+        return RunShadingComparison(bench);
+    if (opt.headless)
+        return opt.benchPath.empty() ? RunHeadlessReplay(opt) : RunHeadlessBenchmark(bench);
 
+    if (opt.software)
+        return RunSoftwareRenderer(opt);
 
+    // --- запись / воспроизведение управления ---
+    InputPlayer player;
+    bool replaying = !opt.replayPath.empty();
+    if (replaying && !player.Open(opt.replayPath))
+        return 1;
 
-int main()
-{
-    setlocale(LC_ALL, "ru_RU.utf8");
+    // --- сценарный пролёт ---
+    CameraPath benchPath;
+    bool benchmarking = !opt.benchPath.empty();
+    if (benchmarking && !benchPath.Load(opt.benchPath))
+        return 1;
 
     sf::Window window(
-        sf::VideoMode({ 1200u, 900u }),
+        sf::VideoMode({ opt.width, opt.height }),
         "OpenGL Solar System (OBJ + camera)",
         sf::Style::Default
     );
-    window.setFramerateLimit(60);
+    // темп держит FramePacer; vsync выключен, чтобы не мешать замерам
+    window.setVerticalSyncEnabled(false);
     window.setActive(true);
 
     GLenum err = glewInit();
@@ -433,212 +805,433 @@ int main()
     std::cout << "OpenGL: " << glGetString(GL_VERSION) << "\n";
     std::cout << "GLSL:   " << glGetString(GL_SHADING_LANGUAGE_VERSION) << "\n";
 
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-
-    // --- шейдерная программа ---
-    GLuint vert = CompileShader(GL_VERTEX_SHADER, vertexShaderSrc);
-    GLuint frag = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSrc);
-    GLuint prog = LinkProgram(vert, frag);
-    glDeleteShader(vert);
-    glDeleteShader(frag);
-
-    GLint uModelLoc = glGetUniformLocation(prog, "uModel");
-    GLint uViewLoc = glGetUniformLocation(prog, "uView");
-    GLint uProjLoc = glGetUniformLocation(prog, "uProj");
-    GLint uTexLoc = glGetUniformLocation(prog, "uTexture");
-
-    // --- загрузка OBJ ---
-    std::vector<float> modelData;
-    if (!LoadOBJ("model.obj", modelData))
-        return 1;
-
-    Mesh modelMesh = CreateMeshFromInterleaved(modelData);
+    SetupSceneGLState();
 
-    // --- текстура для всех объектов (можно потом добавить разные) ---
-    GLuint tex = LoadTextureFromFile("model_diffuse.png");
-    if (!tex) return 1;
+    // --- потоки CPU: нормали при загрузке, BVH для выбора мышью ---
+    ThreadPool pool(opt.threads);
 
-    // --- камера ---
-    Vec3 camPos(0.0f, 3.0f, 12.0f);
-    Vec3 worldUp(0.0f, 1.0f, 0.0f);
-    float yaw = -90.0f;       // в градусах
-    float pitch = -15.0f;
+    // --- загрузка OBJ и текстуры ---
+    MeshData model;
+    if (!LoadOBJ("model.obj", model, pool))
+        return 1;
 
-    auto deg2rad = [](float d) { return d * (float)M_PI / 180.0f; };
+    sf::Image texImage;
+    if (!LoadTextureImage("model_diffuse.png", texImage))
+        return 1;
 
-    auto calcCameraFront = [&]()
+    // --- выбор планеты мышью: BVH модели один раз, планеты — на каждый щелчок ---
+    MeshBvh meshBvh;
+    meshBvh.Build(model, pool);
+    SceneBvh pickScene;
+    // --gpu-pick: номер планеты под курсором из буфера номеров основного прохода
+    GpuPicker picker;
+    if (opt.gpuPick)
+        picker.Init();
+
+    // --- кадры в полёте: CPU готовит кадр, пока GPU рисует предыдущие ---
+    FramesInFlight inflight;
+    inflight.Init(opt.framesInFlight);
+
+    // одна цепочка включения для запуска и для перезагрузки ассетов
+    auto initRenderer = [&](SceneRenderer& r, const MeshData& m, const sf::Image& t)
         {
-            float cy = std::cos(deg2rad(yaw));
-            float sy = std::sin(deg2rad(yaw));
-            float cp = std::cos(deg2rad(pitch));
-            float sp = std::sin(deg2rad(pitch));
-            Vec3 front;
-            front.x = cy * cp;
-            front.y = sp;
-            front.z = sy * cp;
-            return Normalize(front);
+            if (!r.Init(m, t, inflight.Count()) || !r.EnableLighting(opt.lights) ||
+                !r.EnableSunShadows(ShadowSettings(opt)) || !r.SetShadingPath(opt.shading) ||
+                !r.EnableVisibilityBuffer(opt.visibility) ||
+                (opt.rings && !r.EnableRings(opt.ringSettings)) ||
+                (opt.procedural && !r.EnableProceduralPlanets(opt.proceduralSettings, pool)))
+                return false;
+            if (opt.hdr)
+                r.EnableHdrOutput(opt.hdrSettings.emission);
+            r.EnableIdOutput(opt.gpuPick);
+            return true;
         };
 
-    Vec3 camFront = calcCameraFront();
+    SceneRenderer renderer;
+    if (!initRenderer(renderer, model, texImage))
+        return 1;
+
+    // --- HDR: сцена в RGBA16F, bloom и тональная компрессия при выводе ---
+    HdrBloom hdr;
+    if (opt.hdr && !hdr.Init(opt.hdrSettings))
+        return 1;
 
-    // --- матрица проекции (обновится при ресайзе) ---
-    auto makeProjection = [&](unsigned w, unsigned h)
-        {
-            float aspect = (h == 0) ? 1.0f : (float)w / (float)h;
-            return Mat4::Perspective(deg2rad(60.0f), aspect, 0.1f, 1000.0f);
-        };
+    // --- SSAO: между сценой и HDR ---
+    AmbientOcclusion ao;
+    if (opt.ao && !ao.Init(opt.aoSettings))
+        return 1;
 
-    Mat4 proj = makeProjection(window.getSize().x, window.getSize().y);
+    // --- звёздное небо: загружается один раз, переживает перезагрузку модели ---
+    Starfield stars;
+    if (opt.stars && !stars.Init(opt.starSettings))
+        return 1;
+    AsteroidBelt belt;
+    if (opt.belt && !belt.Init(opt.beltSettings))
+        return 1;
+    OrbitTrails trails;
+    if (opt.trails && !trails.Init(opt.trailSettings))
+        return 1;
 
-    struct Planet
+    // --- динамическое разрешение ---
+    DynamicResolution dynres;
+    bool useDynres = opt.dynresTargetMs > 0.0f;
+    if (useDynres)
     {
-        float orbitRadius;    // радиус орбиты
-        float orbitSpeed;     // скорость по орбите (рад/сек)
-        float selfSpeed;      // скорость вращения вокруг своей оси
-        float scale;          // масштаб модели
-        float orbitAngle = 0; // текущий угол на орбите
-        float selfAngle = 0;  // текущий угол собственного вращения
-    };
+        DynamicResolutionSettings settings;
+        settings.targetMs = opt.dynresTargetMs;
+        settings.minScale = opt.dynresMinScale;
+        if (!dynres.Init(settings, window.getSize().x, window.getSize().y))
+            return 1;
+    }
+
+    // --- захват кадров: F12 — скриншот, --capture / --shm-export — каждый кадр ---
+    FrameCapture capture;
+    capture.Init();
+    if (!StartFrameStream(capture, opt, window.getSize().x, window.getSize().y))
+        return 1;
+
+    // --- камера ---
+    Camera camera;
+
+    // --- матрица проекции (обновится при ресайзе) ---
+    Mat4 proj = MakeProjection(window.getSize().x, window.getSize().y);
 
     // --- планеты (0-я — "Солнце") ---
-    srand(static_cast<unsigned>(time(nullptr)));
-    auto frand = [](float a, float b)
-        {
-            return a + (b - a) * (rand() / (float)RAND_MAX);
-        };
-    int planetCount = 100;
-    std::vector<Planet> planets;
-    planets.push_back({ 0.0f, 0.0f, 0.2f, 4.0f });   // Солнце — в центре, большое
-
-    for (int i = 0; i < planetCount; i++) {
-        float orbitRadius = i/2 + 4.0f;
-        float orbitSpeed = frand(0.5f, 1.5f) / orbitRadius;
-        float selfSpeed = frand(0.3f, 1.5f); 
-        float scale = frand(0.4f, 1.5f);
-        float orbitAngle = frand(0.0f, 360.0f);
-        float selfAngle = frand(0.0f, 360.0f);
-
-        planets.push_back({
-            orbitRadius,
-            orbitSpeed,
-            selfSpeed,
-            scale,
-            orbitAngle,
-            selfAngle
-            });
+    RecordingHeader recHeader;
+    recHeader.seed = opt.hasSeed ? opt.seed : static_cast<unsigned>(time(nullptr));
+    recHeader.planetCount = kDefaultPlanetCount;
+    recHeader.startTime = opt.startTime;
+    recHeader.camera = camera;
+    if (replaying)
+    {
+        recHeader = player.Header();
+        camera = recHeader.camera;
     }
-    
+    else if (benchmarking)
+    {
+        recHeader.seed = benchPath.Seed();
+        recHeader.planetCount = (uint32_t)benchPath.PlanetCount();
+        recHeader.startTime = benchPath.StartTime();
+        camera = benchPath.Evaluate(0.0f);
+    }
+
+    std::vector<Planet> planets = CreatePlanets((int)recHeader.planetCount, recHeader.seed);
+    UpdatePlanets(planets, recHeader.startTime);
+    float simTime = recHeader.startTime;   // для пояса астероидов и следов орбит
+
     /*planets.push_back({ 6.0f, 0.4f, 0.7f, 1.0f });
     planets.push_back({ 8.0f, 0.3f, 1.3f, 1.2f });
     planets.push_back({ 10.0f, 0.2f, 0.9f, 0.9f });
     planets.push_back({ 12.0f, 0.15f, 0.5f, 1.4f });*/
 
-    // --- время ---
-    sf::Clock clock;
+    InputRecorder recorder;
+    if (!opt.recordPath.empty() && !recorder.Open(opt.recordPath, recHeader))
+        return 1;
 
-    float cameraSpeed = 7.0f;       // юнитов/сек
-    float rotationSpeed = 50.0f;    // град/сек для стрелок
+    // --- время ---
+    FramePacer pacer;
+    bool uncapped = opt.uncapped || (benchmarking && !opt.hasFps);
+    pacer.SetTargetRate(uncapped ? 0.0 : opt.fps);
 
-    while (window.isOpen())
-    {
-        float dt = clock.restart().asSeconds();
+    sf::Clock clock;
+    FrameTimeStats frameStats;
+
+    // --- простой: без изменений кадр не перерисовывается ---
+    bool interactive = !replaying && !benchmarking;
+    bool paused = opt.startPaused;
+    bool redraw = true;           // на экране устаревший кадр
+    bool idle = false;
+    size_t idleWakeups = 0;
+    size_t framesDrawn = 0;
+
+    // горячая перезагрузка модели и текстуры
+    FileWatcher assetWatcher;
+    assetWatcher.Add("model.obj");
+    assetWatcher.Add("model_diffuse.png");
+    sf::Clock assetClock;
+    auto reloadAssets = [&]()
+        {
+            MeshData newModel;
+            sf::Image newTex;
+            if (!LoadOBJ("model.obj", newModel, pool) || !LoadTextureImage("model_diffuse.png", newTex))
+            {
+                std::cout << "Asset reload failed, keeping previous assets" << std::endl;
+                return false;
+            }
+            // новый рендер целиком рядом со старым; старый уничтожается,
+            // только когда новый готов, иначе остаётся как был
+            SceneRenderer fresh;
+            if (!initRenderer(fresh, newModel, newTex))
+            {
+                fresh.Destroy();
+                std::cout << "Asset reload failed, keeping previous assets" << std::endl;
+                return false;
+            }
+            std::swap(renderer, fresh);
+            fresh.Destroy();
+            meshBvh.Build(newModel, pool);
+            return true;
+        };
 
-        while (auto event = window.pollEvent())
+    auto handleEvent = [&](const sf::Event& event)
         {
-            if (event->is<sf::Event::Closed>())
+            if (event.is<sf::Event::Closed>())
                 window.close();
 
-            if (const auto* resized = event->getIf<sf::Event::Resized>())
+            if (const auto* resized = event.getIf<sf::Event::Resized>())
             {
                 glViewport(0, 0, resized->size.x, resized->size.y);
-                proj = makeProjection(resized->size.x, resized->size.y);
+                proj = MakeProjection(resized->size.x, resized->size.y);
+                if (useDynres)
+                    dynres.Resize(resized->size.x, resized->size.y);
+                redraw = true;
             }
-        }
 
-        camFront = calcCameraFront();
-        Vec3 camRight = Normalize(Cross(camFront, worldUp));
-
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W))
-            camPos = camPos + camFront * (cameraSpeed * dt);
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::S))
-            camPos = camPos - camFront * (cameraSpeed * dt);
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A))
-            camPos = camPos - camRight * (cameraSpeed * dt);
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D))
-            camPos = camPos + camRight * (cameraSpeed * dt);
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Space))
-            camPos = camPos + worldUp * (cameraSpeed * dt);
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LShift))
-            camPos = camPos - worldUp * (cameraSpeed * dt);
-
-        // поворот (стрелочки)
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left))
-            yaw -= rotationSpeed * dt;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right))
-            yaw += rotationSpeed * dt;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Up))
-            pitch += rotationSpeed * dt * 0.5f;
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Down))
-            pitch -= rotationSpeed * dt * 0.5f;
-
-        if (pitch > 89.0f) pitch = 89.0f;
-        if (pitch < -89.0f) pitch = -89.0f;
-
-        camFront = calcCameraFront();
-        Mat4 view = Mat4::LookAt(camPos, camPos + camFront, worldUp);
+            if (event.is<sf::Event::FocusGained>())
+                redraw = true;
 
-        // =================== ОБНОВЛЕНИЕ ПЛАНЕТ ===================
-        for (auto& p : planets)
+            if (const auto* key = event.getIf<sf::Event::KeyPressed>())
+            {
+                if (key->code == sf::Keyboard::Key::F12)
+                {
+                    capture.RequestScreenshot(ScreenshotFileName());
+                    redraw = true;
+                }
+                if (key->code == sf::Keyboard::Key::P)
+                {
+                    paused = !paused;
+                    redraw = true;
+                }
+            }
+
+            if (const auto* click = event.getIf<sf::Event::MouseButtonPressed>())
+            {
+                if (click->button == sf::Mouse::Button::Left && opt.gpuPick)
+                {
+                    // ответ — через кадр-другой, см. picker.Poll
+                    sf::Vector2u size = window.getSize();
+                    picker.RequestPick(click->position.x + 0.5f, click->position.y + 0.5f, size.x, size.y);
+                    redraw = true;
+                }
+                else if (click->button == sf::Mouse::Button::Left && opt.procedural)
+                {
+                    // на экране сферы, а не модель: BVH модели тут не поможет
+                    sf::Vector2u size = window.getSize();
+                    Ray ray = CameraRay(camera, click->position.x + 0.5f, click->position.y + 0.5f, size.x, size.y);
+                    RayHit hit;
+                    if (IntersectPlanetSpheres(planets, renderer.proceduralPlanets.SphereRadius(), ray, hit))
+                        std::cout << "Picked planet " << hit.instance << ", distance " << hit.t << std::endl;
+                    else
+                        std::cout << "Picked nothing" << std::endl;
+                }
+                else if (click->button == sf::Mouse::Button::Left)
+                {
+                    sf::Vector2u size = window.getSize();
+                    Ray ray = CameraRay(camera, click->position.x + 0.5f, click->position.y + 0.5f, size.x, size.y);
+                    pickScene.Build(planets, meshBvh, pool);
+                    RayHit hit;
+                    if (pickScene.Intersect(ray, hit))
+                    {
+                        float uv[2];
+                        meshBvh.TexCoord(hit.triangle, hit.u, hit.v, uv);
+                        std::cout << "Picked planet " << hit.instance << ", uv (" << uv[0] << ", " << uv[1]
+                            << "), distance " << hit.t << std::endl;
+                    }
+                    else
+                    {
+                        std::cout << "Picked nothing" << std::endl;
+                    }
+                }
+            }
+        };
+
+    SegmentReport benchReport(benchPath);
+    int benchFrames = benchmarking ? BenchmarkFrameCount(benchPath, bench.dt) : 0;
+    int benchFrame = 0;
+    size_t benchSegment = 0;
+
+    while (window.isOpen())
+    {
+        if (assetClock.getElapsedTime() >= sf::milliseconds(kAssetPollMs))
         {
-            p.orbitAngle += p.orbitSpeed * dt;
-            p.selfAngle += p.selfSpeed * dt;
+            assetClock.restart();
+            if (assetWatcher.Changed() && reloadAssets())
+            {
+                std::cout << "Assets reloaded" << std::endl;
+                redraw = true;
+            }
         }
 
-        // =================== РЕНДЕР ===================
-        glClearColor(0.02f, 0.02f, 0.05f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // симуляция стоит, камера не двигается, событий нет — спим в ожидании
+        // события: ни симуляции, ни рендера, ни display()
+        if (opt.onDemand && interactive && paused && !redraw && !picker.Pending() &&
+            (SampleKeyboard(0.0f).keys & kCameraKeys) == 0)
+        {
+            idle = true;
+            ++idleWakeups;
+            if (auto event = window.waitEvent(sf::milliseconds(kAssetPollMs)))
+                handleEvent(*event);
+            continue;
+        }
+        if (idle)
+        {
+            // время простоя не идёт в dt и в статистику темпа
+            idle = false;
+            pacer.Restart();
+            clock.restart();
+        }
 
-        glUseProgram(prog);
-        glUniform1i(uTexLoc, 0);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, tex);
+        // ждём срока кадра до опроса событий и клавиатуры
+        pacer.WaitForNextFrame();
+        float dt = clock.restart().asSeconds();
 
-        glUniformMatrix4fv(uViewLoc, 1, GL_FALSE, view.m);
-        glUniformMatrix4fv(uProjLoc, 1, GL_FALSE, proj.m);
+        while (auto event = window.pollEvent())
+            handleEvent(*event);
 
-        glBindVertexArray(modelMesh.VAO);
+        // выбор мышью с GPU: результаты прошлых кадров, без ожидания
+        uint32_t pickedId = 0;
+        unsigned pickLatency = 0;
+        while (picker.Poll(pickedId, pickLatency))
+        {
+            if (benchmarking)
+                continue;
+            if (pickedId == GpuPicker::kNoInstance)
+                std::cout << "Picked nothing (GPU id buffer, " << pickLatency << " frames later)" << std::endl;
+            else
+                std::cout << "Picked planet " << pickedId << " (GPU id buffer, " << pickLatency
+                    << " frames later)" << std::endl;
+        }
+        // пролёт меряет цену выбора: запрос в центр окна каждый кадр
+        if (opt.gpuPick && benchmarking)
+            picker.RequestPick(0.5f, 0.5f, 1, 1);
 
-        for (const auto& p : planets)
+        // управление: живая клавиатура или запись
+        FrameInput input;
+        if (replaying)
         {
-            float x = 0.0f;
-            float z = 0.0f;
-            if (p.orbitRadius > 0.0f)
+            if (!player.Next(input))
             {
-                x = std::cos(p.orbitAngle) * p.orbitRadius;
-                z = std::sin(p.orbitAngle) * p.orbitRadius;
+                window.close();
+                break;
             }
+            if (opt.fixedDt > 0.0f)
+                input.dt = opt.fixedDt;
+            frameStats.Add(dt * 1000.0f);
+        }
+        else if (benchmarking)
+        {
+            // dt — длительность предыдущего кадра; первый кадр с загрузкой не считаем
+            if (benchFrame > 0)
+                benchReport.Add(benchSegment, dt * 1000.0f);
+            if (benchFrame == benchFrames)
+            {
+                window.close();
+                break;
+            }
+            float t = benchFrame * bench.dt;
+            benchSegment = benchPath.SegmentAt(t);
+            camera = benchPath.Evaluate(t);
+            input.dt = bench.dt;
+            ++benchFrame;
+        }
+        else
+        {
+            input = SampleKeyboard(dt);
+            if (paused)
+                input.keys |= kSimPaused;
+            recorder.Write(input);
+        }
 
-            Mat4 model = Mat4::Translation(x, 0.0f, z) *
-                Mat4::RotationY(p.selfAngle) *
-                Mat4::Scale(p.scale, p.scale, p.scale);
+        ApplyCameraInput(camera, input);
 
-            glUniformMatrix4fv(uModelLoc, 1, GL_FALSE, model.m);
-            glDrawArrays(GL_TRIANGLES, 0, modelMesh.vertexCount);
-        }
+        Mat4 view = camera.View();
 
-        glBindVertexArray(0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glUseProgram(0);
+        // =================== ОБНОВЛЕНИЕ ПЛАНЕТ ===================
+        UpdatePlanets(planets, SimulationDt(input));
+        simTime += SimulationDt(input);
 
+        // =================== РЕНДЕР ===================
+        unsigned slot = inflight.BeginFrame();
+        if (useDynres)
+            dynres.BeginScene();
+        if (opt.hdr)
+            hdr.BeginScene();
+        if (opt.ao)
+            ao.BeginScene();
+        if (opt.gpuPick)
+            picker.BeginScene();
+        renderer.Render(planets, view, proj, slot);
+        if (opt.trails)
+            trails.Draw(planets, view, proj, simTime);
+        if (opt.belt)
+            belt.Draw(view, proj, simTime);
+        if (opt.stars)
+            stars.Draw(view, proj);
+        renderer.DrawTransparent();
+        if (opt.gpuPick)
+            picker.EndScene();
+        if (opt.ao)
+            ao.EndScene(view, proj);
+        if (opt.hdr)
+            hdr.EndScene();
+        if (useDynres)
+            dynres.EndScene();
+        inflight.EndFrame();
+
+        capture.CaptureFrame(window.getSize().x, window.getSize().y);
         window.display();
+        pacer.EndFrame();
+        redraw = false;
+        ++framesDrawn;
     }
 
-    glDeleteBuffers(1, &modelMesh.VBO);
-    glDeleteVertexArrays(1, &modelMesh.VAO);
-    glDeleteTextures(1, &tex);
-    glDeleteProgram(prog);
+    recorder.Close();
+    capture.Stop();
+    std::cout << pacer.Summary() << std::endl;
+    std::cout << inflight.Summary() << std::endl;
+    if (opt.lights > 0)
+        std::cout << "Clustered lighting: " << renderer.LightingSummary() << std::endl;
+    if (opt.shadowSize > 0)
+        std::cout << "Sun shadows: " << renderer.ShadowSummary() << std::endl;
+    if (opt.shading != ShadingPath::Forward)
+        std::cout << "Deferred shading: " << renderer.ShadingSummary() << std::endl;
+    if (opt.visibility)
+        std::cout << "Visibility buffer: " << renderer.VisibilitySummary() << std::endl;
+    if (opt.rings)
+        std::cout << "Planet rings: " << renderer.RingSummary() << std::endl;
+    if (opt.procedural)
+        std::cout << "Procedural planets: " << renderer.ProceduralSummary() << std::endl;
+    if (opt.hdr)
+        std::cout << "HDR: " << hdr.Summary() << std::endl;
+    if (opt.ao)
+        std::cout << "Ambient occlusion: " << ao.Summary() << std::endl;
+    if (opt.stars)
+        std::cout << "Starfield: " << stars.Summary() << std::endl;
+    if (opt.belt)
+        std::cout << "Asteroid belt: " << belt.Summary() << std::endl;
+    if (opt.trails)
+        std::cout << "Orbit trails: " << trails.Summary() << std::endl;
+    if (useDynres)
+        std::cout << "Dynamic resolution: " << dynres.Summary() << std::endl;
+    if (opt.gpuPick)
+        std::cout << "GPU picking: " << picker.Summary() << std::endl;
+    if (opt.onDemand)
+        std::cout << "On-demand: " << framesDrawn << " frames drawn, "
+            << idleWakeups << " idle wake-ups" << std::endl;
+    if (replaying)
+        std::cout << "Replay: " << frameStats.Summary() << std::endl;
+    if (benchmarking)
+        benchReport.Print("Benchmark " + opt.benchPath + " (window)");
+
+    picker.Destroy();
+    dynres.Destroy();
+    trails.Destroy();
+    belt.Destroy();
+    stars.Destroy();
+    ao.Destroy();
+    hdr.Destroy();
+    renderer.Destroy();
+    inflight.Destroy();
 
     return 0;
 }